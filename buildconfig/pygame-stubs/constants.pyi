@@ -503,6 +503,7 @@ NUMEVENTS: int
 OPENGL: int
 OPENGLBLIT: int
 PREALLOC: int
+PREMULTIPLIED: int
 QUIT: int
 RESIZABLE: int
 RLEACCEL: int
@@ -1,4 +1,4 @@
-from typing import Union, Optional, Tuple, List, Sequence
+from typing import Any, Union, Optional, Tuple, List, Sequence, Literal
 from typing_extensions import Protocol
 
 from pygame.color import Color
@@ -38,6 +38,7 @@ def polygon(
     color: _ColorValue,
     points: Sequence[_Coordinate],
     width: int = 0,
+    fill_rule: Literal["evenodd", "nonzero"] = "evenodd",
 ) -> Rect: ...
 def circle(
     surface: Surface,
@@ -67,6 +68,7 @@ def line(
     start_pos: _Coordinate,
     end_pos: _Coordinate,
     width: int = 1,
+    cap: Literal["flat", "round", "square"] = "flat",
 ) -> Rect: ...
 def lines(
     surface: Surface,
@@ -74,6 +76,8 @@ def lines(
     closed: bool,
     points: Sequence[_Coordinate],
     width: int = 1,
+    cap: Literal["flat", "round", "square"] = "flat",
+    joint: Literal["none", "round"] = "none",
 ) -> Rect: ...
 def aaline(
     surface: Surface,
@@ -81,6 +85,7 @@ def aaline(
     start_pos: _Coordinate,
     end_pos: _Coordinate,
     blend: int = 1,
+    width: int = 1,
 ) -> Rect: ...
 def aalines(
     surface: Surface,
@@ -89,3 +94,44 @@ def aalines(
     points: Sequence[_Coordinate],
     blend: int = 1,
 ) -> Rect: ...
+def aacircle(
+    surface: Surface,
+    color: _ColorValue,
+    center: _Coordinate,
+    radius: float,
+    width: int = 0,
+) -> Rect: ...
+def aaellipse(surface: Surface, color: _ColorValue, rect: _RectValue) -> Rect: ...
+def aapolygon(
+    surface: Surface,
+    color: _ColorValue,
+    points: Sequence[_Coordinate],
+) -> Rect: ...
+def circles(
+    surface: Surface,
+    colors: Any,  # Buffer protocol is still not implemented in typing
+    centers: Any,
+    radii: Any,
+    width: int = 0,
+) -> Rect: ...
+def rects(
+    surface: Surface,
+    colors: Any,
+    rects: Any,
+    width: int = 0,
+) -> Rect: ...
+def segments(
+    surface: Surface,
+    colors: Any,
+    segments: Any,
+    width: int = 1,
+) -> Rect: ...
+def gradient_rect(
+    surface: Surface,
+    rect: _RectValue,
+    stops: Sequence[Union[_ColorValue, Tuple[float, _ColorValue]]],
+    kind: Literal["linear", "radial", "conic"] = "linear",
+    angle: float = 0,
+    center: Optional[_Coordinate] = None,
+    dither: bool = False,
+) -> Rect: ...
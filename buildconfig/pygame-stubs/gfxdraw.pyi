@@ -1,4 +1,4 @@
-from typing import Union, Tuple, List, Sequence
+from typing import Any, Optional, Union, Tuple, List, Sequence
 from typing_extensions import Protocol
 
 from pygame.surface import Surface
@@ -103,6 +103,14 @@ def filled_polygon(
 def textured_polygon(
     surface: Surface, points: Sequence[_Coordinate], texture: Surface, tx: int, ty: int
 ) -> None: ...
+def textured_triangles(
+    surface: Surface,
+    texture: Surface,
+    vertices: Any,  # Buffer protocol is still not implemented in typing
+    uvs: Any,
+    indices: Optional[Any] = None,
+    bilinear: bool = False,
+) -> None: ...
 def bezier(
     surface: Surface, points: Sequence[_Coordinate], steps: int, color: _ColorValue
 ) -> None: ...
@@ -1,4 +1,4 @@
-from typing import Any, Optional, Union, Text, Tuple, List, TypeVar, Sequence
+from typing import Any, Optional, Union, Text, Tuple, List, TypeVar, Sequence, Hashable
 from typing_extensions import Protocol
 
 from pygame.surface import Surface
@@ -34,6 +34,7 @@ def from_threshold(
     other_surface: Optional[Surface] = None,
     palette_colors: int = 1,
 ) -> Mask: ...
+def rotation_cache(mask: Mask, steps: int, scale: float = 1.0) -> List[Mask]: ...
 
 class Mask:
     def __init__(self, size: _Coordinate, fill: bool = False) -> None: ...
@@ -43,12 +44,17 @@ class Mask:
     def get_at(self, pos: _Coordinate) -> int: ...
     def set_at(self, pos: _Coordinate, value: int = 1) -> None: ...
     def overlap(self, other: Mask, offset: _Offset) -> Union[Tuple[int, int], None]: ...
+    def overlap_many(
+        self, masks: Sequence[Mask], offsets: Union[Sequence[_Coordinate], Any]
+    ) -> List[Tuple[int, Tuple[int, int]]]: ...
     def overlap_area(self, other: Mask, offset: _Coordinate) -> int: ...
     def overlap_mask(self, other: Mask, offset: _Coordinate) -> Mask: ...
     def fill(self) -> None: ...
     def clear(self) -> None: ...
     def invert(self) -> None: ...
     def scale(self, size: _Coordinate) -> Mask: ...
+    def rotate(self, angle: float) -> Mask: ...
+    def transform(self, angle: float, scale: float) -> Mask: ...
     def draw(self, other: Mask, offset: _Coordinate) -> None: ...
     def erase(self, other: Mask, offset: _Coordinate) -> None: ...
     def count(self) -> int: ...
@@ -61,10 +67,18 @@ class Mask:
         output: Optional[Mask] = None,
         offset: _Coordinate = (0, 0),
     ) -> Mask: ...
+    def dilate(self, radius: int) -> Mask: ...
+    def erode(self, radius: int) -> Mask: ...
+    def open(self, radius: int) -> Mask: ...
+    def close(self, radius: int) -> Mask: ...
+    def distance_transform(self) -> memoryview: ...
     def connected_component(
         self, pos: Union[List[int], Tuple[int, int]] = ...
     ) -> Mask: ...
     def connected_components(self, minimum: int = 0) -> List[Mask]: ...
+    def label_connected_components(
+        self, minimum: int = 0
+    ) -> Tuple[memoryview, List[Tuple[int, Rect, Tuple[int, int]]]]: ...
     def get_bounding_rects(self) -> Rect: ...
     def to_surface(
         self,
@@ -75,3 +89,32 @@ class Mask:
         unsetcolor: _ToSurfaceColorValue = (0, 0, 0, 255),
         dest: Union[_RectValue, _Coordinate] = (0, 0),
     ) -> Surface: ...
+
+class CollisionWorld:
+    def __init__(self) -> None: ...
+    def __len__(self) -> int: ...
+    def __contains__(self, key: Hashable) -> bool: ...
+    def add(self, key: Hashable, mask: Mask, offset: _Coordinate) -> None: ...
+    def move(self, key: Hashable, offset: _Coordinate) -> None: ...
+    def remove(self, key: Hashable) -> None: ...
+    def clear(self) -> None: ...
+    def query(self, mask: Mask, offset: _Coordinate) -> List[Any]: ...
+    def query_pairs(
+        self, point: bool = False, area: bool = False
+    ) -> List[Tuple[Any, ...]]: ...
+
+class SparseMask:
+    def __init__(self, size: _Coordinate, fill: bool = False) -> None: ...
+    def get_size(self) -> Tuple[int, int]: ...
+    def get_at(self, pos: _Coordinate) -> int: ...
+    def set_at(self, pos: _Coordinate, value: int = 1) -> None: ...
+    def overlap(
+        self, other: Mask, offset: _Coordinate
+    ) -> Optional[Tuple[int, int]]: ...
+    def overlap_area(self, other: Mask, offset: _Coordinate) -> int: ...
+    def draw(self, other: Mask, offset: _Coordinate) -> None: ...
+    def erase(self, other: Mask, offset: _Coordinate) -> None: ...
+    def count(self) -> int: ...
+    def fill(self) -> None: ...
+    def clear(self) -> None: ...
+    def get_tile_count(self) -> int: ...
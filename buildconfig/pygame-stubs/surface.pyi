@@ -68,6 +68,7 @@ class Surface(object):
     def convert_alpha(self, surface: Surface) -> Surface: ...
     @overload
     def convert_alpha(self) -> Surface: ...
+    def premul_alpha(self) -> Surface: ...
     def copy(self) -> Surface: ...
     def fill(
         self,
@@ -76,6 +77,7 @@ class Surface(object):
         special_flags: int = ...,
     ) -> Rect: ...
     def scroll(self, dx: int = ..., dy: int = ...) -> None: ...
+    def flip_ip(self, flip_x: bool, flip_y: bool) -> None: ...
     @overload
     def set_colorkey(self, color: _ColorInput, flags: int = ...) -> None: ...
     @overload
@@ -13,13 +13,27 @@ _RectValue = Union[
     Union[Tuple[_Coordinate, _Coordinate], List[_Coordinate]],
 ]
 
-def flip(surface: Surface, flip_x: bool, flip_y: bool) -> Surface: ...
+def flip(
+    surface: Surface,
+    flip_x: bool,
+    flip_y: bool,
+    dest_surface: Optional[Surface] = None,
+) -> Surface: ...
 def scale(
     surface: Surface,
     size: _Coordinate,
     dest_surface: Optional[Surface] = None,
 ) -> Surface: ...
-def rotate(surface: Surface, angle: float) -> Surface: ...
+def rotate(
+    surface: Surface, angle: float, dest_surface: Optional[Surface] = None
+) -> Surface: ...
+def affine(
+    surface: Surface,
+    matrix: Sequence[Sequence[float]],
+    size: Optional[_Coordinate] = None,
+    smooth: bool = False,
+    dest_surface: Optional[Surface] = None,
+) -> Surface: ...
 def rotozoom(surface: Surface, angle: float, scale: float) -> Surface: ...
 def scale2x(surface: Surface, dest_surface: Optional[Surface] = None) -> Surface: ...
 def smoothscale(
@@ -31,11 +45,40 @@ def get_smoothscale_backend() -> str: ...
 def set_smoothscale_backend(backend: str) -> None: ...
 def chop(surface: Surface, rect: _RectValue) -> Surface: ...
 def laplacian(surface: Surface, dest_surface: Surface) -> Surface: ...
+def convolve(
+    surface: Surface,
+    kernel: Sequence[Sequence[float]],
+    dest_surface: Optional[Surface] = None,
+    border: str = "clamp",
+    border_color: _ColorValue = (0, 0, 0, 0),
+) -> Surface: ...
+def apply_lut(
+    surface: Surface,
+    lut_r: Optional[Sequence[int]] = None,
+    lut_g: Optional[Sequence[int]] = None,
+    lut_b: Optional[Sequence[int]] = None,
+    lut_a: Optional[Sequence[int]] = None,
+    dest_surface: Optional[Surface] = None,
+) -> Surface: ...
+def color_matrix(
+    surface: Surface,
+    matrix: Sequence[Sequence[float]],
+    dest_surface: Optional[Surface] = None,
+) -> Surface: ...
 def average_surfaces(
     surfaces: Sequence[Surface],
     dest_surface: Optional[Surface] = None,
     palette_colors: Union[bool, int] = 1,
 ) -> Surface: ...
+
+class SurfaceAccumulator:
+    def __init__(self, size: _Coordinate) -> None: ...
+    def add(self, surface: Surface) -> None: ...
+    def get_average(self, dest_surface: Optional[Surface] = None) -> Surface: ...
+    def clear(self) -> None: ...
+    def get_count(self) -> int: ...
+    def get_size(self) -> Tuple[int, int]: ...
+
 def average_color(surface: Surface, rect: Optional[_RectValue]) -> Color: ...
 def threshold(
     dest_surface: Surface,
@@ -0,0 +1,77 @@
+#!/usr/bin/env python
+""" pygame.examples.polygontest
+
+Times draw.polygon filling polygons with many vertices.
+
+The polygons are wobbly rings, like the outlines of terrain or fog of war
+meshes, with more and more vertices. Each is filled with both the
+"evenodd" and the "nonzero" fill rule, and the average time of a call is
+printed.
+
+Run it on two pygame builds to compare them:
+
+    python -m pygame.examples.polygontest [size] [repeats]
+
+"""
+import math
+import random
+import sys
+import time
+import pygame as pg
+
+
+def make_polygon(count, size):
+    """returns a ring of count points wobbling around the surface center"""
+    center = size / 2.0
+    points = []
+    for i in range(count):
+        angle = 2 * math.pi * i / count
+        radius = size * (0.3 + 0.1 * math.sin(angle * 7)) + random.random() * 8
+        points.append(
+            (center + radius * math.cos(angle), center + radius * math.sin(angle))
+        )
+    return points
+
+
+def time_polygon(surface, points, fill_rule, repeats):
+    """returns the average time in ms of a filled draw.polygon call"""
+    start = time.perf_counter()
+    for _ in range(repeats):
+        pg.draw.polygon(surface, "white", points, fill_rule=fill_rule)
+    return (time.perf_counter() - start) / repeats * 1000
+
+
+def SpeedTest(size, repeats):
+    print("\nPolygon Speed Test - Surface Size %s\n" % str((size, size)))
+    surface = pg.Surface((size, size))
+
+    for count in (16, 256, 4096, 65536):
+        points = make_polygon(count, size)
+        print(
+            "%6d vertices: evenodd %9.4f ms, nonzero %9.4f ms."
+            % (
+                count,
+                time_polygon(surface, points, "evenodd", repeats),
+                time_polygon(surface, points, "nonzero", repeats),
+            )
+        )
+
+
+def main(size=1000, repeats=10):
+    """time filled polygons with an increasing number of vertices
+
+    Args:
+        size - width and height of the surface drawn on (default 1000)
+        repeats - calls timed per test (default 10)
+    """
+    random.seed(0)
+    SpeedTest(size, repeats)
+    pg.quit()
+
+
+if __name__ == "__main__":
+    args = sys.argv[1:]
+    main(
+        int(args[0]) if args else 1000,
+        int(args[1]) if len(args) > 1 else 10,
+    )
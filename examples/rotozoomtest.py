@@ -0,0 +1,91 @@
+#!/usr/bin/env python
+""" pygame.examples.rotozoomtest
+
+Times transform.rotozoom on an image.
+
+The filtered rotozoom splits its work across threads and releases the GIL
+while it runs. This prints the average time of a call over a range of
+angles and scales. It then times the same calls made from several Python
+threads at once, which only helps when the GIL is released.
+
+Run it on two pygame builds to compare them:
+
+    python -m pygame.examples.rotozoomtest [imagefile] [repeats]
+
+"""
+import os
+import sys
+import threading
+import time
+import pygame as pg
+
+main_dir = os.path.split(os.path.abspath(__file__))[0]
+
+
+def time_calls(image, calls):
+    """returns the average time in ms of rotozoom(image, angle, scale)"""
+    start = time.perf_counter()
+    for angle, scale in calls:
+        pg.transform.rotozoom(image, angle, scale)
+    return (time.perf_counter() - start) / len(calls) * 1000
+
+
+def time_threaded(image, calls, num_threads):
+    """returns the average time in ms per call with num_threads callers"""
+    threads = [
+        threading.Thread(target=time_calls, args=(image, calls))
+        for _ in range(num_threads)
+    ]
+    start = time.perf_counter()
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return (time.perf_counter() - start) / (len(calls) * num_threads) * 1000
+
+
+def SpeedTest(image, repeats):
+    print("\nRotozoom Speed Test - Image Size %s\n" % str(image.get_size()))
+
+    zooms = [(0.0, 0.5 + i / 16.0) for i in range(repeats)]
+    print("Average zoom only time: %.4f ms." % time_calls(image, zooms))
+
+    rotations = [(i * 360.0 / repeats, 1.0) for i in range(repeats)]
+    print("Average rotation time: %.4f ms." % time_calls(image, rotations))
+
+    rotozooms = [(i * 360.0 / repeats, 0.5 + i / 16.0) for i in range(repeats)]
+    single = time_calls(image, rotozooms)
+    print("Average rotation and zoom time: %.4f ms." % single)
+
+    for num_threads in (2, 4):
+        threaded = time_threaded(image, rotozooms, num_threads)
+        print(
+            "Average rotation and zoom time from %d threads: %.4f ms "
+            "(%.2fx)." % (num_threads, threaded, single / threaded)
+        )
+
+
+def main(imagefile=None, repeats=32):
+    """time rotozoom on an image
+
+    Args:
+        imagefile - name of source image (default data/arraydemo.bmp)
+        repeats - calls timed per test (default 32)
+    """
+    if imagefile is None:
+        imagefile = os.path.join(main_dir, "data", "arraydemo.bmp")
+    image = pg.image.load(imagefile)
+    # time a large 32 bit image, which rotozoom uses without converting it
+    size = (image.get_width() * 4, image.get_height() * 4)
+    big = pg.Surface(size, pg.SRCALPHA, 32)
+    big.blit(pg.transform.scale(image, size), (0, 0))
+    SpeedTest(big, repeats)
+    pg.quit()
+
+
+if __name__ == "__main__":
+    args = sys.argv[1:]
+    main(
+        args[0] if args else None,
+        int(args[1]) if len(args) > 1 else 32,
+    )
@@ -311,6 +311,11 @@ else:
 # headers to install
 headers = glob.glob(os.path.join('src_c', '*.h'))
 headers.remove(os.path.join('src_c', 'scale.h'))
+headers.remove(os.path.join('src_c', 'simd_shared.h'))
+headers.remove(os.path.join('src_c', 'pgthreads.h'))
+headers.remove(os.path.join('src_c', 'pgflip.h'))
+headers.remove(os.path.join('src_c', 'pgconvert.h'))
+headers.remove(os.path.join('src_c', 'pgarray.h'))
 headers.append(os.path.join('src_c', 'include'))
 
 import distutils.command.install_headers
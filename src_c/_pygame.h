@@ -228,9 +228,20 @@ typedef enum {
     PGS_RLEACCELOK = 0x00002000,
     PGS_RLEACCEL = 0x00004000,
     PGS_SRCALPHA = 0x00010000,
+    PGS_PREMULTIPLIED = 0x00020000,
     PGS_PREALLOC = 0x01000000
 } PygameSurfaceFlags;
 
+/* Marks an SDL surface whose colors are premultiplied by alpha. SDL does not
+ * use this bit of SDL_Surface.flags and leaves it alone, so the state lives
+ * with the pixels instead of in the public pgSurfaceObject struct. */
+#define PG_SURF_PREMULTIPLIED 0x10000000
+
+#define pg_IsPremultiplied(surf) (((surf)->flags & PG_SURF_PREMULTIPLIED) != 0)
+#define pg_SetPremultiplied(surf, on)                                 \
+    ((surf)->flags = (on) ? ((surf)->flags | PG_SURF_PREMULTIPLIED) \
+                          : ((surf)->flags & ~PG_SURF_PREMULTIPLIED))
+
 #else /* IS_SDLv2 */
 
 /* To maintain SDL 1.2 build support. */
@@ -3654,3 +3654,112 @@ pygame_AlphaBlit (SDL_Surface * src, SDL_Rect * srcrect,
 {
     return pygame_Blit (src, srcrect, dst, dstrect, the_args);
 }
+
+#if (defined(__SSE2__) || defined(PG_ENABLE_ARM_NEON))
+/* Premultiplies four 32 bit pixels at a time. Each color channel becomes
+   ((c + 1) * a) >> 8, as in Color.premul_alpha(); alpha is kept. */
+static void
+premul_surf_color_by_alpha_sse2(SDL_Surface *src, SDL_Surface *dst)
+{
+    int             width = src->w;
+    int             height = src->h;
+    int             x, y;
+    Uint32          amask = src->format->Amask;
+    __m128i         mm_ashift = _mm_cvtsi32_si128(src->format->Ashift);
+    __m128i         mm_zero = _mm_setzero_si128();
+    __m128i         mm_ones = _mm_set1_epi16(1);
+    __m128i         mm_amask = _mm_set1_epi32((int)amask);
+    __m128i         mm_0xff = _mm_set1_epi32(0xFF);
+
+    for (y = 0; y < height; y++) {
+        Uint32 *srcp = (Uint32 *)((Uint8 *)src->pixels + y * src->pitch);
+        Uint32 *dstp = (Uint32 *)((Uint8 *)dst->pixels + y * dst->pitch);
+
+        for (x = 0; x + 4 <= width; x += 4) {
+            __m128i pixels, alpha, lo, hi;
+
+            pixels = _mm_loadu_si128((__m128i *)(srcp + x));
+            /* 000A000A000A000A -> 0A0A0A0A0A0A0A0A, one alpha per pixel */
+            alpha = _mm_and_si128(_mm_srl_epi32(pixels, mm_ashift), mm_0xff);
+            alpha = _mm_or_si128(alpha, _mm_slli_epi32(alpha, 16));
+
+            lo = _mm_unpacklo_epi8(pixels, mm_zero);
+            lo = _mm_mullo_epi16(_mm_add_epi16(lo, mm_ones),
+                                 _mm_unpacklo_epi32(alpha, alpha));
+            hi = _mm_unpackhi_epi8(pixels, mm_zero);
+            hi = _mm_mullo_epi16(_mm_add_epi16(hi, mm_ones),
+                                 _mm_unpackhi_epi32(alpha, alpha));
+            lo = _mm_packus_epi16(_mm_srli_epi16(lo, 8),
+                                  _mm_srli_epi16(hi, 8));
+
+            /* put the untouched alpha back */
+            lo = _mm_or_si128(_mm_andnot_si128(mm_amask, lo),
+                              _mm_and_si128(mm_amask, pixels));
+            _mm_storeu_si128((__m128i *)(dstp + x), lo);
+        }
+        for (; x < width; x++) {
+            Uint32 pixel = srcp[x];
+            Uint32 a = (pixel & amask) >> src->format->Ashift;
+            Uint32 result = pixel & amask;
+            int shift;
+
+            for (shift = 0; shift < 32; shift += 8) {
+                if (!((amask >> shift) & 0xFF))
+                    result |= ((((pixel >> shift) & 0xFF) + 1) * a >> 8)
+                              << shift;
+            }
+            dstp[x] = result;
+        }
+    }
+}
+#endif /* __SSE2__ || PG_ENABLE_ARM_NEON */
+
+/* Writes src with its colors multiplied by its alpha into dst, which must
+   have the same size and format and may be src. Returns -1 if src has no
+   per-pixel alpha. */
+int
+premul_surf_color_by_alpha(SDL_Surface *src, SDL_Surface *dst)
+{
+    SDL_PixelFormat *fmt = src->format;
+    Uint8 sR, sG, sB, sA;
+    int x, y;
+
+    if (!fmt->Amask || fmt->BytesPerPixel == 1)
+        return -1;
+
+#if (defined(__SSE2__) || defined(PG_ENABLE_ARM_NEON))
+    if (fmt->BytesPerPixel == 4 && fmt->Aloss == 0 &&
+        fmt->Rloss == 0 && fmt->Gloss == 0 && fmt->Bloss == 0) {
+    #if PG_ENABLE_ARM_NEON
+        if (SDL_HasNEON() == SDL_TRUE) {
+            premul_surf_color_by_alpha_sse2(src, dst);
+            return 0;
+        }
+    #endif /* PG_ENABLE_ARM_NEON */
+    #ifdef __SSE2__
+        if (SDL_HasSSE2()) {
+            premul_surf_color_by_alpha_sse2(src, dst);
+            return 0;
+        }
+    #endif /* __SSE2__ */
+    }
+#endif /* __SSE2__ || PG_ENABLE_ARM_NEON */
+
+    for (y = 0; y < src->h; y++) {
+        Uint8 *srcp = (Uint8 *)src->pixels + y * src->pitch;
+        Uint8 *dstp = (Uint8 *)dst->pixels + y * dst->pitch;
+        Uint32 pixel;
+
+        for (x = 0; x < src->w; x++) {
+            GET_PIXEL(pixel, fmt->BytesPerPixel, srcp);
+            SDL_GetRGBA(pixel, fmt, &sR, &sG, &sB, &sA);
+            sR = (Uint8)(((sR + 1) * sA) >> 8);
+            sG = (Uint8)(((sG + 1) * sA) >> 8);
+            sB = (Uint8)(((sB + 1) * sA) >> 8);
+            CREATE_PIXEL(dstp, sR, sG, sB, sA, fmt->BytesPerPixel, fmt);
+            srcp += fmt->BytesPerPixel;
+            dstp += fmt->BytesPerPixel;
+        }
+    }
+    return 0;
+}
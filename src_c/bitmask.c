@@ -21,6 +21,7 @@
  */
 
 #include "include/bitmask.h"
+#include <math.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
@@ -99,6 +100,241 @@ positive_modulo(int dividend, int divisor)
     return (result >= 0) ? result : result + divisor;
 }
 
+/* Row kernels.
+ *
+ * A mask is stored as stripes of BITMASK_W_LEN columns, with the words of
+ * a stripe's rows next to each other. So the inner loops of the overlap
+ * functions all run over the rows of a stripe of a and a stripe of b,
+ * combining each pair of words as
+ *
+ *     a[row] & ((b[row] << lshift) >> rshift)
+ *
+ * where at most one of the shifts is not 0, to line the columns of b up
+ * with those of a. The kernels below do this for n rows. On x86-64 with
+ * GCC or clang, AVX2 versions doing 4 rows at a time and a hardware
+ * popcount are chosen at run time.
+ */
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__LP64__) && \
+    !defined(BITMASK_NO_SIMD)
+#define BITMASK_X86_SIMD 1
+#include <immintrin.h>
+
+#define BITMASK_CPU_BASIC 0
+#define BITMASK_CPU_POPCNT 1
+#define BITMASK_CPU_AVX2 2 /* and popcnt */
+
+/* Set once by bitmask_init(), before any thread uses the kernels. */
+static int bitmask_cpu = BITMASK_CPU_BASIC;
+
+#endif /* BITMASK_X86_SIMD */
+
+void
+bitmask_init(void)
+{
+#ifdef BITMASK_X86_SIMD
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("popcnt")) {
+        bitmask_cpu = BITMASK_CPU_BASIC;
+    }
+    else if (!__builtin_cpu_supports("avx2")) {
+        bitmask_cpu = BITMASK_CPU_POPCNT;
+    }
+    else {
+        bitmask_cpu = BITMASK_CPU_AVX2;
+    }
+#endif /* BITMASK_X86_SIMD */
+}
+
+#ifdef BITMASK_X86_SIMD
+__attribute__((target("avx2"))) static int
+bitmask_rows_first_avx2(const BITMASK_W *a, const BITMASK_W *b, int n,
+                        int lshift, int rshift)
+{
+    const __m128i lcount = _mm_cvtsi32_si128(lshift);
+    const __m128i rcount = _mm_cvtsi32_si128(rshift);
+    __m256i v;
+    int row;
+
+    for (row = 0; row + 4 <= n; row += 4) {
+        v = _mm256_srl_epi64(
+            _mm256_sll_epi64(_mm256_loadu_si256((const __m256i *)(b + row)),
+                             lcount),
+            rcount);
+        v = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(a + row)),
+                             v);
+        if (!_mm256_testz_si256(v, v)) {
+            break;
+        }
+    }
+    for (; row < n; row++) {
+        if (a[row] & ((b[row] << lshift) >> rshift)) {
+            return row;
+        }
+    }
+    return n;
+}
+
+/* Counts the bits 4 rows at a time, looking up the count of each nibble
+ * with a byte shuffle. */
+__attribute__((target("avx2,popcnt"))) static unsigned int
+bitmask_rows_count_avx2(const BITMASK_W *a, const BITMASK_W *b, int n,
+                        int lshift, int rshift)
+{
+    const __m128i lcount = _mm_cvtsi32_si128(lshift);
+    const __m128i rcount = _mm_cvtsi32_si128(rshift);
+    const __m256i nibble_counts =
+        _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1,
+                         1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i v, counts, total = zero;
+    unsigned int count;
+    int row;
+
+    for (row = 0; row + 4 <= n; row += 4) {
+        v = _mm256_srl_epi64(
+            _mm256_sll_epi64(_mm256_loadu_si256((const __m256i *)(b + row)),
+                             lcount),
+            rcount);
+        v = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(a + row)),
+                             v);
+        counts = _mm256_add_epi8(
+            _mm256_shuffle_epi8(nibble_counts,
+                                _mm256_and_si256(v, low_nibbles)),
+            _mm256_shuffle_epi8(
+                nibble_counts,
+                _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibbles)));
+        /* Sum the byte counts into the 4 64 bit lanes. */
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(counts, zero));
+    }
+    count = (unsigned int)(_mm256_extract_epi64(total, 0) +
+                           _mm256_extract_epi64(total, 1) +
+                           _mm256_extract_epi64(total, 2) +
+                           _mm256_extract_epi64(total, 3));
+    for (; row < n; row++) {
+        count += __builtin_popcountl(a[row] & ((b[row] << lshift) >> rshift));
+    }
+    return count;
+}
+
+__attribute__((target("popcnt"))) static unsigned int
+bitmask_rows_count_popcnt(const BITMASK_W *a, const BITMASK_W *b, int n,
+                          int lshift, int rshift)
+{
+    unsigned int count = 0;
+    int row;
+
+    for (row = 0; row < n; row++) {
+        count += __builtin_popcountl(a[row] & ((b[row] << lshift) >> rshift));
+    }
+    return count;
+}
+
+__attribute__((target("avx2"))) static void
+bitmask_rows_and_avx2(BITMASK_W *c, const BITMASK_W *a, const BITMASK_W *b,
+                      int n, int lshift, int rshift, int accumulate)
+{
+    const __m128i lcount = _mm_cvtsi32_si128(lshift);
+    const __m128i rcount = _mm_cvtsi32_si128(rshift);
+    __m256i v;
+    int row;
+
+    for (row = 0; row + 4 <= n; row += 4) {
+        v = _mm256_srl_epi64(
+            _mm256_sll_epi64(_mm256_loadu_si256((const __m256i *)(b + row)),
+                             lcount),
+            rcount);
+        v = _mm256_and_si256(_mm256_loadu_si256((const __m256i *)(a + row)),
+                             v);
+        if (accumulate) {
+            v = _mm256_or_si256(_mm256_loadu_si256((__m256i *)(c + row)), v);
+        }
+        _mm256_storeu_si256((__m256i *)(c + row), v);
+    }
+    for (; row < n; row++) {
+        if (accumulate) {
+            c[row] |= a[row] & ((b[row] << lshift) >> rshift);
+        }
+        else {
+            c[row] = a[row] & ((b[row] << lshift) >> rshift);
+        }
+    }
+}
+#endif /* BITMASK_X86_SIMD */
+
+/* Returns the first of n rows where a and the shifted b overlap, or n if
+ * they do not. */
+static INLINE int
+bitmask_rows_first(const BITMASK_W *a, const BITMASK_W *b, int n,
+                   int lshift, int rshift)
+{
+    int row;
+
+#ifdef BITMASK_X86_SIMD
+    if (bitmask_cpu == BITMASK_CPU_AVX2) {
+        return bitmask_rows_first_avx2(a, b, n, lshift, rshift);
+    }
+#endif /* BITMASK_X86_SIMD */
+
+    for (row = 0; row < n; row++) {
+        if (a[row] & ((b[row] << lshift) >> rshift)) {
+            return row;
+        }
+    }
+    return n;
+}
+
+/* Returns the number of bits set in both a and the shifted b, in n
+ * rows. */
+static INLINE unsigned int
+bitmask_rows_count(const BITMASK_W *a, const BITMASK_W *b, int n,
+                   int lshift, int rshift)
+{
+    unsigned int count = 0;
+    int row;
+
+#ifdef BITMASK_X86_SIMD
+    switch (bitmask_cpu) {
+        case BITMASK_CPU_AVX2:
+            return bitmask_rows_count_avx2(a, b, n, lshift, rshift);
+        case BITMASK_CPU_POPCNT:
+            return bitmask_rows_count_popcnt(a, b, n, lshift, rshift);
+    }
+#endif /* BITMASK_X86_SIMD */
+
+    for (row = 0; row < n; row++) {
+        count += bitcount(a[row] & ((b[row] << lshift) >> rshift));
+    }
+    return count;
+}
+
+/* Sets c to a and the shifted b, in n rows, or ors it into c if
+ * accumulate is not 0. */
+static INLINE void
+bitmask_rows_and(BITMASK_W *c, const BITMASK_W *a, const BITMASK_W *b, int n,
+                 int lshift, int rshift, int accumulate)
+{
+    int row;
+
+#ifdef BITMASK_X86_SIMD
+    if (bitmask_cpu == BITMASK_CPU_AVX2) {
+        bitmask_rows_and_avx2(c, a, b, n, lshift, rshift, accumulate);
+        return;
+    }
+#endif /* BITMASK_X86_SIMD */
+
+    if (accumulate) {
+        for (row = 0; row < n; row++) {
+            c[row] |= a[row] & ((b[row] << lshift) >> rshift);
+        }
+    }
+    else {
+        for (row = 0; row < n; row++) {
+            c[row] = a[row] & ((b[row] << lshift) >> rshift);
+        }
+    }
+}
+
 bitmask_t *
 bitmask_create(int w, int h)
 {
@@ -232,20 +468,12 @@ bitmask_invert(bitmask_t *m)
 unsigned int
 bitmask_count(bitmask_t *m)
 {
-    BITMASK_W *pixels;
-    unsigned int tot = 0;
-
     if (!m->w || !m->h) {
-        return tot;
-    }
-
-    for (pixels = m->bits;
-         pixels < (m->bits + m->h * ((m->w - 1) / BITMASK_W_LEN + 1));
-         pixels++) {
-        tot += bitcount(*pixels);
+        return 0;
     }
 
-    return tot;
+    return bitmask_rows_count(m->bits, m->bits,
+                              m->h * ((m->w - 1) / BITMASK_W_LEN + 1), 0, 0);
 }
 
 int
@@ -254,8 +482,8 @@ bitmask_overlap(const bitmask_t *a, const bitmask_t *b, int xoffset,
 {
     const BITMASK_W *a_entry, *a_end;
     const BITMASK_W *b_entry;
-    const BITMASK_W *ap, *app, *bp;
     unsigned int shift, rshift, i, astripes, bstripes;
+    int rows;
 
     /* Return if no overlap or one mask has a width/height of 0. */
     if ((xoffset >= a->w) || (yoffset >= a->h) || (yoffset <= -b->h) ||
@@ -276,6 +504,7 @@ bitmask_overlap(const bitmask_t *a, const bitmask_t *b, int xoffset,
             a_end = a_entry + MIN(b->h + yoffset, a->h);
             b_entry = b->bits - yoffset;
         }
+        rows = (int)(a_end - a_entry);
         shift = xoffset & BITMASK_W_MASK;
         if (shift) {
             rshift = BITMASK_W_LEN - shift;
@@ -285,30 +514,26 @@ bitmask_overlap(const bitmask_t *a, const bitmask_t *b, int xoffset,
             if (bstripes > astripes) /* zig-zag .. zig*/
             {
                 for (i = 0; i < astripes; i++) {
-                    for (ap = a_entry, app = ap + a->h, bp = b_entry;
-                         ap < a_end;)
-                        if ((*ap++ >> shift) & *bp ||
-                            (*app++ << rshift) & *bp++)
-                            return 1;
+                    if (bitmask_rows_first(a_entry, b_entry, rows, shift, 0) <
+                            rows ||
+                        bitmask_rows_first(a_entry + a->h, b_entry, rows, 0,
+                                           rshift) < rows)
+                        return 1;
                     a_entry += a->h;
-                    a_end += a->h;
                     b_entry += b->h;
                 }
-                for (ap = a_entry, bp = b_entry; ap < a_end;)
-                    if ((*ap++ >> shift) & *bp++)
-                        return 1;
-                return 0;
+                return bitmask_rows_first(a_entry, b_entry, rows, shift, 0) <
+                       rows;
             }
             else /* zig-zag */
             {
                 for (i = 0; i < bstripes; i++) {
-                    for (ap = a_entry, app = ap + a->h, bp = b_entry;
-                         ap < a_end;)
-                        if ((*ap++ >> shift) & *bp ||
-                            (*app++ << rshift) & *bp++)
-                            return 1;
+                    if (bitmask_rows_first(a_entry, b_entry, rows, shift, 0) <
+                            rows ||
+                        bitmask_rows_first(a_entry + a->h, b_entry, rows, 0,
+                                           rshift) < rows)
+                        return 1;
                     a_entry += a->h;
-                    a_end += a->h;
                     b_entry += b->h;
                 }
                 return 0;
@@ -319,11 +544,9 @@ bitmask_overlap(const bitmask_t *a, const bitmask_t *b, int xoffset,
         {
             astripes = (MIN(b->w, a->w - xoffset) - 1) / BITMASK_W_LEN + 1;
             for (i = 0; i < astripes; i++) {
-                for (ap = a_entry, bp = b_entry; ap < a_end;)
-                    if (*ap++ & *bp++)
-                        return 1;
+                if (bitmask_rows_first(a_entry, b_entry, rows, 0, 0) < rows)
+                    return 1;
                 a_entry += a->h;
-                a_end += a->h;
                 b_entry += b->h;
             }
             return 0;
@@ -364,8 +587,9 @@ bitmask_overlap_pos(const bitmask_t *a, const bitmask_t *b, int xoffset,
     }
 
     if (xoffset >= 0) {
-        const BITMASK_W *a_entry, *a_end, *b_entry, *ap, *bp;
+        const BITMASK_W *a_entry, *a_end, *b_entry;
         unsigned int shift, rshift, i, astripes, bstripes, xbase;
+        int row, rows;
 
         xbase = xoffset / BITMASK_W_LEN; /* first stripe from mask a */
 
@@ -380,6 +604,7 @@ bitmask_overlap_pos(const bitmask_t *a, const bitmask_t *b, int xoffset,
             b_entry = b->bits - yoffset;
             yoffset = 0; /* relied on below */
         }
+        rows = (int)(a_end - a_entry);
         shift = xoffset & BITMASK_W_MASK;
         if (shift) {
             rshift = BITMASK_W_LEN - shift;
@@ -388,52 +613,58 @@ bitmask_overlap_pos(const bitmask_t *a, const bitmask_t *b, int xoffset,
             if (bstripes > astripes) /* zig-zag .. zig*/
             {
                 for (i = 0; i < astripes; i++) {
-                    for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++)
-                        if (*ap & (*bp << shift)) {
-                            *y = (int)(ap - a_entry) + yoffset;
-                            *x = (xbase + i) * BITMASK_W_LEN +
-                                 firstsetbit(*ap & (*bp << shift));
-                            return 1;
-                        }
+                    row = bitmask_rows_first(a_entry, b_entry, rows, shift,
+                                             0);
+                    if (row < rows) {
+                        *y = row + yoffset;
+                        *x = (xbase + i) * BITMASK_W_LEN +
+                             firstsetbit(a_entry[row] &
+                                         (b_entry[row] << shift));
+                        return 1;
+                    }
                     a_entry += a->h;
-                    a_end += a->h;
-                    for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++)
-                        if (*ap & (*bp >> rshift)) {
-                            *y = (int)(ap - a_entry) + yoffset;
-                            *x = (xbase + i + 1) * BITMASK_W_LEN +
-                                 firstsetbit(*ap & (*bp >> rshift));
-                            return 1;
-                        }
-                    b_entry += b->h;
-                }
-                for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++)
-                    if (*ap & (*bp << shift)) {
-                        *y = (int)(ap - a_entry) + yoffset;
-                        *x = (xbase + astripes) * BITMASK_W_LEN +
-                             firstsetbit(*ap & (*bp << shift));
+                    row = bitmask_rows_first(a_entry, b_entry, rows, 0,
+                                             rshift);
+                    if (row < rows) {
+                        *y = row + yoffset;
+                        *x = (xbase + i + 1) * BITMASK_W_LEN +
+                             firstsetbit(a_entry[row] &
+                                         (b_entry[row] >> rshift));
                         return 1;
                     }
+                    b_entry += b->h;
+                }
+                row = bitmask_rows_first(a_entry, b_entry, rows, shift, 0);
+                if (row < rows) {
+                    *y = row + yoffset;
+                    *x = (xbase + astripes) * BITMASK_W_LEN +
+                         firstsetbit(a_entry[row] & (b_entry[row] << shift));
+                    return 1;
+                }
                 return 0;
             }
             else /* zig-zag */
             {
                 for (i = 0; i < bstripes; i++) {
-                    for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++)
-                        if (*ap & (*bp << shift)) {
-                            *y = (int)(ap - a_entry) + yoffset;
-                            *x = (xbase + i) * BITMASK_W_LEN +
-                                 firstsetbit(*ap & (*bp << shift));
-                            return 1;
-                        }
+                    row = bitmask_rows_first(a_entry, b_entry, rows, shift,
+                                             0);
+                    if (row < rows) {
+                        *y = row + yoffset;
+                        *x = (xbase + i) * BITMASK_W_LEN +
+                             firstsetbit(a_entry[row] &
+                                         (b_entry[row] << shift));
+                        return 1;
+                    }
                     a_entry += a->h;
-                    a_end += a->h;
-                    for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++)
-                        if (*ap & (*bp >> rshift)) {
-                            *y = (int)(ap - a_entry) + yoffset;
-                            *x = (xbase + i + 1) * BITMASK_W_LEN +
-                                 firstsetbit(*ap & (*bp >> rshift));
-                            return 1;
-                        }
+                    row = bitmask_rows_first(a_entry, b_entry, rows, 0,
+                                             rshift);
+                    if (row < rows) {
+                        *y = row + yoffset;
+                        *x = (xbase + i + 1) * BITMASK_W_LEN +
+                             firstsetbit(a_entry[row] &
+                                         (b_entry[row] >> rshift));
+                        return 1;
+                    }
                     b_entry += b->h;
                 }
                 return 0;
@@ -445,16 +676,14 @@ bitmask_overlap_pos(const bitmask_t *a, const bitmask_t *b, int xoffset,
         {
             astripes = (MIN(b->w, a->w - xoffset) - 1) / BITMASK_W_LEN + 1;
             for (i = 0; i < astripes; i++) {
-                for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++) {
-                    if (*ap & *bp) {
-                        *y = (int)(ap - a_entry) + yoffset;
-                        *x = (xbase + i) * BITMASK_W_LEN +
-                             firstsetbit(*ap & *bp);
-                        return 1;
-                    }
+                row = bitmask_rows_first(a_entry, b_entry, rows, 0, 0);
+                if (row < rows) {
+                    *y = row + yoffset;
+                    *x = (xbase + i) * BITMASK_W_LEN +
+                         firstsetbit(a_entry[row] & b_entry[row]);
+                    return 1;
                 }
                 a_entry += a->h;
-                a_end += a->h;
                 b_entry += b->h;
             }
             return 0;
@@ -475,9 +704,10 @@ int
 bitmask_overlap_area(const bitmask_t *a, const bitmask_t *b, int xoffset,
                      int yoffset)
 {
-    const BITMASK_W *a_entry, *a_end, *b_entry, *ap, *bp;
+    const BITMASK_W *a_entry, *a_end, *b_entry;
     unsigned int shift, rshift, i, astripes, bstripes;
     unsigned int count = 0;
+    int rows;
 
     /* Return if no overlap or one mask has a width/height of 0. */
     if ((xoffset >= a->w) || (yoffset >= a->h) || (yoffset <= -b->h) ||
@@ -497,6 +727,7 @@ bitmask_overlap_area(const bitmask_t *a, const bitmask_t *b, int xoffset,
             a_end = a_entry + MIN(b->h + yoffset, a->h);
             b_entry = b->bits - yoffset;
         }
+        rows = (int)(a_end - a_entry);
         shift = xoffset & BITMASK_W_MASK;
         if (shift) {
             rshift = BITMASK_W_LEN - shift;
@@ -505,25 +736,24 @@ bitmask_overlap_area(const bitmask_t *a, const bitmask_t *b, int xoffset,
             if (bstripes > astripes) /* zig-zag .. zig*/
             {
                 for (i = 0; i < astripes; i++) {
-                    for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++)
-                        count += bitcount(
-                            ((*ap >> shift) | (*(ap + a->h) << rshift)) & *bp);
+                    count += bitmask_rows_count(a_entry, b_entry, rows, shift,
+                                                0) +
+                             bitmask_rows_count(a_entry + a->h, b_entry, rows,
+                                                0, rshift);
                     a_entry += a->h;
-                    a_end += a->h;
                     b_entry += b->h;
                 }
-                for (ap = a_entry, bp = b_entry; ap < a_end;)
-                    count += bitcount((*ap++ >> shift) & *bp++);
+                count += bitmask_rows_count(a_entry, b_entry, rows, shift, 0);
                 return count;
             }
             else /* zig-zag */
             {
                 for (i = 0; i < bstripes; i++) {
-                    for (ap = a_entry, bp = b_entry; ap < a_end; ap++, bp++)
-                        count += bitcount(
-                            ((*ap >> shift) | (*(ap + a->h) << rshift)) & *bp);
+                    count += bitmask_rows_count(a_entry, b_entry, rows, shift,
+                                                0) +
+                             bitmask_rows_count(a_entry + a->h, b_entry, rows,
+                                                0, rshift);
                     a_entry += a->h;
-                    a_end += a->h;
                     b_entry += b->h;
                 }
                 return count;
@@ -534,11 +764,8 @@ bitmask_overlap_area(const bitmask_t *a, const bitmask_t *b, int xoffset,
         {
             astripes = (MIN(b->w, a->w - xoffset) - 1) / BITMASK_W_LEN + 1;
             for (i = 0; i < astripes; i++) {
-                for (ap = a_entry, bp = b_entry; ap < a_end;)
-                    count += bitcount(*ap++ & *bp++);
-
+                count += bitmask_rows_count(a_entry, b_entry, rows, 0, 0);
                 a_entry += a->h;
-                a_end += a->h;
                 b_entry += b->h;
             }
             return count;
@@ -559,8 +786,8 @@ void
 bitmask_overlap_mask(const bitmask_t *a, const bitmask_t *b, bitmask_t *c,
                      int xoffset, int yoffset)
 {
-    const BITMASK_W *a_entry, *ap;
-    const BITMASK_W *b_entry, *bp;
+    const BITMASK_W *a_entry;
+    const BITMASK_W *b_entry;
     BITMASK_W *c_entry, *cp;
     int shift, rshift, i, astripes, bstripes;
 
@@ -594,42 +821,37 @@ bitmask_overlap_mask(const bitmask_t *a, const bitmask_t *b, bitmask_t *c,
             if (bstripes > astripes) /* zig-zag .. zig*/
             {
                 for (i = 0; i < astripes; i++) {
-                    for (ap = a_entry, bp = b_entry, cp = c_entry; ap < a_end;
-                         ap++, bp++, cp++)
-                        *cp |= *ap & (*bp << shift);
+                    bitmask_rows_and(c_entry, a_entry, b_entry,
+                                     (int)(a_end - a_entry), shift, 0, 1);
 
                     /* The c_entry (output mask) must advance with a_entry. */
                     a_entry += a->h;
                     a_end += a->h;
                     c_entry += c->h;
 
-                    for (ap = a_entry, bp = b_entry, cp = c_entry; ap < a_end;
-                         ap++, bp++, cp++)
-                        *cp |= *ap & (*bp >> rshift);
+                    bitmask_rows_and(c_entry, a_entry, b_entry,
+                                     (int)(a_end - a_entry), 0, rshift, 1);
 
                     b_entry += b->h;
                 }
 
                 /* This is the '.. zig' to handle the remaining bits. */
-                for (ap = a_entry, bp = b_entry, cp = c_entry; ap < a_end;
-                     ap++, bp++, cp++)
-                    *cp |= *ap & (*bp << shift);
+                bitmask_rows_and(c_entry, a_entry, b_entry,
+                                 (int)(a_end - a_entry), shift, 0, 1);
             }
             else /* zig-zag */
             {
                 for (i = 0; i < bstripes; i++) {
-                    for (ap = a_entry, bp = b_entry, cp = c_entry; ap < a_end;
-                         ap++, bp++, cp++)
-                        *cp |= *ap & (*bp << shift);
+                    bitmask_rows_and(c_entry, a_entry, b_entry,
+                                     (int)(a_end - a_entry), shift, 0, 1);
 
                     /* The c_entry (output mask) must advance with a_entry. */
                     a_entry += a->h;
                     a_end += a->h;
                     c_entry += c->h;
 
-                    for (ap = a_entry, bp = b_entry, cp = c_entry; ap < a_end;
-                         ap++, bp++, cp++)
-                        *cp |= *ap & (*bp >> rshift);
+                    bitmask_rows_and(c_entry, a_entry, b_entry,
+                                     (int)(a_end - a_entry), 0, rshift, 1);
 
                     b_entry += b->h;
                 }
@@ -640,10 +862,8 @@ bitmask_overlap_mask(const bitmask_t *a, const bitmask_t *b, bitmask_t *c,
         {
             astripes = (MIN(b->w, a->w - xoffset) - 1) / BITMASK_W_LEN + 1;
             for (i = 0; i < astripes; i++) {
-                for (ap = a_entry, bp = b_entry, cp = c_entry; ap < a_end;
-                     ap++, bp++, cp++) {
-                    *cp = *ap & *bp;
-                }
+                bitmask_rows_and(c_entry, a_entry, b_entry,
+                                 (int)(a_end - a_entry), 0, 0, 0);
                 a_entry += a->h;
                 c_entry += c->h;
                 a_end += a->h;
@@ -677,32 +897,27 @@ bitmask_overlap_mask(const bitmask_t *a, const bitmask_t *b, bitmask_t *c,
             if (bstripes > astripes) /* zig-zag .. zig*/
             {
                 for (i = 0; i < astripes; i++) {
-                    for (bp = b_entry, ap = a_entry, cp = c_entry; bp < b_end;
-                         bp++, ap++, cp++)
-                        *cp = *ap & (*bp >> shift);
+                    bitmask_rows_and(c_entry, a_entry, b_entry,
+                                     (int)(b_end - b_entry), 0, shift, 0);
                     b_entry += b->h;
                     b_end += b->h;
-                    for (bp = b_entry, ap = a_entry, cp = c_entry; bp < b_end;
-                         bp++, ap++, cp++)
-                        *cp |= *ap & (*bp << rshift);
+                    bitmask_rows_and(c_entry, a_entry, b_entry,
+                                     (int)(b_end - b_entry), rshift, 0, 1);
                     a_entry += a->h;
                     c_entry += c->h;
                 }
-                for (bp = b_entry, ap = a_entry, cp = c_entry; bp < b_end;
-                     bp++, ap++, cp++)
-                    *cp = *ap & (*bp >> shift);
+                bitmask_rows_and(c_entry, a_entry, b_entry,
+                                 (int)(b_end - b_entry), 0, shift, 0);
             }
             else /* zig-zag */
             {
                 for (i = 0; i < bstripes; i++) {
-                    for (bp = b_entry, ap = a_entry, cp = c_entry; bp < b_end;
-                         bp++, ap++, cp++)
-                        *cp = *ap & (*bp >> shift);
+                    bitmask_rows_and(c_entry, a_entry, b_entry,
+                                     (int)(b_end - b_entry), 0, shift, 0);
                     b_entry += b->h;
                     b_end += b->h;
-                    for (bp = b_entry, ap = a_entry, cp = c_entry; bp < b_end;
-                         bp++, ap++, cp++)
-                        *cp |= *ap & (*bp << rshift);
+                    bitmask_rows_and(c_entry, a_entry, b_entry,
+                                     (int)(b_end - b_entry), rshift, 0, 1);
                     a_entry += a->h;
                     c_entry += c->h;
                 }
@@ -713,10 +928,8 @@ bitmask_overlap_mask(const bitmask_t *a, const bitmask_t *b, bitmask_t *c,
         {
             astripes = (MIN(a->w, b->w - xoffset) - 1) / BITMASK_W_LEN + 1;
             for (i = 0; i < astripes; i++) {
-                for (bp = b_entry, ap = a_entry, cp = c_entry; bp < b_end;
-                     bp++, ap++, cp++) {
-                    *cp = *ap & *bp;
-                }
+                bitmask_rows_and(c_entry, a_entry, b_entry,
+                                 (int)(b_end - b_entry), 0, 0, 0);
                 b_entry += b->h;
                 b_end += b->h;
                 a_entry += a->h;
@@ -1087,3 +1300,280 @@ bitmask_convolve(const bitmask_t *a, const bitmask_t *b, bitmask_t *output,
             if (bitmask_getbit(b, x, y))
                 bitmask_draw(output, a, xoffset - x, yoffset - y);
 }
+
+/* ORs the n words of src, shifted by shift bits towards larger x (or
+ * smaller x if shift is negative), into dst. Bits shifted past either end
+ * are dropped. */
+static void
+bitmask_row_or_shifted(BITMASK_W *dst, const BITMASK_W *src, int n,
+                       int shift)
+{
+    int i, words, bits;
+
+    if (shift >= 0) {
+        words = shift / BITMASK_W_LEN;
+        bits = shift % BITMASK_W_LEN;
+        for (i = n - 1; i >= words; i--) {
+            dst[i] |= src[i - words] << bits;
+            if (bits && i > words) {
+                dst[i] |= src[i - words - 1] >> (BITMASK_W_LEN - bits);
+            }
+        }
+    }
+    else {
+        words = -shift / BITMASK_W_LEN;
+        bits = -shift % BITMASK_W_LEN;
+        for (i = 0; i < n - words; i++) {
+            dst[i] |= src[i + words] >> bits;
+            if (bits && i + words + 1 < n) {
+                dst[i] |= src[i + words + 1] << (BITMASK_W_LEN - bits);
+            }
+        }
+    }
+}
+
+/* Returns the largest dx with dx * dx + dy * dy <= r * r. */
+static int
+disk_half_width(int r, int dy)
+{
+    int dx = (int)sqrt((double)r * r - (double)dy * dy);
+
+    while ((double)dx * dx + (double)dy * dy > (double)r * r) {
+        dx--;
+    }
+    while ((double)(dx + 1) * (dx + 1) + (double)dy * dy <= (double)r * r) {
+        dx++;
+    }
+    return dx;
+}
+
+bitmask_t *
+bitmask_dilate(const bitmask_t *m, int radius)
+{
+    bitmask_t *o;
+    BITMASK_W *row, *tmp, *bits, cmask;
+    int x, y, dy, i, n, margin, len, reach, width, step, shift;
+
+    if (radius < 0) {
+        return NULL;
+    }
+
+    o = bitmask_create(m->w, m->h);
+    if (!o || !m->w || !m->h) {
+        return o;
+    }
+
+    /* Every set bit reaches every bit of the mask at this radius. */
+    if (radius > m->w + m->h) {
+        radius = m->w + m->h;
+    }
+
+    /* Each row is dilated horizontally in a buffer with room for the bits
+     * that spread past the sides, since those can be shifted back in by
+     * the later passes. */
+    n = (m->w - 1) / BITMASK_W_LEN + 1;
+    margin = (radius - 1) / BITMASK_W_LEN + 1;
+    len = n + 2 * margin;
+    row = malloc(2 * len * sizeof(BITMASK_W));
+    if (!row) {
+        bitmask_free(o);
+        return NULL;
+    }
+    tmp = row + len;
+
+    shift = positive_modulo(BITMASK_W_LEN - m->w, (int)BITMASK_W_LEN);
+    cmask = (~(BITMASK_W)0) >> shift;
+
+    for (y = 0; y < m->h; y++) {
+        for (x = 0; x < n; x++) {
+            if (m->bits[x * m->h + y]) {
+                break;
+            }
+        }
+        if (x == n) {
+            continue;
+        }
+
+        memset(row, 0, len * sizeof(BITMASK_W));
+        for (x = 0; x < n; x++) {
+            row[margin + x] = m->bits[x * m->h + y];
+        }
+
+        /* The disk is drawn from its widest rows at the top and bottom
+         * inwards, widening the row by shift-OR passes. Each pass can at
+         * most double the width without leaving gaps. */
+        reach = 0;
+        for (dy = radius; dy >= 0; dy--) {
+            width = disk_half_width(radius, dy);
+            while (reach < width) {
+                step = MIN(width - reach, 2 * reach + 1);
+                memcpy(tmp, row, len * sizeof(BITMASK_W));
+                bitmask_row_or_shifted(row, tmp, len, step);
+                bitmask_row_or_shifted(row, tmp, len, -step);
+                reach += step;
+            }
+
+            for (i = (y - dy >= 0 ? -1 : 1); i <= 1; i += 2) {
+                if (y + i * dy >= m->h) {
+                    break;
+                }
+                bits = o->bits + y + i * dy;
+                for (x = 0; x < n; x++) {
+                    bits[x * o->h] |= row[margin + x];
+                }
+                bits[(n - 1) * o->h] &= cmask;
+                if (!dy) {
+                    break;
+                }
+            }
+        }
+    }
+
+    free(row);
+    return o;
+}
+
+bitmask_t *
+bitmask_erode(const bitmask_t *m, int radius)
+{
+    bitmask_t *inverse, *o;
+    int x, y;
+
+    if (radius < 0) {
+        return NULL;
+    }
+
+    /* A bit stays set if no unset bit is within the radius, which is
+     * the inverse of dilating the unset bits. The bits around the edges
+     * are cleared too, as the bits past the edges count as unset. */
+    inverse = bitmask_copy((bitmask_t *)m);
+    if (!inverse) {
+        return NULL;
+    }
+    bitmask_invert(inverse);
+    o = bitmask_dilate(inverse, radius);
+    bitmask_free(inverse);
+    if (!o || !o->w || !o->h) {
+        return o;
+    }
+    bitmask_invert(o);
+
+    if (radius >= o->w - radius || radius >= o->h - radius) {
+        bitmask_clear(o);
+        return o;
+    }
+    for (y = 0; y < o->h; y++) {
+        for (x = 0; x < radius; x++) {
+            bitmask_clearbit(o, x, y);
+            bitmask_clearbit(o, o->w - 1 - x, y);
+        }
+    }
+    for (y = 0; y < radius; y++) {
+        for (x = 0; x < o->w; x++) {
+            bitmask_clearbit(o, x, y);
+            bitmask_clearbit(o, x, o->h - 1 - y);
+        }
+    }
+    return o;
+}
+
+/* Narrows [*x0, *x1) to the values of x for which a + x * d, rounded down,
+ * may be in [0, size). The range is widened by a bit on each side, so the
+ * caller still has to check each value. */
+static void
+rotozoom_clip(double a, double d, int size, int *x0, int *x1)
+{
+    double lo, hi, t;
+
+    if (fabs(d) < 1e-12) {
+        if (a < 0.0 || a >= size) {
+            *x1 = *x0;
+        }
+        return;
+    }
+
+    lo = -a / d;
+    hi = (size - a) / d;
+    if (lo > hi) {
+        t = lo;
+        lo = hi;
+        hi = t;
+    }
+    if (lo > *x1 || hi < *x0) {
+        *x1 = *x0;
+        return;
+    }
+    if (lo > *x0) {
+        *x0 = MAX(*x0, (int)floor(lo) - 1);
+    }
+    if (hi < *x1) {
+        *x1 = MIN(*x1, (int)ceil(hi) + 1);
+    }
+}
+
+bitmask_t *
+bitmask_rotozoom(const bitmask_t *m, int w, int h, double sangle,
+                 double cangle, double scale)
+{
+    bitmask_t *o;
+    BITMASK_W word;
+    double dcx = w / 2.0, dcy = h / 2.0, scx = m->w / 2.0, scy = m->h / 2.0;
+    double ax, ay, dx, dy;
+    long long fx, fy, idx, idy;
+    int x, y, x0, x1, end;
+
+    if (w < 0 || h < 0 || !(scale >= 0.0) ||
+        (w && h && scale > 0.0 && scale < BITMASK_ROTOZOOM_MIN_SCALE)) {
+        return NULL;
+    }
+
+    o = bitmask_create(w, h);
+    if (!o || !w || !h || !m->w || !m->h || scale == 0.0) {
+        return o;
+    }
+
+    /* The center of each bit of o is rotated back by the angle and scaled
+     * down around the center of o, and then takes the bit of m it lands
+     * on. Along a row of o the position in m moves by a fixed step, so it
+     * is kept in 32.32 fixed point, which the minimum scale keeps the step
+     * within. */
+    dx = cangle / scale;
+    dy = sangle / scale;
+    idx = (long long)floor(dx * 4294967296.0 + 0.5);
+    idy = (long long)floor(dy * 4294967296.0 + 0.5);
+
+    for (y = 0; y < h; y++) {
+        ax = scx + (cangle * (0.5 - dcx) - sangle * (y + 0.5 - dcy)) / scale;
+        ay = scy + (sangle * (0.5 - dcx) + cangle * (y + 0.5 - dcy)) / scale;
+
+        /* Only the part of the row landing in m needs to be looked at,
+         * the rest stays clear. */
+        x0 = 0;
+        x1 = w;
+        rotozoom_clip(ax, dx, m->w, &x0, &x1);
+        rotozoom_clip(ay, dy, m->h, &x0, &x1);
+        if (x0 >= x1) {
+            continue;
+        }
+
+        fx = (long long)floor((ax + x0 * dx) * 4294967296.0 + 0.5);
+        fy = (long long)floor((ay + x0 * dy) * 4294967296.0 + 0.5);
+
+        /* Build each word of the row before storing it. */
+        for (x = x0; x < x1;) {
+            end = MIN(x1, (x / (int)BITMASK_W_LEN + 1) * (int)BITMASK_W_LEN);
+            word = 0;
+            for (; x < end; x++) {
+                if (fx >= 0 && fy >= 0 && (fx >> 32) < m->w &&
+                    (fy >> 32) < m->h &&
+                    bitmask_getbit(m, (int)(fx >> 32), (int)(fy >> 32))) {
+                    word |= BITMASK_N(x & BITMASK_W_MASK);
+                }
+                fx += idx;
+                fy += idy;
+            }
+            o->bits[(x - 1) / BITMASK_W_LEN * h + y] = word;
+        }
+    }
+    return o;
+}
@@ -106,6 +106,7 @@ MODINIT_DEFINE(constants)
     DEC_CONSTSF(RLEACCELOK);
     DEC_CONSTSF(RLEACCEL);
     DEC_CONSTSF(SRCALPHA);
+    DEC_CONSTSF(PREMULTIPLIED);
     DEC_CONSTSF(PREALLOC);
     DEC_CONSTSF(NOFRAME);
     DEC_CONSTSF(SHOWN);
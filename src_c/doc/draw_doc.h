@@ -1,14 +1,21 @@
 /* Auto generated file: with makeref.py .  Docs go in docs/reST/ref/ . */
 #define DOC_PYGAMEDRAW "pygame module for drawing shapes"
 #define DOC_PYGAMEDRAWRECT "rect(surface, color, rect) -> Rect\nrect(surface, color, rect, width=0, border_radius=0, border_top_left_radius=-1, border_top_right_radius=-1, border_bottom_left_radius=-1, border_bottom_right_radius=-1) -> Rect\ndraw a rectangle"
-#define DOC_PYGAMEDRAWPOLYGON "polygon(surface, color, points) -> Rect\npolygon(surface, color, points, width=0) -> Rect\ndraw a polygon"
+#define DOC_PYGAMEDRAWPOLYGON "polygon(surface, color, points) -> Rect\npolygon(surface, color, points, width=0) -> Rect\npolygon(surface, color, points, width=0, fill_rule=\"evenodd\") -> Rect\ndraw a polygon"
 #define DOC_PYGAMEDRAWCIRCLE "circle(surface, color, center, radius) -> Rect\ncircle(surface, color, center, radius, width=0, draw_top_right=None, draw_top_left=None, draw_bottom_left=None, draw_bottom_right=None) -> Rect\ndraw a circle"
 #define DOC_PYGAMEDRAWELLIPSE "ellipse(surface, color, rect) -> Rect\nellipse(surface, color, rect, width=0) -> Rect\ndraw an ellipse"
 #define DOC_PYGAMEDRAWARC "arc(surface, color, rect, start_angle, stop_angle) -> Rect\narc(surface, color, rect, start_angle, stop_angle, width=1) -> Rect\ndraw an elliptical arc"
-#define DOC_PYGAMEDRAWLINE "line(surface, color, start_pos, end_pos) -> Rect\nline(surface, color, start_pos, end_pos, width=1) -> Rect\ndraw a straight line"
-#define DOC_PYGAMEDRAWLINES "lines(surface, color, closed, points) -> Rect\nlines(surface, color, closed, points, width=1) -> Rect\ndraw multiple contiguous straight line segments"
-#define DOC_PYGAMEDRAWAALINE "aaline(surface, color, start_pos, end_pos) -> Rect\naaline(surface, color, start_pos, end_pos, blend=1) -> Rect\ndraw a straight antialiased line"
+#define DOC_PYGAMEDRAWLINE "line(surface, color, start_pos, end_pos) -> Rect\nline(surface, color, start_pos, end_pos, width=1) -> Rect\nline(surface, color, start_pos, end_pos, width=1, cap=\"flat\") -> Rect\ndraw a straight line"
+#define DOC_PYGAMEDRAWLINES "lines(surface, color, closed, points) -> Rect\nlines(surface, color, closed, points, width=1) -> Rect\nlines(surface, color, closed, points, width=1, cap=\"flat\", joint=\"none\") -> Rect\ndraw multiple contiguous straight line segments"
+#define DOC_PYGAMEDRAWAALINE "aaline(surface, color, start_pos, end_pos) -> Rect\naaline(surface, color, start_pos, end_pos, blend=1) -> Rect\naaline(surface, color, start_pos, end_pos, blend=1, width=1) -> Rect\ndraw a straight antialiased line"
 #define DOC_PYGAMEDRAWAALINES "aalines(surface, color, closed, points) -> Rect\naalines(surface, color, closed, points, blend=1) -> Rect\ndraw multiple contiguous straight antialiased line segments"
+#define DOC_PYGAMEDRAWAACIRCLE "aacircle(surface, color, center, radius) -> Rect\naacircle(surface, color, center, radius, width=0) -> Rect\ndraw an antialiased circle"
+#define DOC_PYGAMEDRAWAAELLIPSE "aaellipse(surface, color, rect) -> Rect\ndraw a filled antialiased ellipse"
+#define DOC_PYGAMEDRAWAAPOLYGON "aapolygon(surface, color, points) -> Rect\ndraw a filled antialiased polygon"
+#define DOC_PYGAMEDRAWCIRCLES "circles(surface, colors, centers, radii) -> Rect\ncircles(surface, colors, centers, radii, width=0) -> Rect\ndraw many circles"
+#define DOC_PYGAMEDRAWRECTS "rects(surface, colors, rects) -> Rect\nrects(surface, colors, rects, width=0) -> Rect\ndraw many rectangles"
+#define DOC_PYGAMEDRAWSEGMENTS "segments(surface, colors, segments) -> Rect\nsegments(surface, colors, segments, width=1) -> Rect\ndraw many separate straight line segments"
+#define DOC_PYGAMEDRAWGRADIENTRECT "gradient_rect(surface, rect, stops) -> Rect\ngradient_rect(surface, rect, stops, kind=\"linear\", angle=0, center=None, dither=False) -> Rect\nfill a rectangle with a color gradient"
 
 
 /* Docs in a comment... slightly easier to read. */
@@ -26,6 +33,7 @@ draw a rectangle
 pygame.draw.polygon
  polygon(surface, color, points) -> Rect
  polygon(surface, color, points, width=0) -> Rect
+ polygon(surface, color, points, width=0, fill_rule="evenodd") -> Rect
 draw a polygon
 
 pygame.draw.circle
@@ -46,16 +54,19 @@ draw an elliptical arc
 pygame.draw.line
  line(surface, color, start_pos, end_pos) -> Rect
  line(surface, color, start_pos, end_pos, width=1) -> Rect
+ line(surface, color, start_pos, end_pos, width=1, cap="flat") -> Rect
 draw a straight line
 
 pygame.draw.lines
  lines(surface, color, closed, points) -> Rect
  lines(surface, color, closed, points, width=1) -> Rect
+ lines(surface, color, closed, points, width=1, cap="flat", joint="none") -> Rect
 draw multiple contiguous straight line segments
 
 pygame.draw.aaline
  aaline(surface, color, start_pos, end_pos) -> Rect
  aaline(surface, color, start_pos, end_pos, blend=1) -> Rect
+ aaline(surface, color, start_pos, end_pos, blend=1, width=1) -> Rect
 draw a straight antialiased line
 
 pygame.draw.aalines
@@ -63,4 +74,37 @@ pygame.draw.aalines
  aalines(surface, color, closed, points, blend=1) -> Rect
 draw multiple contiguous straight antialiased line segments
 
-*/
\ No newline at end of file
+pygame.draw.aacircle
+ aacircle(surface, color, center, radius) -> Rect
+ aacircle(surface, color, center, radius, width=0) -> Rect
+draw an antialiased circle
+
+pygame.draw.aaellipse
+ aaellipse(surface, color, rect) -> Rect
+draw a filled antialiased ellipse
+
+pygame.draw.aapolygon
+ aapolygon(surface, color, points) -> Rect
+draw a filled antialiased polygon
+
+pygame.draw.circles
+ circles(surface, colors, centers, radii) -> Rect
+ circles(surface, colors, centers, radii, width=0) -> Rect
+draw many circles
+
+pygame.draw.rects
+ rects(surface, colors, rects) -> Rect
+ rects(surface, colors, rects, width=0) -> Rect
+draw many rectangles
+
+pygame.draw.segments
+ segments(surface, colors, segments) -> Rect
+ segments(surface, colors, segments, width=1) -> Rect
+draw many separate straight line segments
+
+pygame.draw.gradient_rect
+ gradient_rect(surface, rect, stops) -> Rect
+ gradient_rect(surface, rect, stops, kind="linear", angle=0, center=None, dither=False) -> Rect
+fill a rectangle with a color gradient
+
+*/
@@ -21,6 +21,7 @@
 #define DOC_PYGAMEGFXDRAWAAPOLYGON "aapolygon(surface, points, color) -> None\ndraw an antialiased polygon"
 #define DOC_PYGAMEGFXDRAWFILLEDPOLYGON "filled_polygon(surface, points, color) -> None\ndraw a filled polygon"
 #define DOC_PYGAMEGFXDRAWTEXTUREDPOLYGON "textured_polygon(surface, points, texture, tx, ty) -> None\ndraw a textured polygon"
+#define DOC_PYGAMEGFXDRAWTEXTUREDTRIANGLES "textured_triangles(surface, texture, vertices, uvs) -> None\ntextured_triangles(surface, texture, vertices, uvs, indices=None, bilinear=False) -> None\ndraw a mesh of textured triangles"
 #define DOC_PYGAMEGFXDRAWBEZIER "bezier(surface, points, steps, color) -> None\ndraw a Bezier curve"
 
 
@@ -115,6 +116,11 @@ pygame.gfxdraw.textured_polygon
  textured_polygon(surface, points, texture, tx, ty) -> None
 draw a textured polygon
 
+pygame.gfxdraw.textured_triangles
+ textured_triangles(surface, texture, vertices, uvs) -> None
+ textured_triangles(surface, texture, vertices, uvs, indices=None, bilinear=False) -> None
+draw a mesh of textured triangles
+
 pygame.gfxdraw.bezier
  bezier(surface, points, steps, color) -> None
 draw a Bezier curve
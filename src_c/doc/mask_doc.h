@@ -2,6 +2,7 @@
 #define DOC_PYGAMEMASK "pygame module for image masks."
 #define DOC_PYGAMEMASKFROMSURFACE "from_surface(surface) -> Mask\nfrom_surface(surface, threshold=127) -> Mask\nCreates a Mask from the given surface"
 #define DOC_PYGAMEMASKFROMTHRESHOLD "from_threshold(surface, color) -> Mask\nfrom_threshold(surface, color, threshold=(0, 0, 0, 255), othersurface=None, palette_colors=1) -> Mask\nCreates a mask by thresholding Surfaces"
+#define DOC_PYGAMEMASKROTATIONCACHE "rotation_cache(mask, steps) -> [Mask, ...]\nrotation_cache(mask, steps, scale=1.0) -> [Mask, ...]\nReturns a list of masks rotated by evenly spaced angles"
 #define DOC_PYGAMEMASKMASK "Mask(size=(width, height)) -> Mask\nMask(size=(width, height), fill=False) -> Mask\npygame object for representing 2D bitmasks"
 #define DOC_MASKCOPY "copy() -> Mask\nReturns a new copy of the mask"
 #define DOC_MASKGETSIZE "get_size() -> (width, height)\nReturns the size of the mask"
@@ -9,12 +10,15 @@
 #define DOC_MASKGETAT "get_at(pos) -> int\nGets the bit at the given position"
 #define DOC_MASKSETAT "set_at(pos) -> None\nset_at(pos, value=1) -> None\nSets the bit at the given position"
 #define DOC_MASKOVERLAP "overlap(other, offset) -> (x, y)\noverlap(other, offset) -> None\nReturns the point of intersection"
+#define DOC_MASKOVERLAPMANY "overlap_many(masks, offsets) -> [(index, (x, y)), ...]\nReturns the masks overlapping this mask and their points of intersection"
 #define DOC_MASKOVERLAPAREA "overlap_area(other, offset) -> numbits\nReturns the number of overlapping set bits"
 #define DOC_MASKOVERLAPMASK "overlap_mask(other, offset) -> Mask\nReturns a mask of the overlapping set bits"
 #define DOC_MASKFILL "fill() -> None\nSets all bits to 1"
 #define DOC_MASKCLEAR "clear() -> None\nSets all bits to 0"
 #define DOC_MASKINVERT "invert() -> None\nFlips all the bits"
 #define DOC_MASKSCALE "scale((width, height)) -> Mask\nResizes a mask"
+#define DOC_MASKROTATE "rotate(angle) -> Mask\nReturns a rotated copy of the mask"
+#define DOC_MASKTRANSFORM "transform(angle, scale) -> Mask\nReturns a rotated and scaled copy of the mask"
 #define DOC_MASKDRAW "draw(other, offset) -> None\nDraws a mask onto another"
 #define DOC_MASKERASE "erase(other, offset) -> None\nErases a mask from another"
 #define DOC_MASKCOUNT "count() -> bits\nReturns the number of set bits"
@@ -22,10 +26,35 @@
 #define DOC_MASKANGLE "angle() -> theta\nReturns the orientation of the set bits"
 #define DOC_MASKOUTLINE "outline() -> [(x, y), ...]\noutline(every=1) -> [(x, y), ...]\nReturns a list of points outlining an object"
 #define DOC_MASKCONVOLVE "convolve(other) -> Mask\nconvolve(other, output=None, offset=(0, 0)) -> Mask\nReturns the convolution of this mask with another mask"
+#define DOC_MASKDILATE "dilate(radius) -> Mask\nReturns a mask grown by the given radius"
+#define DOC_MASKERODE "erode(radius) -> Mask\nReturns a mask shrunk by the given radius"
+#define DOC_MASKOPEN "open(radius) -> Mask\nReturns the mask eroded and then dilated by the given radius"
+#define DOC_MASKCLOSE "close(radius) -> Mask\nReturns the mask dilated and then eroded by the given radius"
+#define DOC_MASKDISTANCETRANSFORM "distance_transform() -> memoryview\nReturns the distance from each set bit to the nearest unset bit"
 #define DOC_MASKCONNECTEDCOMPONENT "connected_component() -> Mask\nconnected_component(pos) -> Mask\nReturns a mask containing a connected component"
 #define DOC_MASKCONNECTEDCOMPONENTS "connected_components() -> [Mask, ...]\nconnected_components(minimum=0) -> [Mask, ...]\nReturns a list of masks of connected components"
+#define DOC_MASKLABELCONNECTEDCOMPONENTS "label_connected_components() -> (labels, [(area, Rect, (x, y)), ...])\nlabel_connected_components(minimum=0) -> (labels, [(area, Rect, (x, y)), ...])\nReturns the label of each bit and the stats of each connected component"
 #define DOC_MASKGETBOUNDINGRECTS "get_bounding_rects() -> [Rect, ...]\nReturns a list of bounding rects of connected components"
 #define DOC_MASKTOSURFACE "to_surface() -> Surface\nto_surface(surface=None, setsurface=None, unsetsurface=None, setcolor=(255, 255, 255, 255), unsetcolor=(0, 0, 0, 255), dest=(0, 0)) -> Surface\nReturns a surface with the mask drawn on it"
+#define DOC_PYGAMEMASKCOLLISIONWORLD "CollisionWorld() -> CollisionWorld\npygame object for finding collisions between many masks"
+#define DOC_COLLISIONWORLDADD "add(key, mask, offset) -> None\nAdds a mask to the world"
+#define DOC_COLLISIONWORLDMOVE "move(key, offset) -> None\nMoves a mask in the world"
+#define DOC_COLLISIONWORLDREMOVE "remove(key) -> None\nRemoves a mask from the world"
+#define DOC_COLLISIONWORLDCLEAR "clear() -> None\nRemoves all masks from the world"
+#define DOC_COLLISIONWORLDQUERY "query(mask, offset) -> [key, ...]\nReturns the keys of the masks overlapping a mask"
+#define DOC_COLLISIONWORLDQUERYPAIRS "query_pairs() -> [(key1, key2), ...]\nquery_pairs(point=False, area=False) -> [(key1, key2, ...), ...]\nReturns all pairs of overlapping masks"
+#define DOC_PYGAMEMASKSPARSEMASK "SparseMask(size, fill=False) -> SparseMask\npygame object for representing large, mostly empty 2D bitmasks"
+#define DOC_SPARSEMASKGETSIZE "get_size() -> (width, height)\nReturns the size of the sparse mask"
+#define DOC_SPARSEMASKGETAT "get_at(pos) -> int\nGets the bit at the given position"
+#define DOC_SPARSEMASKSETAT "set_at(pos) -> None\nset_at(pos, value=1) -> None\nSets the bit at the given position"
+#define DOC_SPARSEMASKOVERLAP "overlap(other, offset) -> (x, y)\noverlap(other, offset) -> None\nReturns the first point of intersection"
+#define DOC_SPARSEMASKOVERLAPAREA "overlap_area(other, offset) -> numbits\nReturns the number of overlapping set bits"
+#define DOC_SPARSEMASKDRAW "draw(other, offset) -> None\nDraws a mask onto the sparse mask"
+#define DOC_SPARSEMASKERASE "erase(other, offset) -> None\nErases a mask from the sparse mask"
+#define DOC_SPARSEMASKCOUNT "count() -> bits\nReturns the number of set bits"
+#define DOC_SPARSEMASKFILL "fill() -> None\nSets all bits to 1"
+#define DOC_SPARSEMASKCLEAR "clear() -> None\nSets all bits to 0"
+#define DOC_SPARSEMASKGETTILECOUNT "get_tile_count() -> int\nReturns the number of allocated tiles"
 
 
 /* Docs in a comment... slightly easier to read. */
@@ -45,6 +74,11 @@ pygame.mask.from_threshold
  from_threshold(surface, color, threshold=(0, 0, 0, 255), othersurface=None, palette_colors=1) -> Mask
 Creates a mask by thresholding Surfaces
 
+pygame.mask.rotation_cache
+ rotation_cache(mask, steps) -> [Mask, ...]
+ rotation_cache(mask, steps, scale=1.0) -> [Mask, ...]
+Returns a list of masks rotated by evenly spaced angles
+
 pygame.mask.Mask
  Mask(size=(width, height)) -> Mask
  Mask(size=(width, height), fill=False) -> Mask
@@ -76,6 +110,10 @@ pygame.mask.Mask.overlap
  overlap(other, offset) -> None
 Returns the point of intersection
 
+pygame.mask.Mask.overlap_many
+ overlap_many(masks, offsets) -> [(index, (x, y)), ...]
+Returns the masks overlapping this mask and their points of intersection
+
 pygame.mask.Mask.overlap_area
  overlap_area(other, offset) -> numbits
 Returns the number of overlapping set bits
@@ -100,6 +138,14 @@ pygame.mask.Mask.scale
  scale((width, height)) -> Mask
 Resizes a mask
 
+pygame.mask.Mask.rotate
+ rotate(angle) -> Mask
+Returns a rotated copy of the mask
+
+pygame.mask.Mask.transform
+ transform(angle, scale) -> Mask
+Returns a rotated and scaled copy of the mask
+
 pygame.mask.Mask.draw
  draw(other, offset) -> None
 Draws a mask onto another
@@ -130,6 +176,26 @@ pygame.mask.Mask.convolve
  convolve(other, output=None, offset=(0, 0)) -> Mask
 Returns the convolution of this mask with another mask
 
+pygame.mask.Mask.dilate
+ dilate(radius) -> Mask
+Returns a mask grown by the given radius
+
+pygame.mask.Mask.erode
+ erode(radius) -> Mask
+Returns a mask shrunk by the given radius
+
+pygame.mask.Mask.open
+ open(radius) -> Mask
+Returns the mask eroded and then dilated by the given radius
+
+pygame.mask.Mask.close
+ close(radius) -> Mask
+Returns the mask dilated and then eroded by the given radius
+
+pygame.mask.Mask.distance_transform
+ distance_transform() -> memoryview
+Returns the distance from each set bit to the nearest unset bit
+
 pygame.mask.Mask.connected_component
  connected_component() -> Mask
  connected_component(pos) -> Mask
@@ -140,6 +206,11 @@ pygame.mask.Mask.connected_components
  connected_components(minimum=0) -> [Mask, ...]
 Returns a list of masks of connected components
 
+pygame.mask.Mask.label_connected_components
+ label_connected_components() -> (labels, [(area, Rect, (x, y)), ...])
+ label_connected_components(minimum=0) -> (labels, [(area, Rect, (x, y)), ...])
+Returns the label of each bit and the stats of each connected component
+
 pygame.mask.Mask.get_bounding_rects
  get_bounding_rects() -> [Rect, ...]
 Returns a list of bounding rects of connected components
@@ -149,4 +220,83 @@ pygame.mask.Mask.to_surface
  to_surface(surface=None, setsurface=None, unsetsurface=None, setcolor=(255, 255, 255, 255), unsetcolor=(0, 0, 0, 255), dest=(0, 0)) -> Surface
 Returns a surface with the mask drawn on it
 
+pygame.mask.CollisionWorld
+ CollisionWorld() -> CollisionWorld
+pygame object for finding collisions between many masks
+
+pygame.mask.CollisionWorld.add
+ add(key, mask, offset) -> None
+Adds a mask to the world
+
+pygame.mask.CollisionWorld.move
+ move(key, offset) -> None
+Moves a mask in the world
+
+pygame.mask.CollisionWorld.remove
+ remove(key) -> None
+Removes a mask from the world
+
+pygame.mask.CollisionWorld.clear
+ clear() -> None
+Removes all masks from the world
+
+pygame.mask.CollisionWorld.query
+ query(mask, offset) -> [key, ...]
+Returns the keys of the masks overlapping a mask
+
+pygame.mask.CollisionWorld.query_pairs
+ query_pairs() -> [(key1, key2), ...]
+ query_pairs(point=False, area=False) -> [(key1, key2, ...), ...]
+Returns all pairs of overlapping masks
+
+pygame.mask.SparseMask
+ SparseMask(size, fill=False) -> SparseMask
+pygame object for representing large, mostly empty 2D bitmasks
+
+pygame.mask.SparseMask.get_size
+ get_size() -> (width, height)
+Returns the size of the sparse mask
+
+pygame.mask.SparseMask.get_at
+ get_at(pos) -> int
+Gets the bit at the given position
+
+pygame.mask.SparseMask.set_at
+ set_at(pos) -> None
+ set_at(pos, value=1) -> None
+Sets the bit at the given position
+
+pygame.mask.SparseMask.overlap
+ overlap(other, offset) -> (x, y)
+ overlap(other, offset) -> None
+Returns the first point of intersection
+
+pygame.mask.SparseMask.overlap_area
+ overlap_area(other, offset) -> numbits
+Returns the number of overlapping set bits
+
+pygame.mask.SparseMask.draw
+ draw(other, offset) -> None
+Draws a mask onto the sparse mask
+
+pygame.mask.SparseMask.erase
+ erase(other, offset) -> None
+Erases a mask from the sparse mask
+
+pygame.mask.SparseMask.count
+ count() -> bits
+Returns the number of set bits
+
+pygame.mask.SparseMask.fill
+ fill() -> None
+Sets all bits to 1
+
+pygame.mask.SparseMask.clear
+ clear() -> None
+Sets all bits to 0
+
+pygame.mask.SparseMask.get_tile_count
+ get_tile_count() -> int
+Returns the number of allocated tiles
+
 */
\ No newline at end of file
@@ -4,9 +4,11 @@
 #define DOC_SURFACEBLITS "blits(blit_sequence=((source, dest), ...), doreturn=1) -> [Rect, ...] or None\nblits(((source, dest, area), ...)) -> [Rect, ...]\nblits(((source, dest, area, special_flags), ...)) -> [Rect, ...]\ndraw many images onto another"
 #define DOC_SURFACECONVERT "convert(Surface=None) -> Surface\nconvert(depth, flags=0) -> Surface\nconvert(masks, flags=0) -> Surface\nchange the pixel format of an image"
 #define DOC_SURFACECONVERTALPHA "convert_alpha(Surface) -> Surface\nconvert_alpha() -> Surface\nchange the pixel format of an image including per pixel alphas"
+#define DOC_SURFACEPREMULALPHA "premul_alpha() -> Surface\nreturns a copy of the surface with the RGB channels pre-multiplied by the alpha channel"
 #define DOC_SURFACECOPY "copy() -> Surface\ncreate a new copy of a Surface"
 #define DOC_SURFACEFILL "fill(color, rect=None, special_flags=0) -> Rect\nfill Surface with a solid color"
 #define DOC_SURFACESCROLL "scroll(dx=0, dy=0) -> None\nShift the surface image in place"
+#define DOC_SURFACEFLIPIP "flip_ip(flip_x, flip_y) -> None\nmirror the surface image in place"
 #define DOC_SURFACESETCOLORKEY "set_colorkey(Color, flags=0) -> None\nset_colorkey(None) -> None\nSet the transparent colorkey"
 #define DOC_SURFACEGETCOLORKEY "get_colorkey() -> RGB or None\nGet the current transparent colorkey"
 #define DOC_SURFACESETALPHA "set_alpha(value, flags=0) -> None\nset_alpha(None) -> None\nset the alpha value for the full Surface image"
@@ -81,6 +83,10 @@ pygame.Surface.convert_alpha
  convert_alpha() -> Surface
 change the pixel format of an image including per pixel alphas
 
+pygame.Surface.premul_alpha
+ premul_alpha() -> Surface
+returns a copy of the surface with the RGB channels pre-multiplied by the alpha channel
+
 pygame.Surface.copy
  copy() -> Surface
 create a new copy of a Surface
@@ -93,6 +99,10 @@ pygame.Surface.scroll
  scroll(dx=0, dy=0) -> None
 Shift the surface image in place
 
+pygame.Surface.flip_ip
+ flip_ip(flip_x, flip_y) -> None
+mirror the surface image in place
+
 pygame.Surface.set_colorkey
  set_colorkey(Color, flags=0) -> None
  set_colorkey(None) -> None
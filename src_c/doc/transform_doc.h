@@ -1,8 +1,9 @@
 /* Auto generated file: with makeref.py .  Docs go in docs/reST/ref/ . */
 #define DOC_PYGAMETRANSFORM "pygame module to transform surfaces"
-#define DOC_PYGAMETRANSFORMFLIP "flip(surface, flip_x, flip_y) -> Surface\nflip vertically and horizontally"
+#define DOC_PYGAMETRANSFORMFLIP "flip(surface, flip_x, flip_y, dest_surface=None) -> Surface\nflip vertically and horizontally"
 #define DOC_PYGAMETRANSFORMSCALE "scale(surface, size, dest_surface=None) -> Surface\nresize to new resolution"
-#define DOC_PYGAMETRANSFORMROTATE "rotate(surface, angle) -> Surface\nrotate an image"
+#define DOC_PYGAMETRANSFORMROTATE "rotate(surface, angle, dest_surface=None) -> Surface\nrotate an image"
+#define DOC_PYGAMETRANSFORMAFFINE "affine(surface, matrix, size=None, smooth=False, dest_surface=None) -> Surface\napply a general 2D linear transform in one pass"
 #define DOC_PYGAMETRANSFORMROTOZOOM "rotozoom(surface, angle, scale) -> Surface\nfiltered scale and rotation"
 #define DOC_PYGAMETRANSFORMSCALE2X "scale2x(surface, dest_surface=None) -> Surface\nspecialized image doubler"
 #define DOC_PYGAMETRANSFORMSMOOTHSCALE "smoothscale(surface, size, dest_surface=None) -> Surface\nscale a surface to an arbitrary size smoothly"
@@ -10,7 +11,16 @@
 #define DOC_PYGAMETRANSFORMSETSMOOTHSCALEBACKEND "set_smoothscale_backend(backend) -> None\nset smoothscale filter version to one of: 'GENERIC', 'MMX', or 'SSE'"
 #define DOC_PYGAMETRANSFORMCHOP "chop(surface, rect) -> Surface\ngets a copy of an image with an interior area removed"
 #define DOC_PYGAMETRANSFORMLAPLACIAN "laplacian(surface, dest_surface=None) -> Surface\nfind edges in a surface"
+#define DOC_PYGAMETRANSFORMCONVOLVE "convolve(surface, kernel, dest_surface=None, border='clamp', border_color=(0, 0, 0, 0)) -> Surface\napply a small convolution kernel to a surface"
+#define DOC_PYGAMETRANSFORMAPPLYLUT "apply_lut(surface, lut_r=None, lut_g=None, lut_b=None, lut_a=None, dest_surface=None) -> Surface\nremap each color channel through a lookup table"
+#define DOC_PYGAMETRANSFORMCOLORMATRIX "color_matrix(surface, matrix, dest_surface=None) -> Surface\nmix the color channels of every pixel through a 4x5 matrix"
 #define DOC_PYGAMETRANSFORMAVERAGESURFACES "average_surfaces(surfaces, dest_surface=None, palette_colors=1) -> Surface\nfind the average surface from many surfaces."
+#define DOC_PYGAMETRANSFORMSURFACEACCUMULATOR "SurfaceAccumulator(size) -> SurfaceAccumulator\npygame object for averaging surfaces one at a time"
+#define DOC_SURFACEACCUMULATORADD "add(surface) -> None\nadds a surface to the running sum"
+#define DOC_SURFACEACCUMULATORGETAVERAGE "get_average(dest_surface=None) -> Surface\nreturns the average of the surfaces added so far"
+#define DOC_SURFACEACCUMULATORCLEAR "clear() -> None\nresets the running sum"
+#define DOC_SURFACEACCUMULATORGETCOUNT "get_count() -> int\nreturns the number of surfaces added"
+#define DOC_SURFACEACCUMULATORGETSIZE "get_size() -> (width, height)\nreturns the size of the accumulated surfaces"
 #define DOC_PYGAMETRANSFORMAVERAGECOLOR "average_color(surface, rect=None) -> Color\nfinds the average color of a surface"
 #define DOC_PYGAMETRANSFORMTHRESHOLD "threshold(dest_surface, surface, search_color, threshold=(0,0,0,0), set_color=(0,0,0,0), set_behavior=1, search_surf=None, inverse_set=False) -> num_threshold_pixels\nfinds which, and how many pixels in a surface are within a threshold of a 'search_color' or a 'search_surf'."
 
@@ -23,7 +33,7 @@ pygame.transform
 pygame module to transform surfaces
 
 pygame.transform.flip
- flip(surface, flip_x, flip_y) -> Surface
+ flip(surface, flip_x, flip_y, dest_surface=None) -> Surface
 flip vertically and horizontally
 
 pygame.transform.scale
@@ -31,9 +41,13 @@ pygame.transform.scale
 resize to new resolution
 
 pygame.transform.rotate
- rotate(surface, angle) -> Surface
+ rotate(surface, angle, dest_surface=None) -> Surface
 rotate an image
 
+pygame.transform.affine
+ affine(surface, matrix, size=None, smooth=False, dest_surface=None) -> Surface
+apply a general 2D linear transform in one pass
+
 pygame.transform.rotozoom
  rotozoom(surface, angle, scale) -> Surface
 filtered scale and rotation
@@ -62,10 +76,46 @@ pygame.transform.laplacian
  laplacian(surface, dest_surface=None) -> Surface
 find edges in a surface
 
+pygame.transform.convolve
+ convolve(surface, kernel, dest_surface=None, border='clamp', border_color=(0, 0, 0, 0)) -> Surface
+apply a small convolution kernel to a surface
+
+pygame.transform.apply_lut
+ apply_lut(surface, lut_r=None, lut_g=None, lut_b=None, lut_a=None, dest_surface=None) -> Surface
+remap each color channel through a lookup table
+
+pygame.transform.color_matrix
+ color_matrix(surface, matrix, dest_surface=None) -> Surface
+mix the color channels of every pixel through a 4x5 matrix
+
 pygame.transform.average_surfaces
  average_surfaces(surfaces, dest_surface=None, palette_colors=1) -> Surface
 find the average surface from many surfaces.
 
+pygame.transform.SurfaceAccumulator
+ SurfaceAccumulator(size) -> SurfaceAccumulator
+pygame object for averaging surfaces one at a time
+
+pygame.transform.SurfaceAccumulator.add
+ add(surface) -> None
+adds a surface to the running sum
+
+pygame.transform.SurfaceAccumulator.get_average
+ get_average(dest_surface=None) -> Surface
+returns the average of the surfaces added so far
+
+pygame.transform.SurfaceAccumulator.clear
+ clear() -> None
+resets the running sum
+
+pygame.transform.SurfaceAccumulator.get_count
+ get_count() -> int
+returns the number of surfaces added
+
+pygame.transform.SurfaceAccumulator.get_size
+ get_size() -> (width, height)
+returns the size of the accumulated surfaces
+
 pygame.transform.average_color
  average_color(surface, rect=None) -> Color
 finds the average color of a surface
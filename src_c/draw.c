@@ -29,6 +29,10 @@
 
 #include "doc/draw_doc.h"
 
+#include "pgthreads.h"
+
+#include "pgarray.h"
+
 #include <math.h>
 
 #include <float.h>
@@ -37,17 +41,152 @@
 #define M_PI 3.14159265358979323846
 #endif
 
+/* Fill rules of draw_fillpoly */
+#define FILL_RULE_EVENODD 0
+#define FILL_RULE_NONZERO 1
+
+/* End caps of draw_line_capped and joints of lines() */
+#define LINE_CAP_FLAT 0
+#define LINE_CAP_ROUND 1
+#define LINE_CAP_SQUARE 2
+#define LINE_JOINT_NONE 0
+#define LINE_JOINT_ROUND 1
+
+/* A polygon edge in the scanline filler, going down from (x1, y1).
+ * Its x on scanline y is x1 + x_sign * (y - y1) * dx / dy, kept as the
+ * quotient quot and remainder rem of that division.
+ */
+typedef struct {
+    int y1, y_last;   /* first and last scanline crossed */
+    int x1, x_sign;
+    int dx, dy;       /* absolute x and y distances to the lower end */
+    int winding;      /* 1 if the polygon goes down along the edge, else -1 */
+    int x, quot, rem; /* x on the current scanline */
+    int step_quot, step_rem;
+} poly_edge;
+
+/* An edge of an antialiased polygon, in the coordinates of the coverage
+ * buffer of draw_aa_fillpoly.
+ */
+typedef struct {
+    float x0, y0, x1, y1;
+} aa_edge;
+
+/* Rows of coverage rasterized at a time by draw_aa_fillpoly */
+#define AA_BAND_HEIGHT 16
+/* Cells of a coverage row flagged together when an edge changes them */
+#define AA_BLOCK_SHIFT 4
+/* Coverage above which a pixel is drawn without blending, and below
+ * which it is left alone. */
+#define AA_OPAQUE (1.0f - 1.0f / 256.0f)
+#define AA_TRANSPARENT (1.0f / 256.0f)
+
+/* Shapes of a draw_job */
+#define DRAW_JOB_CIRCLE 0
+#define DRAW_JOB_ELLIPSE 1
+#define DRAW_JOB_POLYGON 2
+#define DRAW_JOB_ROUND_RECT 3
+
+/* Filled shapes smaller than this many pixels are drawn on one thread */
+#define DRAW_BAND_MIN_PIXELS (1 << 18)
+/* Fewest rows of a band */
+#define DRAW_BAND_MIN_ROWS 64
+
+/* A call to one of the shape rasterizers, which do not use the Python API
+ * and can run without the GIL (see run_draw_job).
+ */
+typedef struct {
+    int shape;                 /* DRAW_JOB_* */
+    SDL_Surface *surf;
+    Uint32 color;
+    int x, y;                  /* circle center, or top left of the others */
+    int w, h;                  /* size of the ellipse or round rect */
+    int radius;                /* of the circle, or default of the corners */
+    int width;                 /* round rect border, 0 to fill */
+    int corner_radii[4];       /* top left, top right, bottom left and
+                                  bottom right of the round rect */
+    int *point_x, *point_y;    /* polygon vertices */
+    Py_ssize_t num_points;
+    int fill_rule;
+    /* used when the job is split into bands of rows */
+    SDL_Rect area;
+    SDL_SpinLock lock;
+    int *drawn_area;
+} draw_job;
+
+/* Shapes of a span_table */
+#define SPAN_CIRCLE 0
+#define SPAN_CIRCLE_OUTLINE 1
+#define SPAN_CIRCLE_THIN 2
+/* plus 0 to 3 for the top right, top left, bottom left and bottom right */
+#define SPAN_QUADRANT 3
+
+/* Span tables kept by span_table_get, and the largest radius cached */
+#define SPAN_CACHE_SIZE 32
+#define SPAN_CACHE_MAX_RADIUS 256
+
+/* The runs of pixels on each row of a circle or circle quadrant drawn by
+ * one of the draw_circle_*_direct functions around (0, 0), so repeated
+ * draws of the same radius are only horizontal lines.
+ */
+typedef struct {
+    int shape;           /* SPAN_* */
+    int radius, thickness;
+    int top, num_rows;   /* first row and number of rows */
+    int *row_runs;       /* first run of each row, then the number of runs */
+    int *runs;           /* first and last x of each run */
+    unsigned int last_used;
+    int users;           /* draws using the table */
+    int cached;          /* 0 once dropped from the cache */
+} span_table;
+
+/* Kinds of gradient_rect */
+#define GRADIENT_LINEAR 0
+#define GRADIENT_RADIAL 1
+#define GRADIENT_CONIC 2
+/* Colors in the table of a gradient, from t = 0 to t = 1 */
+#define GRADIENT_STEPS 1024
+/* Pixels of a row indexed at a time by draw_gradient_rows */
+#define GRADIENT_CHUNK 256
+
+/* A gradient being drawn into area, split into bands like a draw_job.
+ *
+ * The gradient parameter t of the pixel center (px, py) is
+ *   linear: t0 + (px - cx) * dx + (py - cy) * dy
+ *   radial: hypot(px - cx, py - cy) * dx
+ *   conic:  the angle of (px - cx, cy - py) less dy, over 2 pi
+ */
+typedef struct {
+    int kind;            /* GRADIENT_* */
+    SDL_Surface *surf;
+    SDL_Rect area;       /* clipped rect being filled */
+    int rect_x;          /* left of the unclipped rect */
+    double cx, cy;
+    double t0, dx, dy;
+    Uint32 *table;       /* GRADIENT_STEPS mapped colors, 16 times over
+                            with ordered dithering */
+    int dither;
+} gradient_job;
+
 /* Declaration of drawing algorithms */
 static void
 draw_line_width(SDL_Surface *surf, Uint32 color, int x1, int y1, int x2, int y2, int width,
                          int *drawn_area);
 static void
+draw_line_capped(SDL_Surface *surf, Uint32 color, int x1, int y1, int x2,
+                 int y2, int width, int start_cap, int end_cap,
+                 int *drawn_area);
+static void
 draw_line(SDL_Surface *surf, int x1, int y1, int x2, int y2, Uint32 color,
          int *drawn_area);
 static void
 draw_aaline(SDL_Surface *surf, Uint32 color, float startx, float starty,
             float endx, float endy, int blend, int *drawn_area);
 static void
+draw_aaline_width(SDL_Surface *surf, Uint32 color, float from_x,
+                  float from_y, float to_x, float to_y, float width,
+                  int blend, int *drawn_area);
+static void
 draw_arc(SDL_Surface *surf, int x, int y, int radius1, int radius2,
          double angle_start, double angle_stop, Uint32 color, int *drawn_area);
 static void
@@ -69,13 +208,28 @@ draw_ellipse_filled(SDL_Surface *surf, int x0, int y0, int width, int height,
 static void
 draw_ellipse_thickness(SDL_Surface *surf, int x0, int y0, int width, int height,
                        int thickness, Uint32 color, int *drawn_area);
-static void
+static int
 draw_fillpoly(SDL_Surface *surf, int *vx, int *vy, Py_ssize_t n, Uint32 color,
-              int *drawn_area);
+              int fill_rule, int *drawn_area);
 static void
+draw_aa_fillpoly(SDL_Surface *surf, float *point_x, float *point_y,
+                 Py_ssize_t num_points, Uint32 color, int blend,
+                 int *drawn_area);
+static void
+draw_aa_ellipse(SDL_Surface *surf, float x0, float y0, float radius_x,
+                float radius_y, float inner_x, float inner_y, Uint32 color,
+                int *drawn_area);
+static int
 draw_round_rect(SDL_Surface *surf, int x1, int y1, int x2, int y2, int radius,
                 int width, Uint32 color, int top_left, int top_right,
                 int bottom_left, int bottom_right, int *drawn_area);
+static Uint32 *
+draw_gradient_table(SDL_PixelFormat *format, double *positions, Uint8 *colors,
+                    Py_ssize_t num_stops, int dither);
+static int
+draw_gradient_rows(void *data, int y0, int y1);
+static void
+add_pixel_to_drawn_list(int x, int y, int *pts);
 
 // validation of a draw color
 #define CHECK_LOAD_COLOR(colorobj)                                         \
@@ -87,6 +241,192 @@ draw_round_rect(SDL_Surface *surf, int x1, int y1, int x2, int y2, int radius,
     else                                                                   \
         return NULL; /* pg_RGBAFromFuzzyColorObj sets the exception for us */
 
+/* Converts a cap name to a LINE_CAP_* value.
+ *
+ * Returns 1 on success, or 0 with a ValueError set.
+ */
+static int
+_cap_from_name(const char *name, int *cap)
+{
+    if (!strcmp(name, "flat")) {
+        *cap = LINE_CAP_FLAT;
+    }
+    else if (!strcmp(name, "round")) {
+        *cap = LINE_CAP_ROUND;
+    }
+    else if (!strcmp(name, "square")) {
+        *cap = LINE_CAP_SQUARE;
+    }
+    else {
+        PyErr_SetString(PyExc_ValueError,
+                        "cap must be 'flat', 'round' or 'square'");
+        return 0;
+    }
+    return 1;
+}
+
+/* Runs the rasterizer of a job on surf, which is job->surf or a band of
+ * it.
+ *
+ * Returns 0, or -1 if it ran out of memory.
+ */
+static int
+_draw_job_rasterize(draw_job *job, SDL_Surface *surf, int *drawn_area)
+{
+    switch (job->shape) {
+        case DRAW_JOB_CIRCLE:
+            draw_circle_filled(surf, job->x, job->y, job->radius, job->color,
+                               drawn_area);
+            return 0;
+        case DRAW_JOB_ELLIPSE:
+            draw_ellipse_filled(surf, job->x, job->y, job->w, job->h,
+                                job->color, drawn_area);
+            return 0;
+        case DRAW_JOB_POLYGON:
+            return draw_fillpoly(surf, job->point_x, job->point_y,
+                                 job->num_points, job->color, job->fill_rule,
+                                 drawn_area);
+        default: /* DRAW_JOB_ROUND_RECT */
+            return draw_round_rect(
+                surf, job->x, job->y, job->x + job->w - 1,
+                job->y + job->h - 1, job->radius, job->width, job->color,
+                job->corner_radii[0], job->corner_radii[1],
+                job->corner_radii[2], job->corner_radii[3], drawn_area);
+    }
+}
+
+/* Draws rows [y0, y1) of job->area.
+ *
+ * The band gets its own copy of the surface clipped to its rows. Every
+ * pixel the rasterizers write is checked against the clip rect, so the
+ * bands together draw exactly what a single call does.
+ */
+static int
+_draw_job_band(void *data, int y0, int y1)
+{
+    draw_job *job = (draw_job *)data;
+    SDL_Surface band = *job->surf;
+    int drawn_area[4] = {INT_MAX, INT_MAX, INT_MIN, INT_MIN};
+    int result;
+
+    band.clip_rect.y = job->area.y + y0;
+    band.clip_rect.h = y1 - y0;
+    result = _draw_job_rasterize(job, &band, drawn_area);
+
+    SDL_AtomicLock(&job->lock);
+    if (drawn_area[0] != INT_MAX) {
+        add_pixel_to_drawn_list(drawn_area[0], drawn_area[1],
+                                job->drawn_area);
+        add_pixel_to_drawn_list(drawn_area[2], drawn_area[3],
+                                job->drawn_area);
+    }
+    SDL_AtomicUnlock(&job->lock);
+    return result;
+}
+
+/* Returns 1 if surf is the display surface or one of its subsurfaces. */
+static int
+_is_display_surface(SDL_Surface *surf)
+{
+    pgSurfaceObject *display = pg_GetDefaultWindowSurface();
+    SDL_Surface *display_surf;
+    Uint8 *start;
+
+    if (!display || !(display_surf = pgSurface_AsSurface(display)) ||
+        !display_surf->pixels) {
+        return 0;
+    }
+    /* Subsurfaces share the pixels of their parent. */
+    start = (Uint8 *)display_surf->pixels;
+    return (Uint8 *)surf->pixels >= start &&
+           (Uint8 *)surf->pixels < start + display_surf->pitch * display_surf->h;
+}
+
+/* Runs a draw job on the locked job->surf. The GIL is released, except
+ * when drawing to the display, whose surface can go away with the window.
+ * Filled shapes with more than DRAW_BAND_MIN_PIXELS pixels in the clip area
+ * are split into bands of rows drawn on several threads.
+ *
+ * Returns 0, or -1 with a MemoryError set.
+ */
+static int
+run_draw_job(draw_job *job, int *drawn_area)
+{
+    SDL_Surface *surf = job->surf;
+    SDL_Rect *clip = &surf->clip_rect;
+    Sint64 left, top, right, bottom;
+    Py_ssize_t i;
+    int num_bands = 1, result;
+
+    /* The bounds are in 64 bits, a huge radius or size overflows an int. */
+    switch (job->shape) {
+        case DRAW_JOB_CIRCLE:
+            left = (Sint64)job->x - job->radius;
+            top = (Sint64)job->y - job->radius;
+            right = (Sint64)job->x + job->radius + 1;
+            bottom = (Sint64)job->y + job->radius + 1;
+            break;
+        case DRAW_JOB_POLYGON: {
+            int minx = INT_MAX, miny = INT_MAX, maxx = INT_MIN, maxy = INT_MIN;
+            for (i = 0; i < job->num_points; i++) {
+                minx = MIN(minx, job->point_x[i]);
+                maxx = MAX(maxx, job->point_x[i]);
+                miny = MIN(miny, job->point_y[i]);
+                maxy = MAX(maxy, job->point_y[i]);
+            }
+            left = minx;
+            top = miny;
+            right = (Sint64)maxx + 1;
+            bottom = (Sint64)maxy + 1;
+            break;
+        }
+        default:
+            left = job->x;
+            top = job->y;
+            right = (Sint64)job->x + job->w;
+            bottom = (Sint64)job->y + job->h;
+            break;
+    }
+    /* A margin in case a rasterizer strays a pixel out of its box, then
+     * clipped to the clip rect, so the area fits in an int. */
+    left = MAX(left - 1, clip->x);
+    top = MAX(top - 1, clip->y);
+    right = MIN(right + 1, (Sint64)clip->x + clip->w);
+    bottom = MIN(bottom + 1, (Sint64)clip->y + clip->h);
+    job->area.x = (int)left;
+    job->area.y = (int)top;
+    job->area.w = (int)MAX(right - left, 0);
+    job->area.h = (int)MAX(bottom - top, 0);
+
+    /* Outlines of round rects are not split: the clipping of thick lines
+     * depends on the clip rect. */
+    if ((job->shape != DRAW_JOB_ROUND_RECT || job->width == 0) &&
+        (Sint64)job->area.w * job->area.h >= DRAW_BAND_MIN_PIXELS) {
+        num_bands = pg_band_count(job->area.w, job->area.h, DRAW_BAND_MIN_ROWS);
+    }
+    job->lock = 0;
+    job->drawn_area = drawn_area;
+
+    if (_is_display_surface(surf)) {
+        result = (num_bands > 1)
+                     ? pg_run_bands(_draw_job_band, job, job->area.h, num_bands)
+                     : _draw_job_rasterize(job, surf, drawn_area);
+    }
+    else {
+        Py_BEGIN_ALLOW_THREADS;
+        result = (num_bands > 1)
+                     ? pg_run_bands(_draw_job_band, job, job->area.h, num_bands)
+                     : _draw_job_rasterize(job, surf, drawn_area);
+        Py_END_ALLOW_THREADS;
+    }
+
+    if (result < 0) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    return 0;
+}
+
 /* Definition of functions that get called in Python */
 
 /* Draws an antialiased line on the given surface.
@@ -101,17 +441,18 @@ aaline(PyObject *self, PyObject *arg, PyObject *kwargs)
     SDL_Surface *surf = NULL;
     float startx, starty, endx, endy;
     int blend = 1; /* Default blend. */
+    int width = 1; /* Default width. */
     float pts[4];
     int drawn_area[4] = {INT_MAX, INT_MAX, INT_MIN,
                          INT_MIN}; /* Used to store bounding box values */
     Uint8 rgba[4];
     Uint32 color;
     static char *keywords[] = {"surface", "color", "start_pos",
-                               "end_pos", "blend", NULL};
+                               "end_pos", "blend", "width",     NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(arg, kwargs, "O!OOO|i", keywords,
+    if (!PyArg_ParseTupleAndKeywords(arg, kwargs, "O!OOO|ii", keywords,
                                      &pgSurface_Type, &surfobj, &colorobj,
-                                     &start, &end, &blend)) {
+                                     &start, &end, &blend, &width)) {
         return NULL; /* Exception already set. */
     }
 
@@ -150,13 +491,23 @@ aaline(PyObject *self, PyObject *arg, PyObject *kwargs)
     pts[1] = starty;
     pts[2] = endx;
     pts[3] = endy;
-    draw_aaline(surf, color, pts[0], pts[1], pts[2], pts[3], blend,
-                drawn_area);
+    if (width > 1) {
+        draw_aaline_width(surf, color, pts[0], pts[1], pts[2], pts[3],
+                          (float)width, blend, drawn_area);
+    }
+    else {
+        draw_aaline(surf, color, pts[0], pts[1], pts[2], pts[3], blend,
+                    drawn_area);
+    }
 
     if (!pgSurface_Unlock(surfobj)) {
         return RAISE(PyExc_RuntimeError, "error unlocking surface");
     }
 
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+
     if (drawn_area[0] != INT_MAX && drawn_area[1] != INT_MAX &&
         drawn_area[2] != INT_MIN && drawn_area[3] != INT_MIN)
         return pgRect_New4(drawn_area[0], drawn_area[1],
@@ -180,14 +531,20 @@ line(PyObject *self, PyObject *arg, PyObject *kwargs)
     Uint8 rgba[4];
     Uint32 color;
     int width = 1; /* Default width. */
+    const char *cap_name = "flat"; /* Default cap. */
+    int cap;
     int drawn_area[4] = {INT_MAX, INT_MAX, INT_MIN,
                          INT_MIN}; /* Used to store bounding box values */
     static char *keywords[] = {"surface", "color", "start_pos",
-                               "end_pos", "width", NULL};
+                               "end_pos", "width",  "cap", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(arg, kwargs, "O!OOO|i", keywords,
+    if (!PyArg_ParseTupleAndKeywords(arg, kwargs, "O!OOO|is", keywords,
                                      &pgSurface_Type, &surfobj, &colorobj,
-                                     &start, &end, &width)) {
+                                     &start, &end, &width, &cap_name)) {
+        return NULL; /* Exception already set. */
+    }
+
+    if (!_cap_from_name(cap_name, &cap)) {
         return NULL; /* Exception already set. */
     }
 
@@ -217,7 +574,8 @@ line(PyObject *self, PyObject *arg, PyObject *kwargs)
         return RAISE(PyExc_RuntimeError, "error locking surface");
     }
 
-    draw_line_width(surf, color, startx, starty, endx, endy, width, drawn_area);
+    draw_line_capped(surf, color, startx, starty, endx, endy, width, cap,
+                     cap, drawn_area);
 
     if (!pgSurface_Unlock(surfobj)) {
         return RAISE(PyExc_RuntimeError, "error unlocking surface");
@@ -392,18 +750,36 @@ lines(PyObject *self, PyObject *arg, PyObject *kwargs)
     int x, y, closed, result;
     int *xlist = NULL, *ylist = NULL;
     int width = 1; /* Default width. */
+    const char *cap_name = "flat";    /* Default cap. */
+    const char *joint_name = "none"; /* Default joint. */
+    int cap, joint, start_cap, end_cap;
     Py_ssize_t loop, length;
     int drawn_area[4] = {INT_MAX, INT_MAX, INT_MIN,
                          INT_MIN}; /* Used to store bounding box values */
-    static char *keywords[] = {"surface", "color", "closed",
-                               "points",  "width", NULL};
+    static char *keywords[] = {"surface", "color", "closed", "points",
+                               "width",   "cap",   "joint",  NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(arg, kwargs, "O!OOO|i", keywords,
+    if (!PyArg_ParseTupleAndKeywords(arg, kwargs, "O!OOO|iss", keywords,
                                      &pgSurface_Type, &surfobj, &colorobj,
-                                     &closedobj, &points, &width)) {
+                                     &closedobj, &points, &width, &cap_name,
+                                     &joint_name)) {
         return NULL; /* Exception already set. */
     }
 
+    if (!_cap_from_name(cap_name, &cap)) {
+        return NULL; /* Exception already set. */
+    }
+
+    if (!strcmp(joint_name, "none")) {
+        joint = LINE_JOINT_NONE;
+    }
+    else if (!strcmp(joint_name, "round")) {
+        joint = LINE_JOINT_ROUND;
+    }
+    else {
+        return RAISE(PyExc_ValueError, "joint must be 'none' or 'round'");
+    }
+
     surf = pgSurface_AsSurface(surfobj);
 
     if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4) {
@@ -476,14 +852,30 @@ lines(PyObject *self, PyObject *arg, PyObject *kwargs)
         return RAISE(PyExc_RuntimeError, "error locking surface");
     }
 
+    closed = closed && length > 2;
+
+    /* Only the ends of an open polyline get caps. */
     for (loop = 1; loop < length; ++loop) {
-        draw_line_width(surf, color, xlist[loop - 1], ylist[loop - 1], xlist[loop], ylist[loop], width, drawn_area);
+        start_cap = (loop == 1 && !closed) ? cap : LINE_CAP_FLAT;
+        end_cap = (loop == length - 1 && !closed) ? cap : LINE_CAP_FLAT;
+        draw_line_capped(surf, color, xlist[loop - 1], ylist[loop - 1],
+                         xlist[loop], ylist[loop], width, start_cap, end_cap,
+                         drawn_area);
     }
 
-    if (closed && length > 2) {
+    if (closed) {
         draw_line_width(surf, color, xlist[length - 1], ylist[length - 1], xlist[0], ylist[0], width, drawn_area);
     }
 
+    if (joint == LINE_JOINT_ROUND && width > 1) {
+        for (loop = closed ? 0 : 1; loop < (closed ? length : length - 1);
+             ++loop) {
+            draw_ellipse_filled(surf, xlist[loop] - (width - 1) / 2,
+                                ylist[loop] - (width - 1) / 2, width, width,
+                                color, drawn_area);
+        }
+    }
+
     PyMem_Del(xlist);
     PyMem_Del(ylist);
 
@@ -624,7 +1016,14 @@ ellipse(PyObject *self, PyObject *arg, PyObject *kwargs)
     }
 
     if (!width || width >= MIN(rect->w / 2 + rect->w % 2, rect->h / 2 + rect->h % 2)) {
-        draw_ellipse_filled(surf, rect->x, rect->y, rect->w, rect->h, color, drawn_area);
+        draw_job job = {DRAW_JOB_ELLIPSE};
+        job.surf = surf;
+        job.color = color;
+        job.x = rect->x;
+        job.y = rect->y;
+        job.w = rect->w;
+        job.h = rect->h;
+        run_draw_job(&job, drawn_area);
     }
     else {
         draw_ellipse_thickness(surf, rect->x, rect->y, rect->w, rect->h, width - 1,
@@ -711,7 +1110,13 @@ circle(PyObject *self, PyObject *args, PyObject *kwargs)
     if ((top_right == 0 && top_left == 0 && bottom_left == 0 &&
          bottom_right == 0)) {
         if (!width || width == radius) {
-            draw_circle_filled(surf, posx, posy, radius, color, drawn_area);
+            draw_job job = {DRAW_JOB_CIRCLE};
+            job.surf = surf;
+            job.color = color;
+            job.x = posx;
+            job.y = posy;
+            job.radius = radius;
+            run_draw_job(&job, drawn_area);
         } else if (width == 1) {
             draw_circle_bresenham_thin(surf, posx, posy, radius, color,
                                   drawn_area);
@@ -747,18 +1152,33 @@ polygon(PyObject *self, PyObject *arg, PyObject *kwargs)
     Uint32 color;
     int *xlist = NULL, *ylist = NULL;
     int width = 0; /* Default width. */
+    const char *fill_rule_name = "evenodd"; /* Default fill rule. */
+    int fill_rule;
     int x, y, result, l, t;
     int drawn_area[4] = {INT_MAX, INT_MAX, INT_MIN,
                          INT_MIN}; /* Used to store bounding box values */
+    draw_job job = {DRAW_JOB_POLYGON};
     Py_ssize_t loop, length;
-    static char *keywords[] = {"surface", "color", "points", "width", NULL};
+    static char *keywords[] = {"surface", "color", "points",
+                               "width",   "fill_rule", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(arg, kwargs, "O!OO|i", keywords,
+    if (!PyArg_ParseTupleAndKeywords(arg, kwargs, "O!OO|is", keywords,
                                      &pgSurface_Type, &surfobj, &colorobj,
-                                     &points, &width)) {
+                                     &points, &width, &fill_rule_name)) {
         return NULL; /* Exception already set. */
     }
 
+    if (!strcmp(fill_rule_name, "evenodd")) {
+        fill_rule = FILL_RULE_EVENODD;
+    }
+    else if (!strcmp(fill_rule_name, "nonzero")) {
+        fill_rule = FILL_RULE_NONZERO;
+    }
+    else {
+        return RAISE(PyExc_ValueError,
+                     "fill_rule must be 'evenodd' or 'nonzero'");
+    }
+
     if (width) {
         PyObject *ret = NULL;
         PyObject *args =
@@ -834,7 +1254,13 @@ polygon(PyObject *self, PyObject *arg, PyObject *kwargs)
         return RAISE(PyExc_RuntimeError, "error locking surface");
     }
 
-    draw_fillpoly(surf, xlist, ylist, length, color, drawn_area);
+    job.surf = surf;
+    job.color = color;
+    job.point_x = xlist;
+    job.point_y = ylist;
+    job.num_points = length;
+    job.fill_rule = fill_rule;
+    result = run_draw_job(&job, drawn_area);
     PyMem_Del(xlist);
     PyMem_Del(ylist);
 
@@ -842,6 +1268,10 @@ polygon(PyObject *self, PyObject *arg, PyObject *kwargs)
         return RAISE(PyExc_RuntimeError, "error unlocking surface");
     }
 
+    if (result) {
+        return NULL; /* draw_fillpoly ran out of memory */
+    }
+
     if (drawn_area[0] != INT_MAX && drawn_area[1] != INT_MAX &&
         drawn_area[2] != INT_MIN && drawn_area[3] != INT_MIN)
         return pgRect_New4(drawn_area[0], drawn_area[1],
@@ -871,6 +1301,7 @@ rect(PyObject *self, PyObject *args, PyObject *kwargs)
     SDL_Rect clipped;
     int drawn_area[4] = {INT_MAX, INT_MAX, INT_MIN,
                          INT_MIN}; /* Used to store bounding box values */
+    draw_job job = {DRAW_JOB_ROUND_RECT};
     static char *keywords[] = {"surface",
                                "color",
                                "rect",
@@ -978,12 +1409,25 @@ rect(PyObject *self, PyObject *args, PyObject *kwargs)
             width = MAX(w / 2, h / 2);
         }
 
-        draw_round_rect(surf, x, y, x + w - 1, y + h - 1, radius, width, color,
-                        top_left_radius, top_right_radius, bottom_left_radius,
-                        bottom_right_radius, drawn_area);
+        job.surf = surf;
+        job.color = color;
+        job.x = x;
+        job.y = y;
+        job.w = w;
+        job.h = h;
+        job.radius = radius;
+        job.width = width;
+        job.corner_radii[0] = top_left_radius;
+        job.corner_radii[1] = top_right_radius;
+        job.corner_radii[2] = bottom_left_radius;
+        job.corner_radii[3] = bottom_right_radius;
+        result = run_draw_job(&job, drawn_area);
         if (!pgSurface_Unlock(surfobj)) {
             return RAISE(PyExc_RuntimeError, "error unlocking surface");
         }
+        if (result) {
+            return NULL; /* draw_fillpoly ran out of memory */
+        }
     }
 
     if (drawn_area[0] != INT_MAX && drawn_area[1] != INT_MAX &&
@@ -995,145 +1439,1096 @@ rect(PyObject *self, PyObject *args, PyObject *kwargs)
         return pgRect_New4(rect->x, rect->y, 0, 0);
 }
 
-/* Functions used in drawing algorithms */
-
-static void
-swap(float *a, float *b)
-{
-    float temp = *a;
-    *a = *b;
-    *b = temp;
-}
-
-static int
-compare_int(const void *a, const void *b)
+/* Reads an array of numbers into a new int array, as pg_DoublesFromArray()
+ * does. Values that do not fit in an int raise a ValueError.
+ *
+ * Returns NULL with an exception set on failure, the result is freed with
+ * PyMem_Free.
+ */
+static int *
+_ints_from_array(PyObject *obj, const char *name, int *n_cols,
+                 Py_ssize_t *count)
 {
-    return (*(const int *)a) - (*(const int *)b);
-}
+    double *values;
+    int *ints;
+    Py_ssize_t i, num_values;
 
-static int
-sign(int x, int y)
-{
-    return (x > 0) ? 1 : ((x < 0) ? -1 : y);
-}
+    values = pg_DoublesFromArray(obj, name, 0, n_cols, count);
+    if (values == NULL) {
+        return NULL;
+    }
 
-static Uint32
-get_antialiased_color(SDL_Surface *surf, int x, int y, Uint32 original_color,
-                      float brightness, int blend)
-{
-    Uint8 color_part[4], background_color[4];
-    Uint32 *pixels = (Uint32 *)surf->pixels;
-    SDL_GetRGBA(original_color, surf->format, &color_part[0], &color_part[1],
-                &color_part[2], &color_part[3]);
-    if (blend) {
-        if (x < surf->clip_rect.x || x >= surf->clip_rect.x + surf->clip_rect.w ||
-            y < surf->clip_rect.y || y >= surf->clip_rect.y + surf->clip_rect.h)
-            return original_color;
-        SDL_GetRGBA(pixels[(y * surf->w) + x], surf->format, &background_color[0],
-                    &background_color[1], &background_color[2], &background_color[3]);
-        color_part[0] = (Uint8) (brightness * color_part[0] +
-                                (1 - brightness) * background_color[0]);
-        color_part[1] = (Uint8) (brightness * color_part[1] +
-                                (1 - brightness) * background_color[1]);
-        color_part[2] = (Uint8) (brightness * color_part[2] +
-                                (1 - brightness) * background_color[2]);
-        color_part[3] = (Uint8) (brightness * color_part[3] +
-                                (1 - brightness) * background_color[3]);
+    num_values = *count * *n_cols;
+    ints = PyMem_New(int, num_values + 1);
+    if (ints == NULL) {
+        PyMem_Free(values);
+        PyErr_NoMemory();
+        return NULL;
     }
-    else {
-        color_part[0] =  (Uint8) (brightness * color_part[0]);
-        color_part[1] =  (Uint8) (brightness * color_part[1]);
-        color_part[2] =  (Uint8) (brightness * color_part[2]);
-        color_part[3] =  (Uint8) (brightness * color_part[3]);
+
+    for (i = 0; i < num_values; ++i) {
+        if (!(values[i] > INT_MIN - 1.0 && values[i] < INT_MAX + 1.0)) {
+            PyErr_Format(PyExc_ValueError, "%s has a value out of range",
+                         name);
+            PyMem_Free(ints);
+            PyMem_Free(values);
+            return NULL;
+        }
+        ints[i] = (int)values[i];
     }
-    original_color = SDL_MapRGBA(surf->format, color_part[0], color_part[1],
-                                 color_part[2], color_part[3]);
-    return original_color;
+
+    PyMem_Free(values);
+    return ints;
 }
 
-static void
-add_pixel_to_drawn_list(int x, int y, int *pts)
+/* Gets the colors of count batched primitives. The colors are a single
+ * color for all of them, or an array of mapped colors, or an array of
+ * (r, g, b) or (r, g, b, a) rows.
+ *
+ * Returns 0 with an exception set on failure. On success *colors is NULL
+ * for a single color, else a new array freed with PyMem_Free.
+ */
+static int
+_colors_from_obj(PyObject *colorobj, SDL_Surface *surf, Py_ssize_t count,
+                 Uint32 *color, Uint32 **colors)
 {
-    if (x < pts[0]) {
-        pts[0] = x;
-    }
-    if (y < pts[1]) {
-        pts[1] = y;
+    Uint8 rgba[4];
+    int *values, n_cols = 0, i;
+    Py_ssize_t loop;
+
+    *colors = NULL;
+    if (PyObject_IsInstance(colorobj, &pgColor_Type) ||
+        !PyObject_CheckBuffer(colorobj)) {
+        if (PyInt_Check(colorobj)) {
+            *color = (Uint32)PyInt_AsLong(colorobj);
+        }
+        else if (pg_RGBAFromFuzzyColorObj(colorobj, rgba)) {
+            *color = SDL_MapRGBA(surf->format, rgba[0], rgba[1], rgba[2],
+                                 rgba[3]);
+        }
+        else {
+            return 0; /* Exception already set. */
+        }
+        return 1;
     }
-    if (x > pts[2]) {
-        pts[2] = x;
+
+    values = _ints_from_array(colorobj, "colors", &n_cols, &count);
+    if (values == NULL) {
+        return 0;
     }
-    if (y > pts[3]) {
-        pts[3] = y;
+    if (n_cols != 1 && n_cols != 3 && n_cols != 4) {
+        PyMem_Free(values);
+        PyErr_SetString(PyExc_ValueError,
+                        "colors must be an array of mapped colors or of "
+                        "(r, g, b) or (r, g, b, a) rows");
+        return 0;
     }
-}
 
-static int
-clip_line(SDL_Surface *surf, int *x1, int *y1, int *x2, int *y2) {
-    int p1 = *x1 - *x2;
-    int p2 = -p1;
-    int p3 = *y1 - *y2;
-    int p4 = -p3;
-    int q1 = *x1 - surf->clip_rect.x;
-    int q2 = surf->clip_rect.w + surf->clip_rect.x - *x1;
-    int q3 = *y1 - surf->clip_rect.y;
-    int q4 = surf->clip_rect.h + surf->clip_rect.y - *y1;
-    int old_x1 = *x1;
-    int old_y1 = *y1;
-    double nmax = 0;
-    double pmin = 1;
-    double r1, r2;
-    if ((p1 == 0 && q1 < 0) || (p2 == 0 && q2 < 0) || (p3 == 0 && q3 < 0) || (p4 == 0 && q4 < 0))
+    *colors = PyMem_New(Uint32, count + 1);
+    if (*colors == NULL) {
+        PyMem_Free(values);
+        PyErr_NoMemory();
         return 0;
-    if (p1) {
-        r1 = (double) q1 / p1;
-        r2 = (double) q2 / p2;
-        if (p1 < 0) {
-            if (r1 > nmax)
-                nmax = r1;
-            if (r2 < pmin)
-                pmin = r2;
-        }
-        else {
-            if (r2 > nmax)
-                nmax = r2;
-            if (r1 < pmin)
-                pmin = r1;
-        }
     }
-    if (p3) {
-        r1 = (double) q3 / p3;
-        r2 = (double) q4 / p4;
-        if (p3 < 0) {
-            if (r1 > nmax)
-                nmax = r1;
-            if (r2 < pmin)
-                pmin = r2;
+    for (loop = 0; loop < count; ++loop) {
+        int *value = values + loop * n_cols;
+
+        if (n_cols == 1) {
+            (*colors)[loop] = (Uint32)value[0];
+            continue;
         }
-        else {
-            if (r2 > nmax)
-                nmax = r2;
-            if (r1 < pmin)
-                pmin = r1;
+        rgba[3] = 255;
+        for (i = 0; i < n_cols; ++i) {
+            if (value[i] < 0 || value[i] > 255) {
+                PyMem_Free(values);
+                PyMem_Free(*colors);
+                *colors = NULL;
+                PyErr_SetString(PyExc_ValueError,
+                                "colors must have values from 0 to 255");
+                return 0;
+            }
+            rgba[i] = (Uint8)value[i];
         }
+        (*colors)[loop] =
+            SDL_MapRGBA(surf->format, rgba[0], rgba[1], rgba[2], rgba[3]);
     }
-    if (nmax > pmin)
-        return 0;
-    *x1 = old_x1 + (int) (p2 * nmax < 0 ? (p2 * nmax - 0.5) : (p2 * nmax + 0.5));
-    *y1 = old_y1 + (int) (p4 * nmax < 0 ? (p4 * nmax - 0.5) : (p4 * nmax + 0.5));
-    *x2 = old_x1 + (int) (p2 * pmin < 0 ? (p2 * pmin - 0.5) : (p2 * pmin + 0.5));
-    *y2 = old_y1 + (int) (p4 * pmin < 0 ? (p4 * pmin - 0.5) : (p4 * pmin + 0.5));
+    PyMem_Free(values);
     return 1;
 }
 
-static int
-set_at(SDL_Surface *surf, int x, int y, Uint32 color)
+/* Returns the union of drawn areas of a batch as a Rect, or a zero sized
+ * Rect at (x, y) when nothing was drawn.
+ */
+static PyObject *
+_batch_drawn_rect(int *drawn_area, int x, int y)
 {
-    SDL_PixelFormat *format = surf->format;
-    Uint8 *pixels = (Uint8 *)surf->pixels;
-    Uint8 *byte_buf, rgb[4];
-
-    if (x < surf->clip_rect.x || x >= surf->clip_rect.x + surf->clip_rect.w ||
+    if (drawn_area[0] != INT_MAX && drawn_area[1] != INT_MAX &&
+        drawn_area[2] != INT_MIN && drawn_area[3] != INT_MIN)
+        return pgRect_New4(drawn_area[0], drawn_area[1],
+                           drawn_area[2] - drawn_area[0] + 1,
+                           drawn_area[3] - drawn_area[1] + 1);
+    else
+        return pgRect_New4(x, y, 0, 0);
+}
+
+/* Returns whether the box from (left, top) to (right, bottom), grown by
+ * margin on every side, is outside clip. Computed in 64 bits, so the sums
+ * of coordinates near the int limits do not overflow.
+ */
+static int
+_batch_outside_clip(const SDL_Rect *clip, int left, int top, int right,
+                    int bottom, int margin)
+{
+    return (Sint64)right + margin < clip->x ||
+           (Sint64)bottom + margin < clip->y ||
+           (Sint64)left - margin >= (Sint64)clip->x + clip->w ||
+           (Sint64)top - margin >= (Sint64)clip->y + clip->h;
+}
+
+/* Draws many circles on the given surface with one call.
+ *
+ * Returns a Rect bounding the drawn area of all circles.
+ */
+static PyObject *
+circles(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    pgSurfaceObject *surfobj = NULL;
+    PyObject *colorobj = NULL, *centersobj = NULL, *radiiobj = NULL;
+    SDL_Surface *surf = NULL;
+    SDL_Rect clip;
+    Uint32 color, *colors = NULL;
+    int *centers = NULL, *radii = NULL;
+    int radius, posx, posy, circle_width, n_cols;
+    int width = 0; /* Default width. */
+    int drawn_area[4] = {INT_MAX, INT_MAX, INT_MIN,
+                         INT_MIN}; /* Used to store bounding box values */
+    Py_ssize_t loop, count = -1;
+    static char *keywords[] = {"surface", "colors", "centers",
+                               "radii",   "width",  NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!OOO|i", keywords,
+                                     &pgSurface_Type, &surfobj, &colorobj,
+                                     &centersobj, &radiiobj, &width)) {
+        return NULL; /* Exception already set. */
+    }
+
+    surf = pgSurface_AsSurface(surfobj);
+
+    if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4) {
+        return PyErr_Format(PyExc_ValueError,
+                            "unsupported surface bit depth (%d) for drawing",
+                            surf->format->BytesPerPixel);
+    }
+
+    n_cols = 2;
+    centers = _ints_from_array(centersobj, "centers", &n_cols, &count);
+    if (centers == NULL) {
+        return NULL; /* Exception already set. */
+    }
+
+    if (!pg_IntFromObj(radiiobj, &radius)) {
+        n_cols = 1;
+        radii = _ints_from_array(radiiobj, "radii", &n_cols, &count);
+        if (radii == NULL) {
+            PyMem_Free(centers);
+            return NULL; /* Exception already set. */
+        }
+    }
+
+    if (!_colors_from_obj(colorobj, surf, count, &color, &colors)) {
+        PyMem_Free(centers);
+        PyMem_Free(radii);
+        return NULL; /* Exception already set. */
+    }
+
+    if (width >= 0 && !pgSurface_Lock(surfobj)) {
+        PyMem_Free(centers);
+        PyMem_Free(radii);
+        PyMem_Free(colors);
+        return RAISE(PyExc_RuntimeError, "error locking surface");
+    }
+
+    clip = surf->clip_rect;
+    for (loop = 0; width >= 0 && loop < count; ++loop) {
+        posx = centers[loop * 2];
+        posy = centers[loop * 2 + 1];
+        if (radii) {
+            radius = radii[loop];
+        }
+        if (colors) {
+            color = colors[loop];
+        }
+
+        /* skip the circles that are empty or outside the clip area */
+        if (radius < 1 || _batch_outside_clip(&clip, posx, posy, posx, posy,
+                                              radius)) {
+            continue;
+        }
+
+        circle_width = MIN(width, radius);
+        if (!circle_width || circle_width == radius) {
+            draw_circle_filled(surf, posx, posy, radius, color, drawn_area);
+        }
+        else if (circle_width == 1) {
+            draw_circle_bresenham_thin(surf, posx, posy, radius, color,
+                                       drawn_area);
+        }
+        else {
+            draw_circle_bresenham(surf, posx, posy, radius, circle_width,
+                                  color, drawn_area);
+        }
+    }
+
+    posx = count ? centers[0] : 0;
+    posy = count ? centers[1] : 0;
+    PyMem_Free(centers);
+    PyMem_Free(radii);
+    PyMem_Free(colors);
+
+    if (width >= 0 && !pgSurface_Unlock(surfobj)) {
+        return RAISE(PyExc_RuntimeError, "error unlocking surface");
+    }
+
+    return _batch_drawn_rect(drawn_area, posx, posy);
+}
+
+/* Draws many rectangles on the given surface with one call.
+ *
+ * Returns a Rect bounding the drawn area of all rectangles.
+ */
+static PyObject *
+rects(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    pgSurfaceObject *surfobj = NULL;
+    PyObject *colorobj = NULL, *rectsobj = NULL;
+    SDL_Surface *surf = NULL;
+    SDL_Rect clip, sdlrect, clipped;
+    Uint32 color, *colors = NULL;
+    int *values = NULL, *rect;
+    int l, t, r, b, n_cols = 4, result = 0;
+    int width = 0; /* Default width. */
+    int drawn_area[4] = {INT_MAX, INT_MAX, INT_MIN,
+                         INT_MIN}; /* Used to store bounding box values */
+    Py_ssize_t loop, count = -1;
+    static char *keywords[] = {"surface", "colors", "rects", "width", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!OO|i", keywords,
+                                     &pgSurface_Type, &surfobj, &colorobj,
+                                     &rectsobj, &width)) {
+        return NULL; /* Exception already set. */
+    }
+
+    surf = pgSurface_AsSurface(surfobj);
+
+    if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4) {
+        return PyErr_Format(PyExc_ValueError,
+                            "unsupported surface bit depth (%d) for drawing",
+                            surf->format->BytesPerPixel);
+    }
+
+    values = _ints_from_array(rectsobj, "rects", &n_cols, &count);
+    if (values == NULL) {
+        return NULL; /* Exception already set. */
+    }
+
+    if (!_colors_from_obj(colorobj, surf, count, &color, &colors)) {
+        PyMem_Free(values);
+        return NULL; /* Exception already set. */
+    }
+
+    if (width >= 0 && !pgSurface_Lock(surfobj)) {
+        PyMem_Free(values);
+        PyMem_Free(colors);
+        return RAISE(PyExc_RuntimeError, "error locking surface");
+    }
+
+    clip = surf->clip_rect;
+    for (loop = 0; width >= 0 && loop < count && !result; ++loop) {
+        rect = values + loop * 4;
+        if (colors) {
+            color = colors[loop];
+        }
+
+        if (!width) {
+            /* filled, as in rect(), only the part inside the clip area */
+            sdlrect.x = rect[0];
+            sdlrect.y = rect[1];
+            sdlrect.w = rect[2];
+            sdlrect.h = rect[3];
+            if (!SDL_IntersectRect(&sdlrect, &clip, &clipped)) {
+                continue;
+            }
+            result = SDL_FillRect(surf, &clipped, color);
+            add_pixel_to_drawn_list(clipped.x, clipped.y, drawn_area);
+            add_pixel_to_drawn_list(clipped.x + clipped.w - 1,
+                                    clipped.y + clipped.h - 1, drawn_area);
+            continue;
+        }
+
+        /* an outline, drawn like the closed lines rect() draws */
+        l = rect[0];
+        r = rect[0] + rect[2] - 1;
+        t = rect[1];
+        b = rect[1] + rect[3] - 1;
+        if (_batch_outside_clip(&clip, MIN(l, r), MIN(t, b), MAX(l, r),
+                                MAX(t, b), width)) {
+            continue;
+        }
+        draw_line_width(surf, color, l, t, r, t, width, drawn_area);
+        draw_line_width(surf, color, r, t, r, b, width, drawn_area);
+        draw_line_width(surf, color, r, b, l, b, width, drawn_area);
+        draw_line_width(surf, color, l, b, l, t, width, drawn_area);
+    }
+
+    l = count ? values[0] : 0;
+    t = count ? values[1] : 0;
+    PyMem_Free(values);
+    PyMem_Free(colors);
+
+    if (width >= 0 && !pgSurface_Unlock(surfobj)) {
+        return RAISE(PyExc_RuntimeError, "error unlocking surface");
+    }
+    if (result != 0) {
+        return RAISE(pgExc_SDLError, SDL_GetError());
+    }
+
+    return _batch_drawn_rect(drawn_area, l, t);
+}
+
+/* Draws many separate line segments on the given surface with one call.
+ *
+ * Returns a Rect bounding the drawn area of all segments.
+ */
+static PyObject *
+segments(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    pgSurfaceObject *surfobj = NULL;
+    PyObject *colorobj = NULL, *segmentsobj = NULL;
+    SDL_Surface *surf = NULL;
+    SDL_Rect clip;
+    Uint32 color, *colors = NULL;
+    int *values = NULL, *segment;
+    int x, y, n_cols = 4;
+    int width = 1; /* Default width. */
+    int drawn_area[4] = {INT_MAX, INT_MAX, INT_MIN,
+                         INT_MIN}; /* Used to store bounding box values */
+    Py_ssize_t loop, count = -1;
+    static char *keywords[] = {"surface", "colors", "segments", "width",
+                               NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!OO|i", keywords,
+                                     &pgSurface_Type, &surfobj, &colorobj,
+                                     &segmentsobj, &width)) {
+        return NULL; /* Exception already set. */
+    }
+
+    surf = pgSurface_AsSurface(surfobj);
+
+    if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4) {
+        return PyErr_Format(PyExc_ValueError,
+                            "unsupported surface bit depth (%d) for drawing",
+                            surf->format->BytesPerPixel);
+    }
+
+    values = _ints_from_array(segmentsobj, "segments", &n_cols, &count);
+    if (values == NULL) {
+        return NULL; /* Exception already set. */
+    }
+
+    if (!_colors_from_obj(colorobj, surf, count, &color, &colors)) {
+        PyMem_Free(values);
+        return NULL; /* Exception already set. */
+    }
+
+    if (width >= 1 && !pgSurface_Lock(surfobj)) {
+        PyMem_Free(values);
+        PyMem_Free(colors);
+        return RAISE(PyExc_RuntimeError, "error locking surface");
+    }
+
+    clip = surf->clip_rect;
+    for (loop = 0; width >= 1 && loop < count; ++loop) {
+        segment = values + loop * 4;
+        if (colors) {
+            color = colors[loop];
+        }
+
+        /* skip the segments outside the clip area */
+        if (_batch_outside_clip(&clip, MIN(segment[0], segment[2]),
+                                MIN(segment[1], segment[3]),
+                                MAX(segment[0], segment[2]),
+                                MAX(segment[1], segment[3]), width)) {
+            continue;
+        }
+        draw_line_width(surf, color, segment[0], segment[1], segment[2],
+                        segment[3], width, drawn_area);
+    }
+
+    x = count ? values[0] : 0;
+    y = count ? values[1] : 0;
+    PyMem_Free(values);
+    PyMem_Free(colors);
+
+    if (width >= 1 && !pgSurface_Unlock(surfobj)) {
+        return RAISE(PyExc_RuntimeError, "error unlocking surface");
+    }
+
+    return _batch_drawn_rect(drawn_area, x, y);
+}
+
+/* Draws an antialiased circle on the given surface.
+ *
+ * Returns a Rect bounding the drawn area.
+ */
+static PyObject *
+aacircle(PyObject *self, PyObject *arg, PyObject *kwargs)
+{
+    pgSurfaceObject *surfobj = NULL;
+    PyObject *colorobj = NULL, *posobj = NULL, *radiusobj = NULL;
+    SDL_Surface *surf = NULL;
+    Uint8 rgba[4];
+    Uint32 color;
+    float posx, posy, radius, inner;
+    int width = 0; /* Default values. */
+    int drawn_area[4] = {INT_MAX, INT_MAX, INT_MIN,
+                         INT_MIN}; /* Used to store bounding box values */
+    static char *keywords[] = {"surface", "color", "center", "radius",
+                               "width",   NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(arg, kwargs, "O!OOO|i", keywords,
+                                     &pgSurface_Type, &surfobj, &colorobj,
+                                     &posobj, &radiusobj, &width)) {
+        return NULL; /* Exception already set. */
+    }
+
+    if (!pg_TwoFloatsFromObj(posobj, &posx, &posy)) {
+        return RAISE(PyExc_TypeError,
+                     "center argument must be a pair of numbers");
+    }
+
+    if (!pg_FloatFromObj(radiusobj, &radius)) {
+        return RAISE(PyExc_TypeError, "radius argument must be a number");
+    }
+
+    surf = pgSurface_AsSurface(surfobj);
+
+    if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4) {
+        return PyErr_Format(PyExc_ValueError,
+                            "unsupported surface bit depth (%d) for drawing",
+                            surf->format->BytesPerPixel);
+    }
+
+    CHECK_LOAD_COLOR(colorobj)
+
+    if (radius <= 0.0f || width < 0) {
+        return pgRect_New4((int)posx, (int)posy, 0, 0);
+    }
+
+    if (!pgSurface_Lock(surfobj)) {
+        return RAISE(PyExc_RuntimeError, "error locking surface");
+    }
+
+    /* Like circle(), a width of 0 fills the circle and an outline grows
+     * inward, filling the circle once it is as wide as the radius. */
+    inner = width ? radius - width : 0.0f;
+    draw_aa_ellipse(surf, posx, posy, radius, radius, inner, inner, color,
+                    drawn_area);
+
+    if (!pgSurface_Unlock(surfobj)) {
+        return RAISE(PyExc_RuntimeError, "error unlocking surface");
+    }
+
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+
+    if (drawn_area[0] != INT_MAX && drawn_area[1] != INT_MAX &&
+        drawn_area[2] != INT_MIN && drawn_area[3] != INT_MIN)
+        return pgRect_New4(drawn_area[0], drawn_area[1],
+                           drawn_area[2] - drawn_area[0] + 1,
+                           drawn_area[3] - drawn_area[1] + 1);
+    else
+        return pgRect_New4((int)posx, (int)posy, 0, 0);
+}
+
+/* Draws a filled antialiased ellipse on the given surface.
+ *
+ * Returns a Rect bounding the drawn area.
+ */
+static PyObject *
+aaellipse(PyObject *self, PyObject *arg, PyObject *kwargs)
+{
+    pgSurfaceObject *surfobj = NULL;
+    PyObject *colorobj = NULL, *rectobj = NULL;
+    SDL_Surface *surf = NULL;
+    GAME_Rect *rect = NULL, temp;
+    Uint8 rgba[4];
+    Uint32 color;
+    int drawn_area[4] = {INT_MAX, INT_MAX, INT_MIN,
+                         INT_MIN}; /* Used to store bounding box values */
+    static char *keywords[] = {"surface", "color", "rect", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(arg, kwargs, "O!OO", keywords,
+                                     &pgSurface_Type, &surfobj, &colorobj,
+                                     &rectobj)) {
+        return NULL; /* Exception already set. */
+    }
+
+    rect = pgRect_FromObject(rectobj, &temp);
+
+    if (!rect) {
+        return RAISE(PyExc_TypeError, "rect argument is invalid");
+    }
+
+    surf = pgSurface_AsSurface(surfobj);
+
+    if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4) {
+        return PyErr_Format(PyExc_ValueError,
+                            "unsupported surface bit depth (%d) for drawing",
+                            surf->format->BytesPerPixel);
+    }
+
+    CHECK_LOAD_COLOR(colorobj)
+
+    if (rect->w <= 0 || rect->h <= 0) {
+        return pgRect_New4(rect->x, rect->y, 0, 0);
+    }
+
+    if (!pgSurface_Lock(surfobj)) {
+        return RAISE(PyExc_RuntimeError, "error locking surface");
+    }
+
+    /* The rect's pixels reach half a pixel past their centers. */
+    draw_aa_ellipse(surf, rect->x + rect->w / 2.0f - 0.5f,
+                    rect->y + rect->h / 2.0f - 0.5f, rect->w / 2.0f,
+                    rect->h / 2.0f, 0.0f, 0.0f, color, drawn_area);
+
+    if (!pgSurface_Unlock(surfobj)) {
+        return RAISE(PyExc_RuntimeError, "error unlocking surface");
+    }
+
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+
+    if (drawn_area[0] != INT_MAX && drawn_area[1] != INT_MAX &&
+        drawn_area[2] != INT_MIN && drawn_area[3] != INT_MIN)
+        return pgRect_New4(drawn_area[0], drawn_area[1],
+                           drawn_area[2] - drawn_area[0] + 1,
+                           drawn_area[3] - drawn_area[1] + 1);
+    else
+        return pgRect_New4(rect->x, rect->y, 0, 0);
+}
+
+/* Draws a filled antialiased polygon on the given surface.
+ *
+ * Returns a Rect bounding the drawn area.
+ */
+static PyObject *
+aapolygon(PyObject *self, PyObject *arg, PyObject *kwargs)
+{
+    pgSurfaceObject *surfobj = NULL;
+    PyObject *colorobj = NULL, *points = NULL, *item = NULL;
+    SDL_Surface *surf = NULL;
+    Uint8 rgba[4];
+    Uint32 color;
+    float *xlist = NULL, *ylist = NULL;
+    float x, y;
+    int result, l, t;
+    int drawn_area[4] = {INT_MAX, INT_MAX, INT_MIN,
+                         INT_MIN}; /* Used to store bounding box values */
+    Py_ssize_t loop, length;
+    static char *keywords[] = {"surface", "color", "points", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(arg, kwargs, "O!OO", keywords,
+                                     &pgSurface_Type, &surfobj, &colorobj,
+                                     &points)) {
+        return NULL; /* Exception already set. */
+    }
+
+    surf = pgSurface_AsSurface(surfobj);
+
+    if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4) {
+        return PyErr_Format(PyExc_ValueError,
+                            "unsupported surface bit depth (%d) for drawing",
+                            surf->format->BytesPerPixel);
+    }
+
+    CHECK_LOAD_COLOR(colorobj)
+
+    if (!PySequence_Check(points)) {
+        return RAISE(PyExc_TypeError,
+                     "points argument must be a sequence of number pairs");
+    }
+
+    length = PySequence_Length(points);
+
+    if (length < 3) {
+        return RAISE(PyExc_ValueError,
+                     "points argument must contain more than 2 points");
+    }
+
+    xlist = PyMem_New(float, length);
+    ylist = PyMem_New(float, length);
+
+    if (NULL == xlist || NULL == ylist) {
+        if (xlist) {
+            PyMem_Del(xlist);
+        }
+        if (ylist) {
+            PyMem_Del(ylist);
+        }
+        return RAISE(PyExc_MemoryError,
+                     "cannot allocate memory to draw aapolygon");
+    }
+
+    for (loop = 0; loop < length; ++loop) {
+        item = PySequence_GetItem(points, loop);
+        result = pg_TwoFloatsFromObj(item, &x, &y);
+        Py_DECREF(item);
+
+        if (!result) {
+            PyMem_Del(xlist);
+            PyMem_Del(ylist);
+            return RAISE(PyExc_TypeError, "points must be number pairs");
+        }
+
+        xlist[loop] = x;
+        ylist[loop] = y;
+    }
+
+    l = (int)xlist[0];
+    t = (int)ylist[0];
+
+    if (!pgSurface_Lock(surfobj)) {
+        PyMem_Del(xlist);
+        PyMem_Del(ylist);
+        return RAISE(PyExc_RuntimeError, "error locking surface");
+    }
+
+    draw_aa_fillpoly(surf, xlist, ylist, length, color, 1, drawn_area);
+    PyMem_Del(xlist);
+    PyMem_Del(ylist);
+
+    if (!pgSurface_Unlock(surfobj)) {
+        return RAISE(PyExc_RuntimeError, "error unlocking surface");
+    }
+
+    if (PyErr_Occurred()) {
+        return NULL;
+    }
+
+    if (drawn_area[0] != INT_MAX && drawn_area[1] != INT_MAX &&
+        drawn_area[2] != INT_MIN && drawn_area[3] != INT_MIN)
+        return pgRect_New4(drawn_area[0], drawn_area[1],
+                           drawn_area[2] - drawn_area[0] + 1,
+                           drawn_area[3] - drawn_area[1] + 1);
+    else
+        return pgRect_New4(l, t, 0, 0);
+}
+
+/* Reads the stops of a gradient: a sequence of colors spread evenly from
+ * 0 to 1, or a sequence of (position, color) pairs in order of position.
+ *
+ * Returns the number of stops, or -1 with an exception set. On success
+ * *positions and *colors (4 bytes per stop) are new arrays freed with
+ * PyMem_Free.
+ */
+static Py_ssize_t
+_gradient_stops_from_obj(PyObject *stopsobj, SDL_Surface *surf,
+                         double **positions, Uint8 **colors)
+{
+    PyObject *item, *posobj, *colorobj;
+    Py_ssize_t i, count;
+    int paired = -1, is_pair, ok;
+    float pos = 0.0f;
+    Uint8 *rgba;
+
+    if (!PySequence_Check(stopsobj) || PyUnicode_Check(stopsobj)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "stops must be a sequence of colors or of "
+                        "(position, color) pairs");
+        return -1;
+    }
+    count = PySequence_Length(stopsobj);
+    if (count < 0) {
+        return -1;
+    }
+    if (count == 0) {
+        PyErr_SetString(PyExc_ValueError, "stops must not be empty");
+        return -1;
+    }
+
+    *positions = PyMem_New(double, count);
+    *colors = PyMem_New(Uint8, count * 4);
+    if (*positions == NULL || *colors == NULL) {
+        PyErr_NoMemory();
+        goto error;
+    }
+
+    for (i = 0; i < count; i++) {
+        item = PySequence_GetItem(stopsobj, i);
+        if (item == NULL) {
+            goto error;
+        }
+        is_pair = (PyTuple_Check(item) || PyList_Check(item)) &&
+                  PySequence_Length(item) == 2;
+        if (paired < 0) {
+            paired = is_pair;
+        }
+        else if (paired != is_pair) {
+            Py_DECREF(item);
+            PyErr_SetString(PyExc_ValueError,
+                            "stops must all be colors or all be "
+                            "(position, color) pairs");
+            goto error;
+        }
+
+        if (is_pair) {
+            posobj = PySequence_GetItem(item, 0);
+            colorobj = PySequence_GetItem(item, 1);
+            Py_DECREF(item);
+            ok = posobj != NULL && colorobj != NULL &&
+                 pg_FloatFromObj(posobj, &pos);
+            Py_XDECREF(posobj);
+            if (!ok) {
+                Py_XDECREF(colorobj);
+                if (!PyErr_Occurred()) {
+                    PyErr_SetString(PyExc_TypeError,
+                                    "stop position must be a number");
+                }
+                goto error;
+            }
+            if (i > 0 && !(pos >= (*positions)[i - 1])) {
+                Py_DECREF(colorobj);
+                PyErr_SetString(PyExc_ValueError,
+                                "stop positions must be in increasing order");
+                goto error;
+            }
+            (*positions)[i] = pos;
+        }
+        else {
+            colorobj = item;
+            (*positions)[i] = (count > 1) ? (double)i / (count - 1) : 0.0;
+        }
+
+        rgba = *colors + i * 4;
+        if (PyInt_Check(colorobj)) {
+            SDL_GetRGBA((Uint32)PyInt_AsLong(colorobj), surf->format, rgba,
+                        rgba + 1, rgba + 2, rgba + 3);
+            ok = 1;
+        }
+        else {
+            /* pg_RGBAFromFuzzyColorObj sets the exception for us */
+            ok = pg_RGBAFromFuzzyColorObj(colorobj, rgba);
+        }
+        Py_DECREF(colorobj);
+        if (!ok) {
+            goto error;
+        }
+    }
+    return count;
+
+error:
+    PyMem_Free(*positions);
+    PyMem_Free(*colors);
+    *positions = NULL;
+    *colors = NULL;
+    return -1;
+}
+
+/* Fills a rect of the given surface with a linear, radial or conic
+ * gradient.
+ *
+ * Returns a Rect bounding the drawn area.
+ */
+static PyObject *
+gradient_rect(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    pgSurfaceObject *surfobj = NULL;
+    PyObject *rectobj = NULL, *stopsobj = NULL, *centerobj = Py_None;
+    GAME_Rect *rect = NULL, temp;
+    SDL_Surface *surf = NULL;
+    SDL_Rect sdlrect;
+    gradient_job job;
+    const char *kind = "linear";
+    float angle = 0.0f, center_x, center_y;
+    double *positions = NULL, radians, corner_x, corner_y, radius;
+    Uint8 *colors = NULL;
+    Py_ssize_t num_stops;
+    int dither = 0, num_bands;
+    static char *keywords[] = {"surface", "rect",   "stops",  "kind",
+                               "angle",   "center", "dither", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!OO|sfOp", keywords,
+                                     &pgSurface_Type, &surfobj, &rectobj,
+                                     &stopsobj, &kind, &angle, &centerobj,
+                                     &dither)) {
+        return NULL; /* Exception already set. */
+    }
+
+    if (!(rect = pgRect_FromObject(rectobj, &temp))) {
+        return RAISE(PyExc_TypeError, "rect argument is invalid");
+    }
+
+    surf = pgSurface_AsSurface(surfobj);
+    if (surf->format->BytesPerPixel <= 0 || surf->format->BytesPerPixel > 4) {
+        return PyErr_Format(PyExc_ValueError,
+                            "unsupported surface bit depth (%d) for drawing",
+                            surf->format->BytesPerPixel);
+    }
+
+    if (!strcmp(kind, "linear")) {
+        job.kind = GRADIENT_LINEAR;
+    }
+    else if (!strcmp(kind, "radial")) {
+        job.kind = GRADIENT_RADIAL;
+    }
+    else if (!strcmp(kind, "conic")) {
+        job.kind = GRADIENT_CONIC;
+    }
+    else {
+        return RAISE(PyExc_ValueError,
+                     "kind must be 'linear', 'radial' or 'conic'");
+    }
+
+    if (centerobj == Py_None) {
+        center_x = rect->x + rect->w / 2.0f;
+        center_y = rect->y + rect->h / 2.0f;
+    }
+    else if (!pg_TwoFloatsFromObj(centerobj, &center_x, &center_y)) {
+        return RAISE(PyExc_TypeError,
+                     "center argument must be a pair of numbers");
+    }
+
+    num_stops = _gradient_stops_from_obj(stopsobj, surf, &positions, &colors);
+    if (num_stops < 0) {
+        return NULL; /* Exception already set. */
+    }
+
+    sdlrect.x = rect->x;
+    sdlrect.y = rect->y;
+    sdlrect.w = rect->w;
+    sdlrect.h = rect->h;
+    if (!SDL_IntersectRect(&sdlrect, &surf->clip_rect, &job.area)) {
+        PyMem_Free(positions);
+        PyMem_Free(colors);
+        return pgRect_New4(rect->x, rect->y, 0, 0);
+    }
+
+    job.table = draw_gradient_table(surf->format, positions, colors,
+                                    num_stops, dither);
+    PyMem_Free(positions);
+    PyMem_Free(colors);
+    if (job.table == NULL) {
+        return PyErr_NoMemory();
+    }
+    job.surf = surf;
+    job.rect_x = rect->x;
+    job.dither = dither;
+    job.cx = center_x;
+    job.cy = center_y;
+    job.t0 = 0.0;
+    job.dx = job.dy = 0.0;
+    radians = angle * M_PI / 180.0;
+
+    switch (job.kind) {
+        case GRADIENT_LINEAR: {
+            /* t goes from 0 to 1 across the projection of the rect onto
+             * the direction of the angle, up for 90 degrees. */
+            double span = fabs(rect->w * cos(radians)) +
+                          fabs(rect->h * sin(radians));
+            job.cx = rect->x + rect->w / 2.0;
+            job.cy = rect->y + rect->h / 2.0;
+            job.t0 = 0.5;
+            if (span > 0.0) {
+                job.dx = cos(radians) / span;
+                job.dy = -sin(radians) / span;
+            }
+            break;
+        }
+        case GRADIENT_RADIAL:
+            /* t reaches 1 at the farthest corner from the center. */
+            corner_x = MAX(fabs(rect->x - job.cx),
+                           fabs(rect->x + rect->w - job.cx));
+            corner_y = MAX(fabs(rect->y - job.cy),
+                           fabs(rect->y + rect->h - job.cy));
+            radius = sqrt(corner_x * corner_x + corner_y * corner_y);
+            job.dx = (radius > 0.0) ? 1.0 / radius : 0.0;
+            break;
+        default: /* GRADIENT_CONIC */
+            job.dy = fmod(radians, 2.0 * M_PI);
+            if (job.dy < 0.0) {
+                job.dy += 2.0 * M_PI;
+            }
+            break;
+    }
+
+    if (!pgSurface_Lock(surfobj)) {
+        PyMem_Free(job.table);
+        return RAISE(PyExc_RuntimeError, "error locking surface");
+    }
+
+    num_bands = ((Sint64)job.area.w * job.area.h >= DRAW_BAND_MIN_PIXELS)
+                    ? pg_band_count(job.area.w, job.area.h, DRAW_BAND_MIN_ROWS)
+                    : 1;
+    if (_is_display_surface(surf)) {
+        pg_run_bands(draw_gradient_rows, &job, job.area.h, num_bands);
+    }
+    else {
+        Py_BEGIN_ALLOW_THREADS;
+        pg_run_bands(draw_gradient_rows, &job, job.area.h, num_bands);
+        Py_END_ALLOW_THREADS;
+    }
+    PyMem_Free(job.table);
+
+    if (!pgSurface_Unlock(surfobj)) {
+        return RAISE(PyExc_RuntimeError, "error unlocking surface");
+    }
+
+    return pgRect_New4(job.area.x, job.area.y, job.area.w, job.area.h);
+}
+
+/* Functions used in drawing algorithms */
+
+static void
+swap(float *a, float *b)
+{
+    float temp = *a;
+    *a = *b;
+    *b = temp;
+}
+
+static int
+compare_poly_edge(const void *a, const void *b)
+{
+    int y1 = ((const poly_edge *)a)->y1, y2 = ((const poly_edge *)b)->y1;
+    return (y1 > y2) - (y1 < y2);
+}
+
+static int
+sign(int x, int y)
+{
+    return (x > 0) ? 1 : ((x < 0) ? -1 : y);
+}
+
+static Uint32
+get_antialiased_color(SDL_Surface *surf, int x, int y, Uint32 original_color,
+                      float brightness, int blend)
+{
+    Uint8 color_part[4], background_color[4];
+    Uint32 *pixels = (Uint32 *)surf->pixels;
+    SDL_GetRGBA(original_color, surf->format, &color_part[0], &color_part[1],
+                &color_part[2], &color_part[3]);
+    if (blend) {
+        if (x < surf->clip_rect.x || x >= surf->clip_rect.x + surf->clip_rect.w ||
+            y < surf->clip_rect.y || y >= surf->clip_rect.y + surf->clip_rect.h)
+            return original_color;
+        SDL_GetRGBA(pixels[(y * surf->w) + x], surf->format, &background_color[0],
+                    &background_color[1], &background_color[2], &background_color[3]);
+        color_part[0] = (Uint8) (brightness * color_part[0] +
+                                (1 - brightness) * background_color[0]);
+        color_part[1] = (Uint8) (brightness * color_part[1] +
+                                (1 - brightness) * background_color[1]);
+        color_part[2] = (Uint8) (brightness * color_part[2] +
+                                (1 - brightness) * background_color[2]);
+        color_part[3] = (Uint8) (brightness * color_part[3] +
+                                (1 - brightness) * background_color[3]);
+    }
+    else {
+        color_part[0] =  (Uint8) (brightness * color_part[0]);
+        color_part[1] =  (Uint8) (brightness * color_part[1]);
+        color_part[2] =  (Uint8) (brightness * color_part[2]);
+        color_part[3] =  (Uint8) (brightness * color_part[3]);
+    }
+    original_color = SDL_MapRGBA(surf->format, color_part[0], color_part[1],
+                                 color_part[2], color_part[3]);
+    return original_color;
+}
+
+static void
+add_pixel_to_drawn_list(int x, int y, int *pts)
+{
+    if (x < pts[0]) {
+        pts[0] = x;
+    }
+    if (y < pts[1]) {
+        pts[1] = y;
+    }
+    if (x > pts[2]) {
+        pts[2] = x;
+    }
+    if (y > pts[3]) {
+        pts[3] = y;
+    }
+}
+
+static int
+clip_line(SDL_Surface *surf, int *x1, int *y1, int *x2, int *y2) {
+    int p1 = *x1 - *x2;
+    int p2 = -p1;
+    int p3 = *y1 - *y2;
+    int p4 = -p3;
+    int q1 = *x1 - surf->clip_rect.x;
+    int q2 = surf->clip_rect.w + surf->clip_rect.x - *x1;
+    int q3 = *y1 - surf->clip_rect.y;
+    int q4 = surf->clip_rect.h + surf->clip_rect.y - *y1;
+    int old_x1 = *x1;
+    int old_y1 = *y1;
+    double nmax = 0;
+    double pmin = 1;
+    double r1, r2;
+    if ((p1 == 0 && q1 < 0) || (p2 == 0 && q2 < 0) || (p3 == 0 && q3 < 0) || (p4 == 0 && q4 < 0))
+        return 0;
+    if (p1) {
+        r1 = (double) q1 / p1;
+        r2 = (double) q2 / p2;
+        if (p1 < 0) {
+            if (r1 > nmax)
+                nmax = r1;
+            if (r2 < pmin)
+                pmin = r2;
+        }
+        else {
+            if (r2 > nmax)
+                nmax = r2;
+            if (r1 < pmin)
+                pmin = r1;
+        }
+    }
+    if (p3) {
+        r1 = (double) q3 / p3;
+        r2 = (double) q4 / p4;
+        if (p3 < 0) {
+            if (r1 > nmax)
+                nmax = r1;
+            if (r2 < pmin)
+                pmin = r2;
+        }
+        else {
+            if (r2 > nmax)
+                nmax = r2;
+            if (r1 < pmin)
+                pmin = r1;
+        }
+    }
+    if (nmax > pmin)
+        return 0;
+    *x1 = old_x1 + (int) (p2 * nmax < 0 ? (p2 * nmax - 0.5) : (p2 * nmax + 0.5));
+    *y1 = old_y1 + (int) (p4 * nmax < 0 ? (p4 * nmax - 0.5) : (p4 * nmax + 0.5));
+    *x2 = old_x1 + (int) (p2 * pmin < 0 ? (p2 * pmin - 0.5) : (p2 * pmin + 0.5));
+    *y2 = old_y1 + (int) (p4 * pmin < 0 ? (p4 * pmin - 0.5) : (p4 * pmin + 0.5));
+    return 1;
+}
+
+static int
+set_at(SDL_Surface *surf, int x, int y, Uint32 color)
+{
+    SDL_PixelFormat *format = surf->format;
+    Uint8 *pixels = (Uint8 *)surf->pixels;
+    Uint8 *byte_buf, rgb[4];
+
+    if (x < surf->clip_rect.x || x >= surf->clip_rect.x + surf->clip_rect.w ||
         y < surf->clip_rect.y || y >= surf->clip_rect.y + surf->clip_rect.h)
         return 0;
 
@@ -1455,14 +2850,87 @@ int inside_clip(SDL_Surface *surf, int x, int y) {
     return 1;
 }
 
+/* Steps through the center points of a line that is wider than it is
+ * tall, in the order draw_line_width always has: along the clipped line,
+ * then on past its clipped end while the thick line is still inside the
+ * clip area, then the last point. The points are read in runs of points
+ * on the same row.
+ */
+typedef struct {
+    int x, y, x2, y2, end_x;
+    int dx, dy, sx, sy, err;
+    int width, phase;
+    int run_x, run_y, has_run; /* first point of the next run */
+} line_walk;
+
+static int
+line_walk_point(SDL_Surface *surf, line_walk *walk, int *x, int *y)
+{
+    int e2;
+
+    if (walk->phase == 0 && sign(walk->x - walk->x2, walk->sx) == walk->sx &&
+        sign(walk->y - walk->y2, walk->sy) == walk->sy) {
+        walk->phase = 1;
+    }
+    if (walk->phase == 1 &&
+        (walk->x == walk->end_x ||
+         (!inside_clip(surf, walk->x, walk->y - (walk->width - 1) / 2) &&
+          !inside_clip(surf, walk->x, walk->y + walk->width / 2)))) {
+        walk->phase = 2;
+    }
+    if (walk->phase == 3) {
+        return 0;
+    }
+    *x = walk->x;
+    *y = walk->y;
+    if (walk->phase == 2) {
+        walk->phase = 3;
+        return 1;
+    }
+    e2 = walk->err;
+    if (e2 > -walk->dx) {
+        walk->err -= walk->dy;
+        walk->x += walk->sx;
+    }
+    if (e2 < walk->dy) {
+        walk->err += walk->dx;
+        walk->y += walk->sy;
+    }
+    return 1;
+}
+
+static int
+line_walk_run(SDL_Surface *surf, line_walk *walk, int *x_first, int *x_last)
+{
+    int x, y;
+
+    if (!walk->has_run) {
+        return 0;
+    }
+    *x_first = *x_last = walk->run_x;
+    walk->has_run = 0;
+    while (line_walk_point(surf, walk, &x, &y)) {
+        if (y != walk->run_y) {
+            walk->run_x = x;
+            walk->run_y = y;
+            walk->has_run = 1;
+            break;
+        }
+        *x_last = x;
+    }
+    return 1;
+}
+
 static void
 draw_line_width(SDL_Surface *surf, Uint32 color, int x1, int y1, int x2, int y2, int width,
                 int *drawn_area)
 {
-    int dx, dy, err, e2, sx, sy, y;
+    int dx, dy, err, e2, sx, sy, i;
     int left_top, right_bottom;
     int end_x = x2; int end_y = y2;
     int xinc = 0;
+    line_walk head, tail;
+    int head_first, head_last, tail_first, tail_last, row;
     /* Decide which direction to grow (width/thickness). */
     if (abs(x1 - x2) <= abs(y1 - y2)) {
         /* The line's thickness will be in the x direction. The top/bottom
@@ -1477,58 +2945,119 @@ draw_line_width(SDL_Surface *surf, Uint32 color, int x1, int y1, int x2, int y2,
     if (clip_line(surf, &x1, &y1, &x2, &y2)) {
         if (width == 1)
             draw_line(surf, x1, y1, x2, y2, color, drawn_area);
-        else {
-            if (xinc) {
-                left_top = x1 - (width - 1) / 2;
-                right_bottom = x1 + width / 2;
-            }
-            else {
-                left_top = y1 -(width - 1) / 2;
-                right_bottom = y1 + width / 2;
-            }
+        else if (xinc) {
+            left_top = x1 - (width - 1) / 2;
+            right_bottom = x1 + width / 2;
             while ((sign(x1 - x2, sx) != sx) || (sign(y1 - y2, sy) != sy)) {
-                if (xinc)
-                    drawhorzlineclip(surf, color, left_top, y1, right_bottom, drawn_area);
-                else {
-                    for (y = left_top; y <= right_bottom; y++)
-                        set_and_check_rect(surf, x1, y, color, drawn_area);
-                }
+                drawhorzlineclip(surf, color, left_top, y1, right_bottom, drawn_area);
                 e2 = err;
                 if (e2 >-dx) {
                     err -= dy;
                     x1 += sx;
-                    if (xinc) { left_top += sx; right_bottom += sx; }
+                    left_top += sx;
+                    right_bottom += sx;
                 }
                 if (e2 < dy) {
                     err += dx;
                     y1 += sy;
-                    if (!xinc) { left_top += sy; right_bottom += sy; }
                 }
             }
-            if (xinc) {
-                while (y1 != end_y && (inside_clip(surf, left_top, y1) || inside_clip(surf, right_bottom, y1))) {
-                    drawhorzlineclip(surf, color, left_top, y1, right_bottom, drawn_area);
-                    e2 = err;
-                    if (e2 >-dx) { err -= dy; x1 += sx; left_top += sx; right_bottom += sx; }
-                    if (e2 < dy) { err += dx; y1 += sy; }
-                }
+            while (y1 != end_y && (inside_clip(surf, left_top, y1) || inside_clip(surf, right_bottom, y1))) {
                 drawhorzlineclip(surf, color, left_top, y1, right_bottom, drawn_area);
+                e2 = err;
+                if (e2 >-dx) { err -= dy; x1 += sx; left_top += sx; right_bottom += sx; }
+                if (e2 < dy) { err += dx; y1 += sy; }
             }
-            else {
-                while (x1 != end_x && (inside_clip(surf, x1, left_top) || inside_clip(surf, x1, right_bottom))) {
-                    for (y = left_top; y <= right_bottom; y++)
-                        set_and_check_rect(surf, x1, y, color, drawn_area);
-                    e2 = err;
-                    if (e2 >-dx) { err -= dy; x1 += sx; }
-                    if (e2 < dy) { err += dx; y1 += sy; left_top += sy; right_bottom += sy; }
+            drawhorzlineclip(surf, color, left_top, y1, right_bottom, drawn_area);
+        }
+        else {
+            /* Every center point grows into a column of width pixels, so
+             * each row is covered by the columns of width runs of center
+             * points on consecutive rows. Two walks along the line, width
+             * runs apart, give the first and the last of those columns and
+             * the row is drawn as one span between them.
+             */
+            head.x = x1;
+            head.y = y1;
+            head.x2 = x2;
+            head.y2 = y2;
+            head.end_x = end_x;
+            head.dx = dx;
+            head.dy = dy;
+            head.sx = sx;
+            head.sy = sy;
+            head.err = err;
+            head.width = width;
+            head.phase = 0;
+            line_walk_point(surf, &head, &head.run_x, &head.run_y);
+            head.has_run = 1;
+            tail = head;
+
+            line_walk_run(surf, &head, &head_first, &head_last);
+            line_walk_run(surf, &tail, &tail_first, &tail_last);
+            /* The first row is the top or bottom of the first column. */
+            row = (sy > 0) ? y1 - (width - 1) / 2 : y1 + width / 2;
+            for (i = 0;; ++i, row += sy) {
+                if (i > 0) {
+                    line_walk_run(surf, &head, &head_first, &head_last);
                 }
-                for (y = left_top; y <= right_bottom; y++)
-                    set_and_check_rect(surf, x1, y, color, drawn_area);
+                if (i >= width && !line_walk_run(surf, &tail, &tail_first, &tail_last)) {
+                    break;
+                }
+                drawhorzlineclip(surf, color, tail_first, row, head_last, drawn_area);
             }
         }
     }
 }
 
+/* Draws a thick line with the given LINE_CAP_* at each end.
+ *
+ * A square cap extends the line by half its width, a round cap adds a
+ * filled circle of the line's width centered on the end point.
+ */
+static void
+draw_line_capped(SDL_Surface *surf, Uint32 color, int x1, int y1, int x2,
+                 int y2, int width, int start_cap, int end_cap,
+                 int *drawn_area)
+{
+    int ext_x = 0, ext_y = 0;
+    int sx1 = x1, sy1 = y1, sx2 = x2, sy2 = y2;
+    double length;
+
+    if (width > 1 && (start_cap == LINE_CAP_SQUARE ||
+                      end_cap == LINE_CAP_SQUARE)) {
+        length = sqrt((double)(x2 - x1) * (x2 - x1) +
+                      (double)(y2 - y1) * (y2 - y1));
+        if (length > 0) {
+            ext_x = (int)floor((double)(x2 - x1) * (width / 2) / length + 0.5);
+            ext_y = (int)floor((double)(y2 - y1) * (width / 2) / length + 0.5);
+        }
+        if (start_cap == LINE_CAP_SQUARE) {
+            sx1 -= ext_x;
+            sy1 -= ext_y;
+        }
+        if (end_cap == LINE_CAP_SQUARE) {
+            sx2 += ext_x;
+            sy2 += ext_y;
+        }
+    }
+
+    draw_line_width(surf, color, sx1, sy1, sx2, sy2, width, drawn_area);
+
+    if (width > 1) {
+        if (start_cap == LINE_CAP_ROUND) {
+            draw_ellipse_filled(surf, x1 - (width - 1) / 2,
+                                y1 - (width - 1) / 2, width, width, color,
+                                drawn_area);
+        }
+        if (end_cap == LINE_CAP_ROUND) {
+            draw_ellipse_filled(surf, x2 - (width - 1) / 2,
+                                y2 - (width - 1) / 2, width, width, color,
+                                drawn_area);
+        }
+    }
+}
+
 /* Algorithm modified from
  * https://rosettacode.org/wiki/Bitmap/Bresenham%27s_line_algorithm
  */
@@ -1618,8 +3147,8 @@ draw_arc(SDL_Surface *surf, int x, int y, int radius1, int radius2,
  * with additional line width parameter
  */
 static void
-draw_circle_bresenham(SDL_Surface *surf, int x0, int y0, int radius,
-                      int thickness, Uint32 color, int *drawn_area)
+draw_circle_bresenham_direct(SDL_Surface *surf, int x0, int y0, int radius,
+                             int thickness, Uint32 color, int *drawn_area)
 {
     int f = 1 - radius;
     int ddF_x = 0;
@@ -1682,8 +3211,8 @@ draw_circle_bresenham(SDL_Surface *surf, int x0, int y0, int radius,
 }
 
 static void
-draw_circle_bresenham_thin(SDL_Surface *surf, int x0, int y0, int radius,
-                           Uint32 color, int *drawn_area)
+draw_circle_bresenham_thin_direct(SDL_Surface *surf, int x0, int y0,
+                                  int radius, Uint32 color, int *drawn_area)
 {
     int f = 1 - radius;
     int ddF_x = 0;
@@ -1713,9 +3242,10 @@ draw_circle_bresenham_thin(SDL_Surface *surf, int x0, int y0, int radius,
 }
 
 static void
-draw_circle_quadrant(SDL_Surface *surf, int x0, int y0, int radius,
-                     int thickness, Uint32 color, int top_right, int top_left,
-                     int bottom_left, int bottom_right, int *drawn_area)
+draw_circle_quadrant_direct(SDL_Surface *surf, int x0, int y0, int radius,
+                            int thickness, Uint32 color, int top_right,
+                            int top_left, int bottom_left, int bottom_right,
+                            int *drawn_area)
 {
     int f = 1 - radius;
     int ddF_x = 0;
@@ -1857,8 +3387,8 @@ draw_circle_quadrant(SDL_Surface *surf, int x0, int y0, int radius,
 }
 
 static void
-draw_circle_filled(SDL_Surface *surf, int x0, int y0, int radius, Uint32 color,
-                   int *drawn_area)
+draw_circle_filled_direct(SDL_Surface *surf, int x0, int y0, int radius,
+                          Uint32 color, int *drawn_area)
 {
     int f = 1 - radius;
     int ddF_x = 0;
@@ -1876,14 +3406,305 @@ draw_circle_filled(SDL_Surface *surf, int x0, int y0, int radius, Uint32 color,
         ddF_x += 2;
         f += ddF_x + 1;
 
-        /* optimisation to avoid overdrawing and repeated return rect checks:
-           only draw a line if y-step is about to be decreased. */
-        if (f >= 0) {
-            drawhorzlineclip(surf, color, x0 - x, y0 + y - 1, x0 + x -1, drawn_area);
-            drawhorzlineclip(surf, color, x0 - x, y0 - y, x0 + x -1, drawn_area);
+        /* optimisation to avoid overdrawing and repeated return rect checks:
+           only draw a line if y-step is about to be decreased. */
+        if (f >= 0) {
+            drawhorzlineclip(surf, color, x0 - x, y0 + y - 1, x0 + x -1, drawn_area);
+            drawhorzlineclip(surf, color, x0 - x, y0 - y, x0 + x -1, drawn_area);
+        }
+        drawhorzlineclip(surf, color, x0 - y, y0 + x - 1, x0 + y -1, drawn_area);
+        drawhorzlineclip(surf, color, x0 - y, y0 - x, x0 + y -1, drawn_area);
+    }
+}
+
+/* Span tables of recently drawn circles, least recently used first out.
+ * Shapes are drawn without the GIL, so the cache has its own lock. */
+static span_table *span_cache[SPAN_CACHE_SIZE];
+static unsigned int span_cache_clock = 0;
+static SDL_SpinLock span_cache_lock = 0;
+
+/* Draws a shape with the direct algorithm into an 8 bit canvas and reads
+ * back its runs of pixels.
+ *
+ * Returns a new table to free with free(), or NULL if out of memory.
+ */
+static span_table *
+_span_table_build(int shape, int radius, int thickness)
+{
+    /* The shapes stay within radius of their center, which is put at
+     * (center, center). */
+    int center = radius + 1, size = 2 * radius + 2;
+    int drawn_area[4] = {INT_MAX, INT_MAX, INT_MIN, INT_MIN};
+    int x, y, top = size, bottom = -1, num_runs = 0, row, run;
+    SDL_PixelFormat format;
+    SDL_Surface canvas;
+    span_table *table;
+    Uint8 *pixels, *line;
+
+    pixels = (Uint8 *)calloc((size_t)size * size, 1);
+    if (pixels == NULL) {
+        return NULL;
+    }
+    memset(&format, 0, sizeof(format));
+    memset(&canvas, 0, sizeof(canvas));
+    format.BitsPerPixel = 8;
+    format.BytesPerPixel = 1;
+    canvas.format = &format;
+    canvas.pixels = pixels;
+    canvas.w = canvas.h = canvas.pitch = size;
+    canvas.clip_rect.w = canvas.clip_rect.h = size;
+
+    switch (shape) {
+        case SPAN_CIRCLE:
+            draw_circle_filled_direct(&canvas, center, center, radius, 1,
+                                      drawn_area);
+            break;
+        case SPAN_CIRCLE_OUTLINE:
+            draw_circle_bresenham_direct(&canvas, center, center, radius,
+                                         thickness, 1, drawn_area);
+            break;
+        case SPAN_CIRCLE_THIN:
+            draw_circle_bresenham_thin_direct(&canvas, center, center, radius,
+                                              1, drawn_area);
+            break;
+        default:
+            draw_circle_quadrant_direct(
+                &canvas, center, center, radius, thickness, 1,
+                shape == SPAN_QUADRANT, shape == SPAN_QUADRANT + 1,
+                shape == SPAN_QUADRANT + 2, shape == SPAN_QUADRANT + 3,
+                drawn_area);
+            break;
+    }
+
+    for (y = 0; y < size; y++) {
+        line = pixels + y * size;
+        for (x = 0; x < size; x++) {
+            if (line[x] && (x == 0 || !line[x - 1])) {
+                num_runs++;
+                top = MIN(top, y);
+                bottom = y;
+            }
+        }
+    }
+    if (bottom < top) {
+        top = bottom = center;
+    }
+
+    table = (span_table *)malloc(sizeof(span_table) +
+                                 sizeof(int) * (bottom - top + 2) +
+                                 sizeof(int) * 2 * num_runs);
+    if (table == NULL) {
+        free(pixels);
+        return NULL;
+    }
+    table->shape = shape;
+    table->radius = radius;
+    table->thickness = thickness;
+    table->top = top - center;
+    table->num_rows = bottom - top + 1;
+    table->row_runs = (int *)(table + 1);
+    table->runs = table->row_runs + table->num_rows + 1;
+    table->last_used = 0;
+    table->users = 0;
+    table->cached = 0;
+
+    run = 0;
+    for (row = 0; row < table->num_rows; row++) {
+        line = pixels + (top + row) * size;
+        table->row_runs[row] = run;
+        for (x = 0; x < size; x++) {
+            if (line[x] && (x == 0 || !line[x - 1])) {
+                table->runs[run * 2] = x - center;
+            }
+            if (line[x] && (x == size - 1 || !line[x + 1])) {
+                table->runs[run * 2 + 1] = x - center;
+                run++;
+            }
+        }
+    }
+    table->row_runs[table->num_rows] = run;
+    free(pixels);
+    return table;
+}
+
+/* Returns the span table of a shape, built if it is not in the cache, to
+ * give back with span_table_release. Returns NULL if the shape is not
+ * cached or out of memory, to draw it directly instead.
+ */
+static span_table *
+span_table_get(int shape, int radius, int thickness)
+{
+    span_table *table = NULL, *built;
+    int i, slot = 0;
+
+    if (radius < 1 || radius > SPAN_CACHE_MAX_RADIUS || thickness < 0 ||
+        thickness > radius) {
+        return NULL;
+    }
+
+    SDL_AtomicLock(&span_cache_lock);
+    for (i = 0; i < SPAN_CACHE_SIZE; i++) {
+        table = span_cache[i];
+        if (table && table->shape == shape && table->radius == radius &&
+            table->thickness == thickness) {
+            table->last_used = ++span_cache_clock;
+            table->users++;
+            SDL_AtomicUnlock(&span_cache_lock);
+            return table;
+        }
+    }
+    SDL_AtomicUnlock(&span_cache_lock);
+
+    /* Built outside the lock, another thread may add the same table
+     * meanwhile, then both are used and only one cached. */
+    built = _span_table_build(shape, radius, thickness);
+    if (built == NULL) {
+        return NULL;
+    }
+    built->users = 1;
+
+    SDL_AtomicLock(&span_cache_lock);
+    for (i = 0; i < SPAN_CACHE_SIZE; i++) {
+        if (span_cache[i] == NULL) {
+            slot = i;
+            break;
+        }
+        if (span_cache[i]->last_used < span_cache[slot]->last_used) {
+            slot = i;
+        }
+    }
+    table = span_cache[slot];
+    if (table != NULL) {
+        /* The last user frees a table dropped while in use. */
+        table->cached = 0;
+        if (table->users == 0) {
+            free(table);
+        }
+    }
+    built->cached = 1;
+    built->last_used = ++span_cache_clock;
+    span_cache[slot] = built;
+    SDL_AtomicUnlock(&span_cache_lock);
+    return built;
+}
+
+static void
+span_table_release(span_table *table)
+{
+    int drop;
+
+    SDL_AtomicLock(&span_cache_lock);
+    drop = --table->users == 0 && !table->cached;
+    SDL_AtomicUnlock(&span_cache_lock);
+    if (drop) {
+        free(table);
+    }
+}
+
+/* Empties the span cache. A table still in use is freed by its last user
+ * in span_table_release. */
+static void
+span_cache_clear(void)
+{
+    span_table *table;
+    int i;
+
+    SDL_AtomicLock(&span_cache_lock);
+    for (i = 0; i < SPAN_CACHE_SIZE; i++) {
+        table = span_cache[i];
+        span_cache[i] = NULL;
+        if (table != NULL) {
+            table->cached = 0;
+            if (table->users == 0) {
+                free(table);
+            }
+        }
+    }
+    SDL_AtomicUnlock(&span_cache_lock);
+}
+
+/* Draws the runs of a span table around (x0, y0). */
+static void
+draw_span_table(SDL_Surface *surf, span_table *table, int x0, int y0,
+                Uint32 color, int *drawn_area)
+{
+    int row, run, y;
+    int clip_top = surf->clip_rect.y;
+    int clip_bottom = surf->clip_rect.y + surf->clip_rect.h;
+
+    for (row = 0; row < table->num_rows; row++) {
+        y = y0 + table->top + row;
+        if (y < clip_top || y >= clip_bottom) {
+            continue;
+        }
+        for (run = table->row_runs[row]; run < table->row_runs[row + 1];
+             run++) {
+            drawhorzlineclip(surf, color, x0 + table->runs[run * 2], y,
+                             x0 + table->runs[run * 2 + 1], drawn_area);
+        }
+    }
+}
+
+/* Draws a shape from its span table if it can, else directly. */
+#define DRAW_FROM_SPAN_TABLE(shape, radius, thickness, direct_call)      \
+    {                                                                   \
+        span_table *table = span_table_get(shape, radius, thickness);   \
+        if (table != NULL) {                                            \
+            draw_span_table(surf, table, x0, y0, color, drawn_area);    \
+            span_table_release(table);                                  \
+        }                                                               \
+        else {                                                          \
+            direct_call;                                                \
+        }                                                               \
+    }
+
+static void
+draw_circle_bresenham(SDL_Surface *surf, int x0, int y0, int radius,
+                      int thickness, Uint32 color, int *drawn_area)
+{
+    DRAW_FROM_SPAN_TABLE(SPAN_CIRCLE_OUTLINE, radius, thickness,
+                         draw_circle_bresenham_direct(surf, x0, y0, radius,
+                                                      thickness, color,
+                                                      drawn_area))
+}
+
+static void
+draw_circle_bresenham_thin(SDL_Surface *surf, int x0, int y0, int radius,
+                           Uint32 color, int *drawn_area)
+{
+    DRAW_FROM_SPAN_TABLE(SPAN_CIRCLE_THIN, radius, 0,
+                         draw_circle_bresenham_thin_direct(
+                             surf, x0, y0, radius, color, drawn_area))
+}
+
+static void
+draw_circle_filled(SDL_Surface *surf, int x0, int y0, int radius, Uint32 color,
+                   int *drawn_area)
+{
+    DRAW_FROM_SPAN_TABLE(SPAN_CIRCLE, radius, 0,
+                         draw_circle_filled_direct(surf, x0, y0, radius, color,
+                                                   drawn_area))
+}
+
+static void
+draw_circle_quadrant(SDL_Surface *surf, int x0, int y0, int radius,
+                     int thickness, Uint32 color, int top_right, int top_left,
+                     int bottom_left, int bottom_right, int *drawn_area)
+{
+    int flags[4], i;
+
+    flags[0] = top_right > 0;
+    flags[1] = top_left > 0;
+    flags[2] = bottom_left > 0;
+    flags[3] = bottom_right > 0;
+    for (i = 0; i < 4; i++) {
+        if (flags[i]) {
+            DRAW_FROM_SPAN_TABLE(
+                SPAN_QUADRANT + i, radius, thickness,
+                draw_circle_quadrant_direct(surf, x0, y0, radius, thickness,
+                                            color, i == 0, i == 1, i == 2,
+                                            i == 3, drawn_area))
         }
-        drawhorzlineclip(surf, color, x0 - y, y0 + x - 1, x0 + y -1, drawn_area);
-        drawhorzlineclip(surf, color, x0 - y, y0 - x, x0 + y -1, drawn_area);
     }
 }
 
@@ -2080,25 +3901,29 @@ draw_ellipse_thickness(SDL_Surface *surf, int x0, int y0, int width, int height,
     }
 }
 
-static void
+/* Fills a polygon. It does not use the Python API so it can run without
+ * the GIL.
+ *
+ * Returns 0, or -1 if it ran out of memory.
+ */
+static int
 draw_fillpoly(SDL_Surface *surf, int *point_x, int *point_y,
-              Py_ssize_t num_points, Uint32 color, int *drawn_area)
+              Py_ssize_t num_points, Uint32 color, int fill_rule,
+              int *drawn_area)
 {
     /* point_x : x coordinates of the points
      * point-y : the y coordinates of the points
      * num_points : the number of points
+     * fill_rule : FILL_RULE_EVENODD or FILL_RULE_NONZERO
      */
     Py_ssize_t i, i_previous;  // i_previous is the index of the point before i
-    int y, miny, maxy;
+    Py_ssize_t num_edges = 0, num_active = 0, next_edge = 0, j;
+    int y, miny, maxy, y_start, y_end, winding, span_x;
     int x1, y1;
     int x2, y2;
-    /* x_intersect are the x-coordinates of intersections of the polygon
-     * with some horizontal line */
-    int *x_intersect = PyMem_New(int, num_points);
-    if (x_intersect == NULL) {
-        PyErr_NoMemory();
-        return;
-    }
+    poly_edge *edges, *edge;
+    /* active are the edges crossing the current scanline, sorted by x */
+    poly_edge **active;
 
     /* Determine Y maxima */
     miny = point_y[0];
@@ -2119,54 +3944,135 @@ draw_fillpoly(SDL_Surface *surf, int *point_x, int *point_y,
             maxx = MAX(maxx, point_x[i]);
         }
         draw_line(surf, minx, miny, maxx, miny, color, drawn_area);
-        PyMem_Free(x_intersect);
-        return;
+        return 0;
+    }
+
+    edges = (poly_edge *)malloc(sizeof(poly_edge) * num_points);
+    active = (poly_edge **)malloc(sizeof(poly_edge *) * num_points);
+    if (edges == NULL || active == NULL) {
+        free(edges);
+        free(active);
+        return -1;
+    }
+
+    /* Build the edge table
+     * --------------------
+     * Every edge that is not horizontal crosses the scanlines from its
+     * upper end y1 down to the one before its lower end y2 (the lower end
+     * is excluded so that a vertex shared by two edges is only counted
+     * once), edges ending on the lowest line maxy include it. The table
+     * is sorted by y1 so edges can be activated as the scan reaches them.
+     */
+    for (i = 0; (i < num_points); i++) {
+        i_previous = ((i) ? (i - 1) : (num_points - 1));
+
+        y1 = point_y[i_previous];
+        y2 = point_y[i];
+        if (y1 == y2) {  // horizontal edges are handled below
+            continue;
+        }
+        edge = &edges[num_edges++];
+        if (y1 < y2) {
+            x1 = point_x[i_previous];
+            x2 = point_x[i];
+            edge->winding = 1;
+        }
+        else {
+            y2 = point_y[i_previous];
+            y1 = point_y[i];
+            x2 = point_x[i_previous];
+            x1 = point_x[i];
+            edge->winding = -1;
+        }
+        edge->y1 = y1;
+        edge->y_last = (y2 == maxy) ? y2 : y2 - 1;
+        edge->x1 = x1;
+        edge->x_sign = (x2 < x1) ? -1 : 1;
+        edge->dx = abs(x2 - x1);
+        edge->dy = y2 - y1;
+        edge->step_quot = edge->dx / edge->dy;
+        edge->step_rem = edge->dx % edge->dy;
     }
+    qsort(edges, num_edges, sizeof(poly_edge), compare_poly_edge);
 
     /* Draw, scanning y
      * ----------------
-     * The algorithm uses a horizontal line (y) that moves from top to the
-     * bottom of the polygon:
+     * The algorithm moves a horizontal line (y) from the top to the bottom
+     * of the polygon, only the part inside the clip area is scanned:
      *
-     * 1. search intersections with the border lines
-     * 2. sort intersections (x_intersect)
-     * 3. each two x-coordinates in x_intersect are then inside the polygon
-     *    (draw line for a pair of two such points)
+     * 1. add the edges starting on this line to the active edges, and
+     *    drop the ones that ended on the line before
+     * 2. keep the active edges sorted by x, their order barely changes from
+     *    one line to the next so an insertion sort is nearly linear
+     * 3. draw the spans between the edges that are inside the polygon,
+     *    by the even-odd or the nonzero winding rule
+     * 4. step the x of every active edge to the next line, the quotient
+     *    and remainder of (y - y1) * dx / dy are stepped with integers
+     *    only, giving the same x as dividing on every line
      */
-    for (y = miny; (y <= maxy); y++) {
-        // n_intersections is the number of intersections with the polygon
-        int n_intersections = 0;
-        for (i = 0; (i < num_points); i++) {
-            i_previous = ((i) ? (i - 1) : (num_points - 1));
-
-            y1 = point_y[i_previous];
-            y2 = point_y[i];
-            if (y1 < y2) {
-                x1 = point_x[i_previous];
-                x2 = point_x[i];
+    y_start = MAX(miny, surf->clip_rect.y);
+    y_end = MIN(maxy, surf->clip_rect.y + surf->clip_rect.h - 1);
+
+    for (y = y_start; (y <= y_end); y++) {
+        for (; next_edge < num_edges && edges[next_edge].y1 <= y;
+             next_edge++) {
+            Sint64 offset;
+
+            edge = &edges[next_edge];
+            if (edge->y_last < y) {
+                continue;  // above the clip area
             }
-            else if (y1 > y2) {
-                y2 = point_y[i_previous];
-                y1 = point_y[i];
-                x2 = point_x[i_previous];
-                x1 = point_x[i];
+            offset = (Sint64)(y - edge->y1) * edge->dx;
+            edge->quot = (int)(offset / edge->dy);
+            edge->rem = (int)(offset % edge->dy);
+            edge->x = edge->x1 + edge->x_sign * edge->quot;
+            active[num_active++] = edge;
+        }
+
+        for (i = 1; (i < num_active); i++) {
+            edge = active[i];
+            for (j = i; j > 0 && active[j - 1]->x > edge->x; j--) {
+                active[j] = active[j - 1];
             }
-            else {  // y1 == y2 : has to be handled as special case (below)
-                continue;
+            active[j] = edge;
+        }
+
+        if (fill_rule == FILL_RULE_NONZERO) {
+            winding = 0;
+            span_x = 0;
+            for (i = 0; (i < num_active); i++) {
+                if (!winding) {
+                    span_x = active[i]->x;
+                }
+                winding += active[i]->winding;
+                if (!winding) {
+                    drawhorzlineclip(surf, color, span_x, y, active[i]->x,
+                                     drawn_area);
+                }
             }
-            if (((y >= y1) && (y < y2)) || ((y == maxy) && (y2 == maxy))) {
-                // add intersection if y crosses the edge (excluding the lower
-                // end), or when we are on the lowest line (maxy)
-                x_intersect[n_intersections++] =
-                    (y - y1) * (x2 - x1) / (y2 - y1) + x1;
+        }
+        else {
+            for (i = 0; (i + 1 < num_active); i += 2) {
+                drawhorzlineclip(surf, color, active[i]->x, y,
+                                 active[i + 1]->x, drawn_area);
             }
         }
-        qsort(x_intersect, n_intersections, sizeof(int), compare_int);
 
-        for (i = 0; (i < n_intersections); i += 2) {
-            draw_line(surf, x_intersect[i], y, x_intersect[i + 1], y, color,
-                     drawn_area);
+        for (i = 0, j = 0; (i < num_active); i++) {
+            edge = active[i];
+            if (edge->y_last <= y) {
+                continue;
+            }
+            edge->quot += edge->step_quot;
+            edge->rem += edge->step_rem;
+            if (edge->rem >= edge->dy) {
+                edge->rem -= edge->dy;
+                edge->quot++;
+            }
+            edge->x = edge->x1 + edge->x_sign * edge->quot;
+            active[j++] = edge;
         }
+        num_active = j;
     }
 
     /* Finally, a special case is not handled by above algorithm:
@@ -2183,14 +4089,472 @@ draw_fillpoly(SDL_Surface *surf, int *point_x, int *point_y,
         y = point_y[i];
 
         if ((miny < y) && (point_y[i_previous] == y) && (y < maxy)) {
-            draw_line(surf, point_x[i], y, point_x[i_previous], y, color,
-                     drawn_area);
+            drawhorzlineclip(surf, color, point_x[i], y, point_x[i_previous],
+                             drawn_area);
+        }
+    }
+    free(edges);
+    free(active);
+    return 0;
+}
+
+/* Blends color into the pixel at (x, y), weighted by coverage (0 to 1).
+ *
+ * Like get_antialiased_color, every channel (alpha included) is mixed with
+ * the background, or only scaled by coverage if blend is 0. 32 bit pixels
+ * are mixed two channels at a time.
+ */
+static void
+aa_blend_pixel(SDL_Surface *surf, int x, int y, Uint32 color, float coverage,
+               int blend, int *drawn_area)
+{
+    SDL_PixelFormat *format = surf->format;
+    Uint8 *row = (Uint8 *)surf->pixels + y * surf->pitch;
+    Uint8 *byte_buf;
+    Uint8 fg[4], bg[4];
+    Uint32 pixel, weight, inverse, rb, ag;
+    int i;
+
+    if (x < surf->clip_rect.x || x >= surf->clip_rect.x + surf->clip_rect.w ||
+        y < surf->clip_rect.y || y >= surf->clip_rect.y + surf->clip_rect.h)
+        return;
+
+    weight = (Uint32)(coverage * 256.0f + 0.5f);
+    inverse = blend ? 256 - weight : 0;
+
+    switch (format->BytesPerPixel) {
+        case 4:
+            pixel = *((Uint32 *)row + x);
+            rb = ((color & 0xff00ff) * weight + (pixel & 0xff00ff) * inverse +
+                  0x800080) >>
+                 8;
+            ag = ((color >> 8) & 0xff00ff) * weight +
+                 ((pixel >> 8) & 0xff00ff) * inverse + 0x800080;
+            *((Uint32 *)row + x) = (rb & 0xff00ff) | (ag & 0xff00ff00);
+            add_pixel_to_drawn_list(x, y, drawn_area);
+            return;
+        case 1:
+            pixel = *(row + x);
+            break;
+        case 2:
+            pixel = *((Uint16 *)row + x);
+            break;
+        default: /*case 3:*/
+            byte_buf = row + x * 3;
+#if (SDL_BYTEORDER == SDL_LIL_ENDIAN)
+            pixel = byte_buf[0] | (byte_buf[1] << 8) | (byte_buf[2] << 16);
+#else
+            pixel = (byte_buf[0] << 16) | (byte_buf[1] << 8) | byte_buf[2];
+#endif
+            break;
+    }
+
+    SDL_GetRGBA(color, format, &fg[0], &fg[1], &fg[2], &fg[3]);
+    SDL_GetRGBA(pixel, format, &bg[0], &bg[1], &bg[2], &bg[3]);
+    for (i = 0; i < 4; i++) {
+        fg[i] = (Uint8)((fg[i] * weight + bg[i] * inverse + 128) >> 8);
+    }
+    set_and_check_rect(surf, x, y, SDL_MapRGBA(format, fg[0], fg[1], fg[2], fg[3]),
+                       drawn_area);
+}
+
+/* Adds the signed area an edge covers on the scanlines of a band.
+ *
+ * Every cell of cover gets the change in coverage from the cell to its
+ * left, so a running sum along a row gives the coverage of each pixel.
+ * The blocks of cells changed are flagged in touched, num_blocks per row.
+ * The edge must be within 0 <= x <= width of the row.
+ */
+static void
+aa_accumulate_edge(float *cover, Uint8 *touched, int stride, int num_blocks,
+                   int band_top, int band_height, const aa_edge *edge,
+                   float width)
+{
+    float x0 = edge->x0, y0 = edge->y0, x1 = edge->x1, y1 = edge->y1;
+    float dir = 1.0f, dxdy, top, bottom, x, x_next, d, left, right;
+    float left_frac, right_frac, scale, area0, area1, area2, area_last;
+    float *row;
+    int y, y_start, y_end, left_i, right_i, i;
+
+    if (y0 == y1) {
+        return;
+    }
+    if (y0 > y1) {
+        swap(&x0, &x1);
+        swap(&y0, &y1);
+        dir = -1.0f;
+    }
+    dxdy = (x1 - x0) / (y1 - y0);
+    y_start = MAX((int)floorf(y0), band_top);
+    y_end = MIN((int)ceilf(y1), band_top + band_height);
+
+    for (y = y_start; y < y_end; y++) {
+        row = cover + (y - band_top) * stride;
+        top = MAX((float)y, y0);
+        bottom = MIN((float)(y + 1), y1);
+        x = MIN(MAX(x0 + (top - y0) * dxdy, 0.0f), width);
+        x_next = MIN(MAX(x0 + (bottom - y0) * dxdy, 0.0f), width);
+        d = (bottom - top) * dir;
+        left = MIN(x, x_next);
+        right = MAX(x, x_next);
+        left_i = (int)floorf(left);
+        right_i = (int)ceilf(right);
+        memset(touched + (y - band_top) * num_blocks + (left_i >> AA_BLOCK_SHIFT),
+               1,
+               ((right_i + 1) >> AA_BLOCK_SHIFT) - (left_i >> AA_BLOCK_SHIFT) +
+                   1);
+
+        if (right_i <= left_i + 1) {
+            /* The edge stays within one pixel on this row. */
+            area0 = 0.5f * (x + x_next) - left_i;
+            row[left_i] += d - d * area0;
+            row[left_i + 1] += d * area0;
+            continue;
+        }
+
+        /* The edge crosses several pixels, the first and last get the
+         * triangles it cuts off and the ones in between a trapezoid each.
+         */
+        scale = 1.0f / (right - left);
+        left_frac = left - left_i;
+        area0 = 0.5f * scale * (1.0f - left_frac) * (1.0f - left_frac);
+        right_frac = right - right_i + 1.0f;
+        area_last = 0.5f * scale * right_frac * right_frac;
+        row[left_i] += d * area0;
+        if (right_i == left_i + 2) {
+            row[left_i + 1] += d * (1.0f - area0 - area_last);
+        }
+        else {
+            area1 = scale * (1.5f - left_frac);
+            row[left_i + 1] += d * (area1 - area0);
+            for (i = left_i + 2; i < right_i - 1; i++) {
+                row[i] += d * scale;
+            }
+            area2 = area1 + (right_i - left_i - 3) * scale;
+            row[right_i - 1] += d * (1.0f - area2 - area_last);
+        }
+        row[right_i] += d * area_last;
+    }
+}
+
+/* Returns the cell before the next one after x that an edge changed, or
+ * the last cell of the row.
+ */
+static int
+aa_skip_empty(const float *row, const Uint8 *touched, int x, int width)
+{
+    while (x + 1 < width) {
+        if (!touched[(x + 1) >> AA_BLOCK_SHIFT]) {
+            x = MIN((x + 1) | ((1 << AA_BLOCK_SHIFT) - 1), width - 1);
+        }
+        else if (row[x + 1] == 0.0f) {
+            x++;
+        }
+        else {
+            break;
+        }
+    }
+    return x;
+}
+
+/* Adds the edge from (x0, y0) to (x1, y1) to edges, split where it leaves
+ * the 0 <= x <= width strip and with the parts outside moved onto its
+ * borders. Whatever is left of the strip only matters by the coverage it
+ * gives to everything right of it, which the moved parts keep the same.
+ */
+static void
+aa_add_edge(aa_edge *edges, Py_ssize_t *num_edges, float x0, float y0,
+            float x1, float y1, float width)
+{
+    float t[4], xa, ya, xb, yb;
+    int num_t = 0, i, j;
+
+    if (y0 == y1) {
+        return;
+    }
+    t[num_t++] = 0.0f;
+    if (x0 != x1) {
+        float t_left = (0.0f - x0) / (x1 - x0);
+        float t_right = (width - x0) / (x1 - x0);
+        if (t_left > 0.0f && t_left < 1.0f) {
+            t[num_t++] = t_left;
+        }
+        if (t_right > 0.0f && t_right < 1.0f) {
+            t[num_t++] = t_right;
+        }
+        if (num_t == 3 && t[2] < t[1]) {
+            swap(&t[1], &t[2]);
+        }
+    }
+    t[num_t] = 1.0f;
+
+    for (i = 0; i < num_t; i++) {
+        j = i + 1;
+        xa = (i == 0) ? x0 : x0 + t[i] * (x1 - x0);
+        ya = (i == 0) ? y0 : y0 + t[i] * (y1 - y0);
+        xb = (j == num_t) ? x1 : x0 + t[j] * (x1 - x0);
+        yb = (j == num_t) ? y1 : y0 + t[j] * (y1 - y0);
+        edges[*num_edges].x0 = MIN(MAX(xa, 0.0f), width);
+        edges[*num_edges].y0 = ya;
+        edges[*num_edges].x1 = MIN(MAX(xb, 0.0f), width);
+        edges[*num_edges].y1 = yb;
+        (*num_edges)++;
+    }
+}
+
+/* Fills an antialiased polygon, using the exact area of every pixel
+ * covered by it (nonzero fill rule).
+ *
+ * Pixel centers are on integer coordinates, like draw_aaline. The polygon
+ * is rasterized AA_BAND_HEIGHT rows at a time into a coverage buffer;
+ * fully covered runs are filled as spans and only the pixels along the
+ * edges are blended (see aa_blend_pixel for blend).
+ */
+static void
+draw_aa_fillpoly(SDL_Surface *surf, float *point_x, float *point_y,
+                 Py_ssize_t num_points, Uint32 color, int blend,
+                 int *drawn_area)
+{
+    Py_ssize_t i, i_previous, num_edges = 0;
+    float minx, maxx, miny, maxy, acc, coverage;
+    int left, right, top, bottom, width, height, stride;
+    int band_top, band_height, row_i, x, y, run_start, num_blocks;
+    aa_edge *edges;
+    float *cover, *row;
+    Uint8 *touched, *touched_row;
+
+    minx = maxx = point_x[0];
+    miny = maxy = point_y[0];
+    for (i = 1; i < num_points; i++) {
+        minx = MIN(minx, point_x[i]);
+        maxx = MAX(maxx, point_x[i]);
+        miny = MIN(miny, point_y[i]);
+        maxy = MAX(maxy, point_y[i]);
+    }
+
+    /* Pixels touched by the polygon, within the clip area. */
+    left = MAX((int)floorf(minx + 0.5f), surf->clip_rect.x);
+    right = MIN((int)ceilf(maxx + 0.5f) - 1,
+                surf->clip_rect.x + surf->clip_rect.w - 1);
+    top = MAX((int)floorf(miny + 0.5f), surf->clip_rect.y);
+    bottom = MIN((int)ceilf(maxy + 0.5f) - 1,
+                 surf->clip_rect.y + surf->clip_rect.h - 1);
+    if (left > right || top > bottom) {
+        return;
+    }
+    width = right - left + 1;
+    height = bottom - top + 1;
+    stride = width + 2;
+    band_height = MIN(height, AA_BAND_HEIGHT);
+    num_blocks = (stride >> AA_BLOCK_SHIFT) + 1;
+
+    edges = PyMem_New(aa_edge, 3 * num_points);
+    cover = PyMem_New(float, stride * band_height);
+    touched = PyMem_New(Uint8, num_blocks * band_height);
+    if (edges == NULL || cover == NULL || touched == NULL) {
+        PyMem_Free(edges);
+        PyMem_Free(cover);
+        PyMem_Free(touched);
+        PyErr_NoMemory();
+        return;
+    }
+    memset(cover, 0, sizeof(float) * stride * band_height);
+    memset(touched, 0, num_blocks * band_height);
+
+    /* Edges in the coordinates of the cover buffer, where pixel (left, top)
+     * covers the square from (0, 0) to (1, 1). */
+    for (i = 0; i < num_points; i++) {
+        i_previous = ((i) ? (i - 1) : (num_points - 1));
+        aa_add_edge(edges, &num_edges, point_x[i_previous] + 0.5f - left,
+                    point_y[i_previous] + 0.5f - top,
+                    point_x[i] + 0.5f - left, point_y[i] + 0.5f - top,
+                    (float)width);
+    }
+
+    for (band_top = 0; band_top < height; band_top += band_height) {
+        band_height = MIN(band_height, height - band_top);
+        for (i = 0; i < num_edges; i++) {
+            if (MAX(edges[i].y0, edges[i].y1) <= band_top ||
+                MIN(edges[i].y0, edges[i].y1) >= band_top + band_height) {
+                continue;
+            }
+            aa_accumulate_edge(cover, touched, stride, num_blocks, band_top,
+                               band_height, &edges[i], (float)width);
+        }
+
+        for (row_i = 0; row_i < band_height; row_i++) {
+            row = cover + row_i * stride;
+            touched_row = touched + row_i * num_blocks;
+            y = top + band_top + row_i;
+            acc = 0.0f;
+            coverage = 0.0f;
+            run_start = -1;
+            for (x = 0; x < width; x++) {
+                if (row[x] != 0.0f) {
+                    acc += row[x];
+                    row[x] = 0.0f;
+                    coverage = MIN(fabsf(acc), 1.0f);
+                }
+                if (coverage >= AA_OPAQUE) {
+                    if (run_start < 0) {
+                        run_start = x;
+                    }
+                    /* Nothing changes until the next edge. */
+                    x = aa_skip_empty(row, touched_row, x, width);
+                    continue;
+                }
+                if (run_start >= 0) {
+                    drawhorzlineclip(surf, color, left + run_start, y,
+                                     left + x - 1, drawn_area);
+                    run_start = -1;
+                }
+                if (coverage > AA_TRANSPARENT) {
+                    aa_blend_pixel(surf, left + x, y, color, coverage, blend,
+                                   drawn_area);
+                }
+                else {
+                    x = aa_skip_empty(row, touched_row, x, width);
+                }
+            }
+            if (run_start >= 0) {
+                drawhorzlineclip(surf, color, left + run_start, y, right,
+                                 drawn_area);
+            }
+            row[width] = 0.0f;
+            row[width + 1] = 0.0f;
+            memset(touched_row, 0, num_blocks);
         }
     }
-    PyMem_Free(x_intersect);
+
+    PyMem_Free(edges);
+    PyMem_Free(cover);
+    PyMem_Free(touched);
+}
+
+/* Returns the number of sides of a polygon inscribed in an ellipse that
+ * stays within a tenth of a pixel of the curve.
+ */
+static Py_ssize_t
+aa_ellipse_num_points(float radius_x, float radius_y)
+{
+    double radius = MAX(radius_x, radius_y);
+    Py_ssize_t num_points;
+
+    if (radius <= 0.1) {
+        return 8;
+    }
+    num_points = (Py_ssize_t)ceil(M_PI / acos(1.0 - 0.1 / radius));
+    /* A multiple of 4 keeps the polygon symmetric on both axes. */
+    return MAX((num_points + 3) & ~3, 8);
+}
+
+/* Sets the num_points corners of a polygon inscribed in an ellipse
+ * centered on (x0, y0), from angle 0 and in the direction of step (1 or
+ * -1).
+ */
+static void
+aa_ellipse_points(float *point_x, float *point_y, Py_ssize_t num_points,
+                  float x0, float y0, float radius_x, float radius_y,
+                  int step)
+{
+    double angle = step * 2.0 * M_PI / num_points;
+    Py_ssize_t i;
+
+    for (i = 0; i < num_points; i++) {
+        point_x[i] = (float)(x0 + radius_x * cos(i * angle));
+        point_y[i] = (float)(y0 + radius_y * sin(i * angle));
+    }
+}
+
+/* Draws an antialiased ellipse centered on (x0, y0), as an inscribed
+ * polygon with enough sides to stay within a tenth of a pixel of the curve.
+ * The ellipse is filled if inner_x or inner_y is not greater than 0, else
+ * the ellipse of those radii is left out.
+ *
+ * A ring is one polygon: the outer ellipse, then the inner one backwards,
+ * joined by two horizontal edges at angle 0 that add no coverage. The
+ * backwards inner ellipse takes its area back out, by the nonzero rule.
+ */
+static void
+draw_aa_ellipse(SDL_Surface *surf, float x0, float y0, float radius_x,
+                float radius_y, float inner_x, float inner_y, Uint32 color,
+                int *drawn_area)
+{
+    Py_ssize_t num_points, num_inner = 0, total;
+    float *point_x, *point_y;
+
+    if (radius_x <= 0.0f || radius_y <= 0.0f) {
+        return;
+    }
+
+    num_points = aa_ellipse_num_points(radius_x, radius_y);
+    total = num_points;
+    if (inner_x > 0.0f && inner_y > 0.0f) {
+        num_inner = aa_ellipse_num_points(inner_x, inner_y);
+        total += num_inner + 2;
+    }
+
+    point_x = PyMem_New(float, total);
+    point_y = PyMem_New(float, total);
+    if (point_x == NULL || point_y == NULL) {
+        PyMem_Free(point_x);
+        PyMem_Free(point_y);
+        PyErr_NoMemory();
+        return;
+    }
+    aa_ellipse_points(point_x, point_y, num_points, x0, y0, radius_x,
+                      radius_y, 1);
+    if (num_inner) {
+        /* Back to angle 0, then the inner ellipse around to angle 0. */
+        point_x[num_points] = point_x[0];
+        point_y[num_points] = point_y[0];
+        aa_ellipse_points(point_x + num_points + 1, point_y + num_points + 1,
+                          num_inner, x0, y0, inner_x, inner_y, -1);
+        point_x[total - 1] = point_x[num_points + 1];
+        point_y[total - 1] = point_y[num_points + 1];
+    }
+    draw_aa_fillpoly(surf, point_x, point_y, total, color, 1, drawn_area);
+    PyMem_Free(point_x);
+    PyMem_Free(point_y);
 }
 
+/* Draws an antialiased line of the given width as a filled rectangle. */
 static void
+draw_aaline_width(SDL_Surface *surf, Uint32 color, float from_x,
+                  float from_y, float to_x, float to_y, float width,
+                  int blend, int *drawn_area)
+{
+    float dx = to_x - from_x, dy = to_y - from_y;
+    float length = sqrtf(dx * dx + dy * dy);
+    float normal_x, normal_y, point_x[4], point_y[4];
+
+    if (length < 0.0001f) {
+        /* A line with length 0 is a square of the line's width. */
+        dx = 1.0f;
+        dy = 0.0f;
+        from_x -= width / 2.0f;
+        to_x += width / 2.0f;
+    }
+    else {
+        dx /= length;
+        dy /= length;
+    }
+    normal_x = -dy * width / 2.0f;
+    normal_y = dx * width / 2.0f;
+
+    point_x[0] = from_x + normal_x;
+    point_y[0] = from_y + normal_y;
+    point_x[1] = to_x + normal_x;
+    point_y[1] = to_y + normal_y;
+    point_x[2] = to_x - normal_x;
+    point_y[2] = to_y - normal_y;
+    point_x[3] = from_x - normal_x;
+    point_y[3] = from_y - normal_y;
+    draw_aa_fillpoly(surf, point_x, point_y, 4, color, blend, drawn_area);
+}
+
+/* Returns 0, or -1 if it ran out of memory. */
+static int
 draw_round_rect(SDL_Surface *surf, int x1, int y1, int x2, int y2, int radius,
                 int width, Uint32 color, int top_left, int top_right,
                 int bottom_left, int bottom_right, int *drawn_area)
@@ -2236,7 +4600,10 @@ draw_round_rect(SDL_Surface *surf, int x1, int y1, int x2, int y2, int radius,
         pts[13] = y2;
         pts[14] = y2;
         pts[15] = y2 - bottom_left;
-        draw_fillpoly(surf, pts, pts + 8, 8, color, drawn_area);
+        if (draw_fillpoly(surf, pts, pts + 8, 8, color, FILL_RULE_EVENODD,
+                          drawn_area)) {
+            return -1;
+        }
         draw_circle_quadrant(surf, x2 - top_right + 1, y1 + top_right,
                              top_right, 0, color, 1, 0, 0, 0, drawn_area);
         draw_circle_quadrant(surf, x1 + top_left, y1 + top_left, top_left, 0,
@@ -2299,6 +4666,261 @@ draw_round_rect(SDL_Surface *surf, int x1, int y1, int x2, int y2, int radius,
                              bottom_right, width, color, 0, 0, 0, 1,
                              drawn_area);
     }
+    return 0;
+}
+
+/* Returns the 8 bit value of level q of a channel with max_q levels, as
+ * SDL expands it. */
+#define GRADIENT_LEVEL(q, max_q) (((q)*255 + (max_q) / 2) / (max_q))
+
+/* Dithers the 8.8 fixed point value v of a channel losing loss bits: it
+ * is rounded up to the next level the channel can store if its fraction
+ * of the way there plus threshold (in 256ths) reaches 1.
+ *
+ * Returns the 8 bit value of that level.
+ */
+static Uint8
+_gradient_dither(int v, int loss, int threshold)
+{
+    int max_q = 255 >> loss, q = (v >> 8) >> loss, low, high;
+
+    if (v < GRADIENT_LEVEL(q, max_q) << 8) {
+        q--;
+    }
+    if (q < max_q) {
+        low = GRADIENT_LEVEL(q, max_q) << 8;
+        high = GRADIENT_LEVEL(q + 1, max_q) << 8;
+        if ((v - low) * 256 / (high - low) + threshold >= 256) {
+            q++;
+        }
+    }
+    return (Uint8)GRADIENT_LEVEL(q, max_q);
+}
+
+/* Interpolates the stops of a gradient into a table of GRADIENT_STEPS
+ * colors mapped to format, for t from 0 to 1.
+ *
+ * With dither the table holds 16 such rows, one per threshold of a 4x4
+ * ordered dithering matrix, with the colors dithered between the levels
+ * the format can store.
+ *
+ * Returns a new array freed with PyMem_Free, or NULL if out of memory.
+ */
+static Uint32 *
+draw_gradient_table(SDL_PixelFormat *format, double *positions, Uint8 *colors,
+                    Py_ssize_t num_stops, int dither)
+{
+    int levels = dither ? 16 : 1;
+    Uint32 *table = PyMem_New(Uint32, GRADIENT_STEPS * levels);
+    Uint16 *fixed = PyMem_New(Uint16, GRADIENT_STEPS * 4); /* 8.8 rgba */
+    Uint8 *from, *to, rgba[4];
+    int loss[4], i, k, c, v;
+    Py_ssize_t j = 0;
+    double t, f;
+
+    if (table == NULL || fixed == NULL) {
+        PyMem_Free(table);
+        PyMem_Free(fixed);
+        return NULL;
+    }
+
+    for (i = 0; i < GRADIENT_STEPS; i++) {
+        t = (double)i / (GRADIENT_STEPS - 1);
+        /* Find the last stop at or before t, which with stops at the
+         * same position is the one after the hard edge. */
+        while (j < num_stops - 1 && positions[j + 1] <= t) {
+            j++;
+        }
+        from = colors + j * 4;
+        to = (j < num_stops - 1) ? from + 4 : from;
+        f = (t < positions[0] || j == num_stops - 1)
+                ? 0.0
+                : (t - positions[j]) / (positions[j + 1] - positions[j]);
+        for (c = 0; c < 4; c++) {
+            fixed[i * 4 + c] =
+                (Uint16)((from[c] + (to[c] - from[c]) * f) * 256.0 + 0.5);
+        }
+    }
+
+    loss[0] = format->Rloss;
+    loss[1] = format->Gloss;
+    loss[2] = format->Bloss;
+    loss[3] = format->Aloss;
+    for (c = 0; c < 4; c++) {
+        /* Missing channels and palettes are dithered to 8 bits. */
+        if (loss[c] >= 8) {
+            loss[c] = 0;
+        }
+    }
+
+    for (k = 0; k < levels; k++) {
+        for (i = 0; i < GRADIENT_STEPS; i++) {
+            for (c = 0; c < 4; c++) {
+                v = fixed[i * 4 + c];
+                rgba[c] = dither ? _gradient_dither(v, loss[c], (2 * k + 1) * 8)
+                                 : (Uint8)MIN((v + 128) >> 8, 255);
+            }
+            table[k * GRADIENT_STEPS + i] =
+                SDL_MapRGBA(format, rgba[0], rgba[1], rgba[2], rgba[3]);
+        }
+    }
+    PyMem_Free(fixed);
+    return table;
+}
+
+/* Returns the table index of gradient parameter t, scaled by
+ * GRADIENT_STEPS - 1. */
+static PG_INLINE Uint16
+_gradient_index(double t)
+{
+    if (t <= 0.0) {
+        return 0;
+    }
+    if (t >= GRADIENT_STEPS - 1) {
+        return GRADIENT_STEPS - 1;
+    }
+    return (Uint16)(t + 0.5);
+}
+
+/* Returns the angle of (x, y) in (-pi, pi], like atan2() but about 2.5
+ * times faster, with an error below 1e-5 radians. */
+static PG_INLINE double
+_gradient_atan2(double y, double x)
+{
+    double ax = fabs(x), ay = fabs(y), z, z2, a;
+
+    if (ax == 0.0 && ay == 0.0) {
+        return 0.0;
+    }
+    /* atan(z) for |z| <= 1 */
+    z = (ax >= ay) ? ay / ax : ax / ay;
+    z2 = z * z;
+    a = z * (0.99997726 +
+             z2 * (-0.33262347 +
+                   z2 * (0.19354346 +
+                         z2 * (-0.11643287 +
+                               z2 * (0.05265332 + z2 * -0.01172120)))));
+    if (ay > ax) {
+        a = M_PI / 2 - a;
+    }
+    if (x < 0.0) {
+        a = M_PI - a;
+    }
+    return (y < 0.0) ? -a : a;
+}
+
+/* Draws rows [y0, y1) of the area of a gradient_job, GRADIENT_CHUNK pixels
+ * at a time: the table index of each pixel is worked out incrementally
+ * along the row, then the colors are looked up and stored.
+ *
+ * Does not use the Python API. Always returns 0.
+ */
+static int
+draw_gradient_rows(void *data, int y0, int y1)
+{
+    static const Uint8 bayer[4][4] = {
+        {0, 8, 2, 10}, {12, 4, 14, 6}, {3, 11, 1, 9}, {15, 7, 13, 5}};
+    const double scale = GRADIENT_STEPS - 1;
+    gradient_job *job = (gradient_job *)data;
+    SDL_Surface *surf = job->surf;
+    int x_end = job->area.x + job->area.w;
+    Uint16 index[GRADIENT_CHUNK];
+    Uint32 *tables[4], color;
+    Sint32 fixed, step;
+    int x0, y, i, k, n;
+    double px, py, d2, t;
+    Uint8 *row, *byte_buf;
+
+    for (y = job->area.y + y0; y < job->area.y + y1; y++) {
+        py = y + 0.5 - job->cy;
+        row = (Uint8 *)surf->pixels + (size_t)y * surf->pitch;
+        for (k = 0; k < 4; k++) {
+            tables[k] = job->table +
+                        (job->dither ? bayer[y & 3][k] * GRADIENT_STEPS : 0);
+        }
+
+        for (x0 = job->area.x; x0 < x_end; x0 += GRADIENT_CHUNK) {
+            n = MIN(GRADIENT_CHUNK, x_end - x0);
+            px = x0 + 0.5 - job->cx;
+
+            switch (job->kind) {
+                case GRADIENT_LINEAR:
+                    /* The index changes by a constant along a row, kept in
+                     * 16.16 fixed point. It is stepped from the left of
+                     * the rect, so the clip does not change the result. */
+                    t = (job->t0 + (job->rect_x + 0.5 - job->cx) * job->dx +
+                         py * job->dy) *
+                        scale;
+                    step = (Sint32)(job->dx * scale * 65536.0);
+                    fixed = (Sint32)((Sint64)(t * 65536.0 + 32768.0) +
+                                     (Sint64)step * (x0 - job->rect_x));
+                    for (i = 0; i < n; i++, fixed += step) {
+                        index[i] = (fixed <= 0) ? 0
+                                   : (fixed >= (GRADIENT_STEPS - 1) << 16)
+                                       ? GRADIENT_STEPS - 1
+                                       : (Uint16)(fixed >> 16);
+                    }
+                    break;
+                case GRADIENT_RADIAL:
+                    /* (px + 1)^2 = px^2 + 2 px + 1 */
+                    d2 = px * px + py * py;
+                    for (i = 0; i < n; i++, px += 1.0) {
+                        index[i] = _gradient_index(sqrt(d2) * job->dx * scale);
+                        d2 += 2.0 * px + 1.0;
+                    }
+                    break;
+                default: /* GRADIENT_CONIC */
+                    /* job->dy is in [0, 2 pi) */
+                    for (i = 0; i < n; i++, px += 1.0) {
+                        t = _gradient_atan2(-py, px) - job->dy;
+                        if (t < 0.0) {
+                            t += 2.0 * M_PI;
+                            if (t < 0.0) {
+                                t += 2.0 * M_PI;
+                            }
+                        }
+                        index[i] = _gradient_index(t * (scale / (2.0 * M_PI)));
+                    }
+                    break;
+            }
+
+            switch (surf->format->BytesPerPixel) {
+                case 1:
+                    for (i = 0; i < n; i++) {
+                        row[x0 + i] = (Uint8)tables[(x0 + i) & 3][index[i]];
+                    }
+                    break;
+                case 2:
+                    for (i = 0; i < n; i++) {
+                        ((Uint16 *)row)[x0 + i] =
+                            (Uint16)tables[(x0 + i) & 3][index[i]];
+                    }
+                    break;
+                case 4:
+                    for (i = 0; i < n; i++) {
+                        ((Uint32 *)row)[x0 + i] =
+                            tables[(x0 + i) & 3][index[i]];
+                    }
+                    break;
+                default: /*case 3:*/
+                    byte_buf = row + x0 * 3;
+                    for (i = 0; i < n; i++, byte_buf += 3) {
+                        color = tables[(x0 + i) & 3][index[i]];
+#if (SDL_BYTEORDER == SDL_LIL_ENDIAN)
+                        byte_buf[0] = (Uint8)color;
+                        byte_buf[1] = (Uint8)(color >> 8);
+                        byte_buf[2] = (Uint8)(color >> 16);
+#else
+                        byte_buf[0] = (Uint8)(color >> 16);
+                        byte_buf[1] = (Uint8)(color >> 8);
+                        byte_buf[2] = (Uint8)color;
+#endif
+                    }
+                    break;
+            }
+        }
+    }
+    return 0;
 }
 
 /* List of python functions */
@@ -2307,6 +4929,12 @@ static PyMethodDef _draw_methods[] = {
      DOC_PYGAMEDRAWAALINE},
     {"line", (PyCFunction)line, METH_VARARGS | METH_KEYWORDS,
      DOC_PYGAMEDRAWLINE},
+    {"aacircle", (PyCFunction)aacircle, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMEDRAWAACIRCLE},
+    {"aaellipse", (PyCFunction)aaellipse, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMEDRAWAAELLIPSE},
+    {"aapolygon", (PyCFunction)aapolygon, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMEDRAWAAPOLYGON},
     {"aalines", (PyCFunction)aalines, METH_VARARGS | METH_KEYWORDS,
      DOC_PYGAMEDRAWAALINES},
     {"lines", (PyCFunction)lines, METH_VARARGS | METH_KEYWORDS,
@@ -2321,9 +4949,24 @@ static PyMethodDef _draw_methods[] = {
      DOC_PYGAMEDRAWPOLYGON},
     {"rect", (PyCFunction)rect, METH_VARARGS | METH_KEYWORDS,
      DOC_PYGAMEDRAWRECT},
+    {"circles", (PyCFunction)circles, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMEDRAWCIRCLES},
+    {"rects", (PyCFunction)rects, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMEDRAWRECTS},
+    {"segments", (PyCFunction)segments, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMEDRAWSEGMENTS},
+    {"gradient_rect", (PyCFunction)gradient_rect, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMEDRAWGRADIENTRECT},
 
     {NULL, NULL, 0, NULL}};
 
+/* Frees the cached span tables when the module is torn down. */
+static void
+draw_free(void *module)
+{
+    span_cache_clear();
+}
+
 MODINIT_DEFINE(draw)
 {
     static struct PyModuleDef _module = {PyModuleDef_HEAD_INIT,
@@ -2334,7 +4977,7 @@ MODINIT_DEFINE(draw)
                                          NULL,
                                          NULL,
                                          NULL,
-                                         NULL};
+                                         draw_free};
 
     /* imported needed apis; Do this first so if there is an error
        the module is not loaded.
@@ -38,8 +38,12 @@
 
 #include "pgcompat.h"
 
+#include "pgarray.h"
+
 #include "SDL_gfx/SDL_gfxPrimitives.h"
 
+#include <math.h>
+
 static PyObject *
 _gfx_pixelcolor(PyObject *self, PyObject *args);
 static PyObject *
@@ -83,6 +87,8 @@ _gfx_filledpolygoncolor(PyObject *self, PyObject *args);
 static PyObject *
 _gfx_texturedpolygon(PyObject *self, PyObject *args);
 static PyObject *
+_gfx_texturedtriangles(PyObject *self, PyObject *args, PyObject *kwargs);
+static PyObject *
 _gfx_beziercolor(PyObject *self, PyObject *args);
 
 static PyMethodDef _gfxdraw_methods[] = {
@@ -115,6 +121,8 @@ static PyMethodDef _gfxdraw_methods[] = {
      DOC_PYGAMEGFXDRAWFILLEDPOLYGON},
     {"textured_polygon", _gfx_texturedpolygon, METH_VARARGS,
      DOC_PYGAMEGFXDRAWTEXTUREDPOLYGON},
+    {"textured_triangles", (PyCFunction)_gfx_texturedtriangles,
+     METH_VARARGS | METH_KEYWORDS, DOC_PYGAMEGFXDRAWTEXTUREDTRIANGLES},
     {"bezier", _gfx_beziercolor, METH_VARARGS, DOC_PYGAMEGFXDRAWBEZIER},
     {NULL, NULL, 0, NULL},
 };
@@ -1003,6 +1011,410 @@ _gfx_texturedpolygon(PyObject *self, PyObject *args)
     Py_RETURN_NONE;
 }
 
+/* A corner of a textured triangle, in surface pixels and texels */
+typedef struct {
+    double x, y, u, v;
+} _tt_vertex;
+
+/* The target and texture of textured_triangles */
+typedef struct {
+    SDL_Surface *surf, *texture;
+    int bilinear;
+    int blend; /* the texture has per pixel alpha */
+} _tt_target;
+
+static PG_INLINE Uint32
+_tt_get_pixel(SDL_Surface *surf, int x, int y)
+{
+    Uint8 *pixel = (Uint8 *)surf->pixels + y * surf->pitch +
+                   x * surf->format->BytesPerPixel;
+
+    switch (surf->format->BytesPerPixel) {
+        case 1:
+            return *pixel;
+        case 2:
+            return *(Uint16 *)pixel;
+        case 3:
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            return pixel[0] | (pixel[1] << 8) | (pixel[2] << 16);
+#else
+            return (pixel[0] << 16) | (pixel[1] << 8) | pixel[2];
+#endif
+        default: /* case 4: */
+            return *(Uint32 *)pixel;
+    }
+}
+
+static PG_INLINE void
+_tt_set_pixel(SDL_Surface *surf, int x, int y, Uint32 color)
+{
+    Uint8 *pixel = (Uint8 *)surf->pixels + y * surf->pitch +
+                   x * surf->format->BytesPerPixel;
+
+    switch (surf->format->BytesPerPixel) {
+        case 1:
+            *pixel = (Uint8)color;
+            break;
+        case 2:
+            *(Uint16 *)pixel = (Uint16)color;
+            break;
+        case 3:
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            pixel[0] = (Uint8)color;
+            pixel[1] = (Uint8)(color >> 8);
+            pixel[2] = (Uint8)(color >> 16);
+#else
+            pixel[0] = (Uint8)(color >> 16);
+            pixel[1] = (Uint8)(color >> 8);
+            pixel[2] = (Uint8)color;
+#endif
+            break;
+        default: /* case 4: */
+            *(Uint32 *)pixel = color;
+            break;
+    }
+}
+
+/* Gets the RGBA of a pixel, shifting out 8 bit channels without a call
+ * into SDL. */
+static PG_INLINE void
+_tt_get_rgba(SDL_PixelFormat *format, Uint32 pixel, Uint8 *rgba)
+{
+    if (format->BytesPerPixel == 4 && !format->Rloss && !format->Gloss &&
+        !format->Bloss && (!format->Amask || !format->Aloss)) {
+        rgba[0] = (Uint8)(pixel >> format->Rshift);
+        rgba[1] = (Uint8)(pixel >> format->Gshift);
+        rgba[2] = (Uint8)(pixel >> format->Bshift);
+        rgba[3] = format->Amask ? (Uint8)(pixel >> format->Ashift) : 255;
+    }
+    else {
+        SDL_GetRGBA(pixel, format, rgba, rgba + 1, rgba + 2, rgba + 3);
+    }
+}
+
+/* Maps an RGBA color, like SDL_MapRGBA */
+static PG_INLINE Uint32
+_tt_map_rgba(SDL_PixelFormat *format, Uint8 *rgba)
+{
+    if (format->BytesPerPixel == 4 && !format->Rloss && !format->Gloss &&
+        !format->Bloss && (!format->Amask || !format->Aloss)) {
+        return ((Uint32)rgba[0] << format->Rshift) |
+               ((Uint32)rgba[1] << format->Gshift) |
+               ((Uint32)rgba[2] << format->Bshift) |
+               (format->Amask ? (Uint32)rgba[3] << format->Ashift : 0);
+    }
+    return SDL_MapRGBA(format, rgba[0], rgba[1], rgba[2], rgba[3]);
+}
+
+static PG_INLINE void
+_tt_get_texel(SDL_Surface *texture, int x, int y, Uint8 *rgba)
+{
+    _tt_get_rgba(texture->format, _tt_get_pixel(texture, x, y), rgba);
+}
+
+/* Samples the texture at 16.16 fixed point texel coordinates, which are
+ * in [0, width) and [0, height). Bilinear sampling blends the four texels
+ * around, wrapping at the texture edges. */
+static PG_INLINE void
+_tt_sample(_tt_target *target, Sint64 u, Sint64 v, Uint8 *rgba)
+{
+    SDL_Surface *texture = target->texture;
+    int x0 = (int)(u >> 16), y0 = (int)(v >> 16), x1, y1, fx, fy, c;
+    Uint8 texels[4][4];
+
+    if (!target->bilinear) {
+        _tt_get_texel(texture, x0, y0, rgba);
+        return;
+    }
+
+    x1 = (x0 + 1 == texture->w) ? 0 : x0 + 1;
+    y1 = (y0 + 1 == texture->h) ? 0 : y0 + 1;
+    fx = (int)(u >> 8) & 0xff;
+    fy = (int)(v >> 8) & 0xff;
+    _tt_get_texel(texture, x0, y0, texels[0]);
+    _tt_get_texel(texture, x1, y0, texels[1]);
+    _tt_get_texel(texture, x0, y1, texels[2]);
+    _tt_get_texel(texture, x1, y1, texels[3]);
+    for (c = 0; c < 4; c++) {
+        int top = texels[0][c] * (256 - fx) + texels[1][c] * fx;
+        int bottom = texels[2][c] * (256 - fx) + texels[3][c] * fx;
+        rgba[c] = (Uint8)((top * (256 - fy) + bottom * fy + 32768) >> 16);
+    }
+}
+
+/* Draws pixels [x0, x1) of row y, stepping the texture coordinates by a
+ * constant per pixel. u and v are the texel coordinates of the first
+ * pixel center. */
+static void
+_tt_draw_span(_tt_target *target, int x0, int x1, int y, double u, double v,
+              double du, double dv)
+{
+    SDL_Surface *surf = target->surf;
+    SDL_PixelFormat *format = surf->format;
+    Sint64 width = (Sint64)target->texture->w << 16;
+    Sint64 height = (Sint64)target->texture->h << 16;
+    Sint64 fu, fv, step_u, step_v;
+    Uint8 rgba[4], dst[4];
+    int x, c, alpha;
+
+    /* Bilinear sampling is from the texel centers. */
+    if (target->bilinear) {
+        u -= 0.5;
+        v -= 0.5;
+    }
+    /* Texture coordinates repeat, so they and their steps are kept
+     * wrapped to the texture, in 16.16 fixed point. */
+    fu = (Sint64)floor(fmod(u, target->texture->w) * 65536.0) % width;
+    fv = (Sint64)floor(fmod(v, target->texture->h) * 65536.0) % height;
+    step_u = (Sint64)floor(fmod(du, target->texture->w) * 65536.0 + 0.5) %
+             width;
+    step_v = (Sint64)floor(fmod(dv, target->texture->h) * 65536.0 + 0.5) %
+             height;
+    if (fu < 0) {
+        fu += width;
+    }
+    if (fv < 0) {
+        fv += height;
+    }
+
+    for (x = x0; x < x1; x++) {
+        _tt_sample(target, fu, fv, rgba);
+
+        if (target->blend && rgba[3] != 255) {
+            alpha = rgba[3];
+            if (alpha != 0) {
+                _tt_get_rgba(format, _tt_get_pixel(surf, x, y), dst);
+                for (c = 0; c < 3; c++) {
+                    rgba[c] = (Uint8)((rgba[c] * alpha +
+                                       dst[c] * (255 - alpha) + 127) /
+                                      255);
+                }
+                rgba[3] =
+                    (Uint8)(alpha + (dst[3] * (255 - alpha) + 127) / 255);
+                _tt_set_pixel(surf, x, y, _tt_map_rgba(format, rgba));
+            }
+        }
+        else {
+            _tt_set_pixel(surf, x, y, _tt_map_rgba(format, rgba));
+        }
+
+        fu += step_u;
+        if (fu >= width) {
+            fu -= width;
+        }
+        else if (fu < 0) {
+            fu += width;
+        }
+        fv += step_v;
+        if (fv >= height) {
+            fv -= height;
+        }
+        else if (fv < 0) {
+            fv += height;
+        }
+    }
+}
+
+/* Returns the x where the edge from a down to b crosses row center py. */
+static PG_INLINE double
+_tt_edge_x(_tt_vertex *a, _tt_vertex *b, double py)
+{
+    return a->x + (py - a->y) * (b->x - a->x) / (b->y - a->y);
+}
+
+/* Draws a textured triangle, scanline by scanline. Pixels with their
+ * center inside are drawn, and on a shared edge only those left of or
+ * above it, so a mesh draws each pixel once. The texture coordinates are
+ * affine: they change by constant steps across and down the triangle.
+ */
+static void
+_tt_draw_triangle(_tt_target *target, _tt_vertex *a, _tt_vertex *b,
+                  _tt_vertex *c)
+{
+    SDL_Rect *clip = &target->surf->clip_rect;
+    _tt_vertex *top = a, *mid = b, *bottom = c, *swap;
+    double area, texels, du_dx, dv_dx, du_dy, dv_dy;
+    double py, x_long, x_short, left, right, row, row_end;
+    int y, y_end, x0, x1;
+
+    /* Skip flat triangles and corners that are not finite, for which
+     * x - x is NaN. */
+    texels = a->u + a->v + b->u + b->v + c->u + c->v;
+    area = (b->x - a->x) * (c->y - a->y) - (c->x - a->x) * (b->y - a->y);
+    if (area == 0.0 || area - area != 0.0 || texels - texels != 0.0) {
+        return;
+    }
+    du_dx = ((b->u - a->u) * (c->y - a->y) - (c->u - a->u) * (b->y - a->y)) /
+            area;
+    dv_dx = ((b->v - a->v) * (c->y - a->y) - (c->v - a->v) * (b->y - a->y)) /
+            area;
+    du_dy = ((c->u - a->u) * (b->x - a->x) - (b->u - a->u) * (c->x - a->x)) /
+            area;
+    dv_dy = ((c->v - a->v) * (b->x - a->x) - (b->v - a->v) * (c->x - a->x)) /
+            area;
+
+    if (mid->y < top->y) {
+        swap = top, top = mid, mid = swap;
+    }
+    if (bottom->y < top->y) {
+        swap = top, top = bottom, bottom = swap;
+    }
+    if (bottom->y < mid->y) {
+        swap = mid, mid = bottom, bottom = swap;
+    }
+
+    /* Rows whose center is in [top, bottom), clipped before they are
+     * made ints */
+    row = MAX(ceil(top->y - 0.5), (double)clip->y);
+    row_end = MIN(ceil(bottom->y - 0.5), (double)(clip->y + clip->h));
+    if (row >= row_end) {
+        return;
+    }
+    y_end = (int)row_end;
+    for (y = (int)row; y < y_end; y++) {
+        py = y + 0.5;
+        x_long = _tt_edge_x(top, bottom, py);
+        x_short = (py < mid->y) ? _tt_edge_x(top, mid, py)
+                                : _tt_edge_x(mid, bottom, py);
+        left = MIN(x_long, x_short);
+        right = MAX(x_long, x_short);
+
+        /* Columns whose center is in [left, right) */
+        left = MAX(ceil(left - 0.5), (double)clip->x);
+        right = MIN(ceil(right - 0.5), (double)(clip->x + clip->w));
+        if (left >= right) {
+            continue;
+        }
+        x0 = (int)left;
+        x1 = (int)right;
+        _tt_draw_span(target, x0, x1, y,
+                      a->u + (x0 + 0.5 - a->x) * du_dx + (py - a->y) * du_dy,
+                      a->v + (x0 + 0.5 - a->x) * dv_dx + (py - a->y) * dv_dy,
+                      du_dx, dv_dx);
+    }
+}
+
+static PyObject *
+_gfx_texturedtriangles(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *surface, *texture, *verticesobj, *uvsobj, *indicesobj = Py_None;
+    double *vertices = NULL, *uvs = NULL, *indices = NULL;
+    Py_ssize_t num_vertices = -1, num_indices = -1, i;
+    _tt_vertex corners[3];
+    _tt_target target;
+    int k, index, n_cols, bilinear = 0;
+    static char *keywords[] = {"surface", "texture", "vertices", "uvs",
+                               "indices", "bilinear", NULL};
+
+    ASSERT_VIDEO_INIT(NULL);
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs,
+                                     "OOOO|Op:textured_triangles", keywords,
+                                     &surface, &texture, &verticesobj, &uvsobj,
+                                     &indicesobj, &bilinear))
+        return NULL;
+
+    if (!pgSurface_Check(surface)) {
+        PyErr_SetString(PyExc_TypeError, "surface must be a Surface");
+        return NULL;
+    }
+    if (!pgSurface_Check(texture)) {
+        PyErr_SetString(PyExc_TypeError, "texture must be a Surface");
+        return NULL;
+    }
+    target.surf = pgSurface_AsSurface(surface);
+    target.texture = pgSurface_AsSurface(texture);
+    target.bilinear = bilinear;
+    target.blend = target.texture->format->Amask != 0;
+    if (!target.surf || !target.texture) {
+        return RAISE(pgExc_SDLError, "display Surface quit");
+    }
+
+    n_cols = 2;
+    vertices = pg_DoublesFromArray(verticesobj, "vertices", 0, &n_cols,
+                                   &num_vertices);
+    if (vertices == NULL) {
+        return NULL;
+    }
+    uvs = pg_DoublesFromArray(uvsobj, "uvs", 0, &n_cols, &num_vertices);
+    if (uvs == NULL) {
+        PyMem_Free(vertices);
+        return NULL;
+    }
+    if (indicesobj != Py_None) {
+        n_cols = 3;
+        indices = pg_DoublesFromArray(indicesobj, "indices", 1, &n_cols,
+                                      &num_indices);
+        if (indices == NULL) {
+            PyMem_Free(vertices);
+            PyMem_Free(uvs);
+            return NULL;
+        }
+        num_indices *= 3;
+        for (i = 0; i < num_indices; i++) {
+            if (!(indices[i] >= 0 && indices[i] < num_vertices)) {
+                PyMem_Free(vertices);
+                PyMem_Free(uvs);
+                PyMem_Free(indices);
+                return RAISE(PyExc_ValueError,
+                             "indices must be vertex numbers, from 0 to the "
+                             "number of vertices less 1");
+            }
+        }
+    }
+    else if (num_vertices % 3) {
+        PyMem_Free(vertices);
+        PyMem_Free(uvs);
+        return RAISE(PyExc_ValueError,
+                     "the number of vertices must be a multiple of 3 when "
+                     "no indices are given");
+    }
+    else {
+        num_indices = num_vertices;
+    }
+
+    if (target.texture->w <= 0 || target.texture->h <= 0) {
+        PyMem_Free(vertices);
+        PyMem_Free(uvs);
+        PyMem_Free(indices);
+        Py_RETURN_NONE;
+    }
+
+    if (!pgSurface_Lock((pgSurfaceObject *)surface)) {
+        PyMem_Free(vertices);
+        PyMem_Free(uvs);
+        PyMem_Free(indices);
+        return RAISE(PyExc_RuntimeError, "error locking surface");
+    }
+    if (!pgSurface_Lock((pgSurfaceObject *)texture)) {
+        pgSurface_Unlock((pgSurfaceObject *)surface);
+        PyMem_Free(vertices);
+        PyMem_Free(uvs);
+        PyMem_Free(indices);
+        return RAISE(PyExc_RuntimeError, "error locking surface");
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    for (i = 0; i < num_indices; i += 3) {
+        for (k = 0; k < 3; k++) {
+            index = indices ? (int)indices[i + k] : (int)(i + k);
+            corners[k].x = vertices[index * 2];
+            corners[k].y = vertices[index * 2 + 1];
+            corners[k].u = uvs[index * 2] * target.texture->w;
+            corners[k].v = uvs[index * 2 + 1] * target.texture->h;
+        }
+        _tt_draw_triangle(&target, corners, corners + 1, corners + 2);
+    }
+    Py_END_ALLOW_THREADS;
+
+    pgSurface_Unlock((pgSurfaceObject *)texture);
+    pgSurface_Unlock((pgSurfaceObject *)surface);
+    PyMem_Free(vertices);
+    PyMem_Free(uvs);
+    PyMem_Free(indices);
+    Py_RETURN_NONE;
+}
+
 static PyObject *
 _gfx_beziercolor(PyObject *self, PyObject *args)
 {
@@ -30,6 +30,8 @@
 
 #include "doc/image_doc.h"
 
+#include "pgconvert.h"
+
 #if PG_COMPILE_SSE4_2 && SDL_VERSION_ATLEAST(2, 0, 0)
 #include <emmintrin.h>
 /* SSSE 3 */
@@ -959,7 +961,7 @@ image_fromstring(PyObject *self, PyObject *arg)
     SDL_Surface *surf = NULL;
     int w, h, flipped = 0;
     Py_ssize_t len;
-    int loopw, looph;
+    int looph;
 
     if (!PyArg_ParseTuple(arg, "O!(ii)s|i", &Bytes_Type, &string, &w, &h,
                           &format, &flipped))
@@ -998,19 +1000,12 @@ image_fromstring(PyObject *self, PyObject *arg)
         for (looph = 0; looph < h; ++looph) {
             Uint8 *pix =
                 (Uint8 *)DATAROW(surf->pixels, looph, surf->pitch, h, flipped);
-            for (loopw = 0; loopw < w; ++loopw) {
 #if SDL_BYTEORDER == SDL_LIL_ENDIAN
-                pix[2] = data[0];
-                pix[1] = data[1];
-                pix[0] = data[2];
+            pg_swap_rgb24_row((Uint8 *)data, pix, w);
 #else
-                pix[0] = data[0];
-                pix[1] = data[1];
-                pix[2] = data[2];
+            memcpy(pix, data, (size_t)w * 3);
 #endif
-                pix += 3;
-                data += 3;
-            }
+            data += (size_t)w * 3;
         }
         SDL_UnlockSurface(surf);
     }
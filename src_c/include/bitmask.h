@@ -52,6 +52,12 @@ typedef struct bitmask {
     BITMASK_W bits[1];
 } bitmask_t;
 
+/* Picks the fastest overlap kernels the CPU supports. Call it once before
+   using the other functions; until then the portable ones are used.
+ */
+void
+bitmask_init(void);
+
 /* Creates a bitmask of width w and height h, where
    w and h must both be greater than or equal to 0.
    The mask is automatically cleared when created.
@@ -164,6 +170,33 @@ void
 bitmask_convolve(const bitmask_t *a, const bitmask_t *b, bitmask_t *o,
                  int xoffset, int yoffset);
 
+/* Return a new bitmask with every bit set that is within radius (in
+ * euclidean distance) of a set bit of m. The bits are spread with
+ * word-wide shifts, one row of m at a time. Returns NULL if the radius is
+ * negative or memory can not be allocated. */
+bitmask_t *
+bitmask_dilate(const bitmask_t *m, int radius);
+
+/* Return a new bitmask with every bit set that only has set bits of m
+ * within radius of it. Bits past the edges of m count as unset, so the
+ * bits closer than radius to an edge are never set. Returns NULL if the
+ * radius is negative or memory can not be allocated. */
+bitmask_t *
+bitmask_erode(const bitmask_t *m, int radius);
+
+/* The smallest scale bitmask_rotozoom takes for a non-empty result. */
+#define BITMASK_ROTOZOOM_MIN_SCALE (1.0 / (1 << 30))
+
+/* Return a new w*h bitmask holding m rotated counterclockwise by the angle
+ * with the given sine and cosine and scaled by scale, around the centers
+ * of both masks. Each bit takes the value of the bit of m its center maps
+ * back to. Returns NULL if scale is negative, if w and h are not 0 and
+ * scale is between 0 and BITMASK_ROTOZOOM_MIN_SCALE, or if memory can not
+ * be allocated. */
+bitmask_t *
+bitmask_rotozoom(const bitmask_t *m, int w, int h, double sangle,
+                 double cangle, double scale);
+
 #ifdef __cplusplus
 } /* End of extern "C" { */
 #endif
@@ -37,6 +37,10 @@
 
 #include "structmember.h"
 
+#include "simd_shared.h"
+
+#include "pgarray.h"
+
 #include <math.h>
 
 #ifndef M_PI
@@ -233,6 +237,156 @@ mask_overlap(PyObject *self, PyObject *args, PyObject *kwargs)
     }
 }
 
+/* Converts an offset value read from a buffer to an int. Offsets outside
+ * the int range can not overlap any mask, so they are clamped (NaN too). */
+static int
+_offset_from_double(double value)
+{
+    if (value >= INT_MAX) {
+        return INT_MAX;
+    }
+    if (!(value > INT_MIN)) {
+        return INT_MIN;
+    }
+    return (int)value;
+}
+
+/* Reads count offsets from an (n, 2) array of numbers or from a sequence
+ * of pairs of numbers.
+ *
+ * Returns:
+ *     a PyMem allocated array of 2 * count ints (x0, y0, x1, y1, ...),
+ *     or NULL with an exception set
+ */
+static int *
+_offsets_from_obj(PyObject *obj, Py_ssize_t count)
+{
+    PyObject *seq;
+    double *values;
+    int *offsets, n_cols = 2;
+    Py_ssize_t i;
+
+    offsets = PyMem_New(int, 2 * count + 1);
+    if (!offsets) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    if (!PyObject_CheckBuffer(obj)) {
+        seq = PySequence_Fast(obj, "offsets must be a sequence");
+        if (!seq) {
+            PyMem_Free(offsets);
+            return NULL;
+        }
+        if (PySequence_Fast_GET_SIZE(seq) != count) {
+            PyErr_Format(PyExc_ValueError,
+                         "offsets must have %zd items, not %zd", count,
+                         PySequence_Fast_GET_SIZE(seq));
+            Py_DECREF(seq);
+            PyMem_Free(offsets);
+            return NULL;
+        }
+        for (i = 0; i < count; ++i) {
+            if (!pg_TwoIntsFromObj(PySequence_Fast_GET_ITEM(seq, i),
+                                   offsets + 2 * i, offsets + 2 * i + 1)) {
+                PyErr_SetString(PyExc_TypeError,
+                                "offset must be two numbers");
+                Py_DECREF(seq);
+                PyMem_Free(offsets);
+                return NULL;
+            }
+        }
+        Py_DECREF(seq);
+        return offsets;
+    }
+
+    values = pg_DoublesFromArray(obj, "offsets", 0, &n_cols, &count);
+    if (!values) {
+        PyMem_Free(offsets);
+        return NULL;
+    }
+    for (i = 0; i < 2 * count; ++i) {
+        offsets[i] = _offset_from_double(values[i]);
+    }
+
+    PyMem_Free(values);
+    return offsets;
+}
+
+static PyObject *
+mask_overlap_many(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    bitmask_t *mask = pgMask_AsBitmap(self);
+    bitmask_t *othermask;
+    PyObject *masksobj, *offsetsobj, *masks, *maskobj, *hit;
+    PyObject *result = NULL;
+    Py_ssize_t i, count;
+    int *offsets;
+    int x, y, xp, yp;
+    static char *keywords[] = {"masks", "offsets", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO", keywords, &masksobj,
+                                     &offsetsobj)) {
+        return NULL;
+    }
+
+    masks = PySequence_Fast(masksobj, "masks must be a sequence of masks");
+    if (!masks) {
+        return NULL;
+    }
+    count = PySequence_Fast_GET_SIZE(masks);
+
+    for (i = 0; i < count; ++i) {
+        if (!PyObject_TypeCheck(PySequence_Fast_GET_ITEM(masks, i),
+                                &pgMask_Type)) {
+            Py_DECREF(masks);
+            return RAISE(PyExc_TypeError, "masks must be a sequence of masks");
+        }
+    }
+
+    offsets = _offsets_from_obj(offsetsobj, count);
+    if (!offsets) {
+        Py_DECREF(masks);
+        return NULL;
+    }
+
+    result = PyList_New(0);
+    if (!result) {
+        goto done;
+    }
+
+    for (i = 0; i < count; ++i) {
+        maskobj = PySequence_Fast_GET_ITEM(masks, i);
+        othermask = pgMask_AsBitmap(maskobj);
+        x = offsets[2 * i];
+        y = offsets[2 * i + 1];
+
+        /* Reject the masks whose rects do not overlap this mask's rect
+         * before going through the bits. */
+        if (x >= mask->w || y >= mask->h || x <= -othermask->w ||
+            y <= -othermask->h) {
+            continue;
+        }
+
+        if (!bitmask_overlap_pos(mask, othermask, x, y, &xp, &yp)) {
+            continue;
+        }
+
+        hit = Py_BuildValue("(n(ii))", i, xp, yp);
+        if (!hit || PyList_Append(result, hit)) {
+            Py_XDECREF(hit);
+            Py_CLEAR(result);
+            goto done;
+        }
+        Py_DECREF(hit);
+    }
+
+done:
+    PyMem_Free(offsets);
+    Py_DECREF(masks);
+    return result;
+}
+
 static PyObject *
 mask_overlap_area(PyObject *self, PyObject *args, PyObject *kwargs)
 {
@@ -346,6 +500,123 @@ mask_scale(PyObject *self, PyObject *args, PyObject *kwargs)
     return (PyObject *)create_mask_using_bitmask(bitmask);
 }
 
+/* Finds the size of a mask rotated counterclockwise by angle degrees and
+ * scaled by scale. With a scale of 1 the size is found with the same sums
+ * transform.rotate() truncates, so the two always agree. Multiples of 90
+ * degrees use exact sines and cosines.
+ *
+ * Returns:
+ *     1 on success, 0 with an exception set
+ */
+static int
+rotozoom_size(const bitmask_t *mask, double angle, double scale,
+              double *sangle, double *cangle, int *w, int *h)
+{
+    double nw, nh;
+
+    if (!isfinite(angle)) {
+        PyErr_SetString(PyExc_ValueError, "angle must be finite");
+        return 0;
+    }
+
+    if (!(scale >= 0.0) || !isfinite(scale)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "scale must be a positive number or 0");
+        return 0;
+    }
+
+    if (!fmod(angle, 90.0)) {
+        switch (((int)(fmod(angle, 360.0) / 90.0) + 4) % 4) {
+            case 0:
+                *sangle = 0.0;
+                *cangle = 1.0;
+                break;
+            case 1:
+                *sangle = 1.0;
+                *cangle = 0.0;
+                break;
+            case 2:
+                *sangle = 0.0;
+                *cangle = -1.0;
+                break;
+            default:
+                *sangle = -1.0;
+                *cangle = 0.0;
+                break;
+        }
+    }
+    else {
+        *sangle = sin(angle * .01745329251994329);
+        *cangle = cos(angle * .01745329251994329);
+    }
+
+    nw = (fabs(*cangle * mask->w) + fabs(*sangle * mask->h)) * scale;
+    nh = (fabs(*sangle * mask->w) + fabs(*cangle * mask->h)) * scale;
+    if (nw >= INT_MAX || nh >= INT_MAX) {
+        PyErr_SetString(PyExc_ValueError, "transformed mask is too large");
+        return 0;
+    }
+
+    *w = (int)nw;
+    *h = (int)nh;
+    if (*w && *h && scale > 0.0 && scale < BITMASK_ROTOZOOM_MIN_SCALE) {
+        PyErr_SetString(PyExc_ValueError, "scale is too small");
+        return 0;
+    }
+    return 1;
+}
+
+/* Rotates and scales a mask into a new mask object. */
+static PyObject *
+rotozoom_mask(PyObject *self, double angle, double scale)
+{
+    bitmask_t *mask = pgMask_AsBitmap(self);
+    bitmask_t *bitmask;
+    double sangle, cangle;
+    int w, h;
+
+    if (!rotozoom_size(mask, angle, scale, &sangle, &cangle, &w, &h)) {
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS; /* Release the GIL. */
+    bitmask = bitmask_rotozoom(mask, w, h, sangle, cangle, scale);
+    Py_END_ALLOW_THREADS; /* Obtain the GIL. */
+
+    if (NULL == bitmask) {
+        return RAISE(PyExc_MemoryError, "cannot allocate memory for bitmask");
+    }
+
+    return (PyObject *)create_mask_using_bitmask(bitmask);
+}
+
+static PyObject *
+mask_rotate(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    float angle; /* A float, as transform.rotate() takes. */
+    static char *keywords[] = {"angle", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "f", keywords, &angle)) {
+        return NULL; /* Exception already set. */
+    }
+
+    return rotozoom_mask(self, angle, 1.0);
+}
+
+static PyObject *
+mask_transform(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    double angle, scale;
+    static char *keywords[] = {"angle", "scale", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "dd", keywords, &angle,
+                                     &scale)) {
+        return NULL; /* Exception already set. */
+    }
+
+    return rotozoom_mask(self, angle, scale);
+}
+
 static PyObject *
 mask_draw(PyObject *self, PyObject *args, PyObject *kwargs)
 {
@@ -682,6 +953,313 @@ mask_convolve(PyObject *aobj, PyObject *args, PyObject *kwargs)
     return oobj;
 }
 
+#define MASK_DILATE 0
+#define MASK_ERODE 1
+#define MASK_OPEN 2
+#define MASK_CLOSE 3
+
+/* Closes the mask, padded by radius on every side so the bits set by the
+ * dilation past the edges of the mask are there for the erosion. */
+static bitmask_t *
+close_bitmask(const bitmask_t *m, int radius)
+{
+    bitmask_t *padded, *dilated, *eroded, *o;
+
+    padded = bitmask_create(m->w + 2 * radius, m->h + 2 * radius);
+    if (!padded) {
+        return NULL;
+    }
+    bitmask_draw(padded, m, radius, radius);
+    dilated = bitmask_dilate(padded, radius);
+    bitmask_free(padded);
+    if (!dilated) {
+        return NULL;
+    }
+    eroded = bitmask_erode(dilated, radius);
+    bitmask_free(dilated);
+    if (!eroded) {
+        return NULL;
+    }
+    o = bitmask_create(m->w, m->h);
+    if (o) {
+        bitmask_draw(o, eroded, -radius, -radius);
+    }
+    bitmask_free(eroded);
+    return o;
+}
+
+/* Dilates, erodes, opens or closes a mask with a circle of the given
+ * radius. The mask is not changed, a new mask is returned. */
+static PyObject *
+mask_morphology(PyObject *self, PyObject *args, PyObject *kwargs, int op)
+{
+    bitmask_t *mask = pgMask_AsBitmap(self);
+    bitmask_t *eroded, *output = NULL;
+    int radius;
+    static char *keywords[] = {"radius", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "i", keywords, &radius)) {
+        return NULL;
+    }
+
+    if (radius < 0) {
+        return RAISE(PyExc_ValueError, "radius must be non-negative");
+    }
+
+    if (op == MASK_CLOSE && radius > (INT_MAX - MAX(mask->w, mask->h)) / 2) {
+        return RAISE(PyExc_ValueError, "radius is too large");
+    }
+
+    Py_BEGIN_ALLOW_THREADS; /* Release the GIL. */
+
+    switch (op) {
+        case MASK_DILATE:
+            output = bitmask_dilate(mask, radius);
+            break;
+        case MASK_ERODE:
+            output = bitmask_erode(mask, radius);
+            break;
+        case MASK_OPEN:
+            eroded = bitmask_erode(mask, radius);
+            if (eroded) {
+                output = bitmask_dilate(eroded, radius);
+                bitmask_free(eroded);
+            }
+            break;
+        default: /* MASK_CLOSE */
+            output = close_bitmask(mask, radius);
+            break;
+    }
+
+    Py_END_ALLOW_THREADS; /* Obtain the GIL. */
+
+    if (NULL == output) {
+        return RAISE(PyExc_MemoryError, "cannot allocate memory for bitmask");
+    }
+
+    return (PyObject *)create_mask_using_bitmask(output);
+}
+
+static PyObject *
+mask_dilate(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    return mask_morphology(self, args, kwargs, MASK_DILATE);
+}
+
+static PyObject *
+mask_erode(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    return mask_morphology(self, args, kwargs, MASK_ERODE);
+}
+
+static PyObject *
+mask_open(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    return mask_morphology(self, args, kwargs, MASK_OPEN);
+}
+
+static PyObject *
+mask_close(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    return mask_morphology(self, args, kwargs, MASK_CLOSE);
+}
+
+/* One dimensional squared euclidean distance transform (Felzenszwalb and
+ * Huttenlocher). Each d[q] is set to the minimum of (q - p)^2 + f[p] over
+ * the p with finite f[p], or to HUGE_VAL if there are none.
+ *
+ * Params:
+ *     f: the n input values
+ *     d: the n output values
+ *     v: n ints of work space, the sites of the lower envelope
+ *     z: n + 1 doubles of work space, the boundaries of the envelope
+ */
+static void
+distance_transform_1d(const double *f, double *d, int n, int *v, double *z)
+{
+    int p, q, k = -1;
+    double s;
+
+    for (q = 0; q < n; ++q) {
+        if (f[q] == HUGE_VAL) {
+            continue;
+        }
+        if (k < 0) {
+            k = 0;
+            v[0] = q;
+            z[0] = -HUGE_VAL;
+            z[1] = HUGE_VAL;
+            continue;
+        }
+        for (;;) {
+            p = v[k];
+            s = ((f[q] + (double)q * q) - (f[p] + (double)p * p)) /
+                (2.0 * (q - p));
+            if (s > z[k]) {
+                break;
+            }
+            --k; /* z[0] is -HUGE_VAL, so k stays >= 0 */
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = HUGE_VAL;
+    }
+
+    if (k < 0) {
+        for (q = 0; q < n; ++q) {
+            d[q] = HUGE_VAL;
+        }
+        return;
+    }
+
+    for (q = 0, k = 0; q < n; ++q) {
+        while (z[k + 1] < q) {
+            ++k;
+        }
+        d[q] = (double)(q - v[k]) * (q - v[k]) + f[v[k]];
+    }
+}
+
+/* Number of rows of distances gathered before they are written out
+ * column by column. */
+#define DISTANCE_TILE_ROWS 16
+
+/* Computes the euclidean distance from each set bit to the nearest unset
+ * bit, 0 for the unset bits. The distances are written to out[x * h + y].
+ *
+ * Returns:
+ *     0 on success, -1 if memory can not be allocated
+ */
+static int
+distance_transform(const bitmask_t *mask, float *out)
+{
+    int w = mask->w, h = mask->h;
+    int x, y, y0, rows, *v;
+    size_t i;
+    double *grid, *row, *below, *d, *z;
+    float *tile;
+
+    grid = PyMem_RawMalloc(((size_t)w * h + 2 * (size_t)w + 1) *
+                           sizeof(double));
+    v = PyMem_RawMalloc(w * sizeof(int));
+    tile = PyMem_RawMalloc((size_t)w * DISTANCE_TILE_ROWS * sizeof(float));
+    if (!grid || !v || !tile) {
+        PyMem_RawFree(grid);
+        PyMem_RawFree(v);
+        PyMem_RawFree(tile);
+        return -1;
+    }
+    d = grid + (size_t)w * h;
+    z = d + w;
+
+    /* The distance to the nearest unset bit in the same column, found by
+     * scanning down and then up. The grid is stored by rows so both scans
+     * go through it in order. */
+    for (y = 0; y < h; ++y) {
+        row = grid + (size_t)y * w;
+        for (x = 0; x < w; ++x) {
+            if (!bitmask_getbit(mask, x, y)) {
+                row[x] = 0.0;
+            }
+            else {
+                row[x] = y ? row[x - w] + 1.0 : HUGE_VAL;
+            }
+        }
+    }
+    for (y = h - 2; y >= 0; --y) {
+        row = grid + (size_t)y * w;
+        below = row + w;
+        for (x = 0; x < w; ++x) {
+            if (below[x] + 1.0 < row[x]) {
+                row[x] = below[x] + 1.0;
+            }
+        }
+    }
+    for (i = 0; i < (size_t)w * h; ++i) {
+        grid[i] *= grid[i];
+    }
+
+    /* Then the rows, a tile of rows at a time so the distances can be
+     * written out a column at a time. */
+    for (y0 = 0; y0 < h; y0 += DISTANCE_TILE_ROWS) {
+        rows = MIN(DISTANCE_TILE_ROWS, h - y0);
+        for (y = 0; y < rows; ++y) {
+            distance_transform_1d(grid + (size_t)(y0 + y) * w, d, w, v, z);
+            for (x = 0; x < w; ++x) {
+                tile[x * DISTANCE_TILE_ROWS + y] = (float)sqrt(d[x]);
+            }
+        }
+        for (x = 0; x < w; ++x) {
+            memcpy(out + (size_t)x * h + y0, tile + x * DISTANCE_TILE_ROWS,
+                   rows * sizeof(float));
+        }
+    }
+
+    PyMem_RawFree(grid);
+    PyMem_RawFree(v);
+    PyMem_RawFree(tile);
+    return 0;
+}
+
+/* Wraps the given bytes in a memoryview of the given item format with the
+ * shape (w, h). A memoryview can not be cast to a shape with a 0 in it, so
+ * the view of an empty mask is one dimensional. Steals the reference to
+ * data. */
+static PyObject *
+shaped_view(PyObject *data, const char *format, int w, int h)
+{
+    PyObject *view, *result;
+
+    if (!data) {
+        return NULL;
+    }
+
+    view = PyMemoryView_FromObject(data);
+    Py_DECREF(data);
+    if (!view) {
+        return NULL;
+    }
+
+    if (w && h) {
+        result = PyObject_CallMethod(view, "cast", "s(ii)", format, w, h);
+    }
+    else {
+        result = PyObject_CallMethod(view, "cast", "s", format);
+    }
+    Py_DECREF(view);
+    return result;
+}
+
+static PyObject *
+mask_distance_transform(PyObject *self, PyObject *args)
+{
+    bitmask_t *mask = pgMask_AsBitmap(self);
+    PyObject *data;
+    int failed = 0;
+
+    data = PyByteArray_FromStringAndSize(
+        NULL, (Py_ssize_t)mask->w * mask->h * sizeof(float));
+    if (!data) {
+        return NULL;
+    }
+
+    if (mask->w && mask->h) {
+        Py_BEGIN_ALLOW_THREADS; /* Release the GIL. */
+        failed = distance_transform(mask,
+                                    (float *)PyByteArray_AS_STRING(data));
+        Py_END_ALLOW_THREADS; /* Obtain the GIL. */
+    }
+
+    if (failed) {
+        Py_DECREF(data);
+        return RAISE(PyExc_MemoryError,
+                     "cannot allocate memory for distance transform");
+    }
+
+    return shaped_view(data, "f", mask->w, mask->h);
+}
+
 /* Gets the color of a given pixel.
  *
  * Params:
@@ -751,10 +1329,103 @@ set_pixel_color(Uint8 *pixel, Uint8 bpp, Uint32 color)
     }
 }
 
-/* For each surface pixel's alpha that is greater than the threshold,
- * the corresponding bitmask bit is set.
- *
- * Params:
+/* Ors the bits of a row of pixels, starting at x, into the mask word that
+ * holds pixel x. */
+#define SET_ROW_BITS(bitmask, x, y, word)                              \
+    (bitmask)->bits[(x) / BITMASK_W_LEN * (bitmask)->h + (y)] |= (word)
+
+#if PG_HAS_SSE2_OR_NEON
+/* Packs the results of four 32 bit lane compares, 16 pixels, into 16 bits
+ * in pixel order. */
+static PG_INLINE int
+pack_lanes_sse2(__m128i c0, __m128i c1, __m128i c2, __m128i c3)
+{
+    return _mm_movemask_epi8(_mm_packs_epi16(_mm_packs_epi32(c0, c1),
+                                             _mm_packs_epi32(c2, c3)));
+}
+
+/* Sets the bits of the 32 bit pixels in a row with an alpha greater than
+ * threshold, 16 pixels at a time. The alpha must be a whole byte.
+ *
+ * Returns:
+ *     the number of pixels done, the rest are left to the caller
+ */
+static int
+set_from_threshold_row_sse2(Uint8 *pixels, int width, int y,
+                            bitmask_t *bitmask, int ashift, int threshold)
+{
+    const __m128i thresh = _mm_set1_epi32(threshold);
+    const __m128i byte = _mm_set1_epi32(0xff);
+    const __m128i shift = _mm_cvtsi32_si128(ashift);
+    __m128i alpha[4];
+    BITMASK_W word = 0;
+    int x, i;
+
+    for (x = 0; x + 16 <= width; x += 16, pixels += 64) {
+        for (i = 0; i < 4; ++i) {
+            alpha[i] = _mm_and_si128(
+                _mm_srl_epi32(_mm_loadu_si128((__m128i *)pixels + i), shift),
+                byte);
+            alpha[i] = _mm_cmpgt_epi32(alpha[i], thresh);
+        }
+        word |= (BITMASK_W)pack_lanes_sse2(alpha[0], alpha[1], alpha[2],
+                                           alpha[3])
+                << (x & BITMASK_W_MASK);
+        if (((x + 16) & BITMASK_W_MASK) == 0) {
+            SET_ROW_BITS(bitmask, x, y, word);
+            word = 0;
+        }
+    }
+    if (word) {
+        SET_ROW_BITS(bitmask, x - 16, y, word);
+    }
+    return x;
+}
+
+/* Sets the bits of the 32 bit pixels in a row not equal to colorkey, 16
+ * pixels at a time.
+ *
+ * Returns:
+ *     the number of pixels done, the rest are left to the caller
+ */
+static int
+set_from_colorkey_row_sse2(Uint8 *pixels, int width, int y,
+                           bitmask_t *bitmask, Uint32 colorkey)
+{
+    const __m128i key = _mm_set1_epi32((int)colorkey);
+    __m128i equal[4];
+    BITMASK_W word = 0;
+    int x, i;
+
+    for (x = 0; x + 16 <= width; x += 16, pixels += 64) {
+        for (i = 0; i < 4; ++i) {
+            equal[i] =
+                _mm_cmpeq_epi32(_mm_loadu_si128((__m128i *)pixels + i), key);
+        }
+        word |= (BITMASK_W)(~pack_lanes_sse2(equal[0], equal[1], equal[2],
+                                             equal[3]) &
+                            0xffff)
+                << (x & BITMASK_W_MASK);
+        if (((x + 16) & BITMASK_W_MASK) == 0) {
+            SET_ROW_BITS(bitmask, x, y, word);
+            word = 0;
+        }
+    }
+    if (word) {
+        SET_ROW_BITS(bitmask, x - 16, y, word);
+    }
+    return x;
+}
+#endif /* PG_HAS_SSE2_OR_NEON */
+
+/* For each surface pixel's alpha that is greater than the threshold,
+ * the corresponding bitmask bit is set.
+ *
+ * The alpha of each possible alpha (or palette index) value is looked up
+ * once, so the pixels only need masking. 32 bit pixels are compared 16 at
+ * a time with SSE2/NEON when available.
+ *
+ * Params:
  *     surf: surface
  *     bitmask: bitmask to alter
  *     threshold: threshold used check surface pixels (alpha) against
@@ -769,16 +1440,57 @@ set_from_threshold(SDL_Surface *surf, bitmask_t *bitmask, int threshold)
     Uint8 bpp = format->BytesPerPixel;
     Uint8 *pixel = NULL;
     Uint8 rgba[4];
+    Uint8 above[256]; /* if the alpha of an index is above threshold */
+    Uint32 index_mask, index_shift, i;
+    BITMASK_W word;
     int x, y;
+#if PG_HAS_SSE2_OR_NEON
+    int use_simd = bpp == 4 && format->Amask == 0xffu << format->Ashift &&
+                   pg_HasSSE_NEON();
+#endif /* PG_HAS_SSE2_OR_NEON */
+
+    if (!format->Amask && !format->palette) {
+        /* Every pixel is opaque. */
+        if (threshold < 255) {
+            bitmask_fill(bitmask);
+        }
+        return;
+    }
+
+    if (bpp == 1) {
+        index_mask = 0xff;
+        index_shift = 0;
+    }
+    else {
+        index_mask = format->Amask;
+        index_shift = format->Ashift;
+    }
+    for (i = 0; i <= index_mask >> index_shift; ++i) {
+        SDL_GetRGBA(i << index_shift, format, rgba, rgba + 1, rgba + 2,
+                    rgba + 3);
+        above[i] = rgba[3] > threshold;
+    }
 
     for (y = 0; y < surf->h; ++y) {
         pixel = (Uint8 *)surf->pixels + y * surf->pitch;
+        x = 0;
+
+#if PG_HAS_SSE2_OR_NEON
+        if (use_simd) {
+            x = set_from_threshold_row_sse2(pixel, surf->w, y, bitmask,
+                                            format->Ashift, threshold);
+            pixel += x * bpp;
+        }
+#endif /* PG_HAS_SSE2_OR_NEON */
 
-        for (x = 0; x < surf->w; ++x, pixel += bpp) {
-            SDL_GetRGBA(get_pixel_color(pixel, bpp), format, rgba, rgba + 1,
-                        rgba + 2, rgba + 3);
-            if (rgba[3] > threshold) {
-                bitmask_setbit(bitmask, x, y);
+        for (word = 0; x < surf->w; ++x, pixel += bpp) {
+            if (above[(get_pixel_color(pixel, bpp) & index_mask) >>
+                      index_shift]) {
+                word |= BITMASK_N(x & BITMASK_W_MASK);
+            }
+            if ((x & BITMASK_W_MASK) == BITMASK_W_MASK || x == surf->w - 1) {
+                SET_ROW_BITS(bitmask, x, y, word);
+                word = 0;
             }
         }
     }
@@ -800,14 +1512,31 @@ set_from_colorkey(SDL_Surface *surf, bitmask_t *bitmask, Uint32 colorkey)
 {
     Uint8 bpp = surf->format->BytesPerPixel;
     Uint8 *pixel = NULL;
+    BITMASK_W word;
     int x, y;
+#if PG_HAS_SSE2_OR_NEON
+    int use_simd = bpp == 4 && pg_HasSSE_NEON();
+#endif /* PG_HAS_SSE2_OR_NEON */
 
     for (y = 0; y < surf->h; ++y) {
         pixel = (Uint8 *)surf->pixels + y * surf->pitch;
+        x = 0;
+
+#if PG_HAS_SSE2_OR_NEON
+        if (use_simd) {
+            x = set_from_colorkey_row_sse2(pixel, surf->w, y, bitmask,
+                                           colorkey);
+            pixel += x * bpp;
+        }
+#endif /* PG_HAS_SSE2_OR_NEON */
 
-        for (x = 0; x < surf->w; ++x, pixel += bpp) {
+        for (word = 0; x < surf->w; ++x, pixel += bpp) {
             if (get_pixel_color(pixel, bpp) != colorkey) {
-                bitmask_setbit(bitmask, x, y);
+                word |= BITMASK_N(x & BITMASK_W_MASK);
+            }
+            if ((x & BITMASK_W_MASK) == BITMASK_W_MASK || x == surf->w - 1) {
+                SET_ROW_BITS(bitmask, x, y, word);
+                word = 0;
             }
         }
     }
@@ -878,6 +1607,60 @@ mask_from_surface(PyObject *self, PyObject *args, PyObject *kwargs)
     return (PyObject *)maskobj;
 }
 
+#if PG_HAS_SSE2_OR_NEON
+/* Sets the bits of the 32 bit pixels in a row whose red, green and blue
+ * are each within the threshold of the color, or of the pixel at the same
+ * place in pixels2 if it is not NULL, 16 pixels at a time. The color,
+ * threshold and channels are 32 bit pixel values, with whole bytes for
+ * red, green and blue.
+ *
+ * Returns:
+ *     the number of pixels done, the rest are left to the caller
+ */
+static int
+bitmask_threshold_row_sse2(Uint8 *pixels, Uint8 *pixels2, int width, int y,
+                           bitmask_t *m, Uint32 color, Uint32 threshold,
+                           Uint32 channels)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i thresh = _mm_set1_epi32((int)threshold);
+    const __m128i chan = _mm_set1_epi32((int)channels);
+    __m128i other = _mm_set1_epi32((int)color);
+    __m128i pixel, diff, within[4];
+    BITMASK_W word = 0;
+    int x, i;
+
+    for (x = 0; x + 16 <= width; x += 16, pixels += 64) {
+        for (i = 0; i < 4; ++i) {
+            pixel = _mm_loadu_si128((__m128i *)pixels + i);
+            if (pixels2) {
+                other = _mm_loadu_si128((__m128i *)pixels2 + i);
+            }
+            /* |pixel - other| per byte, then a byte is out of threshold
+             * if threshold - diff saturates to 0. */
+            diff = _mm_or_si128(_mm_subs_epu8(pixel, other),
+                                _mm_subs_epu8(other, pixel));
+            diff = _mm_cmpeq_epi8(_mm_subs_epu8(thresh, diff), zero);
+            within[i] = _mm_cmpeq_epi32(_mm_and_si128(diff, chan), zero);
+        }
+        if (pixels2) {
+            pixels2 += 64;
+        }
+        word |= (BITMASK_W)pack_lanes_sse2(within[0], within[1], within[2],
+                                           within[3])
+                << (x & BITMASK_W_MASK);
+        if (((x + 16) & BITMASK_W_MASK) == 0) {
+            SET_ROW_BITS(m, x, y, word);
+            word = 0;
+        }
+    }
+    if (word) {
+        SET_ROW_BITS(m, x - 16, y, word);
+    }
+    return x;
+}
+#endif /* PG_HAS_SSE2_OR_NEON */
+
 /*
 
 palette_colors - this only affects surfaces with a palette
@@ -900,6 +1683,9 @@ bitmask_threshold(bitmask_t *m, SDL_Surface *surf, SDL_Surface *surf2,
     Uint8 r, g, b, a;
     Uint8 tr, tg, tb, ta;
     int bpp1, bpp2;
+#if PG_HAS_SSE2_OR_NEON
+    int use_simd;
+#endif /* PG_HAS_SSE2_OR_NEON */
 
     format = surf->format;
     rmask = format->Rmask;
@@ -939,12 +1725,37 @@ bitmask_threshold(bitmask_t *m, SDL_Surface *surf, SDL_Surface *surf2,
     SDL_GetRGBA(color, format, &r, &g, &b, &a);
     SDL_GetRGBA(threshold, format, &tr, &tg, &tb, &ta);
 
+#if PG_HAS_SSE2_OR_NEON
+    /* 32 bit pixels with byte channels, laid out the same in both
+     * surfaces, are compared a byte per channel. */
+    use_simd = bpp1 == 4 && !rloss && !gloss && !bloss &&
+               (!surf2 || (format2->BytesPerPixel == 4 && rmask2 == rmask &&
+                           gmask2 == gmask && bmask2 == bmask)) &&
+               pg_HasSSE_NEON();
+#endif /* PG_HAS_SSE2_OR_NEON */
+
     for (y = 0; y < surf->h; y++) {
         pixels = (Uint8 *)surf->pixels + y * surf->pitch;
         if (surf2) {
             pixels2 = (Uint8 *)surf2->pixels + y * surf2->pitch;
         }
-        for (x = 0; x < surf->w; x++) {
+        x = 0;
+#if PG_HAS_SSE2_OR_NEON
+        if (use_simd) {
+            x = bitmask_threshold_row_sse2(
+                pixels, pixels2, surf->w, y, m,
+                ((Uint32)r << rshift) | ((Uint32)g << gshift) |
+                    ((Uint32)b << bshift),
+                ((Uint32)tr << rshift) | ((Uint32)tg << gshift) |
+                    ((Uint32)tb << bshift),
+                rmask | gmask | bmask);
+            pixels += x * 4;
+            if (surf2) {
+                pixels2 += x * 4;
+            }
+        }
+#endif /* PG_HAS_SSE2_OR_NEON */
+        for (; x < surf->w; x++) {
             /* the_color = surf->get_at(x,y) */
             switch (bpp1) {
                 case 1:
@@ -1126,207 +1937,320 @@ mask_from_threshold(PyObject *self, PyObject *args, PyObject *kwargs)
     return (PyObject *)maskobj;
 }
 
-/* The initial labelling phase of the connected components algorithm.
- *
- * Connected component labeling based on the SAUF algorithm by Kesheng Wu,
- * Ekow Otoo, and Kenji Suzuki. The algorithm is best explained by their
- * paper, "Two Strategies to Speed up Connected Component Labeling Algorithms",
- * but in summary, it is a very efficient two pass method for 8-connected
- * components. It uses a decision tree to minimize the number of neighbors that
- * need to be checked. It stores equivalence information in an array based
- * union-find.
- *
- * Params:
- *     input - the input mask
- *     image - an array to store labelled pixels
- *     ufind - the union-find label equivalence array
- *     largest - an array to store the number of pixels for each label
- *
- * Returns:
- *     the highest label in the labelled image
- */
-unsigned int
-cc_label(bitmask_t *input, unsigned int *image, unsigned int *ufind,
-         unsigned int *largest)
+static PyObject *
+mask_rotation_cache(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    unsigned int *buf;
-    unsigned int x, y, w, h, root, aroot, croot, temp, label;
+    PyObject *maskobj, *masks = NULL, *item;
+    bitmask_t *mask, **bitmasks;
+    double scale = 1.0, *sangles = NULL, *cangles = NULL;
+    int *sizes = NULL;
+    Py_ssize_t i, steps;
+    int failed = 0;
+    static char *keywords[] = {"mask", "steps", "scale", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!n|d", keywords,
+                                     &pgMask_Type, &maskobj, &steps,
+                                     &scale)) {
+        return NULL; /* Exception already set. */
+    }
 
-    label = 0;
-    w = input->w;
-    h = input->h;
+    if (steps < 1) {
+        return RAISE(PyExc_ValueError, "steps must be at least 1");
+    }
 
-    ufind[0] = 0;
-    buf = image;
+    mask = pgMask_AsBitmap(maskobj);
+    bitmasks = PyMem_New(bitmask_t *, steps);
+    if (bitmasks) {
+        /* Cleaned up from any point on, so every entry starts empty. */
+        for (i = 0; i < steps; ++i) {
+            bitmasks[i] = NULL;
+        }
+    }
+    sangles = PyMem_New(double, steps);
+    cangles = PyMem_New(double, steps);
+    sizes = PyMem_New(int, 2 * steps);
 
-    /* special case for first pixel */
-    if (bitmask_getbit(input, 0, 0)) { /* process for a new connected comp: */
-        label++;                       /* create a new label */
-        *buf = label;                  /* give the pixel the label */
-        ufind[label] = label; /* put the label in the equivalence array */
-        largest[label] = 1;   /* the label has 1 pixel associated with it */
+    if (!bitmasks || !sangles || !cangles || !sizes) {
+        PyErr_NoMemory();
+        goto cleanup;
     }
-    else {
-        *buf = 0;
+
+    for (i = 0; i < steps; ++i) {
+        if (!rotozoom_size(mask, 360.0 * i / steps, scale, sangles + i,
+                           cangles + i, sizes + 2 * i, sizes + 2 * i + 1)) {
+            goto cleanup;
+        }
     }
-    buf++;
 
-    /* special case for first row.
-           Go over the first row except the first pixel.
-    */
-    for (x = 1; x < w; x++) {
-        if (bitmask_getbit(input, x, 0)) {
-            if (*(buf - 1)) { /* d label */
-                *buf = *(buf - 1);
-            }
-            else { /* create label */
-                label++;
-                *buf = label;
-                ufind[label] = label;
-                largest[label] = 0;
+    /* All the masks are made in one go, so the bits of the mask being
+     * rotated stay in the cache. */
+    Py_BEGIN_ALLOW_THREADS; /* Release the GIL. */
+    for (i = 0; i < steps && !failed; ++i) {
+        bitmasks[i] = bitmask_rotozoom(mask, sizes[2 * i], sizes[2 * i + 1],
+                                       sangles[i], cangles[i], scale);
+        failed = !bitmasks[i];
+    }
+    Py_END_ALLOW_THREADS; /* Obtain the GIL. */
+
+    if (failed) {
+        PyErr_SetString(PyExc_MemoryError,
+                        "cannot allocate memory for bitmask");
+        goto cleanup;
+    }
+
+    masks = PyList_New(steps);
+    if (!masks) {
+        goto cleanup;
+    }
+
+    for (i = 0; i < steps; ++i) {
+        item = (PyObject *)create_mask_using_bitmask(bitmasks[i]);
+        if (!item) {
+            Py_CLEAR(masks);
+            goto cleanup;
+        }
+        /* The mask object owns the bitmask now. */
+        bitmasks[i] = NULL;
+        PyList_SET_ITEM(masks, i, item);
+    }
+
+cleanup:
+    if (bitmasks) {
+        for (i = 0; i < steps; ++i) {
+            if (bitmasks[i]) {
+                bitmask_free(bitmasks[i]);
             }
-            largest[*buf]++;
         }
-        else {
-            *buf = 0;
+    }
+    PyMem_Free(bitmasks);
+    PyMem_Free(sangles);
+    PyMem_Free(cangles);
+    PyMem_Free(sizes);
+    return masks;
+}
+
+/* A horizontal run of set bits, covering [x0, x1) of row y. */
+typedef struct {
+    int x0, x1, y;
+    unsigned int parent; /* union-find parent, the index of a run */
+    unsigned int label;  /* the component of the run, 0 if filtered out */
+} cc_run;
+
+/* Returns the index of the lowest set bit of a non-zero word. */
+static PG_INLINE int
+cc_first_bit(BITMASK_W word)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzl(word);
+#else
+    int i = 0;
+
+    while (!(word & 1)) {
+        word >>= 1;
+        ++i;
+    }
+    return i;
+#endif
+}
+
+/* Finds the first set (or unset if set is 0) bit of row y at or after x.
+ *
+ * Returns:
+ *     the x of the bit, or the width of the mask if there is none
+ */
+static int
+cc_next_bit(const bitmask_t *mask, int x, int y, int set)
+{
+    int words = (mask->w - 1) / BITMASK_W_LEN + 1;
+    int word_index = x / BITMASK_W_LEN;
+    BITMASK_W word;
+
+    if (x >= mask->w) {
+        return mask->w;
+    }
+
+    word = mask->bits[word_index * mask->h + y];
+    word = (set ? word : ~word) & (~(BITMASK_W)0 << (x % BITMASK_W_LEN));
+
+    while (!word) {
+        if (++word_index == words) {
+            return mask->w;
         }
-        buf++;
+        word = mask->bits[word_index * mask->h + y];
+        word = set ? word : ~word;
+    }
+
+    /* The unused bits past the width are unset, so they can be found
+     * here. */
+    x = word_index * BITMASK_W_LEN + cc_first_bit(word);
+    return MIN(x, mask->w);
+}
+
+/* Finds the root of a run's union-find tree, halving the path to it. */
+static PG_INLINE unsigned int
+cc_find(cc_run *runs, unsigned int i)
+{
+    while (runs[i].parent != i) {
+        runs[i].parent = runs[runs[i].parent].parent;
+        i = runs[i].parent;
     }
+    return i;
+}
 
-    /* the rest of the image */
-    for (y = 1; y < h; y++) {
-        /* first pixel of the row */
-        if (bitmask_getbit(input, 0, y)) {
-            if (*(buf - w)) { /* b label */
-                *buf = *(buf - w);
+/* Labels the 8-connected components of a mask.
+ *
+ * The set bits of each row are collected into runs, and the runs that touch
+ * a run of the row above are joined with a union-find. The root of each
+ * tree is its first run, so the components are numbered in the order their
+ * first bits are found going through the mask row by row.
+ *
+ * Allocates memory for runs.
+ *
+ * NOTE: Caller is responsible for freeing the "ret_runs" memory.
+ *
+ * Params:
+ *     mask - the mask to label
+ *     min - minimum number of bits for a component to be labelled, the
+ *         runs of smaller components get the label 0
+ *     ret_runs - passes back the runs, in row order, memory is allocated
+ *     num_runs - passes back the number of runs
+ *
+ * Returns:
+ *     the number of components labelled (>= 0), labels are 1 to this number
+ *     -2 on memory allocation error
+ */
+static int
+cc_label(const bitmask_t *mask, unsigned int min, cc_run **ret_runs,
+         unsigned int *num_runs)
+{
+    cc_run *runs = NULL, *new_runs;
+    unsigned int *areas;
+    unsigned int count = 0, max_runs = 0, prev, row, i, j, a, b;
+    int x, y, x1, label, relabel;
+
+    *ret_runs = NULL;
+    *num_runs = 0;
+
+    for (prev = row = 0, y = 0; y < mask->h; ++y, prev = row, row = count) {
+        for (x = cc_next_bit(mask, 0, y, 1); x < mask->w;
+             x = cc_next_bit(mask, x1, y, 1)) {
+            x1 = cc_next_bit(mask, x, y, 0);
+
+            if (count == max_runs) {
+                max_runs = max_runs ? 2 * max_runs : 64;
+                new_runs = (cc_run *)realloc(runs, max_runs * sizeof(cc_run));
+                if (!new_runs) {
+                    free(runs);
+                    return -2;
+                }
+                runs = new_runs;
             }
-            else if (*(buf - w + 1)) { /* c label */
-                *buf = *(buf - w + 1);
+            runs[count].x0 = x;
+            runs[count].x1 = x1;
+            runs[count].y = y;
+            runs[count].parent = count;
+            ++count;
+        }
+
+        /* Join the runs of this row with the runs above them. Two runs are
+         * 8-connected if they overlap once one is widened by a bit on each
+         * side. */
+        for (i = prev, j = row; i < row && j < count;) {
+            if (runs[i].x1 < runs[j].x0) {
+                ++i;
+                continue;
             }
-            else { /* create label */
-                label++;
-                *buf = label;
-                ufind[label] = label;
-                largest[label] = 0;
+            if (runs[j].x1 < runs[i].x0) {
+                ++j;
+                continue;
             }
-            largest[*buf]++;
-        }
-        else {
-            *buf = 0;
-        }
-        buf++;
-        /* middle pixels of the row */
-        for (x = 1; x < (w - 1); x++) {
-            if (bitmask_getbit(input, x, y)) {
-                if (*(buf - w)) { /* b label */
-                    *buf = *(buf - w);
-                }
-                else if (*(buf - w + 1)) { /* c branch of tree */
-                    if (*(buf - w - 1)) {  /* union(c, a) */
-                        croot = root = *(buf - w + 1);
-                        while (ufind[root] < root) { /* find root */
-                            root = ufind[root];
-                        }
-                        if (croot != *(buf - w - 1)) {
-                            temp = aroot = *(buf - w - 1);
-                            while (ufind[aroot] < aroot) { /* find root */
-                                aroot = ufind[aroot];
-                            }
-                            if (root > aroot) {
-                                root = aroot;
-                            }
-                            while (ufind[temp] > root) { /* set root */
-                                aroot = ufind[temp];
-                                ufind[temp] = root;
-                                temp = aroot;
-                            }
-                        }
-                        while (ufind[croot] > root) { /* set root */
-                            temp = ufind[croot];
-                            ufind[croot] = root;
-                            croot = temp;
-                        }
-                        *buf = root;
-                    }
-                    else if (*(buf - 1)) { /* union(c, d) */
-                        croot = root = *(buf - w + 1);
-                        while (ufind[root] < root) { /* find root */
-                            root = ufind[root];
-                        }
-                        if (croot != *(buf - 1)) {
-                            temp = aroot = *(buf - 1);
-                            while (ufind[aroot] < aroot) { /* find root */
-                                aroot = ufind[aroot];
-                            }
-                            if (root > aroot) {
-                                root = aroot;
-                            }
-                            while (ufind[temp] > root) { /* set root */
-                                aroot = ufind[temp];
-                                ufind[temp] = root;
-                                temp = aroot;
-                            }
-                        }
-                        while (ufind[croot] > root) { /* set root */
-                            temp = ufind[croot];
-                            ufind[croot] = root;
-                            croot = temp;
-                        }
-                        *buf = root;
-                    }
-                    else { /* c label */
-                        *buf = *(buf - w + 1);
-                    }
-                }
-                else if (*(buf - w - 1)) { /* a label */
-                    *buf = *(buf - w - 1);
-                }
-                else if (*(buf - 1)) { /* d label */
-                    *buf = *(buf - 1);
-                }
-                else { /* create label */
-                    label++;
-                    *buf = label;
-                    ufind[label] = label;
-                    largest[label] = 0;
-                }
-                largest[*buf]++;
+
+            a = cc_find(runs, i);
+            b = cc_find(runs, j);
+            if (a < b) {
+                runs[b].parent = a;
             }
             else {
-                *buf = 0;
+                runs[a].parent = b;
             }
-            buf++;
-        }
-        /* last pixel of the row, if its not also the first pixel of the row */
-        if (w > 1) {
-            if (bitmask_getbit(input, x, y)) {
-                if (*(buf - w)) { /* b label */
-                    *buf = *(buf - w);
-                }
-                else if (*(buf - w - 1)) { /* a label */
-                    *buf = *(buf - w - 1);
-                }
-                else if (*(buf - 1)) { /* d label */
-                    *buf = *(buf - 1);
-                }
-                else { /* create label */
-                    label++;
-                    *buf = label;
-                    ufind[label] = label;
-                    largest[label] = 0;
-                }
-                largest[*buf]++;
+
+            if (runs[i].x1 < runs[j].x1) {
+                ++i;
             }
             else {
-                *buf = 0;
+                ++j;
             }
-            buf++;
         }
     }
 
+    if (!count) {
+        return 0;
+    }
+
+    /* Number the roots in order, counting the bits of each component. */
+    areas = (unsigned int *)malloc(sizeof(unsigned int) * (count + 1));
+    if (!areas) {
+        free(runs);
+        return -2;
+    }
+    areas[0] = 0;
+
+    label = 0;
+    for (i = 0; i < count; ++i) {
+        a = cc_find(runs, i);
+        if (a == i) {
+            runs[i].label = ++label;
+            areas[label] = 0;
+        }
+        else {
+            runs[i].label = runs[a].label;
+        }
+        areas[runs[i].label] += runs[i].x1 - runs[i].x0;
+    }
+
+    /* Drop the components smaller than min. */
+    if (min > 1) {
+        relabel = 0;
+        for (x = 1; x <= label; ++x) {
+            areas[x] = (areas[x] >= min) ? ++relabel : 0;
+        }
+        for (i = 0; i < count; ++i) {
+            runs[i].label = areas[runs[i].label];
+        }
+        label = relabel;
+    }
+
+    free(areas);
+    if (!label) {
+        free(runs);
+        return 0;
+    }
+    *ret_runs = runs;
+    *num_runs = count;
+
     return label;
 }
 
+/* Sets the bits of a run in a mask. */
+static void
+cc_draw_run(bitmask_t *mask, const cc_run *run)
+{
+    int x0 = run->x0, x1 = run->x1, end;
+    BITMASK_W *word = mask->bits + (x0 / BITMASK_W_LEN) * mask->h + run->y;
+
+    while (x0 < x1) {
+        end = MIN(x1, (x0 / (int)BITMASK_W_LEN + 1) * (int)BITMASK_W_LEN);
+        if (end - x0 == (int)BITMASK_W_LEN) {
+            *word = ~(BITMASK_W)0;
+        }
+        else {
+            *word |= ((BITMASK_N(end - x0) - 1) << (x0 % BITMASK_W_LEN));
+        }
+        word += mask->h;
+        x0 = end;
+    }
+}
+
 /* Creates a bounding rect for each connected component in the given mask.
  *
  * Allocates memory for rects.
@@ -1347,111 +2271,52 @@ static int
 get_bounding_rects(bitmask_t *input, int *num_bounding_boxes,
                    GAME_Rect **ret_rects)
 {
-    unsigned int *image, *ufind, *largest, *buf;
-    unsigned int x_uf, label = 0;
-    int x, y, w, h, temp, relabel;
-    GAME_Rect *rects;
-
-    rects = NULL;
-
-    w = input->w;
-    h = input->h;
-
-    if (!w || !h) {
-        *ret_rects = rects;
-        return 0;
-    }
-    /* a temporary image to assign labels to each bit of the mask */
-    image = (unsigned int *)malloc(sizeof(int) * w * h);
-    if (!image) {
-        return -2;
-    }
+    cc_run *runs, *run;
+    unsigned int num_runs;
+    int label, relabel;
+    GAME_Rect *rects, *rect;
 
-    /* allocate enough space for the maximum possible connected components */
-    /* the union-find array. see wikipedia for info on union find */
-    ufind = (unsigned int *)malloc(sizeof(int) * (w / 2 + 1) * (h / 2 + 1));
-    if (!ufind) {
-        free(image);
-        return -2;
-    }
-
-    largest = (unsigned int *)malloc(sizeof(int) * (w / 2 + 1) * (h / 2 + 1));
-    if (!largest) {
-        free(image);
-        free(ufind);
-        return -2;
-    }
-
-    /* do the initial labelling */
-    label = cc_label(input, image, ufind, largest);
-
-    relabel = 0;
-    /* flatten and relabel the union-find equivalence array.  Start at label 1
-       because label 0 indicates an unset pixel.  For this reason, we also use
-       <= label rather than < label. */
-    for (x_uf = 1; x_uf <= label; ++x_uf) {
-        if (ufind[x_uf] < x_uf) {             /* is it a union find root? */
-            ufind[x_uf] = ufind[ufind[x_uf]]; /* relabel it to its root */
-        }
-        else { /* its a root */
-            relabel++;
-            ufind[x_uf] = relabel; /* assign the lowest label available */
-        }
-    }
-
-    *num_bounding_boxes = relabel;
+    *ret_rects = NULL;
+    *num_bounding_boxes = 0;
 
-    if (relabel == 0) {
-        /* early out, as we didn't find anything. */
-        free(image);
-        free(ufind);
-        free(largest);
-        *ret_rects = rects;
-        return 0;
+    relabel = cc_label(input, 0, &runs, &num_runs);
+    if (relabel <= 0) {
+        return relabel;
     }
 
     /* the bounding rects, need enough space for the number of labels */
     rects = (GAME_Rect *)malloc(sizeof(GAME_Rect) * (relabel + 1));
     if (!rects) {
-        free(image);
-        free(ufind);
-        free(largest);
+        free(runs);
         return -2;
     }
 
-    for (temp = 0; temp <= relabel; temp++) {
-        rects[temp].h = 0; /* so we know if its a new rect or not */
-    }
-
-    /* find the bounding rect of each connected component */
-    buf = image;
-    for (y = 0; y < h; y++) {
-        for (x = 0; x < w; x++) {
-            if (ufind[*buf]) { /* if the pixel is part of a component */
-                if (rects[ufind[*buf]].h) { /* the component has a rect */
-                    temp = rects[ufind[*buf]].x;
-                    rects[ufind[*buf]].x = MIN(x, temp);
-                    rects[ufind[*buf]].y = MIN(y, rects[ufind[*buf]].y);
-                    rects[ufind[*buf]].w =
-                        MAX(rects[ufind[*buf]].w + temp, x + 1) -
-                        rects[ufind[*buf]].x;
-                    rects[ufind[*buf]].h = MAX(rects[ufind[*buf]].h,
-                                               y - rects[ufind[*buf]].y + 1);
-                }
-                else { /* otherwise, start the rect */
-                    rects[ufind[*buf]].x = x;
-                    rects[ufind[*buf]].y = y;
-                    rects[ufind[*buf]].w = 1;
-                    rects[ufind[*buf]].h = 1;
-                }
+    for (label = 0; label <= relabel; label++) {
+        rects[label].h = 0; /* so we know if its a new rect or not */
+    }
+
+    /* The runs are in row order, so the first run of a component is in its
+     * top row and the last run is in its bottom row. */
+    for (run = runs; run < runs + num_runs; ++run) {
+        rect = rects + run->label;
+        if (rect->h) { /* the component has a rect */
+            if (run->x0 < rect->x) {
+                rect->w += rect->x - run->x0;
+                rect->x = run->x0;
             }
-            buf++;
+            rect->w = MAX(rect->w, run->x1 - rect->x);
+            rect->h = run->y - rect->y + 1;
+        }
+        else { /* otherwise, start the rect */
+            rect->x = run->x0;
+            rect->y = run->y;
+            rect->w = run->x1 - run->x0;
+            rect->h = 1;
         }
     }
 
-    free(image);
-    free(ufind);
-    free(largest);
+    free(runs);
+    *num_bounding_boxes = relabel;
     *ret_rects = rects;
 
     return 0;
@@ -1543,105 +2408,45 @@ mask_get_bounding_rects(PyObject *self, PyObject *args)
 static int
 get_connected_components(bitmask_t *mask, bitmask_t ***components, int min)
 {
-    unsigned int *image, *ufind, *largest, *buf;
-    unsigned int x_uf, min_cc, label = 0;
-    int x, y, w, h, relabel;
+    cc_run *runs, *run;
+    unsigned int num_runs;
+    int x, relabel;
     bitmask_t **comps;
 
-    w = mask->w;
-    h = mask->h;
-
-    if (!w || !h) {
-        return 0;
-    }
-
-    /* a temporary image to assign labels to each bit of the mask */
-    image = (unsigned int *)malloc(sizeof(int) * w * h);
-    if (!image) {
-        return -2;
-    }
-
-    /* allocate enough space for the maximum possible connected components */
-    /* the union-find array. see wikipedia for info on union find */
-    ufind = (unsigned int *)malloc(sizeof(int) * (w / 2 + 1) * (h / 2 + 1));
-    if (!ufind) {
-        free(image);
-        return -2;
-    }
-
-    largest = (unsigned int *)malloc(sizeof(int) * (w / 2 + 1) * (h / 2 + 1));
-    if (!largest) {
-        free(image);
-        free(ufind);
-        return -2;
-    }
-
-    /* do the initial labelling */
-    label = cc_label(mask, image, ufind, largest);
-
-    for (x_uf = 1; x_uf <= label; ++x_uf) {
-        if (ufind[x_uf] < x_uf) {
-            largest[ufind[x_uf]] += largest[x_uf];
-        }
-    }
-
-    relabel = 0;
-    min_cc = (0 < min) ? (unsigned int)min : 0;
-
-    /* flatten and relabel the union-find equivalence array.  Start at label 1
-       because label 0 indicates an unset pixel.  For this reason, we also use
-       <= label rather than < label. */
-    for (x_uf = 1; x_uf <= label; ++x_uf) {
-        if (ufind[x_uf] < x_uf) {             /* is it a union find root? */
-            ufind[x_uf] = ufind[ufind[x_uf]]; /* relabel it to its root */
-        }
-        else { /* its a root */
-            if (largest[x_uf] >= min_cc) {
-                relabel++;
-                ufind[x_uf] = relabel; /* assign the lowest label available */
-            }
-            else {
-                ufind[x_uf] = 0;
-            }
-        }
-    }
-
-    if (relabel == 0) {
-        /* early out, as we didn't find anything. */
-        free(image);
-        free(ufind);
-        free(largest);
-        return 0;
+    relabel = cc_label(mask, (0 < min) ? (unsigned int)min : 0, &runs,
+                       &num_runs);
+    if (relabel <= 0) {
+        return relabel;
     }
 
     /* allocate space for the mask array */
     comps = (bitmask_t **)malloc(sizeof(bitmask_t *) * (relabel + 1));
     if (!comps) {
-        free(image);
-        free(ufind);
-        free(largest);
+        free(runs);
         return -2;
     }
 
     /* create the empty masks */
     for (x = 1; x <= relabel; x++) {
-        comps[x] = bitmask_create(w, h);
+        comps[x] = bitmask_create(mask->w, mask->h);
+        if (!comps[x]) {
+            while (--x > 0) {
+                bitmask_free(comps[x]);
+            }
+            free(comps);
+            free(runs);
+            return -2;
+        }
     }
 
-    /* set the bits in each mask */
-    buf = image;
-    for (y = 0; y < h; y++) {
-        for (x = 0; x < w; x++) {
-            if (ufind[*buf]) { /* if the pixel is part of a component */
-                bitmask_setbit(comps[ufind[*buf]], x, y);
-            }
-            buf++;
+    /* set the bits of each run in its component's mask */
+    for (run = runs; run < runs + num_runs; ++run) {
+        if (run->label) {
+            cc_draw_run(comps[run->label], run);
         }
     }
 
-    free(image);
-    free(ufind);
-    free(largest);
+    free(runs);
 
     *components = comps;
 
@@ -1719,9 +2524,9 @@ mask_connected_components(PyObject *self, PyObject *args, PyObject *kwargs)
 
 /* Finds the largest connected component in a given mask.
  *
- * Tracks the number of pixels in each label, finding the biggest one while
- * flattening the union-find equivalence array. It then writes an output mask
- * containing only the largest connected component.
+ * Counts the number of pixels in each component, finding the biggest one
+ * (the first one found if several are the biggest). It then writes an output
+ * mask containing only the largest connected component.
  *
  * Params:
  *     input - mask to search in for the largest connected component
@@ -1738,71 +2543,196 @@ mask_connected_components(PyObject *self, PyObject *args, PyObject *kwargs)
 static int
 largest_connected_comp(bitmask_t *input, bitmask_t *output, int ccx, int ccy)
 {
-    unsigned int *image, *ufind, *largest, *buf;
-    unsigned int max, x, y, w, h, label;
+    cc_run *runs, *run;
+    unsigned int num_runs, *areas;
+    int x, label, max = 0;
 
-    w = input->w;
-    h = input->h;
-
-    if (!w || !h) {
-        return 0;
+    label = cc_label(input, 0, &runs, &num_runs);
+    if (label <= 0) {
+        return label;
     }
 
-    /* a temporary image to assign labels to each bit of the mask */
-    image = (unsigned int *)malloc(sizeof(int) * w * h);
-    if (!image) {
-        return -2;
-    }
-    /* allocate enough space for the maximum possible connected components */
-    /* the union-find array. see wikipedia for info on union find */
-    ufind = (unsigned int *)malloc(sizeof(int) * (w / 2 + 1) * (h / 2 + 1));
-    if (!ufind) {
-        free(image);
-        return -2;
-    }
-    /* an array to track the number of pixels associated with each label */
-    largest = (unsigned int *)malloc(sizeof(int) * (w / 2 + 1) * (h / 2 + 1));
-    if (!largest) {
-        free(image);
-        free(ufind);
-        return -2;
+    if (ccx >= 0) {
+        for (run = runs; run < runs + num_runs; ++run) {
+            if (run->y == ccy && run->x0 <= ccx && ccx < run->x1) {
+                max = run->label;
+                break;
+            }
+        }
     }
-
-    /* do the initial labelling */
-    label = cc_label(input, image, ufind, largest);
-
-    max = 1;
-    /* flatten the union-find equivalence array */
-    for (x = 2; x <= label; x++) {
-        if (ufind[x] != x) {                 /* is it a union find root? */
-            largest[ufind[x]] += largest[x]; /* add its pixels to its root */
-            ufind[x] = ufind[ufind[x]];      /* relabel it to its root */
+    else {
+        areas = (unsigned int *)calloc(label + 1, sizeof(unsigned int));
+        if (!areas) {
+            free(runs);
+            return -2;
+        }
+        for (run = runs; run < runs + num_runs; ++run) {
+            areas[run->label] += run->x1 - run->x0;
         }
-        if (largest[ufind[x]] > largest[max]) { /* is it the new biggest? */
-            max = ufind[x];
+        for (max = 1, x = 2; x <= label; ++x) {
+            if (areas[x] > areas[max]) {
+                max = x;
+            }
         }
+        free(areas);
     }
 
-    /* write out the final image */
-    buf = image;
-    if (ccx >= 0)
-        max = ufind[*(buf + ccy * w + ccx)];
-    for (y = 0; y < h; y++) {
-        for (x = 0; x < w; x++) {
-            if (ufind[*buf] == max) {         /* if the label is the max one */
-                bitmask_setbit(output, x, y); /* set the bit in the mask */
-            }
-            buf++;
+    /* write out the runs of the chosen component */
+    for (run = runs; run < runs + num_runs; ++run) {
+        if (run->label == (unsigned int)max) {
+            cc_draw_run(output, run);
         }
     }
 
-    free(image);
-    free(ufind);
-    free(largest);
+    free(runs);
 
     return 0;
 }
 
+/* The area, bounding rect and coordinate sums of a connected component. */
+typedef struct {
+    long long area, xsum, ysum;
+    int left, top, right, bottom;
+} cc_stats;
+
+/* Labels the connected components of a mask, writing the label of the bit
+ * at (x, y) to labels[x * h + y] and the stats of each component to
+ * stats[label - 1].
+ *
+ * Allocates memory for stats.
+ *
+ * NOTE: Caller is responsible for freeing the "ret_stats" memory.
+ *
+ * Returns:
+ *     the number of connected components (>= 0)
+ *     -2 on memory allocation error
+ */
+static int
+label_connected_components(bitmask_t *mask, int min, Uint32 *labels,
+                           cc_stats **ret_stats)
+{
+    cc_run *runs, *run;
+    cc_stats *stats, *stat;
+    unsigned int num_runs;
+    int x, relabel;
+    long long length;
+
+    *ret_stats = NULL;
+
+    relabel = cc_label(mask, (0 < min) ? (unsigned int)min : 0, &runs,
+                       &num_runs);
+    if (relabel <= 0) {
+        return relabel;
+    }
+
+    stats = (cc_stats *)calloc(relabel, sizeof(cc_stats));
+    if (!stats) {
+        free(runs);
+        return -2;
+    }
+
+    for (run = runs; run < runs + num_runs; ++run) {
+        if (!run->label) {
+            continue;
+        }
+        for (x = run->x0; x < run->x1; ++x) {
+            labels[(size_t)x * mask->h + run->y] = run->label;
+        }
+
+        stat = stats + run->label - 1;
+        length = run->x1 - run->x0;
+        if (!stat->area) {
+            stat->left = run->x0;
+            stat->top = run->y;
+            stat->right = run->x1;
+        }
+        stat->left = MIN(stat->left, run->x0);
+        stat->right = MAX(stat->right, run->x1);
+        stat->bottom = run->y + 1;
+        stat->area += length;
+        stat->xsum += length * (run->x0 + run->x1 - 1) / 2;
+        stat->ysum += length * run->y;
+    }
+
+    free(runs);
+    *ret_stats = stats;
+
+    return relabel;
+}
+
+static PyObject *
+mask_label_connected_components(PyObject *self, PyObject *args,
+                                PyObject *kwargs)
+{
+    bitmask_t *mask = pgMask_AsBitmap(self);
+    PyObject *data, *view, *stats_list, *item, *rect;
+    cc_stats *stats = NULL, *stat;
+    int i, num_components = 0, min = 0; /* Default min value. */
+    static char *keywords[] = {"minimum", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|i", keywords, &min)) {
+        return NULL; /* Exception already set. */
+    }
+
+    data = PyByteArray_FromStringAndSize(
+        NULL, (Py_ssize_t)mask->w * mask->h * sizeof(Uint32));
+    if (!data) {
+        return NULL; /* Exception already set. */
+    }
+
+    if (mask->w && mask->h) {
+        Py_BEGIN_ALLOW_THREADS;
+        memset(PyByteArray_AS_STRING(data), 0,
+               (size_t)mask->w * mask->h * sizeof(Uint32));
+        num_components = label_connected_components(
+            mask, min, (Uint32 *)PyByteArray_AS_STRING(data), &stats);
+        Py_END_ALLOW_THREADS;
+    }
+
+    if (num_components == -2) {
+        Py_DECREF(data);
+        return RAISE(PyExc_MemoryError,
+                     "cannot allocate memory for connected components");
+    }
+
+    stats_list = PyList_New(num_components);
+    if (!stats_list) {
+        Py_DECREF(data);
+        free(stats);
+        return NULL; /* Exception already set. */
+    }
+
+    for (i = 0; i < num_components; ++i) {
+        stat = stats + i;
+        rect = pgRect_New4(stat->left, stat->top, stat->right - stat->left,
+                           stat->bottom - stat->top);
+        if (!rect) {
+            break;
+        }
+        item = Py_BuildValue("(LN(LL))", stat->area, rect,
+                             stat->xsum / stat->area, stat->ysum / stat->area);
+        if (!item) {
+            break;
+        }
+        PyList_SET_ITEM(stats_list, i, item);
+    }
+    free(stats);
+
+    if (i < num_components) {
+        Py_DECREF(data);
+        Py_DECREF(stats_list);
+        return NULL; /* Exception already set. */
+    }
+
+    view = shaped_view(data, "I", mask->w, mask->h);
+    if (!view) {
+        Py_DECREF(stats_list);
+        return NULL; /* Exception already set. */
+    }
+
+    return Py_BuildValue("(NN)", view, stats_list);
+}
+
 static PyObject *
 mask_connected_component(PyObject *self, PyObject *args, PyObject *kwargs)
 {
@@ -1909,6 +2839,183 @@ extract_color(SDL_Surface *surf, PyObject *color_obj, Uint8 rgba_color[],
     return 0; /* Exception already set. */
 }
 
+#if PG_HAS_SSE2_OR_NEON
+/* Returns the 32 bits of row y of the bitmask starting at x, in the low
+ * bits. Bits past the width of the bitmask are 0. */
+static PG_INLINE Uint32
+get_row_bits32(const bitmask_t *bitmask, int x, int y)
+{
+    int i = x / (int)BITMASK_W_LEN, shift = x & BITMASK_W_MASK;
+    BITMASK_W word = bitmask->bits[i * bitmask->h + y] >> shift;
+
+    if (shift && shift + 32 > (int)BITMASK_W_LEN &&
+        (i + 1) * (int)BITMASK_W_LEN < bitmask->w) {
+        word |= bitmask->bits[(i + 1) * bitmask->h + y]
+                << (BITMASK_W_LEN - shift);
+    }
+    return (Uint32)word;
+}
+
+/* Draws width bits of row ym of the bitmask, starting at xm, onto a row of
+ * 32 bit pixels. The set bits take their color from setsrc, else setcolor,
+ * else the pixel is left alone, and the same goes for the unset bits.
+ *
+ * The bits are read 32 at a time and each group of 4 bits is spread into a
+ * lane mask that picks between the set and unset colors, so 4 pixels are
+ * written with one store.
+ */
+static void
+draw_row_sse2(Uint32 *dst, int width, const bitmask_t *bitmask, int xm,
+              int ym, const Uint32 *setsrc, const Uint32 *setcolor,
+              const Uint32 *unsetsrc, const Uint32 *unsetcolor)
+{
+    const __m128i lanes = _mm_set_epi32(8, 4, 2, 1);
+    __m128i setv = _mm_setzero_si128(), unsetv = _mm_setzero_si128(), sel;
+    Uint32 bits, chunk;
+    int x, i, n;
+    int keep_set = !setsrc && !setcolor;
+    int keep_unset = !unsetsrc && !unsetcolor;
+
+    if (NULL != setcolor) {
+        setv = _mm_set1_epi32((int)*setcolor);
+    }
+    if (NULL != unsetcolor) {
+        unsetv = _mm_set1_epi32((int)*unsetcolor);
+    }
+
+    for (x = 0; x < width; x += 32) {
+        n = MIN(32, width - x);
+        chunk = (n == 32) ? 0xffffffffu : (1u << n) - 1;
+        bits = get_row_bits32(bitmask, xm + x, ym) & chunk;
+
+        /* Skip the pixels that would all be left alone. */
+        if ((keep_unset && !bits) || (keep_set && bits == chunk)) {
+            continue;
+        }
+
+        for (i = 0; i + 4 <= n; i += 4, bits >>= 4) {
+            sel = _mm_set1_epi32((int)(bits & 0xf));
+            sel = _mm_cmpeq_epi32(_mm_and_si128(sel, lanes), lanes);
+
+            if (NULL != setsrc) {
+                setv = _mm_loadu_si128((const __m128i *)(setsrc + x + i));
+            }
+            else if (keep_set) {
+                setv = _mm_loadu_si128((const __m128i *)(dst + x + i));
+            }
+            if (NULL != unsetsrc) {
+                unsetv = _mm_loadu_si128((const __m128i *)(unsetsrc + x + i));
+            }
+            else if (keep_unset) {
+                unsetv = _mm_loadu_si128((const __m128i *)(dst + x + i));
+            }
+
+            _mm_storeu_si128((__m128i *)(dst + x + i),
+                             _mm_or_si128(_mm_and_si128(sel, setv),
+                                          _mm_andnot_si128(sel, unsetv)));
+        }
+
+        for (; i < n; ++i, bits >>= 1) {
+            if (bits & 1) {
+                if (NULL != setsrc) {
+                    dst[x + i] = setsrc[x + i];
+                }
+                else if (NULL != setcolor) {
+                    dst[x + i] = *setcolor;
+                }
+            }
+            else if (NULL != unsetsrc) {
+                dst[x + i] = unsetsrc[x + i];
+            }
+            else if (NULL != unsetcolor) {
+                dst[x + i] = *unsetcolor;
+            }
+        }
+    }
+}
+
+/* Checks if the pixels of two surfaces share any memory. */
+static int
+surfaces_overlap(SDL_Surface *a, SDL_Surface *b)
+{
+    Uint8 *a_start = (Uint8 *)a->pixels, *b_start = (Uint8 *)b->pixels;
+
+    return a_start < b_start + (size_t)b->pitch * b->h &&
+           b_start < a_start + (size_t)a->pitch * a->h;
+}
+
+/* Draws a mask on a 32 bit surface with draw_row_sse2(). Takes the same
+ * arguments as draw_to_surface(), with the area to draw already clipped.
+ *
+ * Each row is split where setsurf or unsetsurf end, so every part of it
+ * takes its set and unset colors from one place.
+ */
+static void
+draw_to_surface_sse2(SDL_Surface *surf, bitmask_t *bitmask, int x_start,
+                     int y_start, int x_end, int y_end, int xm_start,
+                     int ym_start, int draw_setbits, int draw_unsetbits,
+                     SDL_Surface *setsurf, SDL_Surface *unsetsurf,
+                     Uint32 *setcolor, Uint32 *unsetcolor)
+{
+    const Uint32 *setsrc, *unsetsrc, *setrow, *unsetrow;
+    Uint32 *dst;
+    int y, ym, xm_end = xm_start + x_end - x_start;
+    int bounds[4], num_bounds, i, a, b;
+
+    if (!draw_setbits) {
+        setsurf = NULL;
+        setcolor = NULL;
+    }
+    if (!draw_unsetbits) {
+        unsetsurf = NULL;
+        unsetcolor = NULL;
+    }
+
+    for (y = y_start, ym = ym_start; y < y_end; ++y, ++ym) {
+        dst = (Uint32 *)((Uint8 *)surf->pixels + y * surf->pitch) + x_start;
+        setrow = (NULL != setsurf && setsurf->h > ym)
+                     ? (Uint32 *)((Uint8 *)setsurf->pixels +
+                                  ym * setsurf->pitch)
+                     : NULL;
+        unsetrow = (NULL != unsetsurf && unsetsurf->h > ym)
+                       ? (Uint32 *)((Uint8 *)unsetsurf->pixels +
+                                    ym * unsetsurf->pitch)
+                       : NULL;
+
+        /* The bounds of the parts of the row, in bitmask coordinates. */
+        num_bounds = 0;
+        bounds[num_bounds++] = xm_start;
+        if (NULL != setrow && setsurf->w > xm_start && setsurf->w < xm_end) {
+            bounds[num_bounds++] = setsurf->w;
+        }
+        if (NULL != unsetrow && unsetsurf->w > xm_start &&
+            unsetsurf->w < xm_end) {
+            bounds[num_bounds++] = unsetsurf->w;
+        }
+        bounds[num_bounds++] = xm_end;
+        if (num_bounds == 4 && bounds[1] > bounds[2]) {
+            a = bounds[1];
+            bounds[1] = bounds[2];
+            bounds[2] = a;
+        }
+
+        for (i = 0; i + 1 < num_bounds; ++i) {
+            a = bounds[i];
+            b = bounds[i + 1];
+            if (a == b) {
+                continue;
+            }
+            setsrc = (NULL != setrow && setsurf->w > a) ? setrow + a : NULL;
+            unsetsrc =
+                (NULL != unsetrow && unsetsurf->w > a) ? unsetrow + a : NULL;
+            draw_row_sse2(dst + (a - xm_start), b - a, bitmask, a, ym, setsrc,
+                          setsrc ? NULL : setcolor, unsetsrc,
+                          unsetsrc ? NULL : unsetcolor);
+        }
+    }
+}
+#endif /* PG_HAS_SSE2_OR_NEON */
+
 /* Draws a mask on a surface.
  *
  * Params:
@@ -1964,6 +3071,20 @@ draw_to_surface(SDL_Surface *surf, bitmask_t *bitmask, int x_dest, int y_dest,
     y_start = (y_dest > 0) ? y_dest : 0;
     y_end = MIN(surf->h, bitmask->h + y_dest);
 
+#if PG_HAS_SSE2_OR_NEON
+    /* The SIMD rows read a pixel's source color before writing it 4 pixels
+     * at a time, so surfaces drawing onto themselves take the slow path to
+     * keep the results the same. */
+    if (bpp == 4 && pg_HasSSE_NEON() &&
+        (NULL == setsurf || !surfaces_overlap(surf, setsurf)) &&
+        (NULL == unsetsurf || !surfaces_overlap(surf, unsetsurf))) {
+        draw_to_surface_sse2(surf, bitmask, x_start, y_start, x_end, y_end,
+                             xm_start, ym_start, draw_setbits, draw_unsetbits,
+                             setsurf, unsetsurf, setcolor, unsetcolor);
+        return;
+    }
+#endif /* PG_HAS_SSE2_OR_NEON */
+
     if (NULL == setsurf && NULL == unsetsurf) {
         /* Draw just using color values. No surfaces. */
         draw_setbits = draw_setbits && NULL != setcolor;
@@ -2319,6 +3440,8 @@ static PyMethodDef mask_methods[] = {
     DOC_MASKSETAT},
     {"overlap", (PyCFunction)mask_overlap, METH_VARARGS | METH_KEYWORDS, 
     DOC_MASKOVERLAP},
+    {"overlap_many", (PyCFunction)mask_overlap_many,
+     METH_VARARGS | METH_KEYWORDS, DOC_MASKOVERLAPMANY},
     {"overlap_area", (PyCFunction)mask_overlap_area, METH_VARARGS | METH_KEYWORDS,
      DOC_MASKOVERLAPAREA},
     {"overlap_mask", (PyCFunction)mask_overlap_mask, METH_VARARGS | METH_KEYWORDS,
@@ -2328,6 +3451,10 @@ static PyMethodDef mask_methods[] = {
     {"invert", mask_invert, METH_NOARGS, DOC_MASKINVERT},
     {"scale", (PyCFunction)mask_scale, METH_VARARGS | METH_KEYWORDS, 
     DOC_MASKSCALE},
+    {"rotate", (PyCFunction)mask_rotate, METH_VARARGS | METH_KEYWORDS,
+     DOC_MASKROTATE},
+    {"transform", (PyCFunction)mask_transform, METH_VARARGS | METH_KEYWORDS,
+     DOC_MASKTRANSFORM},
     {"draw", (PyCFunction)mask_draw, METH_VARARGS | METH_KEYWORDS, 
     DOC_MASKDRAW},
     {"erase", (PyCFunction)mask_erase, METH_VARARGS | METH_KEYWORDS, 
@@ -2339,10 +3466,23 @@ static PyMethodDef mask_methods[] = {
      DOC_MASKOUTLINE},
     {"convolve", (PyCFunction)mask_convolve, METH_VARARGS | METH_KEYWORDS, 
     DOC_MASKCONVOLVE},
+    {"dilate", (PyCFunction)mask_dilate, METH_VARARGS | METH_KEYWORDS,
+     DOC_MASKDILATE},
+    {"erode", (PyCFunction)mask_erode, METH_VARARGS | METH_KEYWORDS,
+     DOC_MASKERODE},
+    {"open", (PyCFunction)mask_open, METH_VARARGS | METH_KEYWORDS,
+     DOC_MASKOPEN},
+    {"close", (PyCFunction)mask_close, METH_VARARGS | METH_KEYWORDS,
+     DOC_MASKCLOSE},
+    {"distance_transform", mask_distance_transform, METH_NOARGS,
+     DOC_MASKDISTANCETRANSFORM},
     {"connected_component", (PyCFunction)mask_connected_component, METH_VARARGS | METH_KEYWORDS,
      DOC_MASKCONNECTEDCOMPONENT},
     {"connected_components", (PyCFunction)mask_connected_components, METH_VARARGS | METH_KEYWORDS,
      DOC_MASKCONNECTEDCOMPONENTS},
+    {"label_connected_components",
+     (PyCFunction)mask_label_connected_components,
+     METH_VARARGS | METH_KEYWORDS, DOC_MASKLABELCONNECTEDCOMPONENTS},
     {"get_bounding_rects", mask_get_bounding_rects, METH_NOARGS,
      DOC_MASKGETBOUNDINGRECTS},
     {"to_surface", (PyCFunction)mask_to_surface, METH_VARARGS | METH_KEYWORDS,
@@ -2582,67 +3722,1331 @@ static PyTypeObject pgMask_Type = {
     mask_new,           /* tp_new */
 };
 
-/*mask module methods*/
-static PyMethodDef _mask_methods[] = {
-    {"from_surface", (PyCFunction)mask_from_surface, METH_VARARGS | METH_KEYWORDS,
-     DOC_PYGAMEMASKFROMSURFACE},
-    {"from_threshold", (PyCFunction)mask_from_threshold, METH_VARARGS | METH_KEYWORDS,
-     DOC_PYGAMEMASKFROMTHRESHOLD},
-    {NULL, NULL, 0, NULL}};
+/*
+ * CollisionWorld: masks at offsets, checked against each other in one call.
+ *
+ * Entries live in slots and are found by their key through a dict. The
+ * broadphase is a sweep and prune over the bounding boxes of the entries,
+ * which are kept in a list sorted by their left edge. Entries only move a
+ * little between queries, so the insertion sort that re-sorts the list is
+ * close to linear. Boxes that overlap are then checked with
+ * bitmask_overlap().
+ */
+typedef struct {
+    PyObject *key; /* NULL if the slot is free */
+    PyObject *mask;
+    int x, y;
+    int in_boxes; /* the slot has a box in the sorted list */
+} _world_entry;
 
-MODINIT_DEFINE(mask)
+typedef struct {
+    Sint64 left, right, top, bottom;
+    Py_ssize_t slot;
+} _world_box;
+
+/* A box and its entry, holding references of its own. */
+typedef struct {
+    _world_box box;
+    PyObject *key;
+    PyObject *mask;
+    int x, y;
+} _world_item;
+
+typedef struct {
+    PyObject_HEAD PyObject *keys; /* key -> slot number */
+    _world_entry *entries;
+    Py_ssize_t num_slots, max_slots;
+    Py_ssize_t *free_slots;
+    Py_ssize_t num_free;
+    _world_box *boxes; /* max_slots long */
+    Py_ssize_t num_boxes;
+} pgCollisionWorldObject;
+
+/* Makes room for one more slot. Returns -1 with an exception set on
+ * failure. */
+static int
+_world_reserve(pgCollisionWorldObject *self)
 {
-    PyObject *module, *dict, *apiobj;
-    static void *c_api[PYGAMEAPI_MASK_NUMSLOTS];
+    Py_ssize_t max_slots = self->max_slots ? self->max_slots * 2 : 16;
+    _world_entry *entries;
+    Py_ssize_t *free_slots;
+    _world_box *boxes;
 
-    static struct PyModuleDef _module = {PyModuleDef_HEAD_INIT,
-                                         "mask",
-                                         DOC_PYGAMEMASK,
-                                         -1,
-                                         _mask_methods,
-                                         NULL,
-                                         NULL,
-                                         NULL,
-                                         NULL};
+    if (self->num_slots < self->max_slots || self->num_free) {
+        return 0;
+    }
 
-    /* imported needed apis; Do this first so if there is an error
-       the module is not loaded.
-    */
-    import_pygame_base();
-    if (PyErr_Occurred()) {
-        MODINIT_ERROR;
+    entries = PyMem_Resize(self->entries, _world_entry, max_slots);
+    if (!entries) {
+        PyErr_NoMemory();
+        return -1;
     }
-    import_pygame_color();
-    if (PyErr_Occurred()) {
-        MODINIT_ERROR;
+    self->entries = entries;
+    free_slots = PyMem_Resize(self->free_slots, Py_ssize_t, max_slots);
+    if (!free_slots) {
+        PyErr_NoMemory();
+        return -1;
     }
-    import_pygame_surface();
-    if (PyErr_Occurred()) {
-        MODINIT_ERROR;
+    self->free_slots = free_slots;
+    boxes = PyMem_Resize(self->boxes, _world_box, max_slots);
+    if (!boxes) {
+        PyErr_NoMemory();
+        return -1;
     }
-    import_pygame_rect();
-    if (PyErr_Occurred()) {
-        MODINIT_ERROR;
+    self->boxes = boxes;
+    self->max_slots = max_slots;
+    return 0;
+}
+
+/* Finds the slot of key.
+ *
+ * Returns:
+ *     the slot, or -1 with a KeyError (or other exception) set
+ */
+static Py_ssize_t
+_world_find(pgCollisionWorldObject *self, PyObject *key)
+{
+    PyObject *slot = PyDict_GetItemWithError(self->keys, key);
+
+    if (!slot) {
+        if (!PyErr_Occurred()) {
+            PyErr_SetObject(PyExc_KeyError, key);
+        }
+        return -1;
     }
+    return PyLong_AsSsize_t(slot);
+}
 
-    /* create the mask type */
-    if (PyType_Ready(&pgMask_Type) < 0) {
-        MODINIT_ERROR;
+/* Brings the sorted list of boxes up to date: drops the boxes of removed
+ * entries, adds boxes for new ones, updates the positions and sizes of
+ * the rest and sorts them by their left edge. */
+static void
+_world_update_boxes(pgCollisionWorldObject *self)
+{
+    _world_entry *entry;
+    _world_box *boxes = self->boxes, box;
+    bitmask_t *mask;
+    Py_ssize_t i, j, n = 0;
+
+    for (i = 0; i < self->num_boxes; ++i) {
+        entry = self->entries + boxes[i].slot;
+        if (!entry->key) {
+            entry->in_boxes = 0;
+            continue;
+        }
+        boxes[n++].slot = boxes[i].slot;
+    }
+    for (i = 0; i < self->num_slots; ++i) {
+        entry = self->entries + i;
+        if (entry->key && !entry->in_boxes) {
+            entry->in_boxes = 1;
+            boxes[n++].slot = i;
+        }
     }
+    self->num_boxes = n;
 
-    /* create the module */
-    module = PyModule_Create(&_module);
-    if (module == NULL) {
-        MODINIT_ERROR;
+    for (i = 0; i < n; ++i) {
+        entry = self->entries + boxes[i].slot;
+        mask = pgMask_AsBitmap(entry->mask);
+        boxes[i].left = entry->x;
+        boxes[i].right = (Sint64)entry->x + mask->w;
+        boxes[i].top = entry->y;
+        boxes[i].bottom = (Sint64)entry->y + mask->h;
     }
-    dict = PyModule_GetDict(module);
-    if (PyDict_SetItemString(dict, "MaskType", (PyObject *)&pgMask_Type) ==
-        -1) {
-        DECREF_MOD(module);
-        MODINIT_ERROR;
+
+    for (i = 1; i < n; ++i) {
+        if (boxes[i].left >= boxes[i - 1].left) {
+            continue;
+        }
+        box = boxes[i];
+        for (j = i; j > 0 && boxes[j - 1].left > box.left; --j) {
+            boxes[j] = boxes[j - 1];
+        }
+        boxes[j] = box;
     }
+}
 
-    if (PyDict_SetItemString(dict, "Mask", (PyObject *)&pgMask_Type) == -1) {
+/* Brings the boxes up to date and copies them with their entries, in
+ * order. Building the results of a sweep can run Python code (a finalizer
+ * called by the garbage collector) that changes the world, so the sweep
+ * goes over this copy. Returns NULL with an exception set on failure. */
+static _world_item *
+_world_items_new(pgCollisionWorldObject *self, Py_ssize_t *count)
+{
+    _world_item *items;
+    _world_entry *entry;
+    Py_ssize_t i;
+
+    _world_update_boxes(self);
+    items = PyMem_New(_world_item, self->num_boxes + 1);
+    if (!items) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+    for (i = 0; i < self->num_boxes; ++i) {
+        entry = self->entries + self->boxes[i].slot;
+        items[i].box = self->boxes[i];
+        items[i].key = entry->key;
+        Py_INCREF(entry->key);
+        items[i].mask = entry->mask;
+        Py_INCREF(entry->mask);
+        items[i].x = entry->x;
+        items[i].y = entry->y;
+    }
+    *count = self->num_boxes;
+    return items;
+}
+
+static void
+_world_items_free(_world_item *items, Py_ssize_t count)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < count; ++i) {
+        Py_DECREF(items[i].key);
+        Py_DECREF(items[i].mask);
+    }
+    PyMem_Free(items);
+}
+
+/* Frees every entry. */
+static void
+_world_clear(pgCollisionWorldObject *self)
+{
+    Py_ssize_t i;
+
+    for (i = 0; i < self->num_slots; ++i) {
+        Py_CLEAR(self->entries[i].key);
+        Py_CLEAR(self->entries[i].mask);
+    }
+    self->num_slots = 0;
+    self->num_free = 0;
+    self->num_boxes = 0;
+    if (self->keys) {
+        PyDict_Clear(self->keys);
+    }
+}
+
+static PyObject *
+world_add(pgCollisionWorldObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *key, *maskobj, *offset, *slotobj;
+    _world_entry *entry;
+    Py_ssize_t slot;
+    int x, y;
+    static char *keywords[] = {"key", "mask", "offset", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO!O", keywords, &key,
+                                     &pgMask_Type, &maskobj, &offset)) {
+        return NULL;
+    }
+
+    if (!pg_TwoIntsFromObj(offset, &x, &y)) {
+        return RAISE(PyExc_TypeError, "offset must be two numbers");
+    }
+
+    slotobj = PyDict_GetItemWithError(self->keys, key);
+    if (slotobj) {
+        /* Already in the world, replace its mask and offset. */
+        entry = self->entries + PyLong_AsSsize_t(slotobj);
+        Py_INCREF(maskobj);
+        Py_SETREF(entry->mask, maskobj);
+        entry->x = x;
+        entry->y = y;
+        Py_RETURN_NONE;
+    }
+    if (PyErr_Occurred() || _world_reserve(self)) {
+        return NULL;
+    }
+
+    /* The slot is taken before the dict hashes and compares the key, which
+     * can run Python code that adds or removes other entries. */
+    if (self->num_free) {
+        slot = self->free_slots[--self->num_free];
+    }
+    else {
+        slot = self->num_slots++;
+        self->entries[slot].in_boxes = 0;
+    }
+    entry = self->entries + slot;
+    Py_INCREF(key);
+    entry->key = key;
+    Py_INCREF(maskobj);
+    entry->mask = maskobj;
+    entry->x = x;
+    entry->y = y;
+
+    slotobj = PyLong_FromSsize_t(slot);
+    if (!slotobj || PyDict_SetItem(self->keys, key, slotobj)) {
+        Py_XDECREF(slotobj);
+        entry = self->entries + slot;
+        Py_CLEAR(entry->key);
+        Py_CLEAR(entry->mask);
+        self->free_slots[self->num_free++] = slot;
+        return NULL;
+    }
+    Py_DECREF(slotobj);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+world_move(pgCollisionWorldObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *key, *offset;
+    Py_ssize_t slot;
+    int x, y;
+    static char *keywords[] = {"key", "offset", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO", keywords, &key,
+                                     &offset)) {
+        return NULL;
+    }
+
+    if (!pg_TwoIntsFromObj(offset, &x, &y)) {
+        return RAISE(PyExc_TypeError, "offset must be two numbers");
+    }
+
+    slot = _world_find(self, key);
+    if (slot < 0) {
+        return NULL;
+    }
+    self->entries[slot].x = x;
+    self->entries[slot].y = y;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+world_remove(pgCollisionWorldObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *key, *stored;
+    _world_entry *entry;
+    Py_ssize_t slot;
+    static char *keywords[] = {"key", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", keywords, &key)) {
+        return NULL;
+    }
+
+    slot = _world_find(self, key);
+    if (slot < 0) {
+        return NULL;
+    }
+
+    /* Removing the key from the dict compares keys, which can run Python
+     * code that changes the world, so the slot is only freed if it still
+     * holds the same entry. */
+    stored = self->entries[slot].key;
+    Py_INCREF(stored);
+    if (PyDict_DelItem(self->keys, key)) {
+        Py_DECREF(stored);
+        return NULL;
+    }
+
+    /* The box of the slot is dropped by the next query, unless the slot
+     * is used again first. */
+    entry = self->entries + slot;
+    if (entry->key == stored) {
+        Py_CLEAR(entry->key);
+        Py_CLEAR(entry->mask);
+        self->free_slots[self->num_free++] = slot;
+    }
+    Py_DECREF(stored);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+world_clear(pgCollisionWorldObject *self, PyObject *args)
+{
+    _world_clear(self);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+world_query(pgCollisionWorldObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *maskobj, *offset, *result;
+    bitmask_t *mask;
+    _world_entry *entry;
+    _world_box *box;
+    Sint64 right, bottom;
+    Py_ssize_t i;
+    int x, y;
+    static char *keywords[] = {"mask", "offset", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O", keywords,
+                                     &pgMask_Type, &maskobj, &offset)) {
+        return NULL;
+    }
+
+    if (!pg_TwoIntsFromObj(offset, &x, &y)) {
+        return RAISE(PyExc_TypeError, "offset must be two numbers");
+    }
+
+    mask = pgMask_AsBitmap(maskobj);
+    right = (Sint64)x + mask->w;
+    bottom = (Sint64)y + mask->h;
+
+    result = PyList_New(0);
+    if (!result) {
+        return NULL;
+    }
+
+    _world_update_boxes(self);
+
+    for (i = 0, box = self->boxes;
+         i < self->num_boxes && box->left < right; ++i, ++box) {
+        if (box->right <= x || box->top >= bottom || box->bottom <= y) {
+            continue;
+        }
+        entry = self->entries + box->slot;
+        if (bitmask_overlap(mask, pgMask_AsBitmap(entry->mask),
+                            entry->x - x, entry->y - y) &&
+            PyList_Append(result, entry->key)) {
+            Py_DECREF(result);
+            return NULL;
+        }
+    }
+
+    return result;
+}
+
+static PyObject *
+world_query_pairs(pgCollisionWorldObject *self, PyObject *args,
+                  PyObject *kwargs)
+{
+    PyObject *result, *pair;
+    _world_item *items, *item1, *item2, *end;
+    Py_ssize_t count_items;
+    bitmask_t *mask1, *mask2;
+    int point = 0, area = 0;
+    int xoffset, yoffset, x = 0, y = 0, count = 0;
+    static char *keywords[] = {"point", "area", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|pp", keywords, &point,
+                                     &area)) {
+        return NULL;
+    }
+
+    items = _world_items_new(self, &count_items);
+    if (!items) {
+        return NULL;
+    }
+    result = PyList_New(0);
+    if (!result) {
+        _world_items_free(items, count_items);
+        return NULL;
+    }
+    end = items + count_items;
+
+    for (item1 = items; item1 < end; ++item1) {
+        for (item2 = item1 + 1;
+             item2 < end && item2->box.left < item1->box.right; ++item2) {
+            if (item2->box.top >= item1->box.bottom ||
+                item1->box.top >= item2->box.bottom) {
+                continue;
+            }
+
+            /* The boxes overlap, so these offsets are less than the mask
+             * sizes. */
+            mask1 = pgMask_AsBitmap(item1->mask);
+            mask2 = pgMask_AsBitmap(item2->mask);
+            xoffset = (int)(item2->box.left - item1->box.left);
+            yoffset = (int)(item2->box.top - item1->box.top);
+
+            if (area) {
+                count = bitmask_overlap_area(mask1, mask2, xoffset, yoffset);
+                if (!count) {
+                    continue;
+                }
+            }
+            if (point) {
+                if (!bitmask_overlap_pos(mask1, mask2, xoffset, yoffset, &x,
+                                         &y)) {
+                    continue;
+                }
+            }
+            else if (!area &&
+                     !bitmask_overlap(mask1, mask2, xoffset, yoffset)) {
+                continue;
+            }
+
+            if (point && area) {
+                pair = Py_BuildValue("(OO(ii)i)", item1->key, item2->key,
+                                     item1->x + x, item1->y + y, count);
+            }
+            else if (point) {
+                pair = Py_BuildValue("(OO(ii))", item1->key, item2->key,
+                                     item1->x + x, item1->y + y);
+            }
+            else if (area) {
+                pair = Py_BuildValue("(OOi)", item1->key, item2->key, count);
+            }
+            else {
+                pair = PyTuple_Pack(2, item1->key, item2->key);
+            }
+            if (!pair || PyList_Append(result, pair)) {
+                Py_XDECREF(pair);
+                Py_DECREF(result);
+                _world_items_free(items, count_items);
+                return NULL;
+            }
+            Py_DECREF(pair);
+        }
+    }
+
+    _world_items_free(items, count_items);
+    return result;
+}
+
+static Py_ssize_t
+world_len(pgCollisionWorldObject *self)
+{
+    return PyDict_Size(self->keys);
+}
+
+static int
+world_contains(pgCollisionWorldObject *self, PyObject *key)
+{
+    return PyDict_Contains(self->keys, key);
+}
+
+static PyObject *
+world_repr(pgCollisionWorldObject *self)
+{
+    return Text_FromFormat("<CollisionWorld(%zd entries)>",
+                           PyDict_Size(self->keys));
+}
+
+static PyObject *
+world_new(PyTypeObject *subtype, PyObject *args, PyObject *kwargs)
+{
+    pgCollisionWorldObject *self =
+        (pgCollisionWorldObject *)subtype->tp_alloc(subtype, 0);
+
+    if (!self) {
+        return NULL;
+    }
+    self->keys = PyDict_New();
+    if (!self->keys) {
+        Py_DECREF(self);
+        return NULL;
+    }
+    return (PyObject *)self;
+}
+
+static int
+world_init(pgCollisionWorldObject *self, PyObject *args, PyObject *kwargs)
+{
+    static char *keywords[] = {NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, ":CollisionWorld",
+                                     keywords)) {
+        return -1;
+    }
+    return 0;
+}
+
+static int
+world_traverse(pgCollisionWorldObject *self, visitproc visit, void *arg)
+{
+    Py_ssize_t i;
+
+    Py_VISIT(self->keys);
+    for (i = 0; i < self->num_slots; ++i) {
+        Py_VISIT(self->entries[i].key);
+        Py_VISIT(self->entries[i].mask);
+    }
+    return 0;
+}
+
+static int
+world_tp_clear(pgCollisionWorldObject *self)
+{
+    _world_clear(self);
+    Py_CLEAR(self->keys);
+    return 0;
+}
+
+static void
+world_dealloc(pgCollisionWorldObject *self)
+{
+    PyObject_GC_UnTrack(self);
+    world_tp_clear(self);
+    PyMem_Free(self->entries);
+    PyMem_Free(self->free_slots);
+    PyMem_Free(self->boxes);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyMethodDef world_methods[] = {
+    {"add", (PyCFunction)world_add, METH_VARARGS | METH_KEYWORDS,
+     DOC_COLLISIONWORLDADD},
+    {"move", (PyCFunction)world_move, METH_VARARGS | METH_KEYWORDS,
+     DOC_COLLISIONWORLDMOVE},
+    {"remove", (PyCFunction)world_remove, METH_VARARGS | METH_KEYWORDS,
+     DOC_COLLISIONWORLDREMOVE},
+    {"clear", (PyCFunction)world_clear, METH_NOARGS, DOC_COLLISIONWORLDCLEAR},
+    {"query", (PyCFunction)world_query, METH_VARARGS | METH_KEYWORDS,
+     DOC_COLLISIONWORLDQUERY},
+    {"query_pairs", (PyCFunction)world_query_pairs,
+     METH_VARARGS | METH_KEYWORDS, DOC_COLLISIONWORLDQUERYPAIRS},
+    {NULL, NULL, 0, NULL}};
+
+static PySequenceMethods world_as_sequence = {
+    (lenfunc)world_len,          /* sq_length */
+    0,                           /* sq_concat */
+    0,                           /* sq_repeat */
+    0,                           /* sq_item */
+    0,                           /* was_sq_slice */
+    0,                           /* sq_ass_item */
+    0,                           /* was_sq_ass_slice */
+    (objobjproc)world_contains, /* sq_contains */
+};
+
+static PyTypeObject pgCollisionWorld_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0) "pygame.mask.CollisionWorld",
+    sizeof(pgCollisionWorldObject), /* tp_basicsize */
+    0,                              /* tp_itemsize */
+    (destructor)world_dealloc,      /* tp_dealloc */
+    0,                              /* tp_print */
+    0,                              /* tp_getattr */
+    0,                              /* tp_setattr */
+    0,                              /* tp_as_async */
+    (reprfunc)world_repr,           /* tp_repr */
+    0,                              /* tp_as_number */
+    &world_as_sequence,             /* tp_as_sequence */
+    0,                              /* tp_as_mapping */
+    0,                              /* tp_hash */
+    0,                              /* tp_call */
+    0,                              /* tp_str */
+    0,                              /* tp_getattro */
+    0,                              /* tp_setattro */
+    0,                              /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE | Py_TPFLAGS_HAVE_GC,
+    DOC_PYGAMEMASKCOLLISIONWORLD,   /* tp_doc */
+    (traverseproc)world_traverse,   /* tp_traverse */
+    (inquiry)world_tp_clear,        /* tp_clear */
+    0,                              /* tp_richcompare */
+    0,                              /* tp_weaklistoffset */
+    0,                              /* tp_iter */
+    0,                              /* tp_iternext */
+    world_methods,                  /* tp_methods */
+    0,                              /* tp_members */
+    0,                              /* tp_getset */
+    0,                              /* tp_base */
+    0,                              /* tp_dict */
+    0,                              /* tp_descr_get */
+    0,                              /* tp_descr_set */
+    0,                              /* tp_dictoffset */
+    (initproc)world_init,           /* tp_init */
+    0,                              /* tp_alloc */
+    world_new,                      /* tp_new */
+};
+
+/*
+ * SparseMask: a mask split into tiles that are only allocated once bits are
+ * set in them.
+ *
+ * A NULL tile has no bits set. A tile with all its bits set points to one
+ * of the mask's shared full tiles (there is one per tile size, as the tiles
+ * on the right and bottom edges can be smaller), which is copied before a
+ * bit of it is cleared. Tiles are checked after each change, so empty tiles
+ * are freed and full ones shared again. This lets the checks against empty
+ * and full areas skip the bits.
+ */
+#define SPARSE_TILE_SHIFT 8
+#define SPARSE_TILE_SIZE (1 << SPARSE_TILE_SHIFT)
+
+typedef struct {
+    PyObject_HEAD int w, h;
+    int tiles_w, tiles_h; /* number of tiles across and down */
+    bitmask_t **tiles;    /* tiles_w * tiles_h tiles, by rows */
+    bitmask_t *full[4];   /* the shared full tiles, see sparse_full_tile() */
+} pgSparseMaskObject;
+
+/* The area covered by a mask at an offset, in tiles: [tx0, tx1) x [ty0,
+ * ty1). Empty if the mask is outside the sparse mask. */
+typedef struct {
+    int tx0, ty0, tx1, ty1;
+} sparse_span;
+
+static int
+sparse_tile_w(pgSparseMaskObject *self, int tx)
+{
+    return MIN(SPARSE_TILE_SIZE, self->w - (tx << SPARSE_TILE_SHIFT));
+}
+
+static int
+sparse_tile_h(pgSparseMaskObject *self, int ty)
+{
+    return MIN(SPARSE_TILE_SIZE, self->h - (ty << SPARSE_TILE_SHIFT));
+}
+
+/* Returns the shared full tile for tile (tx, ty), creating it if needed.
+ *
+ * Returns:
+ *     the tile, or NULL if memory can not be allocated
+ */
+static bitmask_t *
+sparse_full_tile(pgSparseMaskObject *self, int tx, int ty)
+{
+    int index = (tx == self->tiles_w - 1) + 2 * (ty == self->tiles_h - 1);
+    bitmask_t *tile = self->full[index];
+
+    if (!tile) {
+        tile = bitmask_create(sparse_tile_w(self, tx), sparse_tile_h(self, ty));
+        if (tile) {
+            bitmask_fill(tile);
+            self->full[index] = tile;
+        }
+    }
+    return tile;
+}
+
+static int
+sparse_is_full(pgSparseMaskObject *self, bitmask_t *tile)
+{
+    return tile && (tile == self->full[0] || tile == self->full[1] ||
+                    tile == self->full[2] || tile == self->full[3]);
+}
+
+/* Frees a tile, unless it is a shared full tile. */
+static void
+sparse_free_tile(pgSparseMaskObject *self, bitmask_t *tile)
+{
+    if (tile && !sparse_is_full(self, tile)) {
+        bitmask_free(tile);
+    }
+}
+
+/* Frees an empty tile and shares a full one after the tile is changed. */
+static void
+sparse_update_tile(pgSparseMaskObject *self, int tx, int ty)
+{
+    bitmask_t **tile = self->tiles + ty * self->tiles_w + tx;
+    bitmask_t *full;
+    unsigned int count;
+
+    if (!*tile || sparse_is_full(self, *tile)) {
+        return;
+    }
+
+    count = bitmask_count(*tile);
+    if (!count) {
+        bitmask_free(*tile);
+        *tile = NULL;
+    }
+    else if (count == (unsigned int)((*tile)->w * (*tile)->h)) {
+        full = sparse_full_tile(self, tx, ty);
+        if (full) {
+            bitmask_free(*tile);
+            *tile = full;
+        }
+    }
+}
+
+/* Makes the tile at (tx, ty) writable: allocates it if it is empty and
+ * copies it if it is a shared full tile.
+ *
+ * Returns:
+ *     the tile, or NULL with a MemoryError set
+ */
+static bitmask_t *
+sparse_writable_tile(pgSparseMaskObject *self, int tx, int ty)
+{
+    bitmask_t **tile = self->tiles + ty * self->tiles_w + tx;
+    bitmask_t *new_tile;
+
+    if (*tile && !sparse_is_full(self, *tile)) {
+        return *tile;
+    }
+
+    if (*tile) {
+        new_tile = bitmask_copy(*tile);
+    }
+    else {
+        new_tile = bitmask_create(sparse_tile_w(self, tx),
+                                  sparse_tile_h(self, ty));
+    }
+    if (!new_tile) {
+        PyErr_SetString(PyExc_MemoryError,
+                        "cannot allocate memory for bitmask");
+        return NULL;
+    }
+    *tile = new_tile;
+    return new_tile;
+}
+
+/* Finds the tiles covered by a mask of size (w, h) at (x, y). */
+static sparse_span
+sparse_span_of(pgSparseMaskObject *self, int x, int y, int w, int h)
+{
+    sparse_span span;
+    Sint64 left = MAX(x, 0), top = MAX(y, 0);
+    Sint64 right = MIN((Sint64)x + w, self->w);
+    Sint64 bottom = MIN((Sint64)y + h, self->h);
+
+    if (left >= right || top >= bottom) {
+        span.tx0 = span.ty0 = span.tx1 = span.ty1 = 0;
+        return span;
+    }
+    span.tx0 = (int)(left >> SPARSE_TILE_SHIFT);
+    span.ty0 = (int)(top >> SPARSE_TILE_SHIFT);
+    span.tx1 = (int)(((right - 1) >> SPARSE_TILE_SHIFT) + 1);
+    span.ty1 = (int)(((bottom - 1) >> SPARSE_TILE_SHIFT) + 1);
+    return span;
+}
+
+/* Frees all the tiles. */
+static void
+sparse_clear(pgSparseMaskObject *self)
+{
+    Py_ssize_t i, num_tiles = (Py_ssize_t)self->tiles_w * self->tiles_h;
+
+    if (!self->tiles) {
+        return;
+    }
+    for (i = 0; i < num_tiles; ++i) {
+        sparse_free_tile(self, self->tiles[i]);
+        self->tiles[i] = NULL;
+    }
+}
+
+/* Parses the (other, offset) arguments of the methods taking a mask.
+ *
+ * Returns:
+ *     the other mask, or NULL with an exception set
+ */
+static bitmask_t *
+sparse_parse_other(PyObject *args, PyObject *kwargs, int *x, int *y)
+{
+    PyObject *maskobj, *offset;
+    static char *keywords[] = {"other", "offset", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O", keywords,
+                                     &pgMask_Type, &maskobj, &offset)) {
+        return NULL;
+    }
+
+    if (!pg_TwoIntsFromObj(offset, x, y)) {
+        PyErr_SetString(PyExc_TypeError, "offset must be two numbers");
+        return NULL;
+    }
+
+    return pgMask_AsBitmap(maskobj);
+}
+
+/* Parses a position argument, checking it is in the mask.
+ *
+ * Returns:
+ *     1 on success, 0 with an exception set
+ */
+static int
+sparse_parse_pos(pgSparseMaskObject *self, PyObject *pos, int *x, int *y)
+{
+    if (!pg_TwoIntsFromObj(pos, x, y)) {
+        PyErr_SetString(PyExc_TypeError, "pos must be two numbers");
+        return 0;
+    }
+
+    if (*x < 0 || *x >= self->w || *y < 0 || *y >= self->h) {
+        PyErr_Format(PyExc_IndexError, "%d, %d is out of bounds", *x, *y);
+        return 0;
+    }
+    return 1;
+}
+
+static PyObject *
+sparse_get_size(pgSparseMaskObject *self, PyObject *args)
+{
+    return Py_BuildValue("(ii)", self->w, self->h);
+}
+
+static PyObject *
+sparse_get_at(pgSparseMaskObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *pos;
+    bitmask_t *tile;
+    int x, y;
+    static char *keywords[] = {"pos", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", keywords, &pos) ||
+        !sparse_parse_pos(self, pos, &x, &y)) {
+        return NULL;
+    }
+
+    tile = self->tiles[(y >> SPARSE_TILE_SHIFT) * self->tiles_w +
+                       (x >> SPARSE_TILE_SHIFT)];
+    return PyInt_FromLong(
+        tile ? bitmask_getbit(tile, x & (SPARSE_TILE_SIZE - 1),
+                              y & (SPARSE_TILE_SIZE - 1))
+             : 0);
+}
+
+static PyObject *
+sparse_set_at(pgSparseMaskObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *pos;
+    bitmask_t *tile;
+    int x, y, tx, ty, value = 1;
+    static char *keywords[] = {"pos", "value", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|i", keywords, &pos,
+                                     &value) ||
+        !sparse_parse_pos(self, pos, &x, &y)) {
+        return NULL;
+    }
+
+    tx = x >> SPARSE_TILE_SHIFT;
+    ty = y >> SPARSE_TILE_SHIFT;
+    tile = self->tiles[ty * self->tiles_w + tx];
+
+    /* Nothing changes when setting a bit of a full tile or clearing a bit
+     * of an empty tile. */
+    if (value ? sparse_is_full(self, tile) : !tile) {
+        Py_RETURN_NONE;
+    }
+
+    tile = sparse_writable_tile(self, tx, ty);
+    if (!tile) {
+        return NULL;
+    }
+    if (value) {
+        bitmask_setbit(tile, x & (SPARSE_TILE_SIZE - 1),
+                       y & (SPARSE_TILE_SIZE - 1));
+    }
+    else {
+        bitmask_clearbit(tile, x & (SPARSE_TILE_SIZE - 1),
+                         y & (SPARSE_TILE_SIZE - 1));
+    }
+    sparse_update_tile(self, tx, ty);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+sparse_overlap(pgSparseMaskObject *self, PyObject *args, PyObject *kwargs)
+{
+    bitmask_t *other, *tile;
+    sparse_span span;
+    int x, y, tx, ty, ox, oy, xp, yp;
+
+    other = sparse_parse_other(args, kwargs, &x, &y);
+    if (!other) {
+        return NULL;
+    }
+
+    span = sparse_span_of(self, x, y, other->w, other->h);
+    for (ty = span.ty0; ty < span.ty1; ++ty) {
+        for (tx = span.tx0; tx < span.tx1; ++tx) {
+            tile = self->tiles[ty * self->tiles_w + tx];
+            if (!tile) {
+                continue;
+            }
+            ox = tx << SPARSE_TILE_SHIFT;
+            oy = ty << SPARSE_TILE_SHIFT;
+            if (bitmask_overlap_pos(tile, other, x - ox, y - oy, &xp, &yp)) {
+                return Py_BuildValue("(ii)", ox + xp, oy + yp);
+            }
+        }
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+sparse_overlap_area(pgSparseMaskObject *self, PyObject *args,
+                    PyObject *kwargs)
+{
+    bitmask_t *other, *tile;
+    sparse_span span;
+    int x, y, tx, ty;
+    long area = 0;
+
+    other = sparse_parse_other(args, kwargs, &x, &y);
+    if (!other) {
+        return NULL;
+    }
+
+    span = sparse_span_of(self, x, y, other->w, other->h);
+    for (ty = span.ty0; ty < span.ty1; ++ty) {
+        for (tx = span.tx0; tx < span.tx1; ++tx) {
+            tile = self->tiles[ty * self->tiles_w + tx];
+            if (tile) {
+                area += bitmask_overlap_area(
+                    tile, other, x - (tx << SPARSE_TILE_SHIFT),
+                    y - (ty << SPARSE_TILE_SHIFT));
+            }
+        }
+    }
+
+    return PyInt_FromLong(area);
+}
+
+static PyObject *
+sparse_draw(pgSparseMaskObject *self, PyObject *args, PyObject *kwargs)
+{
+    bitmask_t *other, *tile;
+    sparse_span span;
+    int x, y, tx, ty;
+
+    other = sparse_parse_other(args, kwargs, &x, &y);
+    if (!other) {
+        return NULL;
+    }
+
+    span = sparse_span_of(self, x, y, other->w, other->h);
+    for (ty = span.ty0; ty < span.ty1; ++ty) {
+        for (tx = span.tx0; tx < span.tx1; ++tx) {
+            if (sparse_is_full(self, self->tiles[ty * self->tiles_w + tx])) {
+                continue;
+            }
+            tile = sparse_writable_tile(self, tx, ty);
+            if (!tile) {
+                return NULL;
+            }
+            bitmask_draw(tile, other, x - (tx << SPARSE_TILE_SHIFT),
+                         y - (ty << SPARSE_TILE_SHIFT));
+            sparse_update_tile(self, tx, ty);
+        }
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+sparse_erase(pgSparseMaskObject *self, PyObject *args, PyObject *kwargs)
+{
+    bitmask_t *other, *tile;
+    sparse_span span;
+    int x, y, tx, ty;
+
+    other = sparse_parse_other(args, kwargs, &x, &y);
+    if (!other) {
+        return NULL;
+    }
+
+    span = sparse_span_of(self, x, y, other->w, other->h);
+    for (ty = span.ty0; ty < span.ty1; ++ty) {
+        for (tx = span.tx0; tx < span.tx1; ++tx) {
+            tile = self->tiles[ty * self->tiles_w + tx];
+            if (!tile) {
+                continue;
+            }
+            /* Check before copying a full tile. */
+            if (sparse_is_full(self, tile) &&
+                !bitmask_overlap(tile, other, x - (tx << SPARSE_TILE_SHIFT),
+                                 y - (ty << SPARSE_TILE_SHIFT))) {
+                continue;
+            }
+            tile = sparse_writable_tile(self, tx, ty);
+            if (!tile) {
+                return NULL;
+            }
+            bitmask_erase(tile, other, x - (tx << SPARSE_TILE_SHIFT),
+                          y - (ty << SPARSE_TILE_SHIFT));
+            sparse_update_tile(self, tx, ty);
+        }
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+sparse_count(pgSparseMaskObject *self, PyObject *args)
+{
+    Py_ssize_t i, num_tiles = (Py_ssize_t)self->tiles_w * self->tiles_h;
+    bitmask_t *tile;
+    long long count = 0;
+
+    for (i = 0; i < num_tiles; ++i) {
+        tile = self->tiles[i];
+        if (sparse_is_full(self, tile)) {
+            count += (long long)tile->w * tile->h;
+        }
+        else if (tile) {
+            count += bitmask_count(tile);
+        }
+    }
+
+    return PyLong_FromLongLong(count);
+}
+
+static PyObject *
+sparse_fill(pgSparseMaskObject *self, PyObject *args)
+{
+    int tx, ty;
+    bitmask_t *full;
+
+    for (ty = 0; ty < self->tiles_h; ++ty) {
+        for (tx = 0; tx < self->tiles_w; ++tx) {
+            full = sparse_full_tile(self, tx, ty);
+            if (!full) {
+                return RAISE(PyExc_MemoryError,
+                             "cannot allocate memory for bitmask");
+            }
+            sparse_free_tile(self, self->tiles[ty * self->tiles_w + tx]);
+            self->tiles[ty * self->tiles_w + tx] = full;
+        }
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+sparse_clear_method(pgSparseMaskObject *self, PyObject *args)
+{
+    sparse_clear(self);
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+sparse_get_tile_count(pgSparseMaskObject *self, PyObject *args)
+{
+    Py_ssize_t i, num_tiles = (Py_ssize_t)self->tiles_w * self->tiles_h;
+    Py_ssize_t allocated = 0;
+
+    for (i = 0; i < num_tiles; ++i) {
+        if (self->tiles[i] && !sparse_is_full(self, self->tiles[i])) {
+            ++allocated;
+        }
+    }
+
+    return PyLong_FromSsize_t(allocated);
+}
+
+static PyObject *
+sparse_repr(pgSparseMaskObject *self)
+{
+    return Text_FromFormat("<SparseMask(%dx%d)>", self->w, self->h);
+}
+
+static int
+sparse_init(pgSparseMaskObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *size, *result;
+    bitmask_t **tiles;
+    size_t i, num_tiles;
+    int w, h, tiles_w, tiles_h, fill = 0;
+    static char *keywords[] = {"size", "fill", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|p", keywords, &size,
+                                     &fill)) {
+        return -1;
+    }
+
+    if (!pg_TwoIntsFromObj(size, &w, &h)) {
+        PyErr_SetString(PyExc_TypeError, "size must be two numbers");
+        return -1;
+    }
+
+    if (w < 0 || h < 0) {
+        PyErr_SetString(PyExc_ValueError,
+                        "cannot create mask with negative size");
+        return -1;
+    }
+
+    tiles_w = (int)(((Sint64)w + SPARSE_TILE_SIZE - 1) >> SPARSE_TILE_SHIFT);
+    tiles_h = (int)(((Sint64)h + SPARSE_TILE_SIZE - 1) >> SPARSE_TILE_SHIFT);
+    num_tiles = (size_t)tiles_w * tiles_h;
+
+    /* Allocate at least one pointer, PyMem_New(x, 0) may return NULL. */
+    tiles = PyMem_New(bitmask_t *, num_tiles ? num_tiles : 1);
+    if (!tiles) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    for (i = 0; i < num_tiles; ++i) {
+        tiles[i] = NULL;
+    }
+
+    /* Release the tiles of a previous __init__(). */
+    sparse_clear(self);
+    PyMem_Free(self->tiles);
+    for (i = 0; i < 4; ++i) {
+        if (self->full[i]) {
+            bitmask_free(self->full[i]);
+            self->full[i] = NULL;
+        }
+    }
+
+    self->w = w;
+    self->h = h;
+    self->tiles_w = tiles_w;
+    self->tiles_h = tiles_h;
+    self->tiles = tiles;
+
+    if (fill) {
+        result = sparse_fill(self, NULL);
+        if (!result) {
+            return -1;
+        }
+        Py_DECREF(result);
+    }
+    return 0;
+}
+
+static void
+sparse_dealloc(pgSparseMaskObject *self)
+{
+    int i;
+
+    sparse_clear(self);
+    PyMem_Free(self->tiles);
+    for (i = 0; i < 4; ++i) {
+        if (self->full[i]) {
+            bitmask_free(self->full[i]);
+        }
+    }
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyMethodDef sparse_methods[] = {
+    {"get_size", (PyCFunction)sparse_get_size, METH_NOARGS,
+     DOC_SPARSEMASKGETSIZE},
+    {"get_at", (PyCFunction)sparse_get_at, METH_VARARGS | METH_KEYWORDS,
+     DOC_SPARSEMASKGETAT},
+    {"set_at", (PyCFunction)sparse_set_at, METH_VARARGS | METH_KEYWORDS,
+     DOC_SPARSEMASKSETAT},
+    {"overlap", (PyCFunction)sparse_overlap, METH_VARARGS | METH_KEYWORDS,
+     DOC_SPARSEMASKOVERLAP},
+    {"overlap_area", (PyCFunction)sparse_overlap_area,
+     METH_VARARGS | METH_KEYWORDS, DOC_SPARSEMASKOVERLAPAREA},
+    {"draw", (PyCFunction)sparse_draw, METH_VARARGS | METH_KEYWORDS,
+     DOC_SPARSEMASKDRAW},
+    {"erase", (PyCFunction)sparse_erase, METH_VARARGS | METH_KEYWORDS,
+     DOC_SPARSEMASKERASE},
+    {"count", (PyCFunction)sparse_count, METH_NOARGS, DOC_SPARSEMASKCOUNT},
+    {"fill", (PyCFunction)sparse_fill, METH_NOARGS, DOC_SPARSEMASKFILL},
+    {"clear", (PyCFunction)sparse_clear_method, METH_NOARGS,
+     DOC_SPARSEMASKCLEAR},
+    {"get_tile_count", (PyCFunction)sparse_get_tile_count, METH_NOARGS,
+     DOC_SPARSEMASKGETTILECOUNT},
+    {NULL, NULL, 0, NULL}};
+
+static PyTypeObject pgSparseMask_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0) "pygame.mask.SparseMask",
+    sizeof(pgSparseMaskObject),              /* tp_basicsize */
+    0,                                       /* tp_itemsize */
+    (destructor)sparse_dealloc,              /* tp_dealloc */
+    0,                                       /* tp_print */
+    0,                                       /* tp_getattr */
+    0,                                       /* tp_setattr */
+    0,                                       /* tp_as_async */
+    (reprfunc)sparse_repr,                   /* tp_repr */
+    0,                                       /* tp_as_number */
+    0,                                       /* tp_as_sequence */
+    0,                                       /* tp_as_mapping */
+    0,                                       /* tp_hash */
+    0,                                       /* tp_call */
+    0,                                       /* tp_str */
+    0,                                       /* tp_getattro */
+    0,                                       /* tp_setattro */
+    0,                                       /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, /* tp_flags */
+    DOC_PYGAMEMASKSPARSEMASK,                /* tp_doc */
+    0,                                       /* tp_traverse */
+    0,                                       /* tp_clear */
+    0,                                       /* tp_richcompare */
+    0,                                       /* tp_weaklistoffset */
+    0,                                       /* tp_iter */
+    0,                                       /* tp_iternext */
+    sparse_methods,                          /* tp_methods */
+    0,                                       /* tp_members */
+    0,                                       /* tp_getset */
+    0,                                       /* tp_base */
+    0,                                       /* tp_dict */
+    0,                                       /* tp_descr_get */
+    0,                                       /* tp_descr_set */
+    0,                                       /* tp_dictoffset */
+    (initproc)sparse_init,                   /* tp_init */
+    0,                                       /* tp_alloc */
+    PyType_GenericNew,                       /* tp_new */
+};
+
+/*mask module methods*/
+static PyMethodDef _mask_methods[] = {
+    {"from_surface", (PyCFunction)mask_from_surface, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMEMASKFROMSURFACE},
+    {"from_threshold", (PyCFunction)mask_from_threshold, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMEMASKFROMTHRESHOLD},
+    {"rotation_cache", (PyCFunction)mask_rotation_cache,
+     METH_VARARGS | METH_KEYWORDS, DOC_PYGAMEMASKROTATIONCACHE},
+    {NULL, NULL, 0, NULL}};
+
+MODINIT_DEFINE(mask)
+{
+    PyObject *module, *dict, *apiobj;
+    static void *c_api[PYGAMEAPI_MASK_NUMSLOTS];
+
+    static struct PyModuleDef _module = {PyModuleDef_HEAD_INIT,
+                                         "mask",
+                                         DOC_PYGAMEMASK,
+                                         -1,
+                                         _mask_methods,
+                                         NULL,
+                                         NULL,
+                                         NULL,
+                                         NULL};
+
+    /* imported needed apis; Do this first so if there is an error
+       the module is not loaded.
+    */
+    import_pygame_base();
+    if (PyErr_Occurred()) {
+        MODINIT_ERROR;
+    }
+    import_pygame_color();
+    if (PyErr_Occurred()) {
+        MODINIT_ERROR;
+    }
+    import_pygame_surface();
+    if (PyErr_Occurred()) {
+        MODINIT_ERROR;
+    }
+    import_pygame_rect();
+    if (PyErr_Occurred()) {
+        MODINIT_ERROR;
+    }
+
+    /* before any thread can use the masks */
+    bitmask_init();
+
+    /* create the mask type */
+    if (PyType_Ready(&pgMask_Type) < 0) {
+        MODINIT_ERROR;
+    }
+    if (PyType_Ready(&pgCollisionWorld_Type) < 0) {
+        MODINIT_ERROR;
+    }
+    if (PyType_Ready(&pgSparseMask_Type) < 0) {
+        MODINIT_ERROR;
+    }
+
+    /* create the module */
+    module = PyModule_Create(&_module);
+    if (module == NULL) {
+        MODINIT_ERROR;
+    }
+    dict = PyModule_GetDict(module);
+    if (PyDict_SetItemString(dict, "MaskType", (PyObject *)&pgMask_Type) ==
+        -1) {
+        DECREF_MOD(module);
+        MODINIT_ERROR;
+    }
+
+    if (PyDict_SetItemString(dict, "Mask", (PyObject *)&pgMask_Type) == -1) {
+        DECREF_MOD(module);
+        MODINIT_ERROR;
+    }
+
+    if (PyDict_SetItemString(dict, "CollisionWorld",
+                             (PyObject *)&pgCollisionWorld_Type) == -1) {
+        DECREF_MOD(module);
+        MODINIT_ERROR;
+    }
+
+    if (PyDict_SetItemString(dict, "SparseMask",
+                             (PyObject *)&pgSparseMask_Type) == -1) {
         DECREF_MOD(module);
         MODINIT_ERROR;
     }
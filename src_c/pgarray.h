@@ -0,0 +1,235 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/*
+ *  Reading arrays of numbers through the buffer protocol, shared by the
+ *  batched functions of the draw, gfxdraw and mask modules.
+ *
+ *  Items are one of the struct module formats bBhHiIlLqQfd, in native
+ *  byte order, with either native ('@', or no prefix) or standard ('=',
+ *  '<' or '>') sizes. The buffer's itemsize has to match the format and
+ *  items are copied out with memcpy, so unaligned buffers are fine.
+ */
+#ifndef PG_ARRAY_H
+#define PG_ARRAY_H
+
+#include "pygame.h"
+
+#include <string.h>
+
+/* Finds the item kind and size of a buffer format.
+ *
+ * Returns the item size, or 0 if the format is not supported.
+ */
+static int
+_pg_array_item_size(const char *format, char *kind)
+{
+    int native = 1;
+
+    if (*format == '@') {
+        ++format;
+    }
+    else if (*format == '=' ||
+             *format == (SDL_BYTEORDER == SDL_LIL_ENDIAN ? '<' : '>')) {
+        native = 0;
+        ++format;
+    }
+
+    if (format[0] == '\0' || format[1] != '\0' ||
+        !strchr("bBhHiIlLqQfd", format[0])) {
+        return 0;
+    }
+    *kind = format[0];
+
+    switch (*kind) {
+        case 'b':
+        case 'B':
+            return 1;
+        case 'h':
+        case 'H':
+            return native ? (int)sizeof(short) : 2;
+        case 'i':
+        case 'I':
+            return native ? (int)sizeof(int) : 4;
+        case 'l':
+        case 'L':
+            return native ? (int)sizeof(long) : 4;
+        case 'q':
+        case 'Q':
+            return 8;
+        case 'f':
+            return 4;
+        default: /* 'd' */
+            return 8;
+    }
+}
+
+/* Reads one item of the given kind and size. */
+static double
+_pg_array_item(const char *item, char kind, int size)
+{
+    int is_signed = kind == 'b' || kind == 'h' || kind == 'i' ||
+                    kind == 'l' || kind == 'q';
+    float f;
+    double d;
+    Sint8 s8;
+    Uint8 u8;
+    Sint16 s16;
+    Uint16 u16;
+    Sint32 s32;
+    Uint32 u32;
+    Sint64 s64;
+    Uint64 u64;
+
+    if (kind == 'f') {
+        memcpy(&f, item, sizeof(f));
+        return f;
+    }
+    if (kind == 'd') {
+        memcpy(&d, item, sizeof(d));
+        return d;
+    }
+
+    switch (size) {
+        case 1:
+            if (is_signed) {
+                memcpy(&s8, item, 1);
+                return s8;
+            }
+            memcpy(&u8, item, 1);
+            return u8;
+        case 2:
+            if (is_signed) {
+                memcpy(&s16, item, 2);
+                return s16;
+            }
+            memcpy(&u16, item, 2);
+            return u16;
+        case 4:
+            if (is_signed) {
+                memcpy(&s32, item, 4);
+                return s32;
+            }
+            memcpy(&u32, item, 4);
+            return u32;
+        default: /* 8 */
+            if (is_signed) {
+                memcpy(&s64, item, 8);
+                return (double)s64;
+            }
+            memcpy(&u64, item, 8);
+            return (double)u64;
+    }
+}
+
+/* Reads an array of numbers, any object with the buffer or array
+ * interface, into a new double array of count rows of n_cols values. A 1
+ * dimensional array has 1 column. If *n_cols is 0 any column count is
+ * taken and returned in *n_cols, if *count is not -1 the array must have
+ * that many rows, else the row count is returned in *count. If integers
+ * is non-zero, arrays of floats are refused.
+ *
+ * Returns NULL with an exception set on failure, the result is freed with
+ * PyMem_Free.
+ */
+static double *
+pg_DoublesFromArray(PyObject *obj, const char *name, int integers,
+                    int *n_cols, Py_ssize_t *count)
+{
+    pg_buffer pg_view;
+    Py_buffer *view_p = (Py_buffer *)&pg_view;
+    Py_ssize_t rows, cols, row, col;
+    const char *format;
+    char *item;
+    char kind = 'B';
+    int size;
+    double *values;
+
+    if (pgObject_GetBuffer(obj, &pg_view, PyBUF_RECORDS_RO)) {
+        return NULL;
+    }
+
+    rows = view_p->ndim ? view_p->shape[0] : 0;
+    cols = view_p->ndim == 2 ? view_p->shape[1] : 1;
+    format = view_p->format ? view_p->format : "B";
+
+    if (view_p->ndim < 1 || view_p->ndim > 2 || (*n_cols && cols != *n_cols)) {
+        if (*n_cols == 1) {
+            PyErr_Format(PyExc_ValueError, "%s must be a 1 dimensional array",
+                         name);
+        }
+        else if (*n_cols) {
+            PyErr_Format(PyExc_ValueError,
+                         "%s must be an array of shape (n, %d)", name,
+                         *n_cols);
+        }
+        else {
+            PyErr_Format(PyExc_ValueError,
+                         "%s must be a 1 or 2 dimensional array", name);
+        }
+        pgBuffer_Release(&pg_view);
+        return NULL;
+    }
+    if (*count != -1 && rows != *count) {
+        PyErr_Format(PyExc_ValueError, "%s must have %zd items, not %zd",
+                     name, *count, rows);
+        pgBuffer_Release(&pg_view);
+        return NULL;
+    }
+
+    size = _pg_array_item_size(format, &kind);
+    if (!size || (integers && (kind == 'f' || kind == 'd'))) {
+        PyErr_Format(PyExc_ValueError,
+                     "%s must be an array of %s, not '%s'", name,
+                     integers ? "integers" : "numbers", format);
+        pgBuffer_Release(&pg_view);
+        return NULL;
+    }
+    if (view_p->itemsize != size) {
+        PyErr_Format(PyExc_ValueError,
+                     "%s has items of %zd bytes, but format '%s' is %d bytes",
+                     name, view_p->itemsize, format, size);
+        pgBuffer_Release(&pg_view);
+        return NULL;
+    }
+
+    values = PyMem_New(double, rows * cols + 1);
+    if (values == NULL) {
+        pgBuffer_Release(&pg_view);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    for (row = 0; row < rows; ++row) {
+        for (col = 0; col < cols; ++col) {
+            item = (char *)view_p->buf + row * view_p->strides[0];
+            if (view_p->ndim == 2) {
+                item += col * view_p->strides[1];
+            }
+            values[row * cols + col] = _pg_array_item(item, kind, size);
+        }
+    }
+
+    pgBuffer_Release(&pg_view);
+    *n_cols = (int)cols;
+    *count = rows;
+    return values;
+}
+
+#endif /* ~PG_ARRAY_H */
@@ -0,0 +1,406 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/*
+ *  Pixel format conversion shared by Surface.convert(),
+ *  Surface.convert_alpha() and image.fromstring().
+ *
+ *  pg_ConvertSurface() stands in for SDL_ConvertSurface() with no flags.
+ *  Conversions into a 32 bit format with 8 bit channels are done here
+ *  when the source is an 8 bit palette surface or a 16, 24 or 32 bit
+ *  surface with 4 to 8 bits per channel. Channels are widened the way SDL
+ *  does it, by repeating their high bits, so the pixels match what SDL
+ *  would have produced. Anything else, and any source with a colorkey,
+ *  color or alpha modulation, an unusual blend mode or RLE acceleration,
+ *  is left to SDL.
+ */
+#ifndef PG_CONVERT_H
+#define PG_CONVERT_H
+
+#include "pygame.h"
+#include "simd_shared.h"
+
+typedef struct {
+    int bpp;         /* source bytes per pixel */
+    int nchannels;   /* 3, or 4 when the source alpha is kept */
+    Uint32 max[4];   /* R, G, B, A source channel masks, shifted down */
+    int shift[4];    /* source channel shifts */
+    int loss[4];     /* 8 minus the source channel bits */
+    int dshift[4];   /* destination channel shifts */
+    Uint32 fill;     /* or'ed into every pixel, an opaque alpha */
+    Uint32 lut[256]; /* mapped palette for 8 bit sources */
+} _pg_convert_info;
+
+/* Returns the number of bits in a contiguous channel mask. */
+static int
+_pg_channel_bits(Uint32 mask, int *shift)
+{
+    int bits = 0;
+
+    *shift = 0;
+    if (!mask)
+        return 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        ++*shift;
+    }
+    while (mask & 1) {
+        mask >>= 1;
+        ++bits;
+    }
+    return mask ? -1 : bits;
+}
+
+/* Fills in ci for a src to dst conversion. Returns 0 if it is not one
+   handled here. Only the masks and sizes of dst are used. */
+static int
+_pg_convert_setup(SDL_Surface *src, const SDL_PixelFormat *dst,
+                  _pg_convert_info *ci)
+{
+    const SDL_PixelFormat *sf = src->format;
+    Uint32 smasks[4], dmasks[4];
+    int i, bits, dshift;
+
+    if (dst->BitsPerPixel != 32 || dst->BytesPerPixel != 4 || dst->palette)
+        return 0;
+    dmasks[0] = dst->Rmask;
+    dmasks[1] = dst->Gmask;
+    dmasks[2] = dst->Bmask;
+    dmasks[3] = dst->Amask;
+    for (i = 0; i < 4; i++) {
+        bits = _pg_channel_bits(dmasks[i], &ci->dshift[i]);
+        if (bits != 8 && (i < 3 || bits != 0))
+            return 0;
+    }
+    if ((dst->Rmask & dst->Gmask) || (dst->Rmask & dst->Bmask) ||
+        (dst->Gmask & dst->Bmask) ||
+        (dst->Amask & (dst->Rmask | dst->Gmask | dst->Bmask)))
+        return 0;
+
+    ci->bpp = sf->BytesPerPixel;
+    if (ci->bpp == 1) {
+        SDL_Palette *pal = sf->palette;
+
+        if (!pal || sf->BitsPerPixel != 8)
+            return 0;
+        /* indices past the palette come out as 0, as they do in SDL */
+        memset(ci->lut, 0, sizeof(ci->lut));
+        for (i = 0; i < pal->ncolors && i < 256; i++) {
+            SDL_Color *c = pal->colors + i;
+            ci->lut[i] = ((Uint32)c->r << ci->dshift[0]) |
+                         ((Uint32)c->g << ci->dshift[1]) |
+                         ((Uint32)c->b << ci->dshift[2]) |
+                         (dst->Amask ? (Uint32)c->a << ci->dshift[3] : 0);
+        }
+        return 1;
+    }
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    if (ci->bpp == 3)
+        return 0;
+#endif
+    if (ci->bpp < 2 || ci->bpp > 4 || sf->palette)
+        return 0;
+    if (sf->BitsPerPixel == 32 && sf->Rmask == dst->Rmask &&
+        sf->Gmask == dst->Gmask && sf->Bmask == dst->Bmask &&
+        sf->Amask == dst->Amask)
+        return 0; /* a plain copy, which SDL already does well */
+
+    smasks[0] = sf->Rmask;
+    smasks[1] = sf->Gmask;
+    smasks[2] = sf->Bmask;
+    smasks[3] = dst->Amask ? sf->Amask : 0;
+    ci->nchannels = smasks[3] ? 4 : 3;
+    for (i = 0; i < 4; i++) {
+        bits = _pg_channel_bits(smasks[i], &ci->shift[i]);
+        if ((bits < 4 || bits > 8) && (i < 3 || bits != 0))
+            return 0;
+        ci->max[i] = smasks[i] >> ci->shift[i];
+        ci->loss[i] = 8 - bits;
+    }
+    ci->fill = 0;
+    if (dst->Amask && !sf->Amask) {
+        _pg_channel_bits(dst->Amask, &dshift);
+        ci->fill = (Uint32)0xFF << dshift;
+    }
+    return 1;
+}
+
+/* Widens every channel of a source pixel value to 8 bits and moves it. */
+static PG_INLINE Uint32
+_pg_convert_pixel(Uint32 px, const _pg_convert_info *ci)
+{
+    Uint32 out = ci->fill, v;
+    int i;
+
+    for (i = 0; i < ci->nchannels; i++) {
+        v = (px >> ci->shift[i]) & ci->max[i];
+        v = (v << ci->loss[i]) | (v >> (8 - 2 * ci->loss[i]));
+        out |= v << ci->dshift[i];
+    }
+    return out;
+}
+
+#if PG_HAS_SSE2_OR_NEON
+typedef struct {
+    __m128i max[4];
+    __m128i shift[4];
+    __m128i loss[4];
+    __m128i rest[4];
+    __m128i dshift[4];
+    __m128i fill;
+    int nchannels;
+} _pg_convert_sse2;
+
+static void
+_pg_convert_sse2_setup(const _pg_convert_info *ci, _pg_convert_sse2 *cv)
+{
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        cv->max[i] = _mm_set1_epi32((int)ci->max[i]);
+        cv->shift[i] = _mm_cvtsi32_si128(ci->shift[i]);
+        cv->loss[i] = _mm_cvtsi32_si128(ci->loss[i]);
+        cv->rest[i] = _mm_cvtsi32_si128(8 - 2 * ci->loss[i]);
+        cv->dshift[i] = _mm_cvtsi32_si128(ci->dshift[i]);
+    }
+    cv->fill = _mm_set1_epi32((int)ci->fill);
+    cv->nchannels = ci->nchannels;
+}
+
+/* _pg_convert_pixel() for four pixel values at once */
+static PG_INLINE __m128i
+_pg_convert_pixel4(__m128i px, const _pg_convert_sse2 *cv)
+{
+    __m128i out = cv->fill, v;
+    int i;
+
+    for (i = 0; i < cv->nchannels; i++) {
+        v = _mm_and_si128(_mm_srl_epi32(px, cv->shift[i]), cv->max[i]);
+        v = _mm_or_si128(_mm_sll_epi32(v, cv->loss[i]),
+                         _mm_srl_epi32(v, cv->rest[i]));
+        out = _mm_or_si128(out, _mm_sll_epi32(v, cv->dshift[i]));
+    }
+    return out;
+}
+#endif /* PG_HAS_SSE2_OR_NEON */
+
+static void
+_pg_convert_row(const Uint8 *src, Uint32 *dst, int w,
+                const _pg_convert_info *ci)
+{
+    int x = 0;
+#if PG_HAS_SSE2_OR_NEON
+    _pg_convert_sse2 cv;
+    int simd = ci->bpp > 1 && pg_HasSSE_NEON();
+
+    if (simd)
+        _pg_convert_sse2_setup(ci, &cv);
+#endif /* PG_HAS_SSE2_OR_NEON */
+
+    switch (ci->bpp) {
+        case 1:
+            for (; x + 4 <= w; x += 4) {
+                dst[x] = ci->lut[src[x]];
+                dst[x + 1] = ci->lut[src[x + 1]];
+                dst[x + 2] = ci->lut[src[x + 2]];
+                dst[x + 3] = ci->lut[src[x + 3]];
+            }
+            for (; x < w; x++)
+                dst[x] = ci->lut[src[x]];
+            break;
+        case 2: {
+            const Uint16 *src16 = (const Uint16 *)src;
+#if PG_HAS_SSE2_OR_NEON
+            if (simd) {
+                __m128i zero = _mm_setzero_si128();
+                for (; x + 8 <= w; x += 8) {
+                    __m128i px =
+                        _mm_loadu_si128((const __m128i *)(src16 + x));
+                    _mm_storeu_si128(
+                        (__m128i *)(dst + x),
+                        _pg_convert_pixel4(_mm_unpacklo_epi16(px, zero),
+                                           &cv));
+                    _mm_storeu_si128(
+                        (__m128i *)(dst + x + 4),
+                        _pg_convert_pixel4(_mm_unpackhi_epi16(px, zero),
+                                           &cv));
+                }
+            }
+#endif /* PG_HAS_SSE2_OR_NEON */
+            for (; x < w; x++)
+                dst[x] = _pg_convert_pixel(src16[x], ci);
+            break;
+        }
+        case 3:
+#if PG_HAS_SSE2_OR_NEON
+            if (simd) {
+                /* a 16 byte load holds four whole pixels; shifting it by
+                   3, 6 and 9 bytes lines each one up with the first
+                   lane. The load must stay inside the row. */
+                __m128i low24 = _mm_set1_epi32(0xFFFFFF);
+                for (; x + 6 <= w; x += 4) {
+                    __m128i px =
+                        _mm_loadu_si128((const __m128i *)(src + x * 3));
+                    __m128i p01 =
+                        _mm_unpacklo_epi32(px, _mm_srli_si128(px, 3));
+                    __m128i p23 = _mm_unpacklo_epi32(_mm_srli_si128(px, 6),
+                                                     _mm_srli_si128(px, 9));
+                    px = _mm_and_si128(_mm_unpacklo_epi64(p01, p23), low24);
+                    _mm_storeu_si128((__m128i *)(dst + x),
+                                     _pg_convert_pixel4(px, &cv));
+                }
+            }
+#endif /* PG_HAS_SSE2_OR_NEON */
+            for (; x < w; x++) {
+                const Uint8 *p = src + x * 3;
+                dst[x] = _pg_convert_pixel(
+                    p[0] | ((Uint32)p[1] << 8) | ((Uint32)p[2] << 16), ci);
+            }
+            break;
+        default: { /*case 4:*/
+            const Uint32 *src32 = (const Uint32 *)src;
+#if PG_HAS_SSE2_OR_NEON
+            if (simd) {
+                for (; x + 4 <= w; x += 4) {
+                    __m128i px =
+                        _mm_loadu_si128((const __m128i *)(src32 + x));
+                    _mm_storeu_si128((__m128i *)(dst + x),
+                                     _pg_convert_pixel4(px, &cv));
+                }
+            }
+#endif /* PG_HAS_SSE2_OR_NEON */
+            for (; x < w; x++)
+                dst[x] = _pg_convert_pixel(src32[x], ci);
+            break;
+        }
+    }
+}
+
+/* Converts surf into a new surface with the masks and size of format,
+   like SDL_ConvertSurface(surf, format, 0). */
+static SDL_Surface *
+pg_ConvertSurface(SDL_Surface *surf, const SDL_PixelFormat *format)
+{
+    _pg_convert_info *ci;
+    SDL_Surface *newsurf;
+    SDL_BlendMode mode;
+    Uint32 key;
+    Uint8 r, g, b, a;
+    int y;
+
+    if (SDL_GetColorKey(surf, &key) == 0 || (surf->flags & SDL_RLEACCEL) ||
+        SDL_GetSurfaceColorMod(surf, &r, &g, &b) != 0 ||
+        (r & g & b) != 255 || SDL_GetSurfaceAlphaMod(surf, &a) != 0 ||
+        a != 255 || SDL_GetSurfaceBlendMode(surf, &mode) != 0 ||
+        (mode != SDL_BLENDMODE_NONE && mode != SDL_BLENDMODE_BLEND))
+        return SDL_ConvertSurface(surf, (SDL_PixelFormat *)format, 0);
+
+    ci = (_pg_convert_info *)malloc(sizeof(_pg_convert_info));
+    if (!ci || !_pg_convert_setup(surf, format, ci)) {
+        free(ci);
+        return SDL_ConvertSurface(surf, (SDL_PixelFormat *)format, 0);
+    }
+
+    newsurf = SDL_CreateRGBSurface(0, surf->w, surf->h, 32, format->Rmask,
+                                   format->Gmask, format->Bmask,
+                                   format->Amask);
+    if (!newsurf) {
+        free(ci);
+        return NULL;
+    }
+    if (SDL_MUSTLOCK(surf) && SDL_LockSurface(surf) != 0) {
+        SDL_FreeSurface(newsurf);
+        free(ci);
+        return NULL;
+    }
+    for (y = 0; y < surf->h; y++) {
+        _pg_convert_row((Uint8 *)surf->pixels + (Sint64)y * surf->pitch,
+                        (Uint32 *)((Uint8 *)newsurf->pixels +
+                                   (Sint64)y * newsurf->pitch),
+                        surf->w, ci);
+    }
+    if (SDL_MUSTLOCK(surf))
+        SDL_UnlockSurface(surf);
+    free(ci);
+
+    /* SDL only keeps blending on when both formats have alpha */
+    SDL_SetSurfaceBlendMode(newsurf, (surf->format->Amask && format->Amask)
+                                         ? SDL_BLENDMODE_BLEND
+                                         : SDL_BLENDMODE_NONE);
+    SDL_SetClipRect(newsurf, &surf->clip_rect);
+    return newsurf;
+}
+
+/* Copies w pixels of R, G, B bytes into B, G, R order, the byte order of a
+   24 bit surface with a red mask of 0xFF0000 on little endian machines. */
+static void
+pg_swap_rgb24_row(const Uint8 *src, Uint8 *dst, int w)
+{
+    int x = 0;
+
+#if PG_HAS_SSE2_OR_NEON
+    /* Byte i of the output is byte i + 2, i or i - 2 of the input,
+       depending on i % 3. Three shifted loads are blended through masks;
+       as 16 is 1 more than a multiple of 3, each 48 byte block uses three
+       mask sets. The loads reach 2 bytes either side of the block, so
+       the first pixel and the tail are left to the scalar loop. */
+    if (pg_HasSSE_NEON() && w >= 18) {
+        Uint8 bytes[3][3][16];
+        __m128i masks[3][3];
+        int len = w * 3, o, k, j;
+
+        for (k = 0; k < 3; k++) {
+            for (j = 0; j < 16; j++) {
+                int phase = (k + j) % 3;
+                bytes[k][0][j] = phase == 0 ? 0xFF : 0;
+                bytes[k][1][j] = phase == 1 ? 0xFF : 0;
+                bytes[k][2][j] = phase == 2 ? 0xFF : 0;
+            }
+            for (j = 0; j < 3; j++)
+                masks[k][j] = _mm_loadu_si128((__m128i *)bytes[k][j]);
+        }
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        for (o = 3; o + 50 <= len; o += 48) {
+            for (k = 0; k < 3; k++) {
+                const Uint8 *s = src + o + k * 16;
+                __m128i v = _mm_or_si128(
+                    _mm_or_si128(
+                        _mm_and_si128(
+                            _mm_loadu_si128((const __m128i *)(s + 2)),
+                            masks[k][0]),
+                        _mm_and_si128(_mm_loadu_si128((const __m128i *)s),
+                                      masks[k][1])),
+                    _mm_and_si128(_mm_loadu_si128((const __m128i *)(s - 2)),
+                                  masks[k][2]));
+                _mm_storeu_si128((__m128i *)(dst + o + k * 16), v);
+            }
+        }
+        x = o / 3;
+    }
+#endif /* PG_HAS_SSE2_OR_NEON */
+    for (; x < w; x++) {
+        dst[x * 3] = src[x * 3 + 2];
+        dst[x * 3 + 1] = src[x * 3 + 1];
+        dst[x * 3 + 2] = src[x * 3];
+    }
+}
+
+#endif /* ~PG_CONVERT_H */
@@ -0,0 +1,200 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/*
+ *  Mirroring of surface pixels, shared by transform.flip() and
+ *  Surface.flip_ip().
+ *
+ *  pg_flip_surface() copies src into dst, or works in place when they are
+ *  the same surface by swapping pixels, so no buffer is allocated. Both
+ *  surfaces must be locked and have the same size and pixel size.
+ */
+#ifndef PG_FLIP_H
+#define PG_FLIP_H
+
+#include "pygame.h"
+#include "simd_shared.h"
+
+/* Exchanges a[x] and b[w - 1 - x] for every x. When a and b are the same
+   row only the left half is walked, which reverses the row in place. */
+static void
+_pg_swap_reversed(Uint8 *a, Uint8 *b, int w, int bpp)
+{
+    int n = (a == b) ? w / 2 : w;
+    int x = 0, i;
+
+    switch (bpp) {
+        case 1:
+            for (; x < n; x++) {
+                Uint8 tmp = a[x];
+                a[x] = b[w - 1 - x];
+                b[w - 1 - x] = tmp;
+            }
+            break;
+        case 2: {
+            Uint16 *a16 = (Uint16 *)a, *b16 = (Uint16 *)b;
+            for (; x < n; x++) {
+                Uint16 tmp = a16[x];
+                a16[x] = b16[w - 1 - x];
+                b16[w - 1 - x] = tmp;
+            }
+            break;
+        }
+        case 4: {
+            Uint32 *a32 = (Uint32 *)a, *b32 = (Uint32 *)b;
+#if PG_HAS_SSE2_OR_NEON
+            if (pg_HasSSE_NEON()) {
+                /* in place the two blocks of 4 must not overlap */
+                int limit = (a == b) ? w / 2 - 3 : w - 3;
+                for (; x < limit; x += 4) {
+                    __m128i left = _mm_loadu_si128((__m128i *)(a32 + x));
+                    __m128i right =
+                        _mm_loadu_si128((__m128i *)(b32 + w - 4 - x));
+                    _mm_storeu_si128((__m128i *)(a32 + x),
+                                     _mm_shuffle_epi32(right, 0x1B));
+                    _mm_storeu_si128((__m128i *)(b32 + w - 4 - x),
+                                     _mm_shuffle_epi32(left, 0x1B));
+                }
+            }
+#endif /* PG_HAS_SSE2_OR_NEON */
+            for (; x < n; x++) {
+                Uint32 tmp = a32[x];
+                a32[x] = b32[w - 1 - x];
+                b32[w - 1 - x] = tmp;
+            }
+            break;
+        }
+        default: /*case 3:*/
+            for (; x < n; x++) {
+                Uint8 *pa = a + x * 3, *pb = b + (w - 1 - x) * 3;
+                for (i = 0; i < 3; i++) {
+                    Uint8 tmp = pa[i];
+                    pa[i] = pb[i];
+                    pb[i] = tmp;
+                }
+            }
+            break;
+    }
+}
+
+/* Exchanges two rows of len bytes through a small stack buffer. */
+static void
+_pg_swap_rows(Uint8 *a, Uint8 *b, size_t len)
+{
+    Uint8 tmp[512];
+
+    while (len) {
+        size_t chunk = len < sizeof(tmp) ? len : sizeof(tmp);
+        memcpy(tmp, a, chunk);
+        memcpy(a, b, chunk);
+        memcpy(b, tmp, chunk);
+        a += chunk;
+        b += chunk;
+        len -= chunk;
+    }
+}
+
+/* Copies src into dst with its pixels in reverse order. */
+static void
+_pg_copy_reversed(Uint8 *dst, const Uint8 *src, int w, int bpp)
+{
+    int x = 0;
+
+    switch (bpp) {
+        case 1:
+            for (; x < w; x++)
+                dst[x] = src[w - 1 - x];
+            break;
+        case 2:
+            for (; x < w; x++)
+                ((Uint16 *)dst)[x] = ((const Uint16 *)src)[w - 1 - x];
+            break;
+        case 4: {
+            Uint32 *d32 = (Uint32 *)dst;
+            const Uint32 *s32 = (const Uint32 *)src;
+#if PG_HAS_SSE2_OR_NEON
+            if (pg_HasSSE_NEON()) {
+                for (; x < w - 3; x += 4) {
+                    __m128i pixels =
+                        _mm_loadu_si128((const __m128i *)(s32 + w - 4 - x));
+                    _mm_storeu_si128((__m128i *)(d32 + x),
+                                     _mm_shuffle_epi32(pixels, 0x1B));
+                }
+            }
+#endif /* PG_HAS_SSE2_OR_NEON */
+            for (; x < w; x++)
+                d32[x] = s32[w - 1 - x];
+            break;
+        }
+        default: /*case 3:*/
+            for (; x < w; x++) {
+                const Uint8 *s = src + (w - 1 - x) * 3;
+                dst[x * 3] = s[0];
+                dst[x * 3 + 1] = s[1];
+                dst[x * 3 + 2] = s[2];
+            }
+            break;
+    }
+}
+
+static void
+pg_flip_surface(SDL_Surface *src, SDL_Surface *dst, int xaxis, int yaxis)
+{
+    int w = src->w, h = src->h, y;
+    int bpp = src->format->BytesPerPixel;
+    Uint8 *srcpix = (Uint8 *)src->pixels;
+    Uint8 *dstpix = (Uint8 *)dst->pixels;
+    Sint64 srcpitch = src->pitch;
+    Sint64 dstpitch = dst->pitch;
+
+    if (src == dst) {
+        if (!xaxis) {
+            if (!yaxis)
+                return;
+            for (y = 0; y < h / 2; y++)
+                _pg_swap_rows(srcpix + y * srcpitch,
+                              srcpix + (h - 1 - y) * srcpitch,
+                              (size_t)w * bpp);
+        }
+        else if (!yaxis) {
+            for (y = 0; y < h; y++)
+                _pg_swap_reversed(srcpix + y * srcpitch,
+                                  srcpix + y * srcpitch, w, bpp);
+        }
+        else {
+            /* (x, y) trades places with (w - 1 - x, h - 1 - y) */
+            for (y = 0; y < (h + 1) / 2; y++)
+                _pg_swap_reversed(srcpix + y * srcpitch,
+                                  srcpix + (h - 1 - y) * srcpitch, w, bpp);
+        }
+        return;
+    }
+
+    for (y = 0; y < h; y++) {
+        Uint8 *dstrow = dstpix + y * dstpitch;
+        Uint8 *srcrow = srcpix + (yaxis ? h - 1 - y : y) * srcpitch;
+
+        if (xaxis)
+            _pg_copy_reversed(dstrow, srcrow, w, bpp);
+        else
+            memcpy(dstrow, srcrow, (size_t)w * bpp);
+    }
+}
+
+#endif /* ~PG_FLIP_H */
@@ -0,0 +1,122 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/*
+ *  Splits per row pixel work into horizontal bands run on SDL threads.
+ *
+ *  The band function is called once per band with [y0, y1) and must only
+ *  touch its own rows of the destination. It runs without the GIL, so it
+ *  must not call into Python. It returns 0 on success or -1 on failure
+ *  (typically running out of memory).
+ */
+#ifndef PG_THREADS_H
+#define PG_THREADS_H
+
+#include "pygame.h"
+
+#include <SDL_thread.h>
+
+#define PG_MAX_BANDS 16
+
+/* Below this many pixels the cost of starting threads is not worth it. */
+#define PG_BAND_MIN_PIXELS 65536
+
+typedef int (*pg_band_func)(void *data, int y0, int y1);
+
+typedef struct {
+    pg_band_func func;
+    void *data;
+    int y0;
+    int y1;
+    int result;
+} _pg_band;
+
+static int SDLCALL
+_pg_band_thread(void *arg)
+{
+    _pg_band *band = (_pg_band *)arg;
+
+    band->result = band->func(band->data, band->y0, band->y1);
+    return 0;
+}
+
+/* Returns how many bands a height x width job should be split into. */
+static PG_INLINE int
+pg_band_count(int width, int height, int min_rows)
+{
+    int count = SDL_GetCPUCount();
+
+    if ((Sint64)width * height < PG_BAND_MIN_PIXELS)
+        return 1;
+    if (min_rows < 1)
+        min_rows = 1;
+    if (count > height / min_rows)
+        count = height / min_rows;
+    if (count > PG_MAX_BANDS)
+        count = PG_MAX_BANDS;
+    return count < 1 ? 1 : count;
+}
+
+/* Runs func over rows [0, height) using up to count bands. The calling
+   thread does the first band itself. Falls back to running a band inline
+   if a thread cannot be started. */
+static int
+pg_run_bands(pg_band_func func, void *data, int height, int count)
+{
+    _pg_band bands[PG_MAX_BANDS];
+    SDL_Thread *threads[PG_MAX_BANDS];
+    int i, result = 0;
+
+    if (count > PG_MAX_BANDS)
+        count = PG_MAX_BANDS;
+    if (count > height)
+        count = height;
+    if (count <= 1)
+        return func(data, 0, height);
+
+    for (i = 0; i < count; i++) {
+        bands[i].func = func;
+        bands[i].data = data;
+        bands[i].y0 = (int)((Sint64)height * i / count);
+        bands[i].y1 = (int)((Sint64)height * (i + 1) / count);
+        bands[i].result = 0;
+    }
+
+    threads[0] = NULL;
+    for (i = 1; i < count; i++) {
+        threads[i] = SDL_CreateThread(_pg_band_thread, "pg_band", &bands[i]);
+    }
+
+    bands[0].result = func(data, bands[0].y0, bands[0].y1);
+
+    for (i = 1; i < count; i++) {
+        if (threads[i])
+            SDL_WaitThread(threads[i], NULL);
+        else
+            bands[i].result = func(data, bands[i].y0, bands[i].y1);
+    }
+
+    for (i = 0; i < count; i++) {
+        if (bands[i].result < 0)
+            result = -1;
+    }
+    return result;
+}
+
+#endif /* ~PG_THREADS_H */
@@ -16,6 +16,9 @@
 
 #include "math.h"
 
+#include "pgthreads.h"
+#include "simd_shared.h"
+
 typedef struct tColorRGBA {
     Uint8 r;
     Uint8 g;
@@ -31,6 +34,47 @@ typedef struct tColorRGBA {
 #define M_PI 3.141592654
 #endif
 
+#if PG_HAS_SSE2_OR_NEON
+/*
+ * ((a * b) >> 16) for signed 16 bit lanes a and unsigned 16 bit lanes b.
+ * mulhi treats b as signed, that is as b - 65536 when its top bit is set,
+ * so a is added back for those lanes.
+ */
+static PG_INLINE __m128i
+_rz_mulhi_su16(__m128i a, __m128i b)
+{
+    return _mm_add_epi16(_mm_mulhi_epi16(a, b),
+                         _mm_and_si128(a, _mm_srai_epi16(b, 15)));
+}
+
+/*
+ * Bilinear interpolation of one 32bit pixel from the two adjacent pixels at
+ * row0 and the two below them at row1, with 16 bit fractions ex and ey.
+ * Gives exactly the result of the scalar code: every channel is first
+ * interpolated along x on both rows, then along y.
+ */
+static PG_INLINE Uint32
+_rz_interpolate(const Uint8 *row0, const Uint8 *row1, int ex, int ey)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i top =
+        _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)row0), zero);
+    __m128i bottom =
+        _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)row1), zero);
+    /* c00 | c10 and c01 | c11 */
+    __m128i left = _mm_unpacklo_epi64(top, bottom);
+    __m128i right = _mm_unpackhi_epi64(top, bottom);
+    __m128i t, d;
+
+    /* t1 in the low four lanes, t2 in the high four */
+    t = _mm_add_epi16(left, _rz_mulhi_su16(_mm_sub_epi16(right, left),
+                                           _mm_set1_epi16((short)ex)));
+    d = _mm_sub_epi16(_mm_srli_si128(t, 8), t);
+    t = _mm_add_epi16(t, _rz_mulhi_su16(d, _mm_set1_epi16((short)ey)));
+    return (Uint32)_mm_cvtsi128_si32(_mm_packus_epi16(t, t));
+}
+#endif /* PG_HAS_SSE2_OR_NEON */
+
 /*
 
  32bit Zoomer with optional anti-aliasing by bilinear interpolation.
@@ -38,84 +82,42 @@ typedef struct tColorRGBA {
  Zoomes 32bit RGBA/ABGR 'src' surface to 'dst' surface.
 
 */
-int
-zoomSurfaceRGBA(SDL_Surface *src, SDL_Surface *dst, int smooth)
+
+typedef struct tZoomJob {
+    SDL_Surface *src;
+    SDL_Surface *dst;
+    int *sax;
+    int *say;
+    int *sry;
+    int smooth;
+} tZoomJob;
+
+static int
+zoomSurfaceRGBARows(void *data, int y0, int y1)
 {
-    int x, y, sx, sy, *sax, *say, *csax, *csay, csx, csy, ex, ey, t1, t2,
-        sstep;
+    tZoomJob *job = (tZoomJob *)data;
+    SDL_Surface *src = job->src;
+    SDL_Surface *dst = job->dst;
+    int x, y, *csax, ex, ey, t1, t2, sstep;
     tColorRGBA *c00, *c01, *c10, *c11;
     tColorRGBA *sp, *csp, *dp;
-    int dgap;
-
-    /*
-     * Variable setup
-     */
-    if (smooth) {
-        /*
-         * For interpolation: assume source dimension is one pixel
-         */
-        /*
-         * smaller to avoid overflow on right and bottom edge.
-         */
-        sx = (int)(65536.0 * (float)(src->w - 1) / (float)dst->w);
-        sy = (int)(65536.0 * (float)(src->h - 1) / (float)dst->h);
-    }
-    else {
-        sx = (int)(65536.0 * (float)src->w / (float)dst->w);
-        sy = (int)(65536.0 * (float)src->h / (float)dst->h);
-    }
-
-    /*
-     * Allocate memory for row increments
-     */
-    if ((sax = (int *)malloc((dst->w + 1) * sizeof(Uint32))) == NULL) {
-        return (-1);
-    }
-    if ((say = (int *)malloc((dst->h + 1) * sizeof(Uint32))) == NULL) {
-        free(sax);
-        return (-1);
-    }
+#if PG_HAS_SSE2_OR_NEON
+    int use_simd = pg_HasSSE_NEON();
+#endif /* PG_HAS_SSE2_OR_NEON */
 
-    /*
-     * Precalculate row increments
-     */
-    csx = 0;
-    csax = sax;
-    for (x = 0; x <= dst->w; x++) {
-        *csax = csx;
-        csax++;
-        csx &= 0xffff;
-        csx += sx;
-    }
-    csy = 0;
-    csay = say;
-    for (y = 0; y <= dst->h; y++) {
-        *csay = csy;
-        csay++;
-        csy &= 0xffff;
-        csy += sy;
-    }
-
-    /*
-     * Pointer setup
-     */
-    csp = (tColorRGBA *)src->pixels;
-    dp = (tColorRGBA *)dst->pixels;
-    dgap = dst->pitch - dst->w * 4;
-
-    /*
-     * Switch between interpolating and non-interpolating code
-     */
-    if (smooth) {
+    for (y = y0; y < y1; y++) {
         /*
-         * Interpolating Zoom
+         * Pointer setup
          */
+        csp = (tColorRGBA *)((Uint8 *)src->pixels +
+                             job->sry[y] * src->pitch);
+        dp = (tColorRGBA *)((Uint8 *)dst->pixels + y * dst->pitch);
+        csax = job->sax;
 
         /*
-         * Scan destination
+         * Switch between interpolating and non-interpolating code
          */
-        csay = say;
-        for (y = 0; y < dst->h; y++) {
+        if (job->smooth) {
             /*
              * Setup color source pointers
              */
@@ -125,25 +127,33 @@ zoomSurfaceRGBA(SDL_Surface *src, SDL_Surface *dst, int smooth)
             c10 = (tColorRGBA *)((Uint8 *)csp + src->pitch);
             c11 = c10;
             c11++;
-            csax = sax;
+            ey = (job->say[y] & 0xffff);
             for (x = 0; x < dst->w; x++) {
                 /*
                  * Interpolate colors
                  */
                 ex = (*csax & 0xffff);
-                ey = (*csay & 0xffff);
-                t1 = ((((c01->r - c00->r) * ex) >> 16) + c00->r) & 0xff;
-                t2 = ((((c11->r - c10->r) * ex) >> 16) + c10->r) & 0xff;
-                dp->r = (((t2 - t1) * ey) >> 16) + t1;
-                t1 = ((((c01->g - c00->g) * ex) >> 16) + c00->g) & 0xff;
-                t2 = ((((c11->g - c10->g) * ex) >> 16) + c10->g) & 0xff;
-                dp->g = (((t2 - t1) * ey) >> 16) + t1;
-                t1 = ((((c01->b - c00->b) * ex) >> 16) + c00->b) & 0xff;
-                t2 = ((((c11->b - c10->b) * ex) >> 16) + c10->b) & 0xff;
-                dp->b = (((t2 - t1) * ey) >> 16) + t1;
-                t1 = ((((c01->a - c00->a) * ex) >> 16) + c00->a) & 0xff;
-                t2 = ((((c11->a - c10->a) * ex) >> 16) + c10->a) & 0xff;
-                dp->a = (((t2 - t1) * ey) >> 16) + t1;
+#if PG_HAS_SSE2_OR_NEON
+                if (use_simd) {
+                    *(Uint32 *)dp =
+                        _rz_interpolate((Uint8 *)c00, (Uint8 *)c10, ex, ey);
+                }
+                else
+#endif /* PG_HAS_SSE2_OR_NEON */
+                {
+                    t1 = ((((c01->r - c00->r) * ex) >> 16) + c00->r) & 0xff;
+                    t2 = ((((c11->r - c10->r) * ex) >> 16) + c10->r) & 0xff;
+                    dp->r = (((t2 - t1) * ey) >> 16) + t1;
+                    t1 = ((((c01->g - c00->g) * ex) >> 16) + c00->g) & 0xff;
+                    t2 = ((((c11->g - c10->g) * ex) >> 16) + c10->g) & 0xff;
+                    dp->g = (((t2 - t1) * ey) >> 16) + t1;
+                    t1 = ((((c01->b - c00->b) * ex) >> 16) + c00->b) & 0xff;
+                    t2 = ((((c11->b - c10->b) * ex) >> 16) + c10->b) & 0xff;
+                    dp->b = (((t2 - t1) * ey) >> 16) + t1;
+                    t1 = ((((c01->a - c00->a) * ex) >> 16) + c00->a) & 0xff;
+                    t2 = ((((c11->a - c10->a) * ex) >> 16) + c10->a) & 0xff;
+                    dp->a = (((t2 - t1) * ey) >> 16) + t1;
+                }
 
                 /*
                  * Advance source pointers
@@ -159,26 +169,12 @@ zoomSurfaceRGBA(SDL_Surface *src, SDL_Surface *dst, int smooth)
                  */
                 dp++;
             }
+        }
+        else {
             /*
-             * Advance source pointer
-             */
-            csay++;
-            csp = (tColorRGBA *)((Uint8 *)csp + (*csay >> 16) * src->pitch);
-            /*
-             * Advance destination pointers
+             * Non-Interpolating Zoom
              */
-            dp = (tColorRGBA *)((Uint8 *)dp + dgap);
-        }
-    }
-    else {
-        /*
-         * Non-Interpolating Zoom
-         */
-
-        csay = say;
-        for (y = 0; y < dst->h; y++) {
             sp = csp;
-            csax = sax;
             for (x = 0; x < dst->w; x++) {
                 /*
                  * Draw
@@ -194,23 +190,98 @@ zoomSurfaceRGBA(SDL_Surface *src, SDL_Surface *dst, int smooth)
                  */
                 dp++;
             }
-            /*
-             * Advance source pointer
-             */
-            csay++;
-            csp = (tColorRGBA *)((Uint8 *)csp + (*csay >> 16) * src->pitch);
-            /*
-             * Advance destination pointers
-             */
-            dp = (tColorRGBA *)((Uint8 *)dp + dgap);
         }
     }
+    return 0;
+}
+
+int
+zoomSurfaceRGBA(SDL_Surface *src, SDL_Surface *dst, int smooth)
+{
+    int x, y, sx, sy, *sax, *say, *sry, *csax, *csay, csx, csy;
+    tZoomJob job;
+
+    /*
+     * Variable setup
+     */
+    if (smooth) {
+        /*
+         * For interpolation: assume source dimension is one pixel
+         */
+        /*
+         * smaller to avoid overflow on right and bottom edge.
+         */
+        sx = (int)(65536.0 * (float)(src->w - 1) / (float)dst->w);
+        sy = (int)(65536.0 * (float)(src->h - 1) / (float)dst->h);
+    }
+    else {
+        sx = (int)(65536.0 * (float)src->w / (float)dst->w);
+        sy = (int)(65536.0 * (float)src->h / (float)dst->h);
+    }
+
+    /*
+     * Allocate memory for row increments
+     */
+    if ((sax = (int *)malloc((dst->w + 1) * sizeof(Uint32))) == NULL) {
+        return (-1);
+    }
+    if ((say = (int *)malloc((dst->h + 1) * sizeof(Uint32))) == NULL) {
+        free(sax);
+        return (-1);
+    }
+    if ((sry = (int *)malloc((dst->h + 1) * sizeof(Uint32))) == NULL) {
+        free(sax);
+        free(say);
+        return (-1);
+    }
+
+    /*
+     * Precalculate row increments
+     */
+    csx = 0;
+    csax = sax;
+    for (x = 0; x <= dst->w; x++) {
+        *csax = csx;
+        csax++;
+        csx &= 0xffff;
+        csx += sx;
+    }
+    csy = 0;
+    csay = say;
+    for (y = 0; y <= dst->h; y++) {
+        *csay = csy;
+        csay++;
+        csy &= 0xffff;
+        csy += sy;
+    }
+
+    /*
+     * Source row of every destination row, so that rows can be done in
+     * any order
+     */
+    sry[0] = 0;
+    for (y = 1; y <= dst->h; y++) {
+        sry[y] = sry[y - 1] + (say[y] >> 16);
+    }
+
+    /*
+     * Scan destination, in bands of rows on several threads
+     */
+    job.src = src;
+    job.dst = dst;
+    job.sax = sax;
+    job.say = say;
+    job.sry = sry;
+    job.smooth = smooth;
+    pg_run_bands(zoomSurfaceRGBARows, &job, dst->h,
+                 pg_band_count(dst->w, dst->h, 16));
 
     /*
      * Remove temp arrays
      */
     free(sax);
     free(say);
+    free(sry);
 
     return (0);
 }
@@ -223,14 +294,29 @@ zoomSurfaceRGBA(SDL_Surface *src, SDL_Surface *dst, int smooth)
 
 */
 
-void
-transformSurfaceRGBA(SDL_Surface *src, SDL_Surface *dst, int cx, int cy,
-                     int isin, int icos, int smooth)
+typedef struct tTransformJob {
+    SDL_Surface *src;
+    SDL_Surface *dst;
+    int cx;
+    int cy;
+    int isin;
+    int icos;
+    int smooth;
+} tTransformJob;
+
+static int
+transformSurfaceRGBARows(void *data, int y0, int y1)
 {
+    tTransformJob *job = (tTransformJob *)data;
+    SDL_Surface *src = job->src;
+    SDL_Surface *dst = job->dst;
+    int cx = job->cx, cy = job->cy, isin = job->isin, icos = job->icos;
     int x, y, t1, t2, dx, dy, xd, yd, sdx, sdy, ax, ay, ex, ey, sw, sh;
     tColorRGBA c00, c01, c10, c11;
     tColorRGBA *pc, *sp;
-    int gap;
+#if PG_HAS_SSE2_OR_NEON
+    int use_simd = pg_HasSSE_NEON();
+#endif /* PG_HAS_SSE2_OR_NEON */
 
     /*
      * Variable setup
@@ -241,20 +327,34 @@ transformSurfaceRGBA(SDL_Surface *src, SDL_Surface *dst, int cx, int cy,
     ay = (cy << 16) - (isin * cx);
     sw = src->w - 1;
     sh = src->h - 1;
-    pc = dst->pixels;
-    gap = dst->pitch - dst->w * 4;
 
     /*
      * Switch between interpolating and non-interpolating code
      */
-    if (smooth) {
-        for (y = 0; y < dst->h; y++) {
+    if (job->smooth) {
+        for (y = y0; y < y1; y++) {
+            pc = (tColorRGBA *)((Uint8 *)dst->pixels + y * dst->pitch);
             dy = cy - y;
             sdx = (ax + (isin * dy)) + xd;
             sdy = (ay - (icos * dy)) + yd;
             for (x = 0; x < dst->w; x++) {
                 dx = (sdx >> 16);
                 dy = (sdy >> 16);
+#if PG_HAS_SSE2_OR_NEON
+                /*
+                 * All four source pixels inside: the common case
+                 */
+                if (use_simd && (dx >= 0) && (dy >= 0) && (dx < sw) &&
+                    (dy < sh)) {
+                    sp = (tColorRGBA *)((Uint8 *)src->pixels +
+                                        src->pitch * dy);
+                    sp += dx;
+                    *(Uint32 *)pc =
+                        _rz_interpolate((Uint8 *)sp, (Uint8 *)sp + src->pitch,
+                                        sdx & 0xffff, sdy & 0xffff);
+                }
+                else
+#endif /* PG_HAS_SSE2_OR_NEON */
                 if ((dx >= -1) && (dy >= -1) && (dx < src->w) &&
                     (dy < src->h)) {
                     if ((dx >= 0) && (dy >= 0) && (dx < sw) && (dy < sh)) {
@@ -373,11 +473,11 @@ transformSurfaceRGBA(SDL_Surface *src, SDL_Surface *dst, int cx, int cy,
                 sdy += isin;
                 pc++;
             }
-            pc = (tColorRGBA *)((Uint8 *)pc + gap);
         }
     }
     else {
-        for (y = 0; y < dst->h; y++) {
+        for (y = y0; y < y1; y++) {
+            pc = (tColorRGBA *)((Uint8 *)dst->pixels + y * dst->pitch);
             dy = cy - y;
             sdx = (ax + (isin * dy)) + xd;
             sdy = (ay - (icos * dy)) + yd;
@@ -394,9 +494,29 @@ transformSurfaceRGBA(SDL_Surface *src, SDL_Surface *dst, int cx, int cy,
                 sdy += isin;
                 pc++;
             }
-            pc = (tColorRGBA *)((Uint8 *)pc + gap);
         }
     }
+    return 0;
+}
+
+void
+transformSurfaceRGBA(SDL_Surface *src, SDL_Surface *dst, int cx, int cy,
+                     int isin, int icos, int smooth)
+{
+    tTransformJob job;
+
+    /*
+     * Destination rows are independent: split them in bands over threads
+     */
+    job.src = src;
+    job.dst = dst;
+    job.cx = cx;
+    job.cy = cy;
+    job.isin = isin;
+    job.icos = icos;
+    job.smooth = smooth;
+    pg_run_bands(transformSurfaceRGBARows, &job, dst->h,
+                 pg_band_count(dst->w, dst->h, 16));
 }
 
 /*
@@ -0,0 +1,71 @@
+/*
+  pygame - Python Game Library
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Library General Public
+  License as published by the Free Software Foundation; either
+  version 2 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Library General Public License for more details.
+
+  You should have received a copy of the GNU Library General Public
+  License along with this library; if not, write to the Free
+  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+*/
+
+/*
+ *  SSE2 / NEON setup shared by the pixel kernels of the transform, draw
+ *  and mask modules. alphablit.c keeps its own copy of this logic.
+ *
+ *  Kernels are written with SSE2 intrinsics; on ARM they are translated
+ *  by sse2neon.h. Code using them should be wrapped in
+ *  #if PG_HAS_SSE2_OR_NEON and check pg_HasSSE_NEON() at runtime.
+ */
+#ifndef PG_SIMD_SHARED_H
+#define PG_SIMD_SHARED_H
+
+#include "pygame.h"
+
+#if !defined(PG_ENABLE_ARM_NEON) && defined(__aarch64__)
+// arm64 has neon optimisations enabled by default, even when fpu=neon is not
+// passed
+#define PG_ENABLE_ARM_NEON 1
+#endif
+
+/* MSVC does not define __SSE2__, but always has SSE2 on x64 and has it on
+ * x86 with /arch:SSE2 or later, as alphablit.c also checks. */
+#if defined(__SSE2__) || defined(_M_AMD64) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PG_SIMD_SSE2 1
+#endif
+
+#ifdef PG_ENABLE_ARM_NEON
+// sse2neon.h is from here: https://github.com/DLTcollab/sse2neon
+#include "include/sse2neon.h"
+#elif defined(PG_SIMD_SSE2)
+#include <emmintrin.h>
+#endif /* PG_ENABLE_ARM_NEON */
+
+#if defined(PG_SIMD_SSE2) || defined(PG_ENABLE_ARM_NEON)
+#define PG_HAS_SSE2_OR_NEON 1
+#else
+#define PG_HAS_SSE2_OR_NEON 0
+#endif
+
+#if PG_HAS_SSE2_OR_NEON
+static PG_INLINE int
+pg_HasSSE_NEON(void)
+{
+#if PG_ENABLE_ARM_NEON
+    return SDL_HasNEON() == SDL_TRUE;
+#else
+    return SDL_HasSSE2() == SDL_TRUE;
+#endif
+}
+#endif /* PG_HAS_SSE2_OR_NEON */
+
+#endif /* ~PG_SIMD_SHARED_H */
@@ -31,6 +31,8 @@
 #include "pgcompat.h"
 #include "doc/surface_doc.h"
 #include "pgbufferproxy.h"
+#include "pgflip.h"
+#include "pgconvert.h"
 
 /* stdint.h is missing from some versions of MSVC. */
 #ifdef _MSC_VER
@@ -168,6 +170,8 @@ surf_convert(pgSurfaceObject *self, PyObject *args);
 static PyObject *
 surf_convert_alpha(pgSurfaceObject *self, PyObject *args);
 static PyObject *
+surf_premul_alpha(pgSurfaceObject *self, PyObject *args);
+static PyObject *
 surf_set_clip(PyObject *self, PyObject *args);
 static PyObject *
 surf_get_clip(PyObject *self, PyObject *args);
@@ -180,6 +184,8 @@ surf_fill(pgSurfaceObject *self, PyObject *args, PyObject *keywds);
 static PyObject *
 surf_scroll(PyObject *self, PyObject *args, PyObject *keywds);
 static PyObject *
+surf_flip_ip(PyObject *self, PyObject *args, PyObject *keywds);
+static PyObject *
 surf_get_abs_offset(PyObject *self, PyObject *args);
 static PyObject *
 surf_get_abs_parent(PyObject *self, PyObject *args);
@@ -331,6 +337,8 @@ static struct PyMethodDef surface_methods[] = {
     {"copy", (PyCFunction)surf_copy, METH_NOARGS, DOC_SURFACECOPY},
     {"__copy__", (PyCFunction)surf_copy, METH_NOARGS, DOC_SURFACECOPY},
     {"convert", (PyCFunction)surf_convert, METH_VARARGS, DOC_SURFACECONVERT},
+    {"premul_alpha", (PyCFunction)surf_premul_alpha, METH_NOARGS,
+     DOC_SURFACEPREMULALPHA},
     {"convert_alpha", (PyCFunction)surf_convert_alpha, METH_VARARGS,
      DOC_SURFACECONVERTALPHA},
 
@@ -346,6 +354,8 @@ static struct PyMethodDef surface_methods[] = {
 
     {"scroll", (PyCFunction)surf_scroll, METH_VARARGS | METH_KEYWORDS,
      DOC_SURFACESCROLL},
+    {"flip_ip", (PyCFunction)surf_flip_ip, METH_VARARGS | METH_KEYWORDS,
+     DOC_SURFACEFLIPIP},
 
     {"get_flags", surf_get_flags, METH_NOARGS, DOC_SURFACEGETFLAGS},
     {"get_size", surf_get_size, METH_NOARGS, DOC_SURFACEGETSIZE},
@@ -731,10 +741,19 @@ surface_init(pgSurfaceObject *self, PyObject *args, PyObject *kwds)
         }
     }
 
+    if ((flags & PGS_PREMULTIPLIED) && !surface->format->Amask) {
+        PyErr_SetString(PyExc_ValueError,
+                        "PREMULTIPLIED needs a per-pixel alpha, "
+                        "use it with SRCALPHA");
+        SDL_FreeSurface(surface);
+        return -1;
+    }
+
     if (surface) {
         self->surf = surface;
         self->owner = 1;
         self->subsurface = NULL;
+        pg_SetPremultiplied(surface, (flags & PGS_PREMULTIPLIED) != 0);
     }
 
     return 0;
@@ -1454,6 +1473,8 @@ surf_copy(pgSurfaceObject *self, PyObject *args)
     final = surf_subtype_new(Py_TYPE(self), newsurf, 1);
     if (!final)
         SDL_FreeSurface(newsurf);
+    else
+        pg_SetPremultiplied(newsurf, pg_IsPremultiplied(surf));
     return final;
 }
 
@@ -1494,7 +1515,7 @@ surf_convert(pgSurfaceObject *self, PyObject *args)
     if (argobject) {
         if (pgSurface_Check(argobject)) {
             src = pgSurface_AsSurface(argobject);
-            newsurf = SDL_ConvertSurface(surf, src->format, 0);
+            newsurf = pg_ConvertSurface(surf, src->format);
         }
         else {
             int bpp;
@@ -1597,7 +1618,7 @@ surf_convert(pgSurfaceObject *self, PyObject *args)
                  * that at least one entry is not black.
                  */
                 format.palette = NULL;
-            newsurf = SDL_ConvertSurface(surf, &format, 0);
+            newsurf = pg_ConvertSurface(surf, &format);
             SDL_SetSurfaceBlendMode(newsurf, SDL_BLENDMODE_NONE);
         }
     }
@@ -1620,6 +1641,8 @@ surf_convert(pgSurfaceObject *self, PyObject *args)
     final = surf_subtype_new(Py_TYPE(self), newsurf, 1);
     if (!final)
         SDL_FreeSurface(newsurf);
+    else if (newsurf->format->Amask)
+        pg_SetPremultiplied(newsurf, pg_IsPremultiplied(surf));
     return final;
 }
 
@@ -1632,14 +1655,14 @@ pg_DisplayFormat(SDL_Surface *surface)
         return NULL;
     }
     displaysurf = pgSurface_AsSurface(pg_GetDefaultWindowSurface());
-    return SDL_ConvertSurface(surface, displaysurf->format, 0);
+    return pg_ConvertSurface(surface, displaysurf->format);
 }
 
 static SDL_Surface *
 pg_DisplayFormatAlpha(SDL_Surface *surface)
 {
-    SDL_Surface *displaysurf;
-    SDL_PixelFormat *dformat;
+    SDL_Surface *displaysurf, *newsurf;
+    SDL_PixelFormat *dformat, *format;
     Uint32 pfe;
     Uint32 amask = 0xff000000;
     Uint32 rmask = 0x00ff0000;
@@ -1685,7 +1708,12 @@ pg_DisplayFormatAlpha(SDL_Surface *surface)
         SDL_SetError("unknown pixel format");
         return NULL;
     }
-    return SDL_ConvertSurfaceFormat(surface, pfe, 0);
+    format = SDL_AllocFormat(pfe);
+    if (!format)
+        return NULL;
+    newsurf = pg_ConvertSurface(surface, format);
+    SDL_FreeFormat(format);
+    return newsurf;
 }
 
 static PyObject *
@@ -1716,6 +1744,51 @@ surf_convert_alpha(pgSurfaceObject *self, PyObject *args)
 
     if (!final)
         SDL_FreeSurface(newsurf);
+    else
+        pg_SetPremultiplied(newsurf, pg_IsPremultiplied(surf));
+    return final;
+}
+
+static PyObject *
+surf_premul_alpha(pgSurfaceObject *self, PyObject *args)
+{
+    SDL_Surface *surf = pgSurface_AsSurface(self);
+    PyObject *final;
+    SDL_Surface *newsurf;
+    int result = 0;
+
+    if (!surf)
+        return RAISE(pgExc_SDLError, "display Surface quit");
+    if (!surf->format->Amask)
+        return RAISE(PyExc_ValueError,
+                     "source surface to be alpha pre-multiplied must have "
+                     "alpha channel");
+
+    pgSurface_Prep(self);
+    newsurf = SDL_ConvertSurface(surf, surf->format, 0);
+    pgSurface_Unprep(self);
+
+    /* an already premultiplied surface is only copied */
+    if (newsurf && !pg_IsPremultiplied(surf) && surf->w > 0 && surf->h > 0) {
+        SDL_LockSurface(newsurf);
+        Py_BEGIN_ALLOW_THREADS;
+        result = premul_surf_color_by_alpha(newsurf, newsurf);
+        Py_END_ALLOW_THREADS;
+        SDL_UnlockSurface(newsurf);
+    }
+
+    if (result != 0) {
+        SDL_FreeSurface(newsurf);
+        return RAISE(PyExc_ValueError,
+                     "source surface to be alpha pre-multiplied must have "
+                     "alpha channel");
+    }
+
+    final = surf_subtype_new(Py_TYPE(self), newsurf, 1);
+    if (!final)
+        SDL_FreeSurface(newsurf);
+    else
+        pg_SetPremultiplied(newsurf, 1);
     return final;
 }
 
@@ -2217,6 +2290,42 @@ surf_scroll(PyObject *self, PyObject *args, PyObject *keywds)
     Py_RETURN_NONE;
 }
 
+static PyObject *
+surf_flip_ip(PyObject *self, PyObject *args, PyObject *keywds)
+{
+    int xaxis, yaxis;
+    SDL_Surface *surf;
+
+    static char *kwids[] = {"flip_x", "flip_y", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, keywds, "ii", kwids, &xaxis,
+                                     &yaxis)) {
+        return NULL;
+    }
+
+    surf = pgSurface_AsSurface(self);
+    if (!surf) {
+        return RAISE(pgExc_SDLError, "display Surface quit");
+    }
+
+    if ((!xaxis && !yaxis) || surf->w < 1 || surf->h < 1) {
+        Py_RETURN_NONE;
+    }
+
+    if (!pgSurface_Lock((pgSurfaceObject *)self)) {
+        return NULL;
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    pg_flip_surface(surf, surf, xaxis, yaxis);
+    Py_END_ALLOW_THREADS;
+
+    if (!pgSurface_Unlock((pgSurfaceObject *)self)) {
+        return NULL;
+    }
+
+    Py_RETURN_NONE;
+}
+
 int
 pg_HasSurfaceRLE(SDL_Surface * surface)
 {
@@ -2275,6 +2384,8 @@ surf_get_flags(PyObject *self, PyObject *args)
     if (is_alpha) {
         flags |= PGS_SRCALPHA;
     }
+    if (pg_IsPremultiplied(surf))
+        flags |= PGS_PREMULTIPLIED;
     if (SDL_GetColorKey(surf, NULL) == 0)
         flags |= PGS_SRCCOLORKEY;
     if (sdl_flags & SDL_PREALLOC)
@@ -2558,6 +2669,7 @@ surf_subsurface(PyObject *self, PyObject *args)
     data->offsetx = rect->x;
     data->offsety = rect->y;
     ((pgSurfaceObject *)subobj)->subsurface = data;
+    pg_SetPremultiplied(sub, pg_IsPremultiplied(surf));
 
     return subobj;
 }
@@ -848,6 +848,100 @@ surface_fill_blend_rgba_max(SDL_Surface *surface, SDL_Rect *rect, Uint32 color)
     return result;
 }
 
+static int
+surface_fill_blend_premultiplied(SDL_Surface *surface, SDL_Rect *rect,
+                                 Uint32 color)
+{
+    Uint8 *pixels;
+    int width = rect->w;
+    int height = rect->h;
+    int skip;
+    int bpp = surface->format->BytesPerPixel;
+    int n;
+    SDL_PixelFormat *fmt = surface->format;
+    Uint8 sR, sG, sB, sA, cR, cG, cB, cA;
+    Uint32 pixel;
+    int result = -1;
+    int ppa;
+    SDL_BlendMode mode;
+    SDL_GetSurfaceBlendMode(surface, &mode);
+    ppa = (fmt->Amask && mode != SDL_BLENDMODE_NONE);
+
+    pixels = (Uint8 *)surface->pixels +
+             (Uint16)rect->y * surface->pitch + (Uint16)rect->x * bpp;
+    skip = surface->pitch - width * bpp;
+
+    /* The color is taken as already premultiplied. A channel above the
+     * alpha would overflow, so clamp it to a valid premultiplied value.
+     */
+    if (bpp == 1)
+        SDL_GetRGBA(color, fmt, &cR, &cG, &cB, &cA);
+    else {
+        GET_PIXELVALS(cR, cG, cB, cA, color, fmt, ppa);
+    }
+    cR = MIN(cR, cA);
+    cG = MIN(cG, cA);
+    cB = MIN(cB, cA);
+
+    switch (bpp) {
+        case 1: {
+            while (height--) {
+                LOOP_UNROLLED4(
+                    {
+                        GET_PIXELVALS_1(sR, sG, sB, sA, pixels, fmt);
+                        ALPHA_BLEND_PREMULTIPLIED(tmp, cR, cG, cB, cA, sR, sG,
+                                                  sB, sA);
+                        *pixels = SDL_MapRGBA(fmt, sR, sG, sB, sA);
+                        pixels += bpp;
+                    },
+                    n, width);
+                pixels += skip;
+            }
+            result = 0;
+            break;
+        }
+        case 3: {
+            size_t offsetR, offsetG, offsetB;
+            SET_OFFSETS_24(offsetR, offsetG, offsetB, fmt);
+            while (height--) {
+                LOOP_UNROLLED4(
+                    {
+                        GET_PIXEL(pixel, bpp, pixels);
+                        GET_PIXELVALS(sR, sG, sB, sA, pixel, fmt, ppa);
+                        ALPHA_BLEND_PREMULTIPLIED(tmp, cR, cG, cB, cA, sR, sG,
+                                                  sB, sA);
+                        pixels[offsetR] = sR;
+                        pixels[offsetG] = sG;
+                        pixels[offsetB] = sB;
+                        pixels += bpp;
+                    },
+                    n, width);
+                pixels += skip;
+            }
+            result = 0;
+            break;
+        }
+        default: {
+            while (height--) {
+                LOOP_UNROLLED4(
+                    {
+                        GET_PIXEL(pixel, bpp, pixels);
+                        GET_PIXELVALS(sR, sG, sB, sA, pixel, fmt, ppa);
+                        ALPHA_BLEND_PREMULTIPLIED(tmp, cR, cG, cB, cA, sR, sG,
+                                                  sB, sA);
+                        CREATE_PIXEL(pixels, sR, sG, sB, sA, bpp, fmt);
+                        pixels += bpp;
+                    },
+                    n, width);
+                pixels += skip;
+            }
+            result = 0;
+            break;
+        }
+    }
+    return result;
+}
+
 int
 surface_fill_blend(SDL_Surface *surface, SDL_Rect *rect, Uint32 color,
                    int blendargs)
@@ -907,6 +1001,11 @@ surface_fill_blend(SDL_Surface *surface, SDL_Rect *rect, Uint32 color,
             break;
         }
 
+        case PYGAME_BLEND_PREMULTIPLIED: {
+            result = surface_fill_blend_premultiplied(surface, rect, color);
+            break;
+        }
+
         default: {
             result = -1;
             break;
@@ -30,10 +30,14 @@
 
 #include "doc/transform_doc.h"
 
+#include <limits.h>
 #include <math.h>
 #include <string.h>
 
 #include "scale.h"
+#include "pgflip.h"
+#include "pgthreads.h"
+#include "simd_shared.h"
 
 typedef void (*SMOOTHSCALE_FILTER_P)(Uint8 *, Uint8 *, int, int, int, int,
                                      int);
@@ -176,12 +180,30 @@ newsurf_fromsurf(SDL_Surface *surf, int width, int height)
     return newsurf;
 }
 
-static SDL_Surface *
-rotate90(SDL_Surface *src, int angle)
+/* A surface made from a premultiplied surface by filtering or resampling
+ * is premultiplied too. Marks result, a new or destination surface object,
+ * to match src and returns it.
+ */
+static PyObject *
+_keep_premultiplied(pgSurfaceObject *src, PyObject *result)
+{
+    if (result) {
+        SDL_Surface *newsurf = pgSurface_AsSurface(result);
+
+        pg_SetPremultiplied(newsurf,
+                            pg_IsPremultiplied(pgSurface_AsSurface(src)) &&
+                                newsurf->format->Amask != 0);
+    }
+    return result;
+}
+
+/* dst must be src->w x src->h for half turns and src->h x src->w for
+   quarter turns. A half turn or none may be done with dst == src. */
+static void
+rotate90(SDL_Surface *src, SDL_Surface *dst, int angle)
 {
     int numturns = (angle / 90) % 4;
-    int dstwidth, dstheight;
-    SDL_Surface *dst;
+    int dstwidth = dst->w, dstheight = dst->h;
     char *srcpix, *dstpix, *srcrow, *dstrow;
     int srcstepx, srcstepy, dststepx, dststepy;
     int loopx, loopy;
@@ -189,18 +211,11 @@ rotate90(SDL_Surface *src, int angle)
     if (numturns < 0)
         numturns = 4 + numturns;
     if (!(numturns % 2)) {
-        dstwidth = src->w;
-        dstheight = src->h;
-    }
-    else {
-        dstwidth = src->h;
-        dstheight = src->w;
+        /* a half turn is a flip on both axes */
+        pg_flip_surface(src, dst, numturns, numturns);
+        return;
     }
 
-    dst = newsurf_fromsurf(src, dstwidth, dstheight);
-    if (!dst)
-        return NULL;
-    SDL_LockSurface(dst);
     srcrow = (char *)src->pixels;
     dstrow = (char *)dst->pixels;
     srcstepx = dststepx = src->format->BytesPerPixel;
@@ -208,17 +223,11 @@ rotate90(SDL_Surface *src, int angle)
     dststepy = dst->pitch;
 
     switch (numturns) {
-            /*case 0: we don't need to change anything*/
         case 1:
             srcrow += ((src->w - 1) * srcstepx);
             srcstepy = -srcstepx;
             srcstepx = src->pitch;
             break;
-        case 2:
-            srcrow += ((src->h - 1) * srcstepy) + ((src->w - 1) * srcstepx);
-            srcstepx = -srcstepx;
-            srcstepy = -srcstepy;
-            break;
         case 3:
             srcrow += ((src->h - 1) * srcstepy);
             srcstepx = -srcstepy;
@@ -282,8 +291,6 @@ rotate90(SDL_Surface *src, int angle)
             }
             break;
     }
-    SDL_UnlockSurface(dst);
-    return dst;
 }
 
 static void
@@ -395,6 +402,302 @@ rotate(SDL_Surface *src, SDL_Surface *dst, Uint32 bgcolor, double sangle,
     }
 }
 
+/* Returns the color used for pixels a transform maps from outside the
+   source: the colorkey if there is one, else the top left pixel with its
+   alpha cleared. */
+static Uint32
+_get_bgcolor(SDL_Surface *surf)
+{
+    Uint32 bgcolor;
+
+    if (SDL_GetColorKey(surf, &bgcolor) == 0)
+        return bgcolor;
+
+    SDL_LockSurface(surf);
+    switch (surf->format->BytesPerPixel) {
+        case 1:
+            bgcolor = *(Uint8 *)surf->pixels;
+            break;
+        case 2:
+            bgcolor = *(Uint16 *)surf->pixels;
+            break;
+        case 4:
+            bgcolor = *(Uint32 *)surf->pixels;
+            break;
+        default: /*case 3:*/
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            bgcolor = (((Uint8 *)surf->pixels)[0]) +
+                      (((Uint8 *)surf->pixels)[1] << 8) +
+                      (((Uint8 *)surf->pixels)[2] << 16);
+#else
+            bgcolor = (((Uint8 *)surf->pixels)[2]) +
+                      (((Uint8 *)surf->pixels)[1] << 8) +
+                      (((Uint8 *)surf->pixels)[0] << 16);
+#endif
+    }
+    SDL_UnlockSurface(surf);
+    return bgcolor & ~surf->format->Amask;
+}
+
+/* affine() maps every destination pixel centre back into the source with
+   the inverse matrix inv (row major 2x2), where (tx, ty) is the
+   destination position of the source origin. Source coordinates are
+   stepped along each row in 16.16 fixed point, like rotate(). */
+typedef struct {
+    SDL_Surface *src;
+    SDL_Surface *dst;
+    double inv[4];
+    double tx, ty;
+    Uint32 bgcolor;
+    int smooth;
+} _affine_info;
+
+/* Far enough outside any surface, and small enough to step a full row
+   from without overflowing. */
+#define AFFINE_FIXED_LIMIT ((double)((Sint64)1 << 40))
+#define AFFINE_MAX_STEP 32767.0
+
+static Sint64
+_affine_fixed(double value)
+{
+    value = floor(value * 65536.0 + 0.5);
+    if (value > AFFINE_FIXED_LIMIT)
+        return (Sint64)AFFINE_FIXED_LIMIT;
+    if (value < -AFFINE_FIXED_LIMIT)
+        return -(Sint64)AFFINE_FIXED_LIMIT;
+    return (Sint64)value;
+}
+
+/* Source position of the centre of destination pixel (0, y), 16.16. */
+static void
+_affine_row_start(_affine_info *info, int y, Sint64 *sx, Sint64 *sy)
+{
+    double px = 0.5 - info->tx;
+    double py = y + 0.5 - info->ty;
+
+    *sx = _affine_fixed(info->inv[0] * px + info->inv[1] * py);
+    *sy = _affine_fixed(info->inv[2] * px + info->inv[3] * py);
+}
+
+#define _AFFINE_NEAREST(pixel_t)                                             \
+    for (y = y0; y < y1; y++) {                                              \
+        pixel_t *dstpos = (pixel_t *)(dstrow + (Sint64)y * dstpitch);        \
+        _affine_row_start(info, y, &sx, &sy);                                \
+        for (x = 0; x < dst->w; x++, sx += stepx, sy += stepy) {             \
+            if ((Uint64)sx < xmax && (Uint64)sy < ymax)                      \
+                dstpos[x] =                                                  \
+                    ((pixel_t *)(srcpix + (sy >> 16) * srcpitch))[sx >> 16]; \
+            else                                                             \
+                dstpos[x] = (pixel_t)bgcolor;                                \
+        }                                                                    \
+    }
+
+static void
+_affine_nearest(_affine_info *info, int y0, int y1)
+{
+    SDL_Surface *src = info->src, *dst = info->dst;
+    Uint8 *srcpix = (Uint8 *)src->pixels;
+    Uint8 *dstrow = (Uint8 *)dst->pixels;
+    Sint64 srcpitch = src->pitch;
+    Sint64 dstpitch = dst->pitch;
+    Uint64 xmax = (Uint64)src->w << 16;
+    Uint64 ymax = (Uint64)src->h << 16;
+    Sint64 stepx = _affine_fixed(info->inv[0]);
+    Sint64 stepy = _affine_fixed(info->inv[2]);
+    Uint32 bgcolor = info->bgcolor;
+    Sint64 sx, sy;
+    int x, y;
+
+    switch (src->format->BytesPerPixel) {
+        case 1:
+            _AFFINE_NEAREST(Uint8);
+            break;
+        case 2:
+            _AFFINE_NEAREST(Uint16);
+            break;
+        case 4:
+            _AFFINE_NEAREST(Uint32);
+            break;
+        default: /*case 3:*/
+        {
+            Uint8 bg[3];
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            bg[0] = (Uint8)bgcolor;
+            bg[1] = (Uint8)(bgcolor >> 8);
+            bg[2] = (Uint8)(bgcolor >> 16);
+#else
+            bg[0] = (Uint8)(bgcolor >> 16);
+            bg[1] = (Uint8)(bgcolor >> 8);
+            bg[2] = (Uint8)bgcolor;
+#endif
+            for (y = y0; y < y1; y++) {
+                Uint8 *dstpos = dstrow + (Sint64)y * dstpitch;
+                _affine_row_start(info, y, &sx, &sy);
+                for (x = 0; x < dst->w; x++, sx += stepx, sy += stepy) {
+                    Uint8 *srcpos = bg;
+                    if ((Uint64)sx < xmax && (Uint64)sy < ymax)
+                        srcpos = srcpix + (sy >> 16) * srcpitch +
+                                 (sx >> 16) * 3;
+                    dstpos[0] = srcpos[0];
+                    dstpos[1] = srcpos[1];
+                    dstpos[2] = srcpos[2];
+                    dstpos += 3;
+                }
+            }
+            break;
+        }
+    }
+}
+
+#undef _AFFINE_NEAREST
+
+/* Bilinear sampling for 24 and 32 bit surfaces. Neighbours outside the
+   source take the background color, so edges fade into it. The weights
+   are 8 bit; the vertical lerp is done first and both stages round, the
+   SSE2 path computes exactly the same values. */
+static void
+_affine_smooth(_affine_info *info, int y0, int y1)
+{
+    SDL_Surface *src = info->src, *dst = info->dst;
+    int bpp = src->format->BytesPerPixel;
+    Uint8 *srcpix = (Uint8 *)src->pixels;
+    Uint8 *dstrow = (Uint8 *)dst->pixels;
+    Sint64 srcpitch = src->pitch;
+    Sint64 dstpitch = dst->pitch;
+    Sint64 stepx = _affine_fixed(info->inv[0]);
+    Sint64 stepy = _affine_fixed(info->inv[2]);
+    Sint64 sx, sy;
+    Uint8 bg[4];
+    int x, y, i;
+#if PG_HAS_SSE2_OR_NEON
+    int use_simd = bpp == 4 && pg_HasSSE_NEON();
+    __m128i zero = _mm_setzero_si128();
+    __m128i half = _mm_set1_epi16(128);
+#endif /* PG_HAS_SSE2_OR_NEON */
+
+    if (bpp == 4) {
+        memcpy(bg, &info->bgcolor, 4);
+    }
+    else {
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+        bg[0] = (Uint8)info->bgcolor;
+        bg[1] = (Uint8)(info->bgcolor >> 8);
+        bg[2] = (Uint8)(info->bgcolor >> 16);
+#else
+        bg[0] = (Uint8)(info->bgcolor >> 16);
+        bg[1] = (Uint8)(info->bgcolor >> 8);
+        bg[2] = (Uint8)info->bgcolor;
+#endif
+    }
+
+    for (y = y0; y < y1; y++) {
+        Uint8 *dstpos = dstrow + (Sint64)y * dstpitch;
+
+        _affine_row_start(info, y, &sx, &sy);
+        /* sample between the four pixel centres around the point */
+        sx -= 0x8000;
+        sy -= 0x8000;
+        for (x = 0; x < dst->w; x++, sx += stepx, sy += stepy, dstpos += bpp) {
+            Uint8 *p00, *p01, *p10, *p11;
+            Sint64 ix, iy;
+            int fx, fy;
+
+            if (sx < -0x10000 || sy < -0x10000 ||
+                sx >= ((Sint64)src->w << 16) || sy >= ((Sint64)src->h << 16)) {
+                for (i = 0; i < bpp; i++)
+                    dstpos[i] = bg[i];
+                continue;
+            }
+            ix = ((sx + 0x10000) >> 16) - 1;
+            iy = ((sy + 0x10000) >> 16) - 1;
+            fx = (int)(((Uint64)sx >> 8) & 0xff);
+            fy = (int)(((Uint64)sy >> 8) & 0xff);
+
+            if (ix >= 0 && iy >= 0 && ix + 1 < src->w && iy + 1 < src->h) {
+                p00 = srcpix + iy * srcpitch + ix * bpp;
+#if PG_HAS_SSE2_OR_NEON
+                if (use_simd) {
+                    __m128i top, bottom, v, t;
+
+                    top = _mm_unpacklo_epi8(
+                        _mm_loadl_epi64((const __m128i *)p00), zero);
+                    bottom = _mm_unpacklo_epi8(
+                        _mm_loadl_epi64((const __m128i *)(p00 + srcpitch)),
+                        zero);
+                    v = _mm_add_epi16(
+                        _mm_mullo_epi16(top, _mm_set1_epi16(256 - fy)),
+                        _mm_mullo_epi16(bottom, _mm_set1_epi16(fy)));
+                    v = _mm_srli_epi16(_mm_add_epi16(v, half), 8);
+                    t = _mm_mullo_epi16(
+                        v, _mm_set_epi16(fx, fx, fx, fx, 256 - fx, 256 - fx,
+                                         256 - fx, 256 - fx));
+                    t = _mm_add_epi16(t, _mm_srli_si128(t, 8));
+                    t = _mm_srli_epi16(_mm_add_epi16(t, half), 8);
+                    *(Uint32 *)dstpos =
+                        (Uint32)_mm_cvtsi128_si32(_mm_packus_epi16(t, t));
+                    continue;
+                }
+#endif /* PG_HAS_SSE2_OR_NEON */
+                p01 = p00 + bpp;
+                p10 = p00 + srcpitch;
+                p11 = p10 + bpp;
+            }
+            else {
+                int left = ix >= 0, right = ix + 1 < src->w;
+                int upper = iy >= 0, lower = iy + 1 < src->h;
+
+                p00 = (upper && left) ? srcpix + iy * srcpitch + ix * bpp
+                                      : bg;
+                p01 = (upper && right)
+                          ? srcpix + iy * srcpitch + (ix + 1) * bpp
+                          : bg;
+                p10 = (lower && left)
+                          ? srcpix + (iy + 1) * srcpitch + ix * bpp
+                          : bg;
+                p11 = (lower && right)
+                          ? srcpix + (iy + 1) * srcpitch + (ix + 1) * bpp
+                          : bg;
+            }
+
+            for (i = 0; i < bpp; i++) {
+                int v0 = (p00[i] * (256 - fy) + p10[i] * fy + 128) >> 8;
+                int v1 = (p01[i] * (256 - fy) + p11[i] * fy + 128) >> 8;
+                dstpos[i] = (Uint8)((v0 * (256 - fx) + v1 * fx + 128) >> 8);
+            }
+        }
+    }
+}
+
+static int
+_affine_band(void *data, int y0, int y1)
+{
+    _affine_info *info = (_affine_info *)data;
+
+    if (info->smooth)
+        _affine_smooth(info, y0, y1);
+    else
+        _affine_nearest(info, y0, y1);
+    return 0;
+}
+
+static void
+affine(SDL_Surface *src, SDL_Surface *dst, const double *inv, double tx,
+       double ty, Uint32 bgcolor, int smooth)
+{
+    _affine_info info;
+
+    info.src = src;
+    info.dst = dst;
+    memcpy(info.inv, inv, sizeof(info.inv));
+    info.tx = tx;
+    info.ty = ty;
+    info.bgcolor = bgcolor;
+    info.smooth = smooth;
+
+    pg_run_bands(_affine_band, &info, dst->h,
+                 pg_band_count(dst->w, dst->h, 16));
+}
+
 static void
 stretch(SDL_Surface *src, SDL_Surface *dst)
 {
@@ -562,10 +865,11 @@ surf_scale(PyObject *self, PyObject *args, PyObject *kwargs)
 
     if (surfobj2) {
         Py_INCREF(surfobj2);
-        return surfobj2;
+        return _keep_premultiplied(surfobj, surfobj2);
     }
     else
-        return (PyObject *)pgSurface_New(newsurf);
+        return _keep_premultiplied(surfobj,
+                                   (PyObject *)pgSurface_New(newsurf));
 }
 
 static PyObject *
@@ -627,296 +931,397 @@ surf_scale2x(PyObject *self, PyObject *args, PyObject *kwargs)
 static PyObject *
 surf_rotate(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    pgSurfaceObject *surfobj;
+    pgSurfaceObject *surfobj, *surfobj2 = NULL;
     SDL_Surface *surf, *newsurf;
     float angle;
 
-    double radangle, sangle, cangle;
+    double radangle, sangle = 0.0, cangle = 0.0;
     double x, y, cx, cy, sx, sy;
-    int nxmax, nymax;
-    Uint32 bgcolor;
-    static char *keywords[] = {"surface", "angle", NULL};
+    int nxmax, nymax, quarter;
+    Uint32 bgcolor = 0;
+    static char *keywords[] = {"surface", "angle", "dest_surface", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!f", keywords,
-                                     &pgSurface_Type, &surfobj, &angle))
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!f|O!", keywords,
+                                     &pgSurface_Type, &surfobj, &angle,
+                                     &pgSurface_Type, &surfobj2))
         return NULL;
     surf = pgSurface_AsSurface(surfobj);
     if (surf->w < 1 || surf->h < 1) {
+        if (surfobj2)
+            surfobj = surfobj2;
         Py_INCREF(surfobj);
-        return surfobj;
+        return (PyObject *)surfobj;
     }
 
     if (surf->format->BytesPerPixel == 0 || surf->format->BytesPerPixel > 4)
         return RAISE(PyExc_ValueError,
                      "unsupport Surface bit depth for transform");
 
-    if (!(fmod((double)angle, (double)90.0f))) {
-        pgSurface_Lock(surfobj);
-
-        Py_BEGIN_ALLOW_THREADS;
-        newsurf = rotate90(surf, (int)angle);
-        Py_END_ALLOW_THREADS;
+    quarter = !(fmod((double)angle, (double)90.0f));
+    if (quarter) {
+        if (((int)angle / 90) % 2) {
+            nxmax = surf->h;
+            nymax = surf->w;
+        }
+        else {
+            nxmax = surf->w;
+            nymax = surf->h;
+        }
+    }
+    else {
+        radangle = angle * .01745329251994329;
+        sangle = sin(radangle);
+        cangle = cos(radangle);
+
+        x = surf->w;
+        y = surf->h;
+        cx = cangle * x;
+        cy = cangle * y;
+        sx = sangle * x;
+        sy = sangle * y;
+        nxmax = (int)(MAX(MAX(MAX(fabs(cx + sy), fabs(cx - sy)),
+                              fabs(-cx + sy)),
+                          fabs(-cx - sy)));
+        nymax = (int)(MAX(MAX(MAX(fabs(sx + cy), fabs(sx - cy)),
+                              fabs(-sx + cy)),
+                          fabs(-sx - cy)));
+    }
 
-        pgSurface_Unlock(surfobj);
+    if (!surfobj2) {
+        newsurf = newsurf_fromsurf(surf, nxmax, nymax);
         if (!newsurf)
             return NULL;
-        return (PyObject *)pgSurface_New(newsurf);
+    }
+    else {
+        newsurf = pgSurface_AsSurface(surfobj2);
+        if (newsurf->w != nxmax || newsurf->h != nymax)
+            return RAISE(PyExc_ValueError,
+                         "Destination surface not the size of the rotated "
+                         "surface.");
+        if (newsurf->format->BytesPerPixel != surf->format->BytesPerPixel)
+            return RAISE(PyExc_ValueError,
+                         "Source and destination surfaces need the same "
+                         "format.");
+        /* only half turns can swap pixels in place */
+        if (newsurf == surf && (!quarter || ((int)angle / 90) % 2))
+            return RAISE(PyExc_ValueError,
+                         "Can only rotate in place by multiples of 180 "
+                         "degrees.");
     }
 
-    radangle = angle * .01745329251994329;
-    sangle = sin(radangle);
-    cangle = cos(radangle);
-
-    x = surf->w;
-    y = surf->h;
-    cx = cangle * x;
-    cy = cangle * y;
-    sx = sangle * x;
-    sy = sangle * y;
-    nxmax = (int)(MAX(MAX(MAX(fabs(cx + sy), fabs(cx - sy)), fabs(-cx + sy)),
-                      fabs(-cx - sy)));
-    nymax = (int)(MAX(MAX(MAX(fabs(sx + cy), fabs(sx - cy)), fabs(-sx + cy)),
-                      fabs(-sx - cy)));
-
-    newsurf = newsurf_fromsurf(surf, nxmax, nymax);
-    if (!newsurf)
-        return NULL;
-
+    if (!quarter) {
         /* get the background color */
-    if (SDL_GetColorKey(surf, &bgcolor) != 0)
-    {
-        SDL_LockSurface(surf);
-        switch (surf->format->BytesPerPixel) {
-            case 1:
-                bgcolor = *(Uint8 *)surf->pixels;
-                break;
-            case 2:
-                bgcolor = *(Uint16 *)surf->pixels;
-                break;
-            case 4:
-                bgcolor = *(Uint32 *)surf->pixels;
-                break;
-            default: /*case 3:*/
-#if SDL_BYTEORDER == SDL_LIL_ENDIAN
-                bgcolor = (((Uint8 *)surf->pixels)[0]) +
-                          (((Uint8 *)surf->pixels)[1] << 8) +
-                          (((Uint8 *)surf->pixels)[2] << 16);
-#else
-                bgcolor = (((Uint8 *)surf->pixels)[2]) +
-                          (((Uint8 *)surf->pixels)[1] << 8) +
-                          (((Uint8 *)surf->pixels)[0] << 16);
-#endif
-        }
-        SDL_UnlockSurface(surf);
-        bgcolor &= ~surf->format->Amask;
+        bgcolor = _get_bgcolor(surf);
     }
 
-    SDL_LockSurface(newsurf);
+    if (newsurf != surf)
+        SDL_LockSurface(newsurf);
     pgSurface_Lock(surfobj);
 
     Py_BEGIN_ALLOW_THREADS;
-    rotate(surf, newsurf, bgcolor, sangle, cangle);
+    if (quarter)
+        rotate90(surf, newsurf, (int)angle);
+    else
+        rotate(surf, newsurf, bgcolor, sangle, cangle);
     Py_END_ALLOW_THREADS;
 
     pgSurface_Unlock(surfobj);
-    SDL_UnlockSurface(newsurf);
+    if (newsurf != surf)
+        SDL_UnlockSurface(newsurf);
 
-    return (PyObject *)pgSurface_New(newsurf);
+    if (surfobj2) {
+        Py_INCREF(surfobj2);
+        return (PyObject *)surfobj2;
+    }
+    else
+        return (PyObject *)pgSurface_New(newsurf);
 }
 
-static PyObject *
-surf_flip(PyObject *self, PyObject *args, PyObject *kwargs)
+/* Reads a matrix given as two rows of two or three numbers into
+   m = {a, b, tx, c, d, ty}. The translation defaults to 0. */
+static int
+_get_affine_matrix(PyObject *obj, double *m)
 {
-    pgSurfaceObject *surfobj;
-    SDL_Surface *surf, *newsurf;
-    int xaxis, yaxis;
-    int loopx, loopy;
-    int srcpitch, dstpitch;
-    Uint8 *srcpix, *dstpix;
-    static char *keywords[] = {"surface", "flip_x", "flip_y", NULL};
-
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!ii", keywords,
-                                     &pgSurface_Type, &surfobj, &xaxis,
-                                     &yaxis))
-        return NULL;
-    surf = pgSurface_AsSurface(surfobj);
-
-    newsurf = newsurf_fromsurf(surf, surf->w, surf->h);
-    if (!newsurf)
-        return NULL;
-
-    srcpitch = surf->pitch;
-    dstpitch = newsurf->pitch;
-
-    SDL_LockSurface(newsurf);
-    pgSurface_Lock(surfobj);
+    Py_ssize_t j, i, len;
 
-    srcpix = (Uint8 *)surf->pixels;
-    dstpix = (Uint8 *)newsurf->pixels;
-
-    Py_BEGIN_ALLOW_THREADS;
+    m[2] = m[5] = 0.0;
+    if (!PySequence_Check(obj) || PyUnicode_Check(obj) ||
+        PySequence_Length(obj) != 2) {
+        PyErr_SetString(PyExc_TypeError,
+                        "matrix must be two rows of 2 or 3 numbers");
+        return 0;
+    }
 
-    if (!xaxis) {
-        if (!yaxis) {
-            for (loopy = 0; loopy < surf->h; ++loopy)
-                memcpy(dstpix + loopy * dstpitch, srcpix + loopy * srcpitch,
-                       surf->w * surf->format->BytesPerPixel);
-        }
-        else {
-            for (loopy = 0; loopy < surf->h; ++loopy)
-                memcpy(dstpix + loopy * dstpitch,
-                       srcpix + (surf->h - 1 - loopy) * srcpitch,
-                       surf->w * surf->format->BytesPerPixel);
+    for (j = 0; j < 2; j++) {
+        PyObject *row = PySequence_GetItem(obj, j);
+
+        if (!row)
+            return 0;
+        len = PySequence_Check(row) && !PyUnicode_Check(row)
+                  ? PySequence_Length(row)
+                  : -1;
+        if (len != 2 && len != 3) {
+            Py_DECREF(row);
+            PyErr_Clear();
+            PyErr_SetString(PyExc_TypeError,
+                            "matrix must be two rows of 2 or 3 numbers");
+            return 0;
         }
-    }
-    else /*if (xaxis)*/
-    {
-        if (yaxis) {
-            switch (surf->format->BytesPerPixel) {
-                case 1:
-                    for (loopy = 0; loopy < surf->h; ++loopy) {
-                        Uint8 *dst = (Uint8 *)(dstpix + loopy * dstpitch);
-                        Uint8 *src =
-                            ((Uint8 *)(srcpix +
-                                       (surf->h - 1 - loopy) * srcpitch)) +
-                            surf->w - 1;
-                        for (loopx = 0; loopx < surf->w; ++loopx)
-                            *dst++ = *src--;
-                    }
-                    break;
-                case 2:
-                    for (loopy = 0; loopy < surf->h; ++loopy) {
-                        Uint16 *dst = (Uint16 *)(dstpix + loopy * dstpitch);
-                        Uint16 *src =
-                            ((Uint16 *)(srcpix +
-                                        (surf->h - 1 - loopy) * srcpitch)) +
-                            surf->w - 1;
-                        for (loopx = 0; loopx < surf->w; ++loopx)
-                            *dst++ = *src--;
-                    }
-                    break;
-                case 4:
-                    for (loopy = 0; loopy < surf->h; ++loopy) {
-                        Uint32 *dst = (Uint32 *)(dstpix + loopy * dstpitch);
-                        Uint32 *src =
-                            ((Uint32 *)(srcpix +
-                                        (surf->h - 1 - loopy) * srcpitch)) +
-                            surf->w - 1;
-                        for (loopx = 0; loopx < surf->w; ++loopx)
-                            *dst++ = *src--;
-                    }
-                    break;
-                case 3:
-                    for (loopy = 0; loopy < surf->h; ++loopy) {
-                        Uint8 *dst = (Uint8 *)(dstpix + loopy * dstpitch);
-                        Uint8 *src =
-                            ((Uint8 *)(srcpix +
-                                       (surf->h - 1 - loopy) * srcpitch)) +
-                            surf->w * 3 - 3;
-                        for (loopx = 0; loopx < surf->w; ++loopx) {
-                            dst[0] = src[0];
-                            dst[1] = src[1];
-                            dst[2] = src[2];
-                            dst += 3;
-                            src -= 3;
-                        }
-                    }
-                    break;
+        for (i = 0; i < len; i++) {
+            PyObject *item = PySequence_GetItem(row, i);
+            double value;
+
+            if (!item) {
+                Py_DECREF(row);
+                return 0;
             }
-        }
-        else {
-            switch (surf->format->BytesPerPixel) {
-                case 1:
-                    for (loopy = 0; loopy < surf->h; ++loopy) {
-                        Uint8 *dst = (Uint8 *)(dstpix + loopy * dstpitch);
-                        Uint8 *src = ((Uint8 *)(srcpix + loopy * srcpitch)) +
-                                     surf->w - 1;
-                        for (loopx = 0; loopx < surf->w; ++loopx)
-                            *dst++ = *src--;
-                    }
-                    break;
-                case 2:
-                    for (loopy = 0; loopy < surf->h; ++loopy) {
-                        Uint16 *dst = (Uint16 *)(dstpix + loopy * dstpitch);
-                        Uint16 *src = ((Uint16 *)(srcpix + loopy * srcpitch)) +
-                                      surf->w - 1;
-                        for (loopx = 0; loopx < surf->w; ++loopx)
-                            *dst++ = *src--;
-                    }
-                    break;
-                case 4:
-                    for (loopy = 0; loopy < surf->h; ++loopy) {
-                        Uint32 *dst = (Uint32 *)(dstpix + loopy * dstpitch);
-                        Uint32 *src = ((Uint32 *)(srcpix + loopy * srcpitch)) +
-                                      surf->w - 1;
-                        for (loopx = 0; loopx < surf->w; ++loopx)
-                            *dst++ = *src--;
-                    }
-                    break;
-                case 3:
-                    for (loopy = 0; loopy < surf->h; ++loopy) {
-                        Uint8 *dst = (Uint8 *)(dstpix + loopy * dstpitch);
-                        Uint8 *src = ((Uint8 *)(srcpix + loopy * srcpitch)) +
-                                     surf->w * 3 - 3;
-                        for (loopx = 0; loopx < surf->w; ++loopx) {
-                            dst[0] = src[0];
-                            dst[1] = src[1];
-                            dst[2] = src[2];
-                            dst += 3;
-                            src -= 3;
-                        }
-                    }
-                    break;
+            value = PyFloat_AsDouble(item);
+            Py_DECREF(item);
+            if (value == -1.0 && PyErr_Occurred()) {
+                Py_DECREF(row);
+                return 0;
             }
+            m[j * 3 + i] = value;
         }
+        Py_DECREF(row);
     }
-    Py_END_ALLOW_THREADS;
-
-    pgSurface_Unlock(surfobj);
-    SDL_UnlockSurface(newsurf);
-    return (PyObject *)pgSurface_New(newsurf);
+    return 1;
 }
 
 static PyObject *
-surf_rotozoom(PyObject *self, PyObject *args, PyObject *kwargs)
+surf_affine(PyObject *self, PyObject *args, PyObject *kwargs)
 {
-    pgSurfaceObject *surfobj;
-    SDL_Surface *surf, *newsurf, *surf32;
-    float scale, angle;
-    static char *keywords[] = {"surface", "angle", "scale", NULL};
+    pgSurfaceObject *surfobj, *surfobj2 = NULL;
+    PyObject *matrixobj, *size = Py_None;
+    SDL_Surface *surf, *newsurf;
+    double m[6], inv[4], det, tx, ty;
+    int smooth = 0, width = 0, height = 0, bpp, i;
+    Uint32 bgcolor;
+    static char *keywords[] = {"surface", "matrix",       "size",
+                               "smooth",  "dest_surface", NULL};
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!ff", keywords,
-                                     &pgSurface_Type, &surfobj, &angle,
-                                     &scale))
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O|OpO!", keywords,
+                                     &pgSurface_Type, &surfobj, &matrixobj,
+                                     &size, &smooth, &pgSurface_Type,
+                                     &surfobj2))
+        return NULL;
+
+    if (!_get_affine_matrix(matrixobj, m))
         return NULL;
+
+    det = m[0] * m[4] - m[1] * m[3];
+    if (det == 0.0 || !isfinite(det) || !isfinite(m[2]) || !isfinite(m[5]))
+        return RAISE(PyExc_ValueError, "matrix is not invertible");
+    inv[0] = m[4] / det;
+    inv[1] = -m[1] / det;
+    inv[2] = -m[3] / det;
+    inv[3] = m[0] / det;
+    /* the per pixel steps have to fit the fixed point stepping */
+    for (i = 0; i < 4; i++) {
+        if (!(fabs(inv[i]) <= AFFINE_MAX_STEP))
+            return RAISE(PyExc_ValueError, "matrix is not invertible");
+    }
+
     surf = pgSurface_AsSurface(surfobj);
-    if (scale == 0.0 || surf->w == 0 || surf->h ==0) {
-        newsurf = newsurf_fromsurf(surf, 0, 0);
-        return (PyObject *)pgSurface_New(newsurf);
+    bpp = surf->format->BytesPerPixel;
+    if (bpp == 0 || bpp > 4)
+        return RAISE(PyExc_ValueError,
+                     "unsupport Surface bit depth for transform");
+    if (smooth && bpp < 3)
+        return RAISE(PyExc_ValueError,
+                     "Only 24-bit or 32-bit surfaces can be smoothly "
+                     "transformed");
+
+    if (size != Py_None) {
+        if (!pg_TwoIntsFromObj(size, &width, &height))
+            return RAISE(PyExc_TypeError, "size must be two numbers");
+        if (width < 0 || height < 0)
+            return RAISE(PyExc_ValueError,
+                         "Cannot transform to negative size");
     }
 
-    if (surf->format->BitsPerPixel == 32) {
-        surf32 = surf;
-        pgSurface_Lock(surfobj);
+    if (size == Py_None && !surfobj2) {
+        /* fit the output tightly around the transformed corners */
+        double xs[4], ys[4], minx, maxx, miny, maxy;
+
+        xs[0] = 0.0;
+        ys[0] = 0.0;
+        xs[1] = m[0] * surf->w;
+        ys[1] = m[3] * surf->w;
+        xs[2] = m[1] * surf->h;
+        ys[2] = m[4] * surf->h;
+        xs[3] = xs[1] + xs[2];
+        ys[3] = ys[1] + ys[2];
+        minx = maxx = xs[0];
+        miny = maxy = ys[0];
+        for (i = 1; i < 4; i++) {
+            minx = MIN(minx, xs[i]);
+            maxx = MAX(maxx, xs[i]);
+            miny = MIN(miny, ys[i]);
+            maxy = MAX(maxy, ys[i]);
+        }
+        if (maxx - minx > 0x7fff || maxy - miny > 0x7fff)
+            return RAISE(PyExc_ValueError, "transformed surface too large");
+        /* ignore rounding noise so that exact sizes are not grown */
+        width = (int)ceil(maxx - minx - 1e-6);
+        height = (int)ceil(maxy - miny - 1e-6);
+        tx = -minx;
+        ty = -miny;
     }
     else {
-        Py_BEGIN_ALLOW_THREADS;
-        surf32 = SDL_CreateRGBSurface(SDL_SWSURFACE, surf->w, surf->h, 32,
-                                      0x000000ff, 0x0000ff00, 0x00ff0000,
-                                      0xff000000);
-        SDL_BlitSurface(surf, NULL, surf32, NULL);
-        Py_END_ALLOW_THREADS;
+        tx = m[2];
+        ty = m[5];
     }
 
-    Py_BEGIN_ALLOW_THREADS;
-    newsurf = rotozoomSurface(surf32, angle, scale, 1);
-    Py_END_ALLOW_THREADS;
-
-    if (surf32 == surf)
-        pgSurface_Unlock(surfobj);
-    else
+    if (!surfobj2) {
+        newsurf = newsurf_fromsurf(surf, width, height);
+        if (!newsurf)
+            return NULL;
+    }
+    else {
+        newsurf = pgSurface_AsSurface(surfobj2);
+        if (newsurf == surf)
+            return RAISE(PyExc_ValueError,
+                         "Source and destination surfaces must differ.");
+        if (size != Py_None &&
+            (newsurf->w != width || newsurf->h != height))
+            return RAISE(PyExc_ValueError,
+                         "Destination surface not the given width or "
+                         "height.");
+        if (newsurf->format->BytesPerPixel != bpp)
+            return RAISE(PyExc_ValueError,
+                         "Source and destination surfaces need the same "
+                         "format.");
+    }
+
+    if (surf->w && surf->h && newsurf->w && newsurf->h) {
+        bgcolor = _get_bgcolor(surf);
+
+        SDL_LockSurface(newsurf);
+        pgSurface_Lock(surfobj);
+
+        Py_BEGIN_ALLOW_THREADS;
+        affine(surf, newsurf, inv, tx, ty, bgcolor, smooth);
+        Py_END_ALLOW_THREADS;
+
+        pgSurface_Unlock(surfobj);
+        SDL_UnlockSurface(newsurf);
+    }
+
+    if (surfobj2) {
+        Py_INCREF(surfobj2);
+        return (PyObject *)surfobj2;
+    }
+    else
+        return (PyObject *)pgSurface_New(newsurf);
+}
+
+static PyObject *
+surf_flip(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    pgSurfaceObject *surfobj, *surfobj2 = NULL;
+    SDL_Surface *surf, *newsurf;
+    int xaxis, yaxis;
+    static char *keywords[] = {"surface", "flip_x", "flip_y", "dest_surface",
+                               NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!ii|O!", keywords,
+                                     &pgSurface_Type, &surfobj, &xaxis,
+                                     &yaxis, &pgSurface_Type, &surfobj2))
+        return NULL;
+    surf = pgSurface_AsSurface(surfobj);
+
+    if (!surfobj2) {
+        newsurf = newsurf_fromsurf(surf, surf->w, surf->h);
+        if (!newsurf)
+            return NULL;
+    }
+    else {
+        newsurf = pgSurface_AsSurface(surfobj2);
+        if (newsurf->w != surf->w || newsurf->h != surf->h)
+            return RAISE(PyExc_ValueError,
+                         "Destination surface not the same size.");
+        if (newsurf->format->BytesPerPixel != surf->format->BytesPerPixel)
+            return RAISE(PyExc_ValueError,
+                         "Source and destination surfaces need the same "
+                         "format.");
+    }
+
+    if (newsurf == surf) {
+        pgSurface_Lock(surfobj);
+    }
+    else {
+        SDL_LockSurface(newsurf);
+        pgSurface_Lock(surfobj);
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    pg_flip_surface(surf, newsurf, xaxis, yaxis);
+    Py_END_ALLOW_THREADS;
+
+    pgSurface_Unlock(surfobj);
+    if (newsurf != surf)
+        SDL_UnlockSurface(newsurf);
+
+    if (surfobj2) {
+        Py_INCREF(surfobj2);
+        return (PyObject *)surfobj2;
+    }
+    else
+        return (PyObject *)pgSurface_New(newsurf);
+}
+
+static PyObject *
+surf_rotozoom(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    pgSurfaceObject *surfobj;
+    SDL_Surface *surf, *newsurf, *surf32;
+    float scale, angle;
+    static char *keywords[] = {"surface", "angle", "scale", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!ff", keywords,
+                                     &pgSurface_Type, &surfobj, &angle,
+                                     &scale))
+        return NULL;
+    surf = pgSurface_AsSurface(surfobj);
+    if (scale == 0.0 || surf->w == 0 || surf->h ==0) {
+        newsurf = newsurf_fromsurf(surf, 0, 0);
+        return _keep_premultiplied(surfobj,
+                                   (PyObject *)pgSurface_New(newsurf));
+    }
+
+    if (surf->format->BitsPerPixel == 32) {
+        surf32 = surf;
+        pgSurface_Lock(surfobj);
+    }
+    else if (pg_IsPremultiplied(surf)) {
+        /* blitting would multiply the colors by alpha a second time */
+        pgSurface_Lock(surfobj);
+        Py_BEGIN_ALLOW_THREADS;
+        surf32 = SDL_ConvertSurfaceFormat(surf, SDL_PIXELFORMAT_ABGR8888, 0);
+        Py_END_ALLOW_THREADS;
+        pgSurface_Unlock(surfobj);
+        if (!surf32)
+            return RAISE(pgExc_SDLError, SDL_GetError());
+    }
+    else {
+        Py_BEGIN_ALLOW_THREADS;
+        surf32 = SDL_CreateRGBSurface(SDL_SWSURFACE, surf->w, surf->h, 32,
+                                      0x000000ff, 0x0000ff00, 0x00ff0000,
+                                      0xff000000);
+        SDL_BlitSurface(surf, NULL, surf32, NULL);
+        Py_END_ALLOW_THREADS;
+    }
+
+    Py_BEGIN_ALLOW_THREADS;
+    newsurf = rotozoomSurface(surf32, angle, scale, 1);
+    Py_END_ALLOW_THREADS;
+
+    if (surf32 == surf)
+        pgSurface_Unlock(surfobj);
+    else
         SDL_FreeSurface(surf32);
-    return (PyObject *)pgSurface_New(newsurf);
+    return _keep_premultiplied(surfobj, (PyObject *)pgSurface_New(newsurf));
 }
 
 static SDL_Surface *
@@ -1470,10 +1875,11 @@ surf_scalesmooth(PyObject *self, PyObject *args, PyObject *kwargs)
 
     if (surfobj2) {
         Py_INCREF(surfobj2);
-        return surfobj2;
+        return _keep_premultiplied(surfobj, surfobj2);
     }
     else
-        return (PyObject *)pgSurface_New(newsurf);
+        return _keep_premultiplied(surfobj,
+                                   (PyObject *)pgSurface_New(newsurf));
 }
 
 static PyObject *
@@ -1977,261 +2383,1165 @@ clamp_4
 
 #endif
 
+/* Is this a 32 bit format where every channel fills a whole byte?
+   Then pixels can be handled as four independent Uint8 lanes. */
+static int
+_is_bytealigned_32(SDL_PixelFormat *format)
+{
+    if (format->BytesPerPixel != 4 || format->palette)
+        return 0;
+    if (format->Rloss || format->Gloss || format->Bloss ||
+        format->Rshift % 8 || format->Gshift % 8 || format->Bshift % 8)
+        return 0;
+    if (format->Amask && (format->Aloss || format->Ashift % 8))
+        return 0;
+    return 1;
+}
+
+/* Byte offset of a channel within a pixel, and the reverse. */
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+#define _BYTESLOT(shift) ((shift) >> 3)
+#define _SLOTMASK(slot) ((Uint32)0xff << ((slot) << 3))
+#else
+#define _BYTESLOT(shift) (3 - ((shift) >> 3))
+#define _SLOTMASK(slot) ((Uint32)0xff << ((3 - (slot)) << 3))
+#endif
+
 /*
-number to use for missing samples
+ * convolve: a small (up to 7x7) kernel applied to every channel.
+ *
+ * Every band of rows keeps a ring of kernel height source rows converted
+ * to floats, padded on both sides according to the border mode. An output
+ * pixel is then just a run of multiply-adds over those rows with no bounds
+ * checks, done four pixels (16 floats) at a time with SSE2.
+ *
+ * The float lanes of a pixel are laid out like the bytes of a byte
+ * aligned 32 bit source (see _is_bytealigned_32), otherwise as r, g, b, a.
+ */
+#define CONVOLVE_MAX_SIZE 7
+
+#define CONVOLVE_BORDER_CLAMP 0
+#define CONVOLVE_BORDER_WRAP 1
+#define CONVOLVE_BORDER_CONSTANT 2
+
+typedef struct {
+    SDL_Surface *src;
+    SDL_Surface *dst;
+    float kernel[CONVOLVE_MAX_SIZE * CONVOLVE_MAX_SIZE];
+    int kw, kh;
+    int border;
+    float border_color[4]; /* in lane order */
+    int slots[4];          /* lane of r, g, b and a */
+    int src_direct;        /* src is byte aligned 32 bit */
+    int dst_direct;        /* dst is laid out like the lanes */
+    Uint32 dst_keepmask;
+    Uint32 dst_setmask;
+} _convolve_info;
+
+static PG_INLINE int
+_convolve_map(int v, int size, int border)
+{
+    if (v >= 0 && v < size)
+        return v;
+    if (border == CONVOLVE_BORDER_CLAMP)
+        return v < 0 ? 0 : size - 1;
+    if (border == CONVOLVE_BORDER_WRAP)
+        return ((v % size) + size) % size;
+    return -1;
+}
+
+/* Converts source row y into padded floats, width + kw - 1 pixels. */
+static void
+_convolve_load_row(_convolve_info *info, int y, float *row)
+{
+    SDL_Surface *src = info->src;
+    SDL_PixelFormat *format = src->format;
+    int w = src->w, rx = info->kw / 2;
+    int padded = w + info->kw - 1;
+    float *interior = row + rx * 4;
+    int x, i, sx;
+
+    y = _convolve_map(y, src->h, info->border);
+    if (y < 0) {
+        for (x = 0; x < padded; x++)
+            memcpy(row + x * 4, info->border_color, sizeof(float) * 4);
+        return;
+    }
+
+    if (info->src_direct) {
+        Uint8 *pix = (Uint8 *)src->pixels + y * src->pitch;
+        x = 0;
+#if PG_HAS_SSE2_OR_NEON
+        if (pg_HasSSE_NEON()) {
+            __m128i zero = _mm_setzero_si128();
+            for (; x + 4 <= w; x += 4) {
+                __m128i px = _mm_loadu_si128((__m128i *)(pix + x * 4));
+                __m128i lo = _mm_unpacklo_epi8(px, zero);
+                __m128i hi = _mm_unpackhi_epi8(px, zero);
+                float *f = interior + x * 4;
+                _mm_storeu_ps(f, _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)));
+                _mm_storeu_ps(f + 4,
+                              _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)));
+                _mm_storeu_ps(f + 8,
+                              _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)));
+                _mm_storeu_ps(f + 12,
+                              _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)));
+            }
+        }
+#endif /* PG_HAS_SSE2_OR_NEON */
+        for (x *= 4; x < w * 4; x++)
+            interior[x] = pix[x];
+    }
+    else {
+        Uint8 *pixels = (Uint8 *)src->pixels;
+        Uint8 *pix, rgba[4];
+        Uint32 the_color;
+
+        for (x = 0; x < w; x++) {
+            SURF_GET_AT(the_color, src, x, y, pixels, format, pix);
+            SDL_GetRGBA(the_color, format, rgba, rgba + 1, rgba + 2,
+                        rgba + 3);
+            for (i = 0; i < 4; i++)
+                interior[x * 4 + info->slots[i]] = rgba[i];
+        }
+    }
+
+    for (x = -rx; x < 0; x++) {
+        sx = _convolve_map(x, w, info->border);
+        memcpy(interior + x * 4, sx < 0 ? info->border_color : interior + sx * 4,
+               sizeof(float) * 4);
+    }
+    for (x = w; x < w + rx; x++) {
+        sx = _convolve_map(x, w, info->border);
+        memcpy(interior + x * 4, sx < 0 ? info->border_color : interior + sx * 4,
+               sizeof(float) * 4);
+    }
+}
+
+/* Applies the kernel to one output row, writing clamped bytes in lane
+   order to out (width * 4 bytes). */
+static void
+_convolve_row(_convolve_info *info, float **rows, Uint8 *out, int width)
+{
+    int x = 0, i, j, c;
+    int kw = info->kw, kh = info->kh;
+    float *kernel = info->kernel;
+
+#if PG_HAS_SSE2_OR_NEON
+    if (pg_HasSSE_NEON()) {
+        __m128 zero = _mm_setzero_ps();
+        __m128 top = _mm_set1_ps(255.0f);
+        __m128 half = _mm_set1_ps(.5f);
+
+        for (; x + 4 <= width; x += 4) {
+            __m128 a0 = zero, a1 = zero, a2 = zero, a3 = zero;
+            __m128i c0, c1, c2, c3;
+
+            for (j = 0; j < kh; j++) {
+                float *p = rows[j] + x * 4;
+                for (i = 0; i < kw; i++, p += 4) {
+                    __m128 k = _mm_set1_ps(kernel[j * kw + i]);
+                    a0 = _mm_add_ps(a0, _mm_mul_ps(k, _mm_loadu_ps(p)));
+                    a1 = _mm_add_ps(a1, _mm_mul_ps(k, _mm_loadu_ps(p + 4)));
+                    a2 = _mm_add_ps(a2, _mm_mul_ps(k, _mm_loadu_ps(p + 8)));
+                    a3 = _mm_add_ps(a3, _mm_mul_ps(k, _mm_loadu_ps(p + 12)));
+                }
+            }
+            c0 = _mm_cvttps_epi32(
+                _mm_add_ps(_mm_min_ps(_mm_max_ps(a0, zero), top), half));
+            c1 = _mm_cvttps_epi32(
+                _mm_add_ps(_mm_min_ps(_mm_max_ps(a1, zero), top), half));
+            c2 = _mm_cvttps_epi32(
+                _mm_add_ps(_mm_min_ps(_mm_max_ps(a2, zero), top), half));
+            c3 = _mm_cvttps_epi32(
+                _mm_add_ps(_mm_min_ps(_mm_max_ps(a3, zero), top), half));
+            _mm_storeu_si128((__m128i *)(out + x * 4),
+                             _mm_packus_epi16(_mm_packs_epi32(c0, c1),
+                                              _mm_packs_epi32(c2, c3)));
+        }
+    }
+#endif /* PG_HAS_SSE2_OR_NEON */
+    for (; x < width; x++) {
+        float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+        for (j = 0; j < kh; j++) {
+            float *p = rows[j] + x * 4;
+            for (i = 0; i < kw; i++, p += 4) {
+                float k = kernel[j * kw + i];
+                for (c = 0; c < 4; c++)
+                    acc[c] += k * p[c];
+            }
+        }
+        for (c = 0; c < 4; c++) {
+            float v = acc[c] < 0.0f ? 0.0f : acc[c];
+            out[x * 4 + c] = (Uint8)((v > 255.0f ? 255.0f : v) + .5f);
+        }
+    }
+}
+
+static int
+_convolve_band(void *data, int y0, int y1)
+{
+    _convolve_info *info = (_convolve_info *)data;
+    SDL_Surface *dst = info->dst;
+    SDL_PixelFormat *dstformat = dst->format;
+    Uint8 *dstpixels = (Uint8 *)dst->pixels;
+    int w = info->src->w, kh = info->kh, ry = info->kh / 2;
+    size_t rowfloats = (size_t)(w + info->kw - 1) * 4;
+    float *ring, *rows[CONVOLVE_MAX_SIZE];
+    int ring_y[CONVOLVE_MAX_SIZE];
+    Uint8 *out = NULL;
+    int x, y, j;
+
+    ring = (float *)malloc(sizeof(float) * rowfloats * kh);
+    if (!ring)
+        return -1;
+    if (!info->dst_direct) {
+        out = (Uint8 *)malloc((size_t)w * 4);
+        if (!out) {
+            free(ring);
+            return -1;
+        }
+    }
+    for (j = 0; j < kh; j++)
+        ring_y[j] = INT_MIN;
+
+    for (y = y0; y < y1; y++) {
+        for (j = 0; j < kh; j++) {
+            int sy = y - ry + j;
+            int slot = (sy + kh) % kh;
+
+            if (ring_y[slot] != sy) {
+                _convolve_load_row(info, sy, ring + rowfloats * slot);
+                ring_y[slot] = sy;
+            }
+            rows[j] = ring + rowfloats * slot;
+        }
+
+        if (info->dst_direct) {
+            Uint32 *row = (Uint32 *)(dstpixels + y * dst->pitch);
+
+            _convolve_row(info, rows, (Uint8 *)row, w);
+            for (x = 0; x < w; x++)
+                row[x] = (row[x] & info->dst_keepmask) | info->dst_setmask;
+        }
+        else {
+            Uint8 *byte_buf;
+            Uint32 the_color;
+
+            _convolve_row(info, rows, out, w);
+            for (x = 0; x < w; x++) {
+                Uint8 *lanes = out + x * 4;
+                the_color = SDL_MapRGBA(
+                    dstformat, lanes[info->slots[0]], lanes[info->slots[1]],
+                    lanes[info->slots[2]],
+                    info->src->format->Amask ? lanes[info->slots[3]] : 255);
+                SURF_SET_AT(the_color, dst, x, y, dstpixels, dstformat,
+                            byte_buf);
+            }
+        }
+    }
+
+    free(out);
+    free(ring);
+    return 0;
+}
+
+/* Convolves src into dst, which must be the same size and a different
+   surface. kernel holds kh rows of kw weights, both odd and at most
+   CONVOLVE_MAX_SIZE. border_rgba is only used for
+   CONVOLVE_BORDER_CONSTANT. Both surfaces must be locked. Returns 0, or
+   -1 when out of memory. */
+static int
+convolve(SDL_Surface *src, SDL_Surface *dst, const float *kernel, int kw,
+         int kh, int border, const Uint8 *border_rgba)
+{
+    _convolve_info info;
+    SDL_PixelFormat *srcformat = src->format, *dstformat = dst->format;
+    int i;
+
+    if (!src->w || !src->h)
+        return 0;
+
+    info.src = src;
+    info.dst = dst;
+    memcpy(info.kernel, kernel, sizeof(float) * kw * kh);
+    info.kw = kw;
+    info.kh = kh;
+    info.border = border;
+
+    info.src_direct = _is_bytealigned_32(srcformat);
+    if (info.src_direct) {
+        info.slots[0] = _BYTESLOT(srcformat->Rshift);
+        info.slots[1] = _BYTESLOT(srcformat->Gshift);
+        info.slots[2] = _BYTESLOT(srcformat->Bshift);
+        info.slots[3] = 6 - info.slots[0] - info.slots[1] - info.slots[2];
+    }
+    else {
+        for (i = 0; i < 4; i++)
+            info.slots[i] = i;
+    }
+    for (i = 0; i < 4; i++)
+        info.border_color[info.slots[i]] = border_rgba[i];
+
+    /* results can go straight into dst when it shares the source layout */
+    info.dst_direct =
+        info.src_direct && _is_bytealigned_32(dstformat) &&
+        dstformat->Rmask == srcformat->Rmask &&
+        dstformat->Gmask == srcformat->Gmask &&
+        dstformat->Bmask == srcformat->Bmask &&
+        (!dstformat->Amask || !srcformat->Amask ||
+         dstformat->Amask == srcformat->Amask);
+    info.dst_keepmask = dstformat->Rmask | dstformat->Gmask | dstformat->Bmask;
+    info.dst_setmask = 0;
+    if (srcformat->Amask)
+        info.dst_keepmask |= dstformat->Amask;
+    else
+        info.dst_setmask = dstformat->Amask;
+
+    return pg_run_bands(_convolve_band, &info, src->h,
+                        pg_band_count(src->w, src->h, 16));
+}
+
+/* Reads a kernel given as a sequence of rows of numbers. */
+static int
+_get_convolve_kernel(PyObject *obj, float *kernel, int *kw, int *kh)
+{
+    Py_ssize_t rows, cols = -1, j, i;
+
+    if (!PySequence_Check(obj) || PyUnicode_Check(obj)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "kernel must be a sequence of rows of numbers");
+        return 0;
+    }
+    rows = PySequence_Length(obj);
+    if (rows < 0)
+        return 0;
+    if (rows < 1 || rows > CONVOLVE_MAX_SIZE || !(rows % 2)) {
+        PyErr_Format(PyExc_ValueError,
+                     "kernel must have an odd number of rows, "
+                     "at most %d",
+                     CONVOLVE_MAX_SIZE);
+        return 0;
+    }
+
+    for (j = 0; j < rows; j++) {
+        PyObject *row = PySequence_GetItem(obj, j);
+        Py_ssize_t len;
+
+        if (!row)
+            return 0;
+        if (!PySequence_Check(row) || PyUnicode_Check(row)) {
+            Py_DECREF(row);
+            PyErr_SetString(PyExc_TypeError,
+                            "kernel must be a sequence of rows of numbers");
+            return 0;
+        }
+        len = PySequence_Length(row);
+        if (cols < 0) {
+            cols = len;
+            if (cols < 1 || cols > CONVOLVE_MAX_SIZE || !(cols % 2)) {
+                Py_DECREF(row);
+                PyErr_Format(PyExc_ValueError,
+                             "kernel must have an odd number of columns, "
+                             "at most %d",
+                             CONVOLVE_MAX_SIZE);
+                return 0;
+            }
+        }
+        else if (len != cols) {
+            Py_DECREF(row);
+            PyErr_SetString(PyExc_ValueError,
+                            "kernel rows must all be the same length");
+            return 0;
+        }
+
+        for (i = 0; i < cols; i++) {
+            PyObject *item = PySequence_GetItem(row, i);
+            double value;
+
+            if (!item) {
+                Py_DECREF(row);
+                return 0;
+            }
+            value = PyFloat_AsDouble(item);
+            Py_DECREF(item);
+            if (value == -1.0 && PyErr_Occurred()) {
+                Py_DECREF(row);
+                return 0;
+            }
+            kernel[j * cols + i] = (float)value;
+        }
+        Py_DECREF(row);
+    }
+
+    *kw = (int)cols;
+    *kh = (int)rows;
+    return 1;
+}
+
+static int
+_get_convolve_border(const char *name, int *border)
+{
+    if (!name || !strcmp(name, "clamp"))
+        *border = CONVOLVE_BORDER_CLAMP;
+    else if (!strcmp(name, "wrap"))
+        *border = CONVOLVE_BORDER_WRAP;
+    else if (!strcmp(name, "constant"))
+        *border = CONVOLVE_BORDER_CONSTANT;
+    else {
+        PyErr_SetString(PyExc_ValueError,
+                        "border must be 'clamp', 'wrap' or 'constant'");
+        return 0;
+    }
+    return 1;
+}
+
+/* Runs convolve() for the python functions, handling the destination
+   surface the same way as the other transforms. */
+static PyObject *
+_convolve_surfaces(pgSurfaceObject *surfobj, PyObject *surfobj2,
+                   const float *kernel, int kw, int kh, int border,
+                   const Uint8 *border_rgba)
+{
+    SDL_Surface *surf, *newsurf, *srcsurf;
+    int result;
+
+    surf = pgSurface_AsSurface(surfobj);
+    if (!surf)
+        return RAISE(pgExc_SDLError, "display Surface quit");
+
+    if (!surfobj2) {
+        newsurf = newsurf_fromsurf(surf, surf->w, surf->h);
+        if (!newsurf)
+            return NULL;
+    }
+    else {
+        newsurf = pgSurface_AsSurface(surfobj2);
+        if (!newsurf)
+            return RAISE(pgExc_SDLError, "display Surface quit");
+    }
+
+    /* check to see if the size is the correct size. */
+    if (newsurf->w != (surf->w) || newsurf->h != (surf->h)) {
+        if (!surfobj2)
+            SDL_FreeSurface(newsurf);
+        return RAISE(PyExc_ValueError,
+                     "Destination surface not the same size.");
+    }
+    if (newsurf->format->BytesPerPixel == 0 ||
+        newsurf->format->BytesPerPixel > 4) {
+        return RAISE(PyExc_ValueError,
+                     "unsupport Surface bit depth for transform");
+    }
+
+    srcsurf = surf;
+    if (newsurf == surf) {
+        /* convolving in place: work from a copy of the source */
+        srcsurf = SDL_ConvertSurface(surf, surf->format, 0);
+        if (!srcsurf)
+            return RAISE(pgExc_SDLError, SDL_GetError());
+    }
+    pgSurface_Lock(surfobj);
+    SDL_LockSurface(newsurf);
+    if (srcsurf != surf)
+        SDL_LockSurface(srcsurf);
+
+    Py_BEGIN_ALLOW_THREADS;
+    result = convolve(srcsurf, newsurf, kernel, kw, kh, border, border_rgba);
+    Py_END_ALLOW_THREADS;
+
+    if (srcsurf != surf) {
+        SDL_UnlockSurface(srcsurf);
+        SDL_FreeSurface(srcsurf);
+    }
+    SDL_UnlockSurface(newsurf);
+    pgSurface_Unlock(surfobj);
+
+    if (result < 0) {
+        if (!surfobj2)
+            SDL_FreeSurface(newsurf);
+        return PyErr_NoMemory();
+    }
+
+    if (surfobj2) {
+        Py_INCREF(surfobj2);
+        return surfobj2;
+    }
+    else
+        return (PyObject *)pgSurface_New(newsurf);
+}
+
+static PyObject *
+surf_convolve(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *surfobj, *surfobj2 = NULL, *kernelobj;
+    PyObject *colorobj = NULL;
+    const char *border_name = NULL;
+    float kernel[CONVOLVE_MAX_SIZE * CONVOLVE_MAX_SIZE];
+    Uint8 border_rgba[4] = {0, 0, 0, 0};
+    int kw, kh, border;
+    static char *keywords[] = {"surface",    "kernel",       "dest_surface",
+                               "border",     "border_color", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O|O!zO", keywords,
+                                     &pgSurface_Type, &surfobj, &kernelobj,
+                                     &pgSurface_Type, &surfobj2, &border_name,
+                                     &colorobj))
+        return NULL;
+
+    if (!_get_convolve_kernel(kernelobj, kernel, &kw, &kh))
+        return NULL;
+    if (!_get_convolve_border(border_name, &border))
+        return NULL;
+    if (colorobj && colorobj != Py_None &&
+        !pg_RGBAFromFuzzyColorObj(colorobj, border_rgba))
+        return NULL; /* pg_RGBAFromFuzzyColorObj sets the exception */
+
+    return _convolve_surfaces((pgSurfaceObject *)surfobj, surfobj2, kernel, kw,
+                              kh, border, border_rgba);
+}
+
+/*
+  The laplacian edge detector is a convolve() with this kernel:
+
+    -1 -1 -1
+    -1  8 -1
+    -1 -1 -1
+
+  Samples outside of the surface count as white, which suppresses edges
+  along the border of the surface.
 */
-#define LAPLACIAN_NUM 0xFFFFFFFF
+static const float laplacian_kernel[9] = {-1.0f, -1.0f, -1.0f, -1.0f, 8.0f,
+                                          -1.0f, -1.0f, -1.0f, -1.0f};
+static const Uint8 laplacian_border[4] = {255, 255, 255, 255};
 
-void
+int
 laplacian(SDL_Surface *surf, SDL_Surface *destsurf)
 {
-    int ii;
-    int x, y, height, width;
+    return convolve(surf, destsurf, laplacian_kernel, 3, 3,
+                    CONVOLVE_BORDER_CONSTANT, laplacian_border);
+}
 
-    Uint32 sample[9];
-    // Uint32 total[4];
-    int total[4];
+static PyObject *
+surf_laplacian(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    PyObject *surfobj, *surfobj2 = NULL;
+    SDL_Surface *surf;
+    SDL_Surface *newsurf;
+    static char *keywords[] = {"surface", "dest_surface", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|O!", keywords, 
+                                     &pgSurface_Type, &surfobj,
+                                     &pgSurface_Type, &surfobj2))
+        return NULL;
 
-    Uint8 c1r, c1g, c1b, c1a;
-    // Uint32 c1r, c1g, c1b, c1a;
-    Uint8 acolor[4];
+    surf = pgSurface_AsSurface(surfobj);
 
-    Uint32 the_color;
+    if (surfobj2) {
+        newsurf = pgSurface_AsSurface(surfobj2);
 
-    int atmp0;
-    int atmp1;
-    int atmp2;
-    int atmp3;
+        /* check to see if the size is the correct size. */
+        if (newsurf->w != (surf->w) || newsurf->h != (surf->h))
+            return RAISE(PyExc_ValueError,
+                         "Destination surface not the same size.");
 
-    SDL_PixelFormat *format, *destformat;
-    Uint8 *pixels, *destpixels;
-    Uint8 *pix;
+        /* check to see if the format of the surface is the same. */
+        if (surf->format->BytesPerPixel != newsurf->format->BytesPerPixel)
+            return RAISE(
+                PyExc_ValueError,
+                "Source and destination surfaces need the same format.");
+    }
 
-    Uint8 *byte_buf;
+    return _convolve_surfaces((pgSurfaceObject *)surfobj, surfobj2,
+                              laplacian_kernel, 3, 3, CONVOLVE_BORDER_CONSTANT,
+                              laplacian_border);
+}
 
-    height = surf->h;
-    width = surf->w;
+/*
+ * apply_lut and color_matrix: per pixel color remapping.
+ *
+ * Every output pixel depends only on the same input pixel, so the
+ * destination may be the source itself. Byte aligned 32 bit surfaces of
+ * the same layout are remapped directly on the pixel values. Channels are
+ * addressed by their bit position in the pixel value (shift / 8), not by
+ * memory order. Other formats go through SDL_GetRGBA and SDL_MapRGBA.
+ */
+typedef struct {
+    SDL_Surface *src;
+    SDL_Surface *dst;
+    int direct;
+    /* apply_lut */
+    Uint8 luts[4][256];
+    Uint32 tables[4][256]; /* by bit position, already shifted */
+    /* color_matrix, rows and columns r, g, b, a and the offset column */
+    float matrix[4][5];
+    float columns[4][4]; /* input position to output positions */
+    float offsets[4];
+    Uint32 keepmask; /* bits copied through unchanged */
+} _remap_info;
 
-    pixels = (Uint8 *)surf->pixels;
-    format = surf->format;
+static int
+_remap_is_direct(SDL_Surface *src, SDL_Surface *dst)
+{
+    SDL_PixelFormat *sf = src->format, *df = dst->format;
 
-    destpixels = (Uint8 *)destsurf->pixels;
-    destformat = destsurf->format;
+    return _is_bytealigned_32(sf) && _is_bytealigned_32(df) &&
+           sf->Rmask == df->Rmask && sf->Gmask == df->Gmask &&
+           sf->Bmask == df->Bmask && sf->Amask == df->Amask;
+}
 
-    /*
-        -1 -1 -1
-        -1  8 -1
-        -1 -1 -1
+/* Bit position index of every channel, -1 for a missing alpha. */
+static void
+_remap_positions(SDL_PixelFormat *format, int *positions)
+{
+    positions[0] = format->Rshift >> 3;
+    positions[1] = format->Gshift >> 3;
+    positions[2] = format->Bshift >> 3;
+    positions[3] = format->Amask ? format->Ashift >> 3 : -1;
+}
 
-        col = (sample[4] * 8) - (sample[0] + sample[1] + sample[2] +
-                                 sample[3] +             sample[5] +
-                                 sample[6] + sample[7] + sample[8])
+static int
+_lut_band(void *data, int y0, int y1)
+{
+    _remap_info *info = (_remap_info *)data;
+    SDL_Surface *src = info->src, *dst = info->dst;
+    int x, y;
 
-        [(-1,-1), (0,-1), (1,-1),     (-1,0), (0,0), (1,0),     (-1,1), (0,1),
-       (1,1)]
+    if (info->direct) {
+        Uint32(*tables)[256] = info->tables;
+
+        for (y = y0; y < y1; y++) {
+            Uint32 *srcp = (Uint32 *)((Uint8 *)src->pixels +
+                                      (Sint64)y * src->pitch);
+            Uint32 *dstp = (Uint32 *)((Uint8 *)dst->pixels +
+                                      (Sint64)y * dst->pitch);
+            for (x = 0; x < src->w; x++) {
+                Uint32 p = srcp[x];
+                dstp[x] = tables[0][p & 0xff] | tables[1][(p >> 8) & 0xff] |
+                          tables[2][(p >> 16) & 0xff] | tables[3][p >> 24];
+            }
+        }
+        return 0;
+    }
 
-    */
+    for (y = y0; y < y1; y++) {
+        for (x = 0; x < src->w; x++) {
+            Uint32 pixel;
+            Uint8 r, g, b, a;
+            Uint8 *pix;
+
+            SURF_GET_AT(pixel, src, x, y, (Uint8 *)src->pixels, src->format,
+                        pix);
+            SDL_GetRGBA(pixel, src->format, &r, &g, &b, &a);
+            pixel = SDL_MapRGBA(dst->format, info->luts[0][r],
+                                info->luts[1][g], info->luts[2][b],
+                                info->luts[3][a]);
+            SURF_SET_AT(pixel, dst, x, y, (Uint8 *)dst->pixels, dst->format,
+                        pix);
+        }
+    }
+    return 0;
+}
 
-    for (y = 0; y < height; y++) {
-        for (x = 0; x < width; x++) {
-            // Need to bounds check these accesses.
+static void
+apply_lut(_remap_info *info)
+{
+    int positions[4], i, k;
+
+    info->direct = _remap_is_direct(info->src, info->dst);
+    if (info->direct) {
+        _remap_positions(info->src->format, positions);
+        /* a position without a channel is copied through */
+        for (k = 0; k < 4; k++) {
+            for (i = 0; i < 256; i++)
+                info->tables[k][i] = (Uint32)i << (k << 3);
+        }
+        for (k = 0; k < 4; k++) {
+            if (positions[k] < 0)
+                continue;
+            for (i = 0; i < 256; i++)
+                info->tables[positions[k]][i] = (Uint32)info->luts[k][i]
+                                                << (positions[k] << 3);
+        }
+    }
 
-            if (y > 0) {
-                if (x > 0) {
-                    SURF_GET_AT(sample[0], surf, x + -1, y + -1, pixels,
-                                format, pix);
-                }
+    pg_run_bands(_lut_band, info, info->dst->h,
+                 pg_band_count(info->dst->w, info->dst->h, 16));
+}
 
-                SURF_GET_AT(sample[1], surf, x + 0, y + -1, pixels, format,
-                            pix);
+static PG_INLINE Uint8
+_color_matrix_clamp(float value)
+{
+    if (value < 0.0f)
+        value = 0.0f;
+    else if (value > 255.0f)
+        value = 255.0f;
+    return (Uint8)(value + .5f);
+}
 
-                if (x + 1 < width) {
-                    SURF_GET_AT(sample[2], surf, x + 1, y + -1, pixels, format,
-                                pix);
+static int
+_color_matrix_band(void *data, int y0, int y1)
+{
+    _remap_info *info = (_remap_info *)data;
+    SDL_Surface *src = info->src, *dst = info->dst;
+    int x, y, k, j;
+
+    if (info->direct) {
+        float(*cols)[4] = info->columns;
+        Uint32 keepmask = info->keepmask;
+#if PG_HAS_SSE2_OR_NEON
+        int use_simd = pg_HasSSE_NEON();
+        __m128 col0 = _mm_loadu_ps(cols[0]), col1 = _mm_loadu_ps(cols[1]);
+        __m128 col2 = _mm_loadu_ps(cols[2]), col3 = _mm_loadu_ps(cols[3]);
+        __m128 offset = _mm_loadu_ps(info->offsets);
+        __m128 lo = _mm_setzero_ps(), hi = _mm_set1_ps(255.0f);
+        __m128 half = _mm_set1_ps(.5f);
+        __m128i zero = _mm_setzero_si128();
+#endif /* PG_HAS_SSE2_OR_NEON */
+
+        for (y = y0; y < y1; y++) {
+            Uint32 *srcp = (Uint32 *)((Uint8 *)src->pixels +
+                                      (Sint64)y * src->pitch);
+            Uint32 *dstp = (Uint32 *)((Uint8 *)dst->pixels +
+                                      (Sint64)y * dst->pitch);
+            x = 0;
+#if PG_HAS_SSE2_OR_NEON
+            if (use_simd) {
+                for (; x < src->w; x++) {
+                    Uint32 p = srcp[x];
+                    __m128 v, acc;
+                    __m128i out;
+
+                    /* lane k holds the byte at bit position 8 * k */
+                    out = _mm_unpacklo_epi16(
+                        _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)p), zero),
+                        zero);
+                    v = _mm_cvtepi32_ps(out);
+                    acc = _mm_add_ps(
+                        offset,
+                        _mm_mul_ps(_mm_shuffle_ps(v, v, 0x00), col0));
+                    acc = _mm_add_ps(
+                        acc, _mm_mul_ps(_mm_shuffle_ps(v, v, 0x55), col1));
+                    acc = _mm_add_ps(
+                        acc, _mm_mul_ps(_mm_shuffle_ps(v, v, 0xAA), col2));
+                    acc = _mm_add_ps(
+                        acc, _mm_mul_ps(_mm_shuffle_ps(v, v, 0xFF), col3));
+                    acc = _mm_min_ps(_mm_max_ps(acc, lo), hi);
+                    out = _mm_cvttps_epi32(_mm_add_ps(acc, half));
+                    out = _mm_packs_epi32(out, out);
+                    out = _mm_packus_epi16(out, out);
+                    dstp[x] = ((Uint32)_mm_cvtsi128_si32(out) & ~keepmask) |
+                              (p & keepmask);
                 }
             }
-            else {
-                sample[0] = LAPLACIAN_NUM;
-                sample[1] = LAPLACIAN_NUM;
-                sample[2] = LAPLACIAN_NUM;
+#endif /* PG_HAS_SSE2_OR_NEON */
+            for (; x < src->w; x++) {
+                Uint32 p = srcp[x], result = 0;
+                float v[4];
+
+                for (k = 0; k < 4; k++)
+                    v[k] = (float)((p >> (k << 3)) & 0xff);
+                for (j = 0; j < 4; j++) {
+                    float acc = info->offsets[j] + v[0] * cols[0][j];
+                    acc = acc + v[1] * cols[1][j];
+                    acc = acc + v[2] * cols[2][j];
+                    acc = acc + v[3] * cols[3][j];
+                    result |= (Uint32)_color_matrix_clamp(acc) << (j << 3);
+                }
+                dstp[x] = (result & ~keepmask) | (p & keepmask);
             }
+        }
+        return 0;
+    }
 
-            if (x > 0) {
-                SURF_GET_AT(sample[3], surf, x + -1, y + 0, pixels, format,
-                            pix);
+    for (y = y0; y < y1; y++) {
+        for (x = 0; x < src->w; x++) {
+            Uint32 pixel;
+            Uint8 rgba[4], out[4];
+            Uint8 *pix;
+
+            SURF_GET_AT(pixel, src, x, y, (Uint8 *)src->pixels, src->format,
+                        pix);
+            SDL_GetRGBA(pixel, src->format, rgba, rgba + 1, rgba + 2,
+                        rgba + 3);
+            for (j = 0; j < 4; j++) {
+                float *row = info->matrix[j];
+                float acc = row[4] + rgba[0] * row[0];
+                acc = acc + rgba[1] * row[1];
+                acc = acc + rgba[2] * row[2];
+                acc = acc + rgba[3] * row[3];
+                out[j] = _color_matrix_clamp(acc);
             }
-            else {
-                sample[3] = LAPLACIAN_NUM;
+            pixel = SDL_MapRGBA(dst->format, out[0], out[1], out[2], out[3]);
+            SURF_SET_AT(pixel, dst, x, y, (Uint8 *)dst->pixels, dst->format,
+                        pix);
+        }
+    }
+    return 0;
+}
+
+static void
+color_matrix(_remap_info *info)
+{
+    int positions[4], j, k;
+
+    info->direct = _remap_is_direct(info->src, info->dst);
+    if (info->direct) {
+        _remap_positions(info->src->format, positions);
+        memset(info->columns, 0, sizeof(info->columns));
+        memset(info->offsets, 0, sizeof(info->offsets));
+        info->keepmask = 0xffffffff;
+        for (j = 0; j < 4; j++) {
+            if (positions[j] < 0)
+                continue;
+            info->keepmask &= ~((Uint32)0xff << (positions[j] << 3));
+            info->offsets[positions[j]] = info->matrix[j][4];
+            for (k = 0; k < 4; k++) {
+                if (positions[k] >= 0)
+                    info->columns[positions[k]][positions[j]] =
+                        info->matrix[j][k];
+                else /* a surface without alpha reads as opaque */
+                    info->offsets[positions[j]] += info->matrix[j][k] * 255;
             }
+        }
+    }
+
+    pg_run_bands(_color_matrix_band, info, info->dst->h,
+                 pg_band_count(info->dst->w, info->dst->h, 16));
+}
+
+/* Reads a 256 entry lookup table, or the identity for None. */
+static int
+_get_lut(PyObject *obj, Uint8 *lut)
+{
+    PyObject *seq;
+    Py_ssize_t i;
+
+    if (!obj || obj == Py_None) {
+        for (i = 0; i < 256; i++)
+            lut[i] = (Uint8)i;
+        return 1;
+    }
+
+    if (PyUnicode_Check(obj)) {
+        PyErr_SetString(PyExc_TypeError,
+                        "lookup tables must be sequences of 256 integers");
+        return 0;
+    }
+    seq = PySequence_Fast(obj,
+                          "lookup tables must be sequences of 256 integers");
+    if (!seq)
+        return 0;
+    if (PySequence_Fast_GET_SIZE(seq) != 256) {
+        Py_DECREF(seq);
+        PyErr_SetString(PyExc_ValueError,
+                        "lookup tables must have 256 entries");
+        return 0;
+    }
+    for (i = 0; i < 256; i++) {
+        long value = PyLong_AsLong(PySequence_Fast_GET_ITEM(seq, i));
+
+        if (value == -1 && PyErr_Occurred()) {
+            Py_DECREF(seq);
+            return 0;
+        }
+        if (value < 0 || value > 255) {
+            Py_DECREF(seq);
+            PyErr_SetString(PyExc_ValueError,
+                            "lookup table values must be from 0 to 255");
+            return 0;
+        }
+        lut[i] = (Uint8)value;
+    }
+    Py_DECREF(seq);
+    return 1;
+}
 
-            // SURF_GET_AT(sample[4], surf, x+0 , y+0);
-            sample[4] = 0;
+/* Reads a 4x5 color matrix, rows r, g, b, a. */
+static int
+_get_color_matrix(PyObject *obj, float (*matrix)[5])
+{
+    Py_ssize_t j, i;
 
-            if (x + 1 < width) {
-                SURF_GET_AT(sample[5], surf, x + 1, y + 0, pixels, format,
-                            pix);
+    if (!PySequence_Check(obj) || PyUnicode_Check(obj) ||
+        PySequence_Length(obj) != 4) {
+        PyErr_Clear();
+        PyErr_SetString(PyExc_TypeError,
+                        "matrix must be 4 rows of 5 numbers");
+        return 0;
+    }
+
+    for (j = 0; j < 4; j++) {
+        PyObject *row = PySequence_GetItem(obj, j);
+
+        if (!row)
+            return 0;
+        if (!PySequence_Check(row) || PyUnicode_Check(row) ||
+            PySequence_Length(row) != 5) {
+            Py_DECREF(row);
+            PyErr_Clear();
+            PyErr_SetString(PyExc_TypeError,
+                            "matrix must be 4 rows of 5 numbers");
+            return 0;
+        }
+        for (i = 0; i < 5; i++) {
+            PyObject *item = PySequence_GetItem(row, i);
+            double value;
+
+            if (!item) {
+                Py_DECREF(row);
+                return 0;
             }
-            else {
-                sample[5] = LAPLACIAN_NUM;
+            value = PyFloat_AsDouble(item);
+            Py_DECREF(item);
+            if (value == -1.0 && PyErr_Occurred()) {
+                Py_DECREF(row);
+                return 0;
             }
+            matrix[j][i] = (float)value;
+        }
+        Py_DECREF(row);
+    }
+    return 1;
+}
 
-            if (y + 1 < height) {
-                if (x > 0) {
-                    SURF_GET_AT(sample[6], surf, x + -1, y + 1, pixels, format,
-                                pix);
-                }
+/* Runs apply_lut() or color_matrix() from surfobj into surfobj2, or into a
+   new surface when surfobj2 is NULL. */
+static PyObject *
+_remap_surfaces(pgSurfaceObject *surfobj, pgSurfaceObject *surfobj2,
+                _remap_info *info, void (*remap)(_remap_info *))
+{
+    SDL_Surface *surf = pgSurface_AsSurface(surfobj);
+    SDL_Surface *newsurf;
+
+    if (!surfobj2) {
+        newsurf = newsurf_fromsurf(surf, surf->w, surf->h);
+        if (!newsurf)
+            return NULL;
+    }
+    else {
+        newsurf = pgSurface_AsSurface(surfobj2);
+        if (newsurf->w != surf->w || newsurf->h != surf->h)
+            return RAISE(PyExc_ValueError,
+                         "Destination surface not the same size.");
+        if (newsurf->format->BytesPerPixel == 0 ||
+            newsurf->format->BytesPerPixel > 4)
+            return RAISE(PyExc_ValueError,
+                         "unsupport Surface bit depth for transform");
+    }
 
-                SURF_GET_AT(sample[7], surf, x + 0, y + 1, pixels, format,
-                            pix);
+    info->src = surf;
+    info->dst = newsurf;
 
-                if (x + 1 < width) {
-                    SURF_GET_AT(sample[8], surf, x + 1, y + 1, pixels, format,
-                                pix);
-                }
-            }
-            else {
-                sample[6] = LAPLACIAN_NUM;
-                sample[7] = LAPLACIAN_NUM;
-                sample[8] = LAPLACIAN_NUM;
-            }
+    if (newsurf != surf)
+        SDL_LockSurface(newsurf);
+    pgSurface_Lock(surfobj);
 
-            total[0] = 0;
-            total[1] = 0;
-            total[2] = 0;
-            total[3] = 0;
-
-            for (ii = 0; ii < 9; ii++) {
-                SDL_GetRGBA(sample[ii], format, &c1r, &c1g, &c1b, &c1a);
-                total[0] += c1r;
-                total[1] += c1g;
-                total[2] += c1b;
-                total[3] += c1a;
-            }
+    Py_BEGIN_ALLOW_THREADS;
+    remap(info);
+    Py_END_ALLOW_THREADS;
 
-            SURF_GET_AT(sample[4], surf, x, y, pixels, format, pix);
+    pgSurface_Unlock(surfobj);
+    if (newsurf != surf)
+        SDL_UnlockSurface(newsurf);
 
-            SDL_GetRGBA(sample[4], format, &c1r, &c1g, &c1b, &c1a);
+    if (surfobj2) {
+        Py_INCREF(surfobj2);
+        return (PyObject *)surfobj2;
+    }
+    else
+        return (PyObject *)pgSurface_New(newsurf);
+}
 
-            // cast on the right to a signed int, and then clamp to 0-255.
+static PyObject *
+surf_apply_lut(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    pgSurfaceObject *surfobj, *surfobj2 = NULL;
+    PyObject *lutobjs[4] = {NULL, NULL, NULL, NULL};
+    _remap_info info;
+    int i;
+    static char *keywords[] = {"surface", "lut_r", "lut_g",        "lut_b",
+                               "lut_a",   "dest_surface", NULL};
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|OOOOO!", keywords,
+                                     &pgSurface_Type, &surfobj, &lutobjs[0],
+                                     &lutobjs[1], &lutobjs[2], &lutobjs[3],
+                                     &pgSurface_Type, &surfobj2))
+        return NULL;
 
-            // atmp = c1r * 8
+    for (i = 0; i < 4; i++) {
+        if (!_get_lut(lutobjs[i], info.luts[i]))
+            return NULL;
+    }
 
-            atmp0 = c1r * 8;
-            acolor[0] = MIN(MAX(atmp0 - total[0], 0), 255);
-            atmp1 = c1g * 8;
-            acolor[1] = MIN(MAX(atmp1 - total[1], 0), 255);
-            atmp2 = c1b * 8;
-            acolor[2] = MIN(MAX(atmp2 - total[2], 0), 255);
-            atmp3 = c1a * 8;
-            acolor[3] = MIN(MAX(atmp3 - total[3], 0), 255);
+    return _remap_surfaces(surfobj, surfobj2, &info, apply_lut);
+}
 
-            // printf("%d;;%d;;%d;;  ", atmp0, acolor[0],total[0]);
+static PyObject *
+surf_color_matrix(PyObject *self, PyObject *args, PyObject *kwargs)
+{
+    pgSurfaceObject *surfobj, *surfobj2 = NULL;
+    PyObject *matrixobj;
+    _remap_info info;
+    static char *keywords[] = {"surface", "matrix", "dest_surface", NULL};
 
-            // printf("%d,%d,%d,%d;;  \n", acolor[0], acolor[1], acolor[2],
-            // acolor[3]);
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!O|O!", keywords,
+                                     &pgSurface_Type, &surfobj, &matrixobj,
+                                     &pgSurface_Type, &surfobj2))
+        return NULL;
 
-            // the_color = (Uint32)acolor;
-            // the_color = 0x00000000;
+    if (!_get_color_matrix(matrixobj, info.matrix))
+        return NULL;
 
-            // cast on the right to Uint32, and then clamp to 255.
+    return _remap_surfaces(surfobj, surfobj2, &info, color_matrix);
+}
 
-            the_color = SDL_MapRGBA(surf->format, acolor[0], acolor[1],
-                                    acolor[2], acolor[3]);
+/* Adds every byte of a 32 bit surface into the matching Uint32 of sums,
+   which holds 4 lanes per pixel laid out like the surface bytes. */
+static void
+accumulate_32(Uint32 *sums, Uint8 *pixels, int pitch, int width, int height)
+{
+    int x, y;
+    int rowlen = width * 4;
+#if PG_HAS_SSE2_OR_NEON
+    int use_simd = pg_HasSSE_NEON();
+    __m128i zero = _mm_setzero_si128();
+#endif
 
-            // set_at(destsurf, color, x,y);
+    for (y = 0; y < height; y++) {
+        Uint8 *row = pixels + y * pitch;
+        Uint32 *acc = sums + (size_t)y * rowlen;
 
-            switch (destformat->BytesPerPixel) {
-                case 1:
-                    *((Uint8 *)destpixels + y * destsurf->pitch + x) =
-                        (Uint8)the_color;
-                    break;
-                case 2:
-                    *((Uint16 *)(destpixels + y * destsurf->pitch) + x) =
-                        (Uint16)the_color;
-                    break;
-                case 3:
-                    byte_buf =
-                        (Uint8 *)(destpixels + y * destsurf->pitch) + x * 3;
-#if (SDL_BYTEORDER == SDL_LIL_ENDIAN)
-                    *(byte_buf + (destformat->Rshift >> 3)) =
-                        (Uint8)(the_color >> surf->format->Rshift);
-                    *(byte_buf + (destformat->Gshift >> 3)) =
-                        (Uint8)(the_color >> surf->format->Gshift);
-                    *(byte_buf + (destformat->Bshift >> 3)) =
-                        (Uint8)(the_color >> surf->format->Bshift);
-#else
-                    *(byte_buf + 2 - (destformat->Rshift >> 3)) =
-                        (Uint8)(the_color >> surf->format->Rshift);
-                    *(byte_buf + 2 - (destformat->Gshift >> 3)) =
-                        (Uint8)(the_color >> surf->format->Gshift);
-                    *(byte_buf + 2 - (destformat->Bshift >> 3)) =
-                        (Uint8)(the_color >> surf->format->Bshift);
-#endif
-                    break;
-                default:
-                    *((Uint32 *)(destpixels + y * destsurf->pitch) + x) =
-                        the_color;
-                    break;
+        x = 0;
+#if PG_HAS_SSE2_OR_NEON
+        if (use_simd) {
+            /* widen 16 bytes to 16 Uint32 and add them to the sums */
+            for (; x + 16 <= rowlen; x += 16) {
+                __m128i px = _mm_loadu_si128((__m128i *)(row + x));
+                __m128i lo = _mm_unpacklo_epi8(px, zero);
+                __m128i hi = _mm_unpackhi_epi8(px, zero);
+                __m128i *a = (__m128i *)(acc + x);
+
+                _mm_storeu_si128(
+                    a, _mm_add_epi32(_mm_loadu_si128(a),
+                                     _mm_unpacklo_epi16(lo, zero)));
+                _mm_storeu_si128(
+                    a + 1, _mm_add_epi32(_mm_loadu_si128(a + 1),
+                                         _mm_unpackhi_epi16(lo, zero)));
+                _mm_storeu_si128(
+                    a + 2, _mm_add_epi32(_mm_loadu_si128(a + 2),
+                                         _mm_unpacklo_epi16(hi, zero)));
+                _mm_storeu_si128(
+                    a + 3, _mm_add_epi32(_mm_loadu_si128(a + 3),
+                                         _mm_unpackhi_epi16(hi, zero)));
             }
         }
+#endif /* PG_HAS_SSE2_OR_NEON */
+        for (; x < rowlen; x++)
+            acc[x] += row[x];
     }
 }
 
-static PyObject *
-surf_laplacian(PyObject *self, PyObject *args, PyObject *kwargs)
+/* Writes sums / count back as 32 bit pixels, rounding like
+   average_surfaces does. Only the keepmask bits of the result are
+   kept, then setmask is or'ed in (used for the alpha/padding byte). */
+static void
+average_store_32(Uint32 *sums, Uint32 count, Uint8 *pixels, int pitch,
+                 int width, int height, Uint32 keepmask, Uint32 setmask)
 {
-    PyObject *surfobj, *surfobj2 = NULL;
-    SDL_Surface *surf;
-    SDL_Surface *newsurf;
-    static char *keywords[] = {"surface", "dest_surface", NULL};
-
-    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!|O!", keywords, 
-                                     &pgSurface_Type, &surfobj,
-                                     &pgSurface_Type, &surfobj2))
-        return NULL;
+    int x, y, i;
+    int rowlen = width * 4;
+    float div_inv = (float)(1.0L / count);
+#if PG_HAS_SSE2_OR_NEON
+    int use_simd = pg_HasSSE_NEON();
+    __m128 inv = _mm_set1_ps(div_inv);
+    __m128 half = _mm_set1_ps(.5f);
+    __m128i keep = _mm_set1_epi32((int)keepmask);
+    __m128i set = _mm_set1_epi32((int)setmask);
+#endif
 
-    surf = pgSurface_AsSurface(surfobj);
+    for (y = 0; y < height; y++) {
+        Uint32 *acc = sums + (size_t)y * rowlen;
+        Uint32 *dst = (Uint32 *)(pixels + y * pitch);
 
-    /* if the second surface is not there, then make a new one. */
+        x = 0;
+#if PG_HAS_SSE2_OR_NEON
+        if (use_simd) {
+            for (; x + 4 <= width; x += 4) {
+                __m128i *a = (__m128i *)(acc + x * 4);
+                __m128i c0 = _mm_cvttps_epi32(_mm_add_ps(
+                    _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(a)), inv),
+                    half));
+                __m128i c1 = _mm_cvttps_epi32(_mm_add_ps(
+                    _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(a + 1)), inv),
+                    half));
+                __m128i c2 = _mm_cvttps_epi32(_mm_add_ps(
+                    _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(a + 2)), inv),
+                    half));
+                __m128i c3 = _mm_cvttps_epi32(_mm_add_ps(
+                    _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128(a + 3)), inv),
+                    half));
+                __m128i px = _mm_packus_epi16(_mm_packs_epi32(c0, c1),
+                                              _mm_packs_epi32(c2, c3));
+
+                px = _mm_or_si128(_mm_and_si128(px, keep), set);
+                _mm_storeu_si128((__m128i *)(dst + x), px);
+            }
+        }
+#endif /* PG_HAS_SSE2_OR_NEON */
+        for (; x < width; x++) {
+            Uint32 pixel;
+            Uint8 *bytes = (Uint8 *)&pixel;
+
+            for (i = 0; i < 4; i++)
+                bytes[i] = (Uint8)(acc[x * 4 + i] * div_inv + .5f);
+            dst[x] = (pixel & keepmask) | setmask;
+        }
+    }
+}
 
-    if (!surfobj2) {
-        int width = surf->w;
-        int height = surf->h;
+/* average_surfaces() fast path for surfaces sharing the destination's byte
+   aligned 32 bit layout. Returns 0 if the surfaces do not qualify. */
+static int
+average_surfaces_32(SDL_Surface **surfaces, int num_surfaces,
+                    SDL_Surface *destsurf)
+{
+    SDL_PixelFormat *destformat = destsurf->format;
+    Uint32 *accumulate;
+    int surf_idx;
 
-        newsurf = newsurf_fromsurf(surf, width, height);
+    if (!_is_bytealigned_32(destformat))
+        return 0;
 
-        if (!newsurf)
-            return NULL;
+    for (surf_idx = 0; surf_idx < num_surfaces; surf_idx++) {
+        SDL_Surface *surf = surfaces[surf_idx];
+
+        if (surf->w != destsurf->w || surf->h != destsurf->h ||
+            surf->format->BytesPerPixel != 4 ||
+            surf->format->Rmask != destformat->Rmask ||
+            surf->format->Gmask != destformat->Gmask ||
+            surf->format->Bmask != destformat->Bmask)
+            return 0;
     }
-    else
-        newsurf = pgSurface_AsSurface(surfobj2);
-
-    /* check to see if the size is the correct size. */
-    if (newsurf->w != (surf->w) || newsurf->h != (surf->h))
-        return RAISE(PyExc_ValueError,
-                     "Destination surface not the same size.");
-
-    /* check to see if the format of the surface is the same. */
-    if (surf->format->BytesPerPixel != newsurf->format->BytesPerPixel)
-        return RAISE(PyExc_ValueError,
-                     "Source and destination surfaces need the same format.");
 
-    SDL_LockSurface(newsurf);
-    SDL_LockSurface(surf);
+    accumulate = (Uint32 *)calloc((size_t)destsurf->w * destsurf->h * 4,
+                                  sizeof(Uint32));
+    if (!accumulate)
+        return -1;
 
-    Py_BEGIN_ALLOW_THREADS;
-    laplacian(surf, newsurf);
-    Py_END_ALLOW_THREADS;
+    for (surf_idx = 0; surf_idx < num_surfaces; surf_idx++) {
+        accumulate_32(accumulate, (Uint8 *)surfaces[surf_idx]->pixels,
+                      surfaces[surf_idx]->pitch, destsurf->w, destsurf->h);
+    }
 
-    SDL_UnlockSurface(surf);
-    SDL_UnlockSurface(newsurf);
+    /* like SDL_MapRGB: colour from the average, alpha fully opaque */
+    average_store_32(accumulate, num_surfaces, (Uint8 *)destsurf->pixels,
+                     destsurf->pitch, destsurf->w, destsurf->h,
+                     destformat->Rmask | destformat->Gmask | destformat->Bmask,
+                     destformat->Amask);
 
-    if (surfobj2) {
-        Py_INCREF(surfobj2);
-        return surfobj2;
-    }
-    else
-        return (PyObject *)pgSurface_New(newsurf);
+    free(accumulate);
+    return 1;
 }
 
 int
@@ -2265,11 +3575,18 @@ average_surfaces(SDL_Surface **surfaces, int num_surfaces,
     Uint32 rmask, gmask, bmask;
     int rshift, gshift, bshift, rloss, gloss, bloss;
     int num_elements;
+    int fast_path;
 
     if (!num_surfaces) {
         return 0;
     }
 
+    /* matching 32 bit surfaces can be summed byte by byte */
+    fast_path = average_surfaces_32(surfaces, num_surfaces, destsurf);
+    if (fast_path) {
+        return fast_path;
+    }
+
     height = surfaces[0]->h;
     width = surfaces[0]->w;
 
@@ -2570,6 +3887,363 @@ surf_average_surfaces(PyObject *self, PyObject *args, PyObject *kwargs)
     return ret;
 }
 
+/*
+ * SurfaceAccumulator: a running per pixel sum of surfaces, so an average
+ * can be taken over many frames without keeping the frames around.
+ *
+ * The sums hold four Uint32 lanes per pixel. Each lane is a byte position
+ * within a 32 bit pixel, and the [rgba]slot members say which channel
+ * lives where. The slots are taken from the first surface added when it
+ * is byte aligned, so frames in that format go through accumulate_32().
+ */
+typedef struct {
+    PyObject_HEAD int w;
+    int h;
+    Uint32 count;
+    Uint32 *sums;
+    int has_layout;
+    int has_alpha;
+    int in_use; /* the sums are being used with the GIL released */
+    Uint8 rslot, gslot, bslot, aslot;
+} pgSurfaceAccumulatorObject;
+
+/* add() and get_average() release the GIL while they use the sums, so
+ * every method touching the sums checks that no other thread is in one of
+ * them first. */
+#define ACCUMULATOR_CHECK_IN_USE(self, ret)                            \
+    if ((self)->in_use) {                                              \
+        PyErr_SetString(PyExc_RuntimeError,                            \
+                        "SurfaceAccumulator is in use by another "     \
+                        "thread");                                     \
+        return ret;                                                    \
+    }
+
+/* Does a byte aligned 32 bit format put its colours in the given slots? */
+static int
+_accumulator_layout_matches(pgSurfaceAccumulatorObject *self,
+                            SDL_PixelFormat *format, int need_alpha)
+{
+    if (!_is_bytealigned_32(format))
+        return 0;
+    if (_BYTESLOT(format->Rshift) != self->rslot ||
+        _BYTESLOT(format->Gshift) != self->gslot ||
+        _BYTESLOT(format->Bshift) != self->bslot)
+        return 0;
+    if (need_alpha &&
+        (!format->Amask || _BYTESLOT(format->Ashift) != self->aslot))
+        return 0;
+    return 1;
+}
+
+static void
+_accumulator_set_layout(pgSurfaceAccumulatorObject *self,
+                        SDL_PixelFormat *format)
+{
+    self->has_alpha = format->Amask != 0;
+    if (_is_bytealigned_32(format)) {
+        self->rslot = _BYTESLOT(format->Rshift);
+        self->gslot = _BYTESLOT(format->Gshift);
+        self->bslot = _BYTESLOT(format->Bshift);
+        /* the remaining byte holds alpha, or padding */
+        self->aslot = 6 - self->rslot - self->gslot - self->bslot;
+    }
+    else {
+        self->rslot = 0;
+        self->gslot = 1;
+        self->bslot = 2;
+        self->aslot = 3;
+    }
+    self->has_layout = 1;
+}
+
+/* Slow path for surfaces not laid out like the sums. */
+static void
+_accumulator_add_generic(pgSurfaceAccumulatorObject *self, SDL_Surface *surf)
+{
+    SDL_PixelFormat *format = surf->format;
+    Uint8 *pixels = (Uint8 *)surf->pixels;
+    Uint8 *pix;
+    Uint32 the_color, *acc = self->sums;
+    Uint8 r, g, b, a;
+    int x, y;
+
+    for (y = 0; y < self->h; y++) {
+        for (x = 0; x < self->w; x++) {
+            SURF_GET_AT(the_color, surf, x, y, pixels, format, pix);
+            SDL_GetRGBA(the_color, format, &r, &g, &b, &a);
+            acc[self->rslot] += r;
+            acc[self->gslot] += g;
+            acc[self->bslot] += b;
+            acc[self->aslot] += a;
+            acc += 4;
+        }
+    }
+}
+
+static void
+_accumulator_store_generic(pgSurfaceAccumulatorObject *self,
+                           SDL_Surface *destsurf)
+{
+    SDL_PixelFormat *destformat = destsurf->format;
+    Uint8 *destpixels = (Uint8 *)destsurf->pixels;
+    Uint8 *byte_buf;
+    Uint32 the_color, *acc = self->sums;
+    float div_inv = (float)(1.0L / self->count);
+    int x, y;
+
+    for (y = 0; y < self->h; y++) {
+        for (x = 0; x < self->w; x++) {
+            the_color = SDL_MapRGBA(
+                destformat, (Uint8)(acc[self->rslot] * div_inv + .5f),
+                (Uint8)(acc[self->gslot] * div_inv + .5f),
+                (Uint8)(acc[self->bslot] * div_inv + .5f),
+                self->has_alpha ? (Uint8)(acc[self->aslot] * div_inv + .5f)
+                                : 255);
+            SURF_SET_AT(the_color, destsurf, x, y, destpixels, destformat,
+                        byte_buf);
+            acc += 4;
+        }
+    }
+}
+
+static int
+accumulator_init(pgSurfaceAccumulatorObject *self, PyObject *args,
+                 PyObject *kwargs)
+{
+    PyObject *size;
+    int w, h;
+    static char *keywords[] = {"size", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O", keywords, &size))
+        return -1;
+
+    if (!pg_TwoIntsFromObj(size, &w, &h)) {
+        PyErr_SetString(PyExc_TypeError, "size must be two numbers");
+        return -1;
+    }
+    if (w < 0 || h < 0) {
+        PyErr_SetString(PyExc_ValueError, "cannot use negative size");
+        return -1;
+    }
+    ACCUMULATOR_CHECK_IN_USE(self, -1);
+
+    free(self->sums);
+    self->sums = (Uint32 *)calloc((size_t)w * h * 4 + 1, sizeof(Uint32));
+    if (!self->sums) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    self->w = w;
+    self->h = h;
+    self->count = 0;
+    self->has_layout = 0;
+    return 0;
+}
+
+static void
+accumulator_dealloc(pgSurfaceAccumulatorObject *self)
+{
+    free(self->sums);
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *
+accumulator_add(pgSurfaceAccumulatorObject *self, PyObject *args,
+                PyObject *kwargs)
+{
+    pgSurfaceObject *surfobj;
+    SDL_Surface *surf;
+    static char *keywords[] = {"surface", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O!", keywords,
+                                     &pgSurface_Type, &surfobj))
+        return NULL;
+
+    ACCUMULATOR_CHECK_IN_USE(self, NULL);
+
+    surf = pgSurface_AsSurface(surfobj);
+    if (!surf)
+        return RAISE(pgExc_SDLError, "display Surface quit");
+    if (surf->w != self->w || surf->h != self->h)
+        return RAISE(PyExc_ValueError,
+                     "Surface is not the same size as the accumulator.");
+    if (surf->format->BytesPerPixel == 0 || surf->format->BytesPerPixel > 4)
+        return RAISE(PyExc_ValueError,
+                     "unsupport Surface bit depth for transform");
+    /* keeps every sum below 2 ** 32 */
+    if (self->count >= 0xFFFFFFFF / 255)
+        return RAISE(PyExc_OverflowError,
+                     "too many surfaces added to the accumulator");
+
+    if (!self->has_layout)
+        _accumulator_set_layout(self, surf->format);
+
+    pgSurface_Lock(surfobj);
+    self->in_use = 1;
+    Py_BEGIN_ALLOW_THREADS;
+    if (_accumulator_layout_matches(self, surf->format, self->has_alpha)) {
+        accumulate_32(self->sums, (Uint8 *)surf->pixels, surf->pitch,
+                      self->w, self->h);
+    }
+    else {
+        _accumulator_add_generic(self, surf);
+    }
+    Py_END_ALLOW_THREADS;
+    self->in_use = 0;
+    pgSurface_Unlock(surfobj);
+
+    self->count++;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+accumulator_get_average(pgSurfaceAccumulatorObject *self, PyObject *args,
+                        PyObject *kwargs)
+{
+    PyObject *surfobj2 = NULL;
+    SDL_Surface *newsurf;
+    SDL_PixelFormat *destformat;
+    static char *keywords[] = {"dest_surface", NULL};
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O!", keywords,
+                                     &pgSurface_Type, &surfobj2))
+        return NULL;
+
+    ACCUMULATOR_CHECK_IN_USE(self, NULL);
+
+    if (!self->count)
+        return RAISE(PyExc_ValueError,
+                     "no surfaces have been added to the accumulator");
+
+    if (!surfobj2) {
+        newsurf = SDL_CreateRGBSurface(
+            0, self->w, self->h, 32, _SLOTMASK(self->rslot),
+            _SLOTMASK(self->gslot), _SLOTMASK(self->bslot),
+            self->has_alpha ? _SLOTMASK(self->aslot) : 0);
+        if (!newsurf)
+            return RAISE(pgExc_SDLError, SDL_GetError());
+    }
+    else {
+        newsurf = pgSurface_AsSurface(surfobj2);
+        if (!newsurf)
+            return RAISE(pgExc_SDLError, "display Surface quit");
+        if (newsurf->w != self->w || newsurf->h != self->h)
+            return RAISE(PyExc_ValueError,
+                         "Destination surface not the same size.");
+        if (newsurf->format->BytesPerPixel == 0 ||
+            newsurf->format->BytesPerPixel > 4)
+            return RAISE(PyExc_ValueError,
+                         "unsupport Surface bit depth for transform");
+    }
+    destformat = newsurf->format;
+
+    SDL_LockSurface(newsurf);
+    self->in_use = 1;
+    Py_BEGIN_ALLOW_THREADS;
+    if (_accumulator_layout_matches(
+            self, destformat, self->has_alpha && destformat->Amask)) {
+        Uint32 colors = destformat->Rmask | destformat->Gmask |
+                        destformat->Bmask;
+
+        if (self->has_alpha)
+            average_store_32(self->sums, self->count,
+                             (Uint8 *)newsurf->pixels, newsurf->pitch,
+                             self->w, self->h, colors | destformat->Amask, 0);
+        else
+            average_store_32(self->sums, self->count,
+                             (Uint8 *)newsurf->pixels, newsurf->pitch,
+                             self->w, self->h, colors, destformat->Amask);
+    }
+    else {
+        _accumulator_store_generic(self, newsurf);
+    }
+    Py_END_ALLOW_THREADS;
+    self->in_use = 0;
+    SDL_UnlockSurface(newsurf);
+
+    if (surfobj2) {
+        Py_INCREF(surfobj2);
+        return surfobj2;
+    }
+    return (PyObject *)pgSurface_New(newsurf);
+}
+
+static PyObject *
+accumulator_clear(pgSurfaceAccumulatorObject *self, PyObject *args)
+{
+    ACCUMULATOR_CHECK_IN_USE(self, NULL);
+
+    memset(self->sums, 0, sizeof(Uint32) * self->w * self->h * 4);
+    self->count = 0;
+    self->has_layout = 0;
+    Py_RETURN_NONE;
+}
+
+static PyObject *
+accumulator_get_count(pgSurfaceAccumulatorObject *self, PyObject *args)
+{
+    return PyLong_FromUnsignedLong(self->count);
+}
+
+static PyObject *
+accumulator_get_size(pgSurfaceAccumulatorObject *self, PyObject *args)
+{
+    return Py_BuildValue("(ii)", self->w, self->h);
+}
+
+static PyMethodDef accumulator_methods[] = {
+    {"add", (PyCFunction)accumulator_add, METH_VARARGS | METH_KEYWORDS,
+     DOC_SURFACEACCUMULATORADD},
+    {"get_average", (PyCFunction)accumulator_get_average,
+     METH_VARARGS | METH_KEYWORDS, DOC_SURFACEACCUMULATORGETAVERAGE},
+    {"clear", (PyCFunction)accumulator_clear, METH_NOARGS,
+     DOC_SURFACEACCUMULATORCLEAR},
+    {"get_count", (PyCFunction)accumulator_get_count, METH_NOARGS,
+     DOC_SURFACEACCUMULATORGETCOUNT},
+    {"get_size", (PyCFunction)accumulator_get_size, METH_NOARGS,
+     DOC_SURFACEACCUMULATORGETSIZE},
+    {NULL, NULL, 0, NULL}};
+
+static PyTypeObject pgSurfaceAccumulator_Type = {
+    PyVarObject_HEAD_INIT(NULL, 0) "pygame.transform.SurfaceAccumulator",
+    sizeof(pgSurfaceAccumulatorObject), /* tp_basicsize */
+    0,                                  /* tp_itemsize */
+    (destructor)accumulator_dealloc,    /* tp_dealloc */
+    0,                                  /* tp_print */
+    0,                                  /* tp_getattr */
+    0,                                  /* tp_setattr */
+    0,                                  /* tp_as_async */
+    0,                                  /* tp_repr */
+    0,                                  /* tp_as_number */
+    0,                                  /* tp_as_sequence */
+    0,                                  /* tp_as_mapping */
+    0,                                  /* tp_hash */
+    0,                                  /* tp_call */
+    0,                                  /* tp_str */
+    0,                                  /* tp_getattro */
+    0,                                  /* tp_setattro */
+    0,                                  /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, /* tp_flags */
+    DOC_PYGAMETRANSFORMSURFACEACCUMULATOR,    /* tp_doc */
+    0,                                        /* tp_traverse */
+    0,                                        /* tp_clear */
+    0,                                        /* tp_richcompare */
+    0,                                        /* tp_weaklistoffset */
+    0,                                        /* tp_iter */
+    0,                                        /* tp_iternext */
+    accumulator_methods,                      /* tp_methods */
+    0,                                        /* tp_members */
+    0,                                        /* tp_getset */
+    0,                                        /* tp_base */
+    0,                                        /* tp_dict */
+    0,                                        /* tp_descr_get */
+    0,                                        /* tp_descr_set */
+    0,                                        /* tp_dictoffset */
+    (initproc)accumulator_init,               /* tp_init */
+    0,                                        /* tp_alloc */
+    PyType_GenericNew,                        /* tp_new */
+};
+
 /* VS 2015 crashes when compiling this function, turning off optimisations to
  try to fix it */
 #if defined(_MSC_VER) && (_MSC_VER == 1900)
@@ -2740,6 +4414,8 @@ static PyMethodDef _transform_methods[] = {
      DOC_PYGAMETRANSFORMSCALE},
     {"rotate", (PyCFunction)surf_rotate, METH_VARARGS | METH_KEYWORDS,
      DOC_PYGAMETRANSFORMROTATE},
+    {"affine", (PyCFunction)surf_affine, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMETRANSFORMAFFINE},
     {"flip", (PyCFunction)surf_flip, METH_VARARGS | METH_KEYWORDS, 
      DOC_PYGAMETRANSFORMFLIP},
     {"rotozoom", (PyCFunction)surf_rotozoom, METH_VARARGS | METH_KEYWORDS,
@@ -2757,7 +4433,13 @@ static PyMethodDef _transform_methods[] = {
     {"threshold", (PyCFunction)surf_threshold, METH_VARARGS | METH_KEYWORDS,
      DOC_PYGAMETRANSFORMTHRESHOLD},
     {"laplacian", (PyCFunction)surf_laplacian, METH_VARARGS | METH_KEYWORDS,
-     DOC_PYGAMETRANSFORMTHRESHOLD},
+     DOC_PYGAMETRANSFORMLAPLACIAN},
+    {"convolve", (PyCFunction)surf_convolve, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMETRANSFORMCONVOLVE},
+    {"apply_lut", (PyCFunction)surf_apply_lut, METH_VARARGS | METH_KEYWORDS,
+     DOC_PYGAMETRANSFORMAPPLYLUT},
+    {"color_matrix", (PyCFunction)surf_color_matrix,
+     METH_VARARGS | METH_KEYWORDS, DOC_PYGAMETRANSFORMCOLORMATRIX},
     {"average_surfaces", (PyCFunction)surf_average_surfaces,
      METH_VARARGS | METH_KEYWORDS, DOC_PYGAMETRANSFORMAVERAGESURFACES},
     {"average_color", (PyCFunction)surf_average_color,
@@ -2799,6 +4481,10 @@ MODINIT_DEFINE(transform)
         MODINIT_ERROR;
     }
 
+    if (PyType_Ready(&pgSurfaceAccumulator_Type) < 0) {
+        MODINIT_ERROR;
+    }
+
     /* create the module */
     module = PyModule_Create(&_module);
 
@@ -2806,6 +4492,14 @@ MODINIT_DEFINE(transform)
         MODINIT_ERROR;
     }
 
+    Py_INCREF(&pgSurfaceAccumulator_Type);
+    if (PyModule_AddObject(module, "SurfaceAccumulator",
+                           (PyObject *)&pgSurfaceAccumulator_Type)) {
+        Py_DECREF(&pgSurfaceAccumulator_Type);
+        DECREF_MOD(module);
+        MODINIT_ERROR;
+    }
+
     st = GETSTATE(module);
     if (st->filter_type == 0) {
         smoothscale_init(st);
@@ -522,6 +522,7 @@ __all__ = [
     "OPENGL",
     "OPENGLBLIT",
     "PREALLOC",
+    "PREMULTIPLIED",
     "QUIT",
     "RESIZABLE",
     "RLEACCEL",
@@ -1,6 +1,9 @@
+import array
 import math
+import random
 import unittest
 import sys
+import threading
 import warnings
 
 import pygame
@@ -8,6 +11,7 @@ from pygame import draw
 from pygame import draw_py
 from pygame.locals import SRCALPHA
 from pygame.tests import test_utils
+from pygame.tests.test_utils import number_array
 from pygame.math import Vector2
 
 
@@ -1821,6 +1825,55 @@ class DrawLineTest(LineMixin, DrawTestCase):
         check_white_line((50, 50), (0, 120))
         check_white_line((50, 50), (199, 198))
 
+    def test_line__cap(self):
+        """Ensures the cap parameter shapes the ends of thick lines."""
+        line_color = pygame.Color("yellow")
+        surface_color = pygame.Color("black")
+        surface = pygame.Surface((30, 20))
+        start_pos, end_pos, width = (8, 10), (20, 10), 7
+
+        expected = {
+            # cap: (pixels drawn, pixels not drawn)
+            "flat": ([(8, 7), (20, 13)], [(7, 10), (21, 10)]),
+            "round": ([(5, 10), (23, 10)], [(4, 10), (24, 10), (5, 7), (23, 13)]),
+            "square": ([(5, 7), (23, 13)], [(4, 10), (24, 10)]),
+        }
+
+        for cap, (drawn, not_drawn) in expected.items():
+            surface.fill(surface_color)
+
+            bounds_rect = self.draw_line(
+                surface, line_color, start_pos, end_pos, width, cap=cap
+            )
+
+            for pos in drawn:
+                self.assertEqual(surface.get_at(pos), line_color, (cap, pos))
+            for pos in not_drawn:
+                self.assertEqual(surface.get_at(pos), surface_color, (cap, pos))
+            self.assertEqual(
+                bounds_rect,
+                create_bounding_rect(surface, surface_color, start_pos),
+                cap,
+            )
+
+    def test_line__cap_thin(self):
+        """Ensures caps do not change lines with a width of 1."""
+        surface = pygame.Surface((10, 10))
+        expected = surface.copy()
+        self.draw_line(expected, (255, 0, 0), (2, 3), (7, 5))
+
+        for cap in ("round", "square"):
+            surface.fill((0, 0, 0))
+            self.draw_line(surface, (255, 0, 0), (2, 3), (7, 5), 1, cap)
+
+            for pos in test_utils.rect_area_pts(surface.get_rect()):
+                self.assertEqual(surface.get_at(pos), expected.get_at(pos), cap)
+
+    def test_line__cap_invalid(self):
+        """Ensures an unknown cap name raises a ValueError."""
+        with self.assertRaises(ValueError):
+            self.draw_line(pygame.Surface((5, 5)), (0, 0, 0), (1, 1), (3, 3), 3, "butt")
+
 
 ### Lines Testing #############################################################
 
@@ -2418,6 +2471,70 @@ class DrawLinesTest(LinesMixin, DrawTestCase):
     to add any draw.lines specific tests to.
     """
 
+    def test_lines__joint(self):
+        """Ensures round joints fill a circle around each corner."""
+        line_color = pygame.Color("yellow")
+        surface_color = pygame.Color("black")
+        surface = pygame.Surface((30, 20))
+        points = [(3, 3), (15, 15), (27, 3)]
+        width = 5
+        radius = (width - 1) // 2
+        surface.fill(surface_color)
+        self.draw_lines(surface, line_color, False, points, width)
+        no_joint = surface.copy()
+
+        surface.fill(surface_color)
+        bounds_rect = self.draw_lines(
+            surface, line_color, False, points, width, joint="round"
+        )
+
+        cx, cy = points[1]
+        for pos in test_utils.rect_area_pts(surface.get_rect()):
+            if no_joint.get_at(pos) == line_color:
+                self.assertEqual(surface.get_at(pos), line_color, pos)
+            if (pos[0] - cx) ** 2 + (pos[1] - cy) ** 2 <= radius ** 2:
+                self.assertEqual(surface.get_at(pos), line_color, pos)
+        self.assertEqual(
+            bounds_rect, create_bounding_rect(surface, surface_color, points[0])
+        )
+
+    def test_lines__cap(self):
+        """Ensures caps are only drawn at the ends of open lines."""
+        line_color = pygame.Color("yellow")
+        surface_color = pygame.Color("black")
+        surface = pygame.Surface((30, 20))
+        points = [(8, 4), (20, 4), (20, 14)]
+        width = 5
+
+        surface.fill(surface_color)
+        self.draw_lines(surface, line_color, False, points, width, "square")
+
+        self.assertEqual(surface.get_at((6, 4)), line_color)
+        self.assertEqual(surface.get_at((20, 16)), line_color)
+        # The corner at (20, 4) is not capped.
+        self.assertEqual(surface.get_at((22, 2)), surface_color)
+
+        surface.fill(surface_color)
+        self.draw_lines(surface, line_color, True, points, width)
+        expected = surface.copy()
+
+        surface.fill(surface_color)
+        self.draw_lines(surface, line_color, True, points, width, "square")
+
+        for pos in test_utils.rect_area_pts(surface.get_rect()):
+            self.assertEqual(surface.get_at(pos), expected.get_at(pos), pos)
+
+    def test_lines__cap_and_joint_invalid(self):
+        """Ensures unknown cap and joint names raise a ValueError."""
+        surface = pygame.Surface((5, 5))
+        points = [(0, 0), (2, 2), (4, 0)]
+
+        with self.assertRaises(ValueError):
+            self.draw_lines(surface, (0, 0, 0), False, points, 3, cap="butt")
+
+        with self.assertRaises(ValueError):
+            self.draw_lines(surface, (0, 0, 0), False, points, 3, joint="miter")
+
 
 ### AALine Testing ############################################################
 
@@ -4412,6 +4529,69 @@ class DrawPolygonTest(DrawPolygonMixin, DrawTestCase):
     the class to add any draw.polygon specific tests to.
     """
 
+    def test_polygon__fill_rule(self):
+        """Ensures the fill rule decides how self crossing areas are filled."""
+        surface = pygame.Surface((30, 30))
+        # a pentagram, its center is wound around twice
+        star = [(15, 1), (23, 28), (2, 10), (28, 10), (7, 28)]
+
+        for fill_rule, center_color in (("evenodd", RED), ("nonzero", GREEN)):
+            surface.fill(RED)
+            bounds_rect = self.draw_polygon(
+                surface, GREEN, star, fill_rule=fill_rule
+            )
+
+            self.assertEqual(bounds_rect, pygame.Rect(2, 1, 27, 28))
+            self.assertEqual(surface.get_at((15, 16)), center_color)
+            for point in star:
+                self.assertEqual(surface.get_at(point), GREEN, fill_rule)
+            self.assertEqual(surface.get_at((15, 27)), RED)
+
+        # two overlapping squares drawn in the same direction
+        squares = [(0, 0), (6, 0), (6, 6), (0, 6), (0, 0)]
+        squares += [(3, 3), (9, 3), (9, 9), (3, 9), (3, 3)]
+
+        for fill_rule, overlap_color in (("evenodd", RED), ("nonzero", GREEN)):
+            surface.fill(RED)
+            self.draw_polygon(surface, GREEN, squares, fill_rule=fill_rule)
+
+            self.assertEqual(surface.get_at((4, 4)), overlap_color)
+            self.assertEqual(surface.get_at((1, 1)), GREEN)
+            self.assertEqual(surface.get_at((8, 8)), GREEN)
+
+    def test_polygon__fill_rule_invalid(self):
+        """Ensures an unknown fill rule raises a ValueError."""
+        for fill_rule in ("", "even-odd", "NONZERO"):
+            with self.assertRaises(ValueError):
+                self.draw_polygon(
+                    self.surface, RED, SQUARE, fill_rule=fill_rule
+                )
+
+    def test_polygon__many_points(self):
+        """Ensures polygons with many points are filled like simple ones."""
+        surface = pygame.Surface((200, 200))
+        count = 2000
+        points = [
+            (
+                100 + 90 * math.cos(2 * math.pi * i / count),
+                100 + 90 * math.sin(2 * math.pi * i / count),
+            )
+            for i in range(count)
+        ]
+
+        for fill_rule in ("evenodd", "nonzero"):
+            surface.fill(RED)
+            bounds_rect = self.draw_polygon(
+                surface, GREEN, points, fill_rule=fill_rule
+            )
+
+            self.assertEqual(bounds_rect, pygame.Rect(10, 10, 181, 181))
+            for x in range(25, 175, 5):
+                self.assertEqual(surface.get_at((x, 100)), GREEN)
+                self.assertEqual(surface.get_at((100, x)), GREEN)
+            for corner in ((15, 15), (185, 15), (15, 185), (185, 185)):
+                self.assertEqual(surface.get_at(corner), RED)
+
 
 # Commented out to avoid cluttering the test output. Add back in if draw_py
 # ever fully supports drawing polygons.
@@ -5807,6 +5987,53 @@ class DrawCircleMixin(object):
             self.assertEqual(bounding_rect.width, radius * 2)
             self.assertEqual(bounding_rect.height, radius * 2)
 
+    def test_circle__repeated(self):
+        """Ensures circles drawn again with the same radius, as from a
+        cache of their rows, match the first draw at any position and
+        clip.
+        """
+        color = pygame.Color("red")
+        surface = pygame.Surface((120, 120))
+        # More radii than are cached, so early ones are dropped and redone.
+        radii = list(range(1, 50)) + [3, 10, 45]
+        kwargs_list = [
+            {},
+            {"width": 1},
+            {"width": 3},
+            {"draw_top_left": True, "draw_bottom_right": True},
+            {"width": 2, "draw_top_right": True, "draw_bottom_left": True},
+        ]
+
+        for radius in radii:
+            for kwargs in kwargs_list:
+                surface.fill((0, 0, 0))
+                first_rect = self.draw_circle(
+                    surface, color, (55, 55), radius, **kwargs
+                )
+                first = surface.copy()
+
+                surface.fill((0, 0, 0))
+                rect = self.draw_circle(
+                    surface, color, (60, 58), radius, **kwargs
+                )
+                self.assertEqual(rect, first_rect.move(5, 3))
+                self.assertEqual(
+                    pygame.image.tostring(surface.subsurface(rect), "RGB"),
+                    pygame.image.tostring(first.subsurface(first_rect), "RGB"),
+                )
+
+                surface.fill((0, 0, 0))
+                surface.set_clip((0, 50, 120, 9))
+                rect = self.draw_circle(
+                    surface, color, (55, 55), radius, **kwargs
+                )
+                surface.set_clip(None)
+                self.assertEqual(rect, first_rect.clip((0, 50, 120, 9)))
+                self.assertEqual(
+                    pygame.image.tostring(surface.subsurface(rect), "RGB"),
+                    pygame.image.tostring(first.subsurface(rect), "RGB"),
+                )
+
 
 class DrawCircleTest(DrawCircleMixin, DrawTestCase):
     """Test draw module function circle.
@@ -6410,6 +6637,645 @@ class DrawArcTest(DrawArcMixin, DrawTestCase):
 #    """
 
 
+### Antialiased Filled Shapes Testing #######################################
+
+
+class DrawAAFilledTest(unittest.TestCase):
+    """Tests for draw.aacircle, draw.aaellipse, draw.aapolygon and thick
+    draw.aaline.
+    """
+
+    def _assert_coverage(self, surface, pos, coverage, delta=2):
+        """Checks the blue channel of a white on black drawing."""
+        self.assertAlmostEqual(
+            surface.get_at(pos).b, int(coverage * 255), delta=delta, msg=pos
+        )
+
+    def test_aapolygon__coverage(self):
+        """Ensures pixels are blended by the area the polygon covers."""
+        surface = pygame.Surface((10, 10))
+        white = pygame.Color("white")
+
+        bounds_rect = draw.aapolygon(surface, white, [(2, 2), (7, 2), (7, 7), (2, 7)])
+
+        self.assertEqual(bounds_rect, pygame.Rect(2, 2, 6, 6))
+        for x in range(3, 7):
+            for y in range(3, 7):
+                self.assertEqual(surface.get_at((x, y)), white)
+        for i in range(3, 7):
+            for pos in ((2, i), (7, i), (i, 2), (i, 7)):
+                self._assert_coverage(surface, pos, 0.5)
+        for pos in ((2, 2), (7, 2), (2, 7), (7, 7)):
+            self._assert_coverage(surface, pos, 0.25)
+        for pos in ((1, 4), (8, 4), (4, 1), (4, 8)):
+            self.assertEqual(surface.get_at(pos), (0, 0, 0, 255))
+
+    def test_aapolygon__blend(self):
+        """Ensures edge pixels mix the color with the surface."""
+        surface = pygame.Surface((10, 10))
+        surface.fill((255, 0, 0))
+
+        draw.aapolygon(surface, (0, 0, 255), [(2, 2), (7, 2), (7, 7), (2, 7)])
+
+        color = surface.get_at((2, 4))
+        self.assertAlmostEqual(color.r, 127, delta=2)
+        self.assertAlmostEqual(color.b, 127, delta=2)
+        self.assertEqual(surface.get_at((4, 4)), (0, 0, 255, 255))
+
+    def test_aapolygon__depths(self):
+        """Ensures fully covered pixels get the exact color at every depth."""
+        color = pygame.Color(10, 120, 250)
+
+        for depth in (8, 16, 24, 32):
+            surface = pygame.Surface((10, 10), 0, depth)
+            expected = surface.unmap_rgb(surface.map_rgb(color))
+
+            draw.aapolygon(surface, color, [(1, 1), (8, 1), (8, 8), (1, 8)])
+
+            self.assertEqual(surface.get_at((4, 4)), expected, depth)
+
+    def test_aapolygon__clip(self):
+        """Ensures nothing is drawn outside the clip area."""
+        surface = pygame.Surface((20, 20))
+        clip_rect = pygame.Rect(5, 6, 8, 7)
+        surface.set_clip(clip_rect)
+
+        bounds_rect = draw.aapolygon(
+            surface, (255, 255, 255), [(-3.5, 0), (25, 2.5), (10, 30.2)]
+        )
+
+        self.assertTrue(clip_rect.contains(bounds_rect))
+        for x in range(20):
+            for y in range(20):
+                if not clip_rect.collidepoint(x, y):
+                    self.assertEqual(surface.get_at((x, y)), (0, 0, 0, 255))
+
+    def test_aapolygon__invalid_points(self):
+        """Ensures too few points or invalid points raise an exception."""
+        surface = pygame.Surface((5, 5))
+
+        with self.assertRaises(ValueError):
+            draw.aapolygon(surface, (0, 0, 0), [(0, 0), (2, 2)])
+
+        with self.assertRaises(TypeError):
+            draw.aapolygon(surface, (0, 0, 0), [(0, 0), (2, 2), "ab"])
+
+    def test_aacircle(self):
+        """Ensures aacircle is filled and symmetric around its center."""
+        surface = pygame.Surface((21, 21))
+        white = pygame.Color("white")
+
+        bounds_rect = draw.aacircle(surface, white, (10, 10), 5)
+
+        self.assertEqual(bounds_rect, pygame.Rect(5, 5, 11, 11))
+        self.assertEqual(surface.get_at((10, 10)), white)
+        self.assertEqual(surface.get_at((4, 10)), (0, 0, 0, 255))
+        self._assert_coverage(surface, (5, 10), 0.45, delta=5)
+        for x in range(21):
+            for y in range(21):
+                color = surface.get_at((x, y))
+                self.assertEqual(color, surface.get_at((20 - x, y)), (x, y))
+                self.assertEqual(color, surface.get_at((y, x)), (x, y))
+
+    def test_aacircle__width(self):
+        """Ensures aacircle draws an outline growing inward for width > 0,
+        fills for a width as large as the radius and draws nothing for
+        width < 0."""
+        white = pygame.Color("white")
+        filled = pygame.Surface((21, 21))
+        draw.aacircle(filled, white, (10, 10), 8)
+
+        surface = pygame.Surface((21, 21))
+        bounds_rect = draw.aacircle(surface, white, (10, 10), 8, 3)
+
+        self.assertEqual(bounds_rect, pygame.Rect(2, 2, 17, 17))
+        self.assertEqual(surface.get_at((10, 4)), white)
+        self.assertEqual(surface.get_at((16, 10)), white)
+        self.assertEqual(surface.get_at((10, 6)), (0, 0, 0, 255))
+        self.assertEqual(surface.get_at((10, 10)), (0, 0, 0, 255))
+        for x in range(21):
+            for y in range(21):
+                color = surface.get_at((x, y))
+                self.assertEqual(color, surface.get_at((20 - x, y)), (x, y))
+                self.assertEqual(color, surface.get_at((y, x)), (x, y))
+
+        for width in (8, 20):
+            surface = pygame.Surface((21, 21))
+            draw.aacircle(surface, white, (10, 10), 8, width=width)
+
+            for x in range(21):
+                for y in range(21):
+                    self.assertEqual(
+                        surface.get_at((x, y)), filled.get_at((x, y)), (x, y)
+                    )
+
+        surface = pygame.Surface((21, 21))
+        bounds_rect = draw.aacircle(surface, white, (10, 10), 8, -1)
+
+        self.assertEqual(bounds_rect, pygame.Rect(10, 10, 0, 0))
+        self.assertEqual(surface.get_bounding_rect(), pygame.Rect(0, 0, 0, 0))
+
+    def test_aacircle__radius_not_positive(self):
+        """Ensures nothing is drawn for a radius <= 0."""
+        surface = pygame.Surface((5, 5))
+
+        for radius in (0, -1.5):
+            bounds_rect = draw.aacircle(surface, (255, 0, 0), (2, 3), radius)
+
+            self.assertEqual(bounds_rect, pygame.Rect(2, 3, 0, 0))
+            self.assertEqual(surface.get_bounding_rect(), pygame.Rect(0, 0, 0, 0))
+
+    def test_aaellipse(self):
+        """Ensures aaellipse is drawn inside its rect."""
+        surface = pygame.Surface((30, 20))
+        rect = pygame.Rect(2, 3, 25, 12)
+
+        bounds_rect = draw.aaellipse(surface, (255, 255, 255), rect)
+
+        self.assertEqual(bounds_rect, rect)
+        self.assertEqual(surface.get_at(rect.center), (255, 255, 255, 255))
+        for x in range(30):
+            for y in range(20):
+                if not rect.collidepoint(x, y):
+                    self.assertEqual(surface.get_at((x, y)), (0, 0, 0, 255))
+
+    def test_aaline__width(self):
+        """Ensures a thick aaline covers a rectangle around the line."""
+        surface = pygame.Surface((25, 20))
+        white = pygame.Color("white")
+
+        bounds_rect = draw.aaline(surface, white, (2, 10), (20, 10), width=5)
+
+        self.assertEqual(bounds_rect, pygame.Rect(2, 8, 19, 5))
+        for x in range(3, 20):
+            for y in range(8, 13):
+                self.assertEqual(surface.get_at((x, y)), white)
+            self.assertEqual(surface.get_at((x, 7)), (0, 0, 0, 255))
+            self.assertEqual(surface.get_at((x, 13)), (0, 0, 0, 255))
+        for y in range(8, 13):
+            self._assert_coverage(surface, (2, y), 0.5)
+            self._assert_coverage(surface, (20, y), 0.5)
+
+    def test_aaline__width_blend(self):
+        """Ensures a thick aaline honors blend on its edge pixels."""
+        red, blue = (255, 0, 0), (0, 0, 255)
+        surface = pygame.Surface((25, 20))
+
+        for blend, expected_blue in ((True, 128), (False, 0)):
+            surface.fill(blue)
+            with warnings.catch_warnings():
+                warnings.simplefilter("ignore", DeprecationWarning)
+                draw.aaline(surface, red, (2, 10), (20, 10), blend, 5)
+
+            self.assertEqual(surface.get_at((10, 10)), red)
+            r, g, b, _ = surface.get_at((2, 10))
+            self.assertAlmostEqual(r, 128, delta=2)
+            self.assertAlmostEqual(b, expected_blue, delta=2)
+
+
+### Batched Drawing Testing ##################################################
+
+
+class DrawBatchTest(unittest.TestCase):
+    """Tests for draw.circles, draw.rects and draw.segments."""
+
+    def setUp(self):
+        self.random = random.Random(35)
+
+    def _colors(self, count):
+        return [
+            tuple(self.random.randrange(1, 256) for _ in range(3))
+            for _ in range(count)
+        ]
+
+    def _union(self, rects):
+        drawn = [r for r in rects if r.width and r.height]
+        return drawn[0].unionall(drawn[1:])
+
+    def _assert_same_surface(self, surf1, surf2):
+        for x in range(surf1.get_width()):
+            for y in range(surf1.get_height()):
+                self.assertEqual(surf1.get_at((x, y)), surf2.get_at((x, y)), (x, y))
+
+    def test_circles(self):
+        """Ensures circles draws the same as a circle call per circle."""
+        count = 40
+        centers = [
+            (self.random.randrange(-10, 90), self.random.randrange(-10, 70))
+            for _ in range(count)
+        ]
+        radii = [self.random.randrange(0, 20) for _ in range(count)]
+        colors = self._colors(count)
+
+        for width in (0, 1, 3):
+            surf1 = pygame.Surface((80, 60))
+            surf2 = pygame.Surface((80, 60))
+            surf1.set_clip((5, 5, 60, 45))
+            surf2.set_clip((5, 5, 60, 45))
+
+            bounds_rect = draw.circles(
+                surf1,
+                number_array("B", colors),
+                number_array("i", centers),
+                array.array("h", radii),
+                width,
+            )
+            expected = [
+                draw.circle(surf2, color, center, radius, width)
+                for color, center, radius in zip(colors, centers, radii)
+            ]
+
+            self.assertEqual(bounds_rect, self._union(expected))
+            self._assert_same_surface(surf1, surf2)
+
+    def test_rects(self):
+        """Ensures rects draws the same as a rect call per rectangle."""
+        count = 40
+        rects = [
+            (
+                self.random.randrange(-10, 80),
+                self.random.randrange(-10, 60),
+                self.random.randrange(-5, 30),
+                self.random.randrange(-5, 30),
+            )
+            for _ in range(count)
+        ]
+        colors = self._colors(count)
+
+        for width in (0, 1, 4):
+            surf1 = pygame.Surface((80, 60))
+            surf2 = pygame.Surface((80, 60))
+
+            bounds_rect = draw.rects(
+                surf1, number_array("B", colors), number_array("l", rects), width
+            )
+            expected = [
+                draw.rect(surf2, color, rect, width)
+                for color, rect in zip(colors, rects)
+            ]
+
+            self.assertEqual(bounds_rect, self._union(expected))
+            self._assert_same_surface(surf1, surf2)
+
+    def test_segments(self):
+        """Ensures segments draws the same as a line call per segment."""
+        count = 40
+        segments = [
+            tuple(float(self.random.randrange(-20, 100)) for _ in range(4))
+            for _ in range(count)
+        ]
+        colors = self._colors(count)
+
+        for width in (1, 2, 5):
+            surf1 = pygame.Surface((80, 60))
+            surf2 = pygame.Surface((80, 60))
+
+            bounds_rect = draw.segments(
+                surf1, number_array("B", colors), number_array("d", segments), width
+            )
+            expected = [
+                draw.line(surf2, color, segment[:2], segment[2:], width)
+                for color, segment in zip(colors, segments)
+            ]
+
+            self.assertEqual(bounds_rect, self._union(expected))
+            self._assert_same_surface(surf1, surf2)
+
+    def test_single_color_and_radius(self):
+        """Ensures one color or radius can be given for all primitives."""
+        surf = pygame.Surface((20, 20))
+        centers = number_array("i", [(5, 5), (14, 14)])
+        expected_rect = draw.circle(surf, GREEN, (5, 5), 3).union(
+            draw.circle(surf, GREEN, (14, 14), 3)
+        )
+
+        for color in (GREEN, pygame.Color(GREEN), surf.map_rgb(GREEN), "green"):
+            surf.fill(RED)
+            bounds_rect = draw.circles(surf, color, centers, 3)
+
+            self.assertEqual(bounds_rect, expected_rect)
+            self.assertEqual(surf.get_at((5, 5)), GREEN)
+            self.assertEqual(surf.get_at((14, 14)), GREEN)
+            self.assertEqual(surf.get_at((10, 10)), RED)
+
+        blue = pygame.Color("blue")
+        mapped = array.array("I", [surf.map_rgb(RED), surf.map_rgb(blue)])
+        draw.rects(surf, mapped, number_array("i", [(0, 0, 2, 2), (3, 3, 2, 2)]))
+        self.assertEqual(surf.get_at((1, 1)), RED)
+        self.assertEqual(surf.get_at((4, 4)), blue)
+
+    def test_nothing_drawn(self):
+        """Ensures the rect is empty at the first position if nothing is drawn."""
+        surf = pygame.Surface((20, 20))
+        segments = number_array("i", [(30, 30, 40, 40), (50, 50, 60, 60)])
+
+        self.assertEqual(
+            draw.segments(surf, RED, segments), pygame.Rect(30, 30, 0, 0)
+        )
+        self.assertEqual(
+            draw.segments(surf, RED, number_array("i", [(1, 2, 3, 4)]), 0),
+            pygame.Rect(1, 2, 0, 0),
+        )
+
+    def test_invalid_arrays(self):
+        """Ensures arrays of the wrong shape or length raise a ValueError."""
+        surf = pygame.Surface((20, 20))
+        centers = number_array("i", [(5, 5), (14, 14)])
+
+        with self.assertRaises(ValueError):
+            draw.circles(surf, RED, number_array("i", [(5, 5, 5)]), 3)
+        with self.assertRaises(ValueError):
+            draw.circles(surf, RED, centers, array.array("i", [1, 2, 3]))
+        with self.assertRaises(ValueError):
+            draw.circles(surf, number_array("B", [(1, 2, 3)]), centers, 3)
+        with self.assertRaises(ValueError):
+            draw.circles(surf, number_array("i", [(1, 2)] * 2), centers, 3)
+        with self.assertRaises(ValueError):
+            draw.rects(surf, RED, array.array("i", [0, 0, 5, 5]))
+        with self.assertRaises(ValueError):
+            draw.segments(surf, RED, number_array("d", [(0, 0, 1e20, 0)]))
+        with self.assertRaises(ValueError):
+            draw.segments(surf, RED, [(0, 0, 5, 5)])
+
+    @unittest.skipIf(not pygame.HAVE_NEWBUF, "newbuf not implemented")
+    def test_array_item_sizes(self):
+        """Ensures items are read at the size of their format, from unaligned
+        buffers too, and a buffer whose itemsize does not match its format
+        raises a ValueError."""
+        import ctypes
+        import struct
+        from pygame.tests.test_utils import buftools
+
+        rect_values = [0, 0, 2, 2, 3, 3, 2, 2]
+        standard = buftools.Exporter((2, 4), format="=l")
+        (ctypes.c_int32 * 8).from_address(standard.buf)[:] = rect_values
+        unaligned = bytearray(1 + 4 * 8)
+        struct.pack_into("8i", unaligned, 1, *rect_values)
+
+        for rects in (standard, memoryview(unaligned)[1:].cast("i", (2, 4))):
+            surf = pygame.Surface((20, 20))
+            bounds_rect = draw.rects(surf, RED, rects)
+
+            self.assertEqual(bounds_rect, pygame.Rect(0, 0, 5, 5))
+            self.assertEqual(surf.get_at((4, 4)), RED)
+            self.assertEqual(surf.get_at((2, 2)), (0, 0, 0))
+
+        with self.assertRaises(ValueError):
+            draw.rects(surf, RED, buftools.Exporter((2, 4), "=l", itemsize=8))
+
+
+### Threaded Drawing Testing ################################################
+
+
+class DrawThreadedTest(unittest.TestCase):
+    """Tests for the filled shapes, which release the GIL and draw large
+    areas in bands of rows on several threads.
+    """
+
+    size = (640, 560)
+
+    color = (20, 120, 220)
+    shapes = (
+        lambda surf, c: draw.circle(surf, c, (300, 280), 270),
+        lambda surf, c: draw.ellipse(surf, c, (10, 20, 600, 500)),
+        lambda surf, c: draw.polygon(
+            surf, c, [(0, 10), (630, 40), (320, 550), (600, 500)]
+        ),
+        lambda surf, c: draw.rect(surf, c, (5, 5, 620, 540), border_radius=60),
+    )
+
+    def _draw_all(self, surface):
+        for shape in self.shapes:
+            shape(surface, self.color)
+
+    def test_bands(self):
+        """Ensures large filled shapes draw the same as in small pieces."""
+        surface = pygame.Surface(self.size)
+        strips = pygame.Surface(self.size)
+
+        for i, shape in enumerate(self.shapes):
+            surface.fill((0, 0, 0))
+            strips.fill((0, 0, 0))
+            expected_rect = shape(surface, self.color)
+
+            # Strips small enough to be drawn on one thread.
+            rects = []
+            for y in range(0, self.size[1], 40):
+                strips.set_clip((0, y, self.size[0], 40))
+                rect = shape(strips, self.color)
+                if rect.width and rect.height:
+                    rects.append(rect)
+            strips.set_clip(None)
+
+            self.assertEqual(expected_rect, rects[0].unionall(rects[1:]), i)
+            self.assertEqual(
+                pygame.image.tostring(surface, "RGB"),
+                pygame.image.tostring(strips, "RGB"),
+                i,
+            )
+
+    def test_threads(self):
+        """Ensures shapes drawn from several threads at once are correct."""
+        expected = pygame.Surface(self.size)
+        self._draw_all(expected)
+        expected_bytes = pygame.image.tostring(expected, "RGB")
+        surfaces = [pygame.Surface(self.size) for _ in range(4)]
+
+        threads = [
+            threading.Thread(target=self._draw_all, args=(surface,))
+            for surface in surfaces
+        ]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+        for surface in surfaces:
+            self.assertEqual(pygame.image.tostring(surface, "RGB"), expected_bytes)
+
+
+### Gradient Testing ########################################################
+
+
+class DrawGradientRectTest(unittest.TestCase):
+    """Test draw.gradient_rect."""
+
+    def assertColorAlmostEqual(self, color, expected, delta=2, msg=None):
+        for got, want in zip(color, expected):
+            self.assertAlmostEqual(got, want, delta=delta, msg=msg)
+
+    def test_linear(self):
+        """Ensures a linear gradient goes across the rect."""
+        surface = pygame.Surface((256, 10), SRCALPHA, 32)
+        start, end = (0, 40, 255, 255), (255, 200, 0, 55)
+
+        rect = draw.gradient_rect(surface, surface.get_rect(), [start, end])
+
+        self.assertEqual(rect, surface.get_rect())
+        for x in (0, 63, 128, 200, 255):
+            t = (x + 0.5) / 256
+            expected = [a + (b - a) * t for a, b in zip(start, end)]
+            self.assertColorAlmostEqual(surface.get_at((x, 5)), expected,
+                                        msg=x)
+        self.assertEqual(surface.get_at((40, 0)), surface.get_at((40, 9)))
+
+    def test_linear__angle(self):
+        """Ensures a linear gradient at 90 degrees goes up."""
+        surface = pygame.Surface((10, 100))
+        start, end = (255, 0, 0), (0, 0, 255)
+
+        draw.gradient_rect(surface, (0, 0, 10, 100), [start, end], angle=90)
+
+        self.assertColorAlmostEqual(surface.get_at((5, 99)), start, delta=3)
+        self.assertColorAlmostEqual(surface.get_at((5, 0)), end, delta=3)
+        self.assertEqual(surface.get_at((0, 30)), surface.get_at((9, 30)))
+
+    def test_radial(self):
+        """Ensures a radial gradient reaches its last stop in the corners."""
+        surface = pygame.Surface((101, 101))
+        start, end = (255, 255, 255), (0, 0, 0)
+
+        draw.gradient_rect(surface, surface.get_rect(), [start, end],
+                           kind="radial")
+
+        self.assertColorAlmostEqual(surface.get_at((50, 50)), start, delta=3)
+        self.assertColorAlmostEqual(surface.get_at((0, 0)), end, delta=3)
+        self.assertColorAlmostEqual(surface.get_at((100, 100)), end, delta=3)
+        self.assertEqual(surface.get_at((20, 50)), surface.get_at((80, 50)))
+        self.assertEqual(surface.get_at((50, 20)), surface.get_at((50, 80)))
+
+    def test_radial__center(self):
+        """Ensures a radial gradient can be off the center of the rect."""
+        surface = pygame.Surface((100, 100))
+        start, end = (255, 0, 0), (0, 255, 0)
+
+        draw.gradient_rect(surface, surface.get_rect(), [start, end],
+                           kind="radial", center=(0, 0))
+
+        self.assertColorAlmostEqual(surface.get_at((0, 0)), start, delta=3)
+        self.assertColorAlmostEqual(surface.get_at((99, 99)), end, delta=3)
+
+    def test_conic(self):
+        """Ensures a conic gradient goes counterclockwise from its angle."""
+        surface = pygame.Surface((100, 100))
+        stops = [(0, 0, 0), (200, 200, 200)]
+
+        draw.gradient_rect(surface, surface.get_rect(), stops, kind="conic",
+                           angle=90, center=(50, 50))
+
+        # Just left of straight up, just right of it, then left and down.
+        self.assertColorAlmostEqual(surface.get_at((49, 10)), (0, 0, 0), 3)
+        self.assertColorAlmostEqual(surface.get_at((50, 10)),
+                                    (200, 200, 200), 3)
+        self.assertColorAlmostEqual(surface.get_at((10, 49)), (50, 50, 50), 3)
+        self.assertColorAlmostEqual(surface.get_at((49, 90)),
+                                    (100, 100, 100), 3)
+
+    def test_stop_positions(self):
+        """Ensures stops with positions make flat areas and hard edges."""
+        surface = pygame.Surface((100, 4))
+        red, blue = pygame.Color("red"), pygame.Color("blue")
+        stops = [(0.25, red), (0.5, red), (0.5, blue), (0.75, blue)]
+
+        draw.gradient_rect(surface, surface.get_rect(), stops)
+
+        for x in range(0, 50):
+            self.assertEqual(surface.get_at((x, 0)), red, x)
+        for x in range(50, 100):
+            self.assertEqual(surface.get_at((x, 0)), blue, x)
+
+    def test_single_stop(self):
+        """Ensures a single stop fills the rect with its color."""
+        surface = pygame.Surface((20, 20), SRCALPHA, 32)
+        color = pygame.Color("orange")
+
+        for kind in ("linear", "radial", "conic"):
+            surface.fill((0, 0, 0, 0))
+            draw.gradient_rect(surface, (5, 5, 10, 10), [color], kind=kind)
+
+            self.assertEqual(surface.get_bounding_rect(), (5, 5, 10, 10))
+            self.assertEqual(surface.get_at((9, 12)), color)
+
+    def test_clip(self):
+        """Ensures the gradient is clipped and keeps its geometry."""
+        surface = pygame.Surface((100, 10), SRCALPHA, 32)
+        clipped = pygame.Surface((100, 10), SRCALPHA, 32)
+        clipped.set_clip((30, 2, 50, 5))
+        stops = [(10, 20, 30), (250, 100, 0), (0, 0, 90)]
+
+        draw.gradient_rect(surface, (-20, 0, 200, 10), stops)
+        rect = draw.gradient_rect(clipped, (-20, 0, 200, 10), stops)
+
+        self.assertEqual(rect, (30, 2, 50, 5))
+        self.assertEqual(clipped.get_bounding_rect(), (30, 2, 50, 5))
+        for x in range(30, 80):
+            self.assertEqual(clipped.get_at((x, 4)), surface.get_at((x, 4)))
+
+    def test_nothing_drawn(self):
+        """Ensures a rect outside the clip area returns an empty rect."""
+        surface = pygame.Surface((10, 10), SRCALPHA, 32)
+
+        rect = draw.gradient_rect(surface, (20, 30, 5, 5), ["red", "blue"])
+
+        self.assertEqual(rect, (20, 30, 0, 0))
+        self.assertEqual(surface.get_bounding_rect().size, (0, 0))
+
+    def test_dither(self):
+        """Ensures dithering keeps flat colors and the average of a
+        gradient on a 16 bit surface."""
+        surface = pygame.Surface((128, 8), 0, 16)
+        color = surface.unmap_rgb(surface.map_rgb((96, 160, 64)))
+
+        draw.gradient_rect(surface, surface.get_rect(), [color, color],
+                           dither=True)
+        for pos in ((x, y) for x in range(48, 52) for y in range(4)):
+            self.assertEqual(surface.get_at(pos), color, pos)
+
+        draw.gradient_rect(surface, surface.get_rect(), ["black", "white"],
+                           dither=True)
+        for x in range(0, 120, 4):
+            block = [surface.get_at((x + i, y)).r for i in range(4)
+                     for y in range(4)]
+            expected = (x + 2) * 255 / 128.0
+            self.assertAlmostEqual(sum(block) / 16.0, expected, delta=4)
+
+    def test_surface_depths(self):
+        """Ensures every surface depth gets the same gradient."""
+        stops = [(0, 0, 0), (255, 128, 64)]
+        expected = pygame.Surface((64, 8), 0, 32)
+        draw.gradient_rect(expected, expected.get_rect(), stops)
+
+        for depth in (8, 16, 24, 32):
+            surface = pygame.Surface((64, 8), 0, depth)
+            draw.gradient_rect(surface, surface.get_rect(), stops)
+
+            for x in range(0, 64, 7):
+                want = surface.unmap_rgb(surface.map_rgb(expected.get_at((x, 3))))
+                self.assertEqual(surface.get_at((x, 3)), want, (depth, x))
+
+    def test_invalid_args(self):
+        """Ensures invalid arguments raise errors."""
+        surface = pygame.Surface((10, 10))
+        rect = surface.get_rect()
+
+        with self.assertRaises(ValueError):
+            draw.gradient_rect(surface, rect, ["red", "blue"], kind="spiral")
+        with self.assertRaises(ValueError):
+            draw.gradient_rect(surface, rect, [])
+        with self.assertRaises(ValueError):
+            draw.gradient_rect(surface, rect, ["red", (0.5, "blue")])
+        with self.assertRaises(ValueError):
+            draw.gradient_rect(surface, rect, [(0.5, "red"), (0.2, "blue")])
+        with self.assertRaises(TypeError):
+            draw.gradient_rect(surface, rect, [("a", "red"), (1, "blue")])
+        with self.assertRaises(TypeError):
+            draw.gradient_rect(surface, rect, 5)
+        with self.assertRaises(TypeError):
+            draw.gradient_rect(surface, rect, ["red"], center="middle")
+        with self.assertRaises(ValueError):
+            draw.gradient_rect(surface, rect, ["not a color"])
+
+
 ### Draw Module Testing #######################################################
 
 
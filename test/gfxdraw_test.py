@@ -2,7 +2,7 @@ import unittest
 import pygame
 import pygame.gfxdraw
 from pygame.locals import *
-from pygame.tests.test_utils import SurfaceSubclass
+from pygame.tests.test_utils import SurfaceSubclass, number_array
 
 
 def intensity(c, i):
@@ -851,6 +851,134 @@ class GfxdrawDefaultTest(unittest.TestCase):
             0,
         )
 
+    def test_textured_triangles(self):
+        """textured_triangles(surface, texture, vertices, uvs): return None"""
+        texture = pygame.Surface((8, 8), 0, 32)
+        for y in range(8):
+            for x in range(8):
+                texture.set_at((x, y), (x * 32, y * 32, 128))
+        # Two triangles covering the square (10, 20, 16, 16), with the
+        # texture twice across and down it.
+        vertices = number_array(
+            "f", [(10, 20), (26, 20), (26, 36), (10, 20), (26, 36), (10, 36)]
+        )
+        uvs = number_array("d", [(0, 0), (1, 0), (1, 1), (0, 0), (1, 1), (0, 1)])
+        big_vertices = number_array(
+            "i", [(0, 0), (16, 0), (16, 16), (0, 0), (16, 16), (0, 16)]
+        )
+        big_uvs = number_array(
+            "d", [(0, 0), (2, 0), (2, 2), (0, 0), (2, 2), (0, 2)]
+        )
+        bg = self.background_color
+        for surf in self.surfaces[1:]:
+            surf.fill(bg)
+            self.assertIsNone(
+                pygame.gfxdraw.textured_triangles(surf, texture, vertices, uvs)
+            )
+            for y in range(18, 38):
+                for x in range(8, 28):
+                    if 10 <= x < 26 and 20 <= y < 36:
+                        color = texture.get_at(((x - 10) // 2, (y - 20) // 2))
+                    else:
+                        color = bg
+                    self.check_at(surf, (x, y), surf.unmap_rgb(surf.map_rgb(color)))
+
+            # Texture coordinates outside 0 to 1 repeat the texture.
+            pygame.gfxdraw.textured_triangles(surf, texture, big_vertices, big_uvs)
+            for y in range(16):
+                for x in range(16):
+                    color = texture.get_at((x % 8, y % 8))
+                    self.check_at(surf, (x, y), surf.unmap_rgb(surf.map_rgb(color)))
+
+    def test_textured_triangles__indices(self):
+        """Triangles of a mesh share vertices and draw shared edges once"""
+        texture = pygame.Surface((1, 1), SRCALPHA, 32)
+        texture.fill((255, 0, 0, 64))
+        vertices = number_array(
+            "d", [(10.3, 10.7), (60.5, 12.2), (62.1, 70.9), (8.4, 55.5), (35, 38)]
+        )
+        uvs = number_array("B", [(0, 0)] * 5)
+        indices = number_array("H", [(0, 1, 4), (1, 2, 4), (2, 3, 4), (3, 0, 4)])
+        surf = pygame.Surface(self.default_size, 0, 32)
+        surf.fill((0, 0, 0))
+        pygame.gfxdraw.textured_triangles(surf, texture, vertices, uvs, indices)
+
+        # Every pixel is blended once, inside and on the shared edges.
+        once = (64, 0, 0, 255)
+        for posn in ((35, 38), (35, 20), (50, 40), (20, 40), (34, 60), (45, 25)):
+            self.check_at(surf, posn, once)
+        for posn in ((5, 5), (95, 95), (7, 30), (70, 40)):
+            self.check_at(surf, posn, (0, 0, 0, 255))
+        counts = {}
+        for y in range(surf.get_height()):
+            for x in range(surf.get_width()):
+                color = tuple(surf.get_at((x, y)))
+                counts[color] = counts.get(color, 0) + 1
+        self.assertEqual(set(counts), {once, (0, 0, 0, 255)})
+
+    def test_textured_triangles__bilinear(self):
+        """bilinear=True blends the texels around each pixel center"""
+        texture = pygame.Surface((2, 1), 0, 32)
+        texture.set_at((0, 0), (0, 0, 0))
+        texture.set_at((1, 0), (200, 0, 0))
+        # The texture stretched across 8 pixels puts the texel centers
+        # between pixels 1 and 2 and between pixels 5 and 6. Pixels beyond
+        # them blend with the texel repeated at the other side.
+        vertices = number_array("i", [(0, 0), (8, 0), (8, 4), (0, 4)])
+        uvs = number_array("f", [(0, 0), (1, 0), (1, 1), (0, 1)])
+        indices = number_array("i", [(0, 1, 2), (0, 2, 3)])
+        surf = pygame.Surface((8, 4), 0, 32)
+        pygame.gfxdraw.textured_triangles(
+            surf, texture, vertices, uvs, indices, bilinear=True
+        )
+        reds = [surf.get_at((x, 1)).r for x in range(8)]
+        self.assertEqual(reds, [75, 25, 25, 75, 125, 175, 175, 125])
+
+        pygame.gfxdraw.textured_triangles(
+            surf, texture, vertices, uvs, indices, bilinear=False
+        )
+        reds = [surf.get_at((x, 1)).r for x in range(8)]
+        self.assertEqual(reds, [0, 0, 0, 0, 200, 200, 200, 200])
+
+    def test_textured_triangles__invalid(self):
+        """textured_triangles raises for bad arguments"""
+        surf = pygame.Surface((10, 10))
+        texture = pygame.Surface((4, 4))
+        vertices = number_array("i", [(0, 0), (5, 0), (0, 5)])
+        uvs = number_array("d", [(0, 0), (1, 0), (0, 1)])
+        draw = pygame.gfxdraw.textured_triangles
+
+        with self.assertRaises(TypeError):
+            draw(surf, None, vertices, uvs)
+        with self.assertRaises(TypeError):
+            draw(None, texture, vertices, uvs)
+        with self.assertRaises(ValueError):
+            draw(surf, texture, number_array("i", [(0, 0, 0)]), uvs)
+        with self.assertRaises(ValueError):
+            draw(surf, texture, vertices, number_array("d", [(0, 0), (1, 0)]))
+        with self.assertRaises(ValueError):
+            draw(surf, texture, vertices, uvs, number_array("i", [(0, 1)]))
+        with self.assertRaises(ValueError):
+            draw(surf, texture, vertices, uvs, number_array("i", [(0, 1, 3)]))
+        with self.assertRaises(ValueError):
+            draw(surf, texture, vertices, uvs, number_array("i", [(0, -1, 2)]))
+        with self.assertRaises(ValueError):
+            draw(surf, texture, vertices, uvs, number_array("d", [(0, 1, 2)]))
+        with self.assertRaises(ValueError):
+            draw(
+                surf,
+                texture,
+                number_array("i", [(0, 0), (5, 0), (0, 5), (5, 5)]),
+                number_array("d", [(0, 0), (1, 0), (0, 1), (1, 1)]),
+            )
+
+        # Flat triangles and zero sized textures draw nothing.
+        surf.fill((1, 2, 3))
+        draw(surf, texture, number_array("i", [(0, 0), (5, 5), (9, 9)]), uvs)
+        draw(surf, pygame.Surface((0, 0)), vertices, uvs)
+        for i in range(10):
+            self.check_at(surf, (i, i), (1, 2, 3, 255))
+
     def test_bezier(self):
         """bezier(surface, points, steps, color): return None"""
         fg = self.foreground_color
@@ -575,6 +575,21 @@ class ImageModuleTest(unittest.TestCase):
                 'symmetric with "{}" format'.format(fmt),
             )
 
+    def test_fromstring_RGB(self):
+        """Ensure fromstring reads "RGB" byte triples, also when flipped."""
+        w, h = 75, 3
+        data = bytes(i % 251 for i in range(w * h * 3))
+
+        for flipped in (False, True):
+            surface = pygame.image.fromstring(data, (w, h), "RGB", flipped)
+            for y in range(h):
+                row = h - 1 - y if flipped else y
+                for x in range(w):
+                    i = (row * w + x) * 3
+                    self.assertEqual(
+                        surface.get_at((x, y)), tuple(data[i : i + 3]) + (255,)
+                    )
+
     def test_tostring_depth_24(self):
         test_surface = pygame.Surface((64, 256), depth=24)
         for i in range(256):
@@ -1,5 +1,8 @@
 from collections import OrderedDict
+import array
 import copy
+import gc
+import math
 import platform
 import random
 import unittest
@@ -8,7 +11,7 @@ import sys
 import pygame
 from pygame.locals import *
 from pygame.math import Vector2
-from pygame.tests.test_utils import AssertRaisesRegexMixin
+from pygame.tests.test_utils import AssertRaisesRegexMixin, number_array
 
 
 IS_PYPY = "PyPy" == platform.python_implementation()
@@ -757,6 +760,63 @@ class MaskTypeTest(AssertRaisesRegexMixin, unittest.TestCase):
         with self.assertRaises(TypeError):
             overlap_pos = mask1.overlap(mask2, offset)
 
+    def test_overlap_many(self):
+        """Ensure overlap_many returns the same hits as calling overlap for
+        each mask.
+        """
+        random.seed(45)
+        mask = random_mask((40, 30))
+        masks = [
+            random_mask((random.randint(1, 30), random.randint(1, 30)))
+            for _ in range(25)
+        ]
+        offsets = [
+            (random.randint(-40, 50), random.randint(-40, 40)) for _ in masks
+        ]
+        expected_hits = []
+
+        for index, (other, offset) in enumerate(zip(masks, offsets)):
+            overlap_pos = mask.overlap(other, offset)
+
+            if overlap_pos is not None:
+                expected_hits.append((index, overlap_pos))
+
+        hits = mask.overlap_many(masks, offsets)
+
+        self.assertEqual(hits, expected_hits)
+        self.assertEqual(mask.overlap_many([], []), [])
+
+    def test_overlap_many__offset_array(self):
+        """Ensure overlap_many accepts an (n, 2) array of offsets."""
+        mask = pygame.mask.Mask((10, 10), fill=True)
+        masks = [pygame.mask.Mask((4, 4), fill=True)] * 3
+        offsets = [(-4, 0), (8, 9), (3, -2)]
+        expected_hits = [(1, (8, 9)), (2, (3, 0))]
+
+        for typecode in ("b", "i", "q", "d"):
+            offset_array = number_array(typecode, offsets)
+
+            hits = mask.overlap_many(masks, offset_array)
+
+            self.assertEqual(hits, expected_hits, typecode)
+
+    def test_overlap_many__invalid_args(self):
+        """Ensure overlap_many handles invalid arguments correctly."""
+        mask = pygame.mask.Mask((5, 5))
+        masks = [pygame.mask.Mask((5, 5))] * 2
+
+        with self.assertRaises(TypeError):
+            mask.overlap_many([mask, pygame.Surface((5, 5))], [(0, 0)] * 2)
+
+        with self.assertRaises(TypeError):
+            mask.overlap_many(masks, [(0, 0), "(0, 0)"])
+
+        with self.assertRaises(ValueError):
+            mask.overlap_many(masks, [(0, 0)])
+
+        with self.assertRaises(ValueError):
+            mask.overlap_many(masks, array.array("i", [0, 0, 0, 0]))
+
     @unittest.skipIf(IS_PYPY, "Segfaults on pypy")
     def test_overlap_area(self):
         """Ensure the overlap_area is correctly calculated.
@@ -890,6 +950,44 @@ class MaskTypeTest(AssertRaisesRegexMixin, unittest.TestCase):
                     self.assertEqual(mask1.get_size(), mask_size, msg)
                     self.assertEqual(mask2.get_size(), mask_size, msg)
 
+    def test_overlap_area__random_bits(self):
+        """Ensures overlap, overlap_area and overlap_mask agree with the set
+        bits of masks with random bits.
+
+        The masks are several mask words wide and tall enough to be
+        compared several rows at a time, with rows left over.
+        """
+        random.seed(43)
+        mask1 = random_mask((150, 23))
+        mask2 = random_mask((131, 13))
+        bits1 = {
+            (x, y) for x in range(150) for y in range(23) if mask1.get_at((x, y))
+        }
+        bits2 = {
+            (x, y) for x in range(131) for y in range(13) if mask2.get_at((x, y))
+        }
+
+        for offset in ((0, 0), (64, 5), (1, 1), (-1, -3), (37, 19), (-100, -2)):
+            msg = "offset={}".format(offset)
+            overlap = {
+                (x + offset[0], y + offset[1])
+                for x, y in bits2
+                if (x + offset[0], y + offset[1]) in bits1
+            }
+
+            self.assertEqual(mask1.overlap_area(mask2, offset), len(overlap), msg)
+            self.assertEqual(
+                mask2.overlap_area(mask1, (-offset[0], -offset[1])),
+                len(overlap),
+                msg,
+            )
+            self.assertIn(mask1.overlap(mask2, offset), overlap, msg)
+
+            overlap_mask = mask1.overlap_mask(mask2, offset)
+            self.assertEqual(overlap_mask.count(), len(overlap), msg)
+            for pos in overlap:
+                self.assertEqual(overlap_mask.get_at(pos), 1, msg)
+
     def test_overlap_area__invalid_mask_arg(self):
         """Ensure overlap_area handles invalid mask arguments correctly."""
         size = (3, 5)
@@ -1335,6 +1433,112 @@ class MaskTypeTest(AssertRaisesRegexMixin, unittest.TestCase):
         with self.assertRaises(ValueError):
             mask.scale((10, -1))
 
+    def test_rotate__quarter_turns(self):
+        """Ensures rotating by multiples of 90 degrees moves the bits
+        exactly.
+        """
+        random.seed(49)
+        width, height = 13, 7
+        mask = random_mask((width, height))
+        expected_positions = {
+            0: lambda x, y: (x, y),
+            90: lambda x, y: (y, width - 1 - x),
+            180: lambda x, y: (width - 1 - x, height - 1 - y),
+            270: lambda x, y: (height - 1 - y, x),
+        }
+
+        for angle in (-270, -180, -90, 0, 90, 180, 270, 360, 450):
+            position = expected_positions[angle % 360]
+            msg = "angle={}".format(angle)
+
+            rotated = mask.rotate(angle)
+
+            self.assertIsInstance(rotated, pygame.mask.Mask, msg)
+            expected_size = (height, width) if angle % 180 else (width, height)
+
+            self.assertEqual(rotated.get_size(), expected_size, msg)
+            self.assertEqual(rotated.count(), mask.count(), msg)
+
+            for x in range(width):
+                for y in range(height):
+                    self.assertEqual(
+                        rotated.get_at(position(x, y)), mask.get_at((x, y)), msg
+                    )
+
+    def test_rotate__size(self):
+        """Ensures rotated masks are the size of rotated surfaces."""
+        width, height = 31, 17
+        mask = pygame.Mask((width, height), fill=True)
+        surface = pygame.Surface((width, height))
+
+        # Fractional angles give sizes close to whole numbers, which have to
+        # be truncated the same way.
+        angles = [1, 10.5, 30, 45, 89, 135, 200, -33]
+        angles += [a / 10.0 for a in range(-3600, 3600, 7)]
+
+        for angle in angles:
+            msg = "angle={}".format(angle)
+
+            rotated = mask.rotate(angle)
+
+            self.assertEqual(
+                rotated.get_size(),
+                pygame.transform.rotate(surface, angle).get_size(),
+                msg,
+            )
+            # Only the bits along the edges can be rounded either way.
+            self.assertAlmostEqual(
+                rotated.count(), width * height, delta=2 * (width + height), msg=msg
+            )
+            self.assertEqual(mask.count(), width * height, msg)
+
+    def test_rotate__empty_mask(self):
+        """Ensures zero sized masks can be rotated."""
+        for size in ((0, 0), (0, 5), (5, 0)):
+            self.assertEqual(pygame.Mask(size).rotate(90).get_size(), size[::-1])
+            self.assertEqual(pygame.Mask(size).rotate(45).count(), 0)
+
+    def test_transform(self):
+        """Ensures masks can be rotated and scaled at once."""
+        random.seed(49)
+        mask = random_mask((10, 10))
+
+        scaled = mask.transform(0, 2)
+
+        self.assertEqual(scaled.get_size(), (20, 20))
+
+        for x in range(20):
+            for y in range(20):
+                self.assertEqual(
+                    scaled.get_at((x, y)), mask.get_at((x // 2, y // 2))
+                )
+
+        rotated = pygame.Mask((20, 10), fill=True).transform(angle=90, scale=0.5)
+
+        self.assertEqual(rotated.get_size(), (5, 10))
+        self.assertEqual(rotated.count(), 50)
+
+        assertMaskEqual(self, mask.transform(33, 1), mask.rotate(33))
+        self.assertEqual(mask.transform(45, 0).get_size(), (0, 0))
+        self.assertEqual(mask.transform(45, 1e-12).get_size(), (0, 0))
+
+    def test_transform__invalid_args(self):
+        """Ensures invalid angles and scales are rejected."""
+        mask = pygame.Mask((10, 10), fill=True)
+
+        for angle, scale in (
+            (float("nan"), 1),
+            (float("inf"), 1),
+            (0, -1),
+            (0, float("nan")),
+            (0, 1e12),
+        ):
+            with self.assertRaises(ValueError):
+                mask.transform(angle, scale)
+
+        with self.assertRaises(TypeError):
+            mask.rotate("90")
+
     def test_draw(self):
         """Ensure a mask can be drawn onto another mask.
 
@@ -2062,6 +2266,136 @@ class MaskTypeTest(AssertRaisesRegexMixin, unittest.TestCase):
                     conv.get_at((i, j)) == 0, m1.overlap(m2, (i - 99, j - 99)) is None
                 )
 
+    def _circle_mask(self, radius):
+        """Returns a mask with a circle of the given radius set in it."""
+        circle = pygame.mask.Mask((2 * radius + 1, 2 * radius + 1))
+
+        for y in range(-radius, radius + 1):
+            for x in range(-radius, radius + 1):
+                if x * x + y * y <= radius * radius:
+                    circle.set_at((x + radius, y + radius))
+
+        return circle
+
+    def test_dilate(self):
+        """Ensures dilate matches convolving with a circle."""
+        random.seed(46)
+        mask = random_mask((150, 20))
+        mask.erase(random_mask((150, 20)), (0, 0))
+        original = mask.copy()
+
+        for radius in (0, 1, 2, 5, 11):
+            circle = self._circle_mask(radius)
+            expected_mask = mask.convolve(
+                circle, pygame.mask.Mask(mask.get_size()), (-radius, -radius)
+            )
+
+            dilated = mask.dilate(radius)
+
+            self.assertIsInstance(dilated, pygame.mask.Mask)
+            assertMaskEqual(self, dilated, expected_mask, radius)
+
+        assertMaskEqual(self, mask, original)
+
+    def test_erode(self):
+        """Ensures erode only keeps the bits with a circle of set bits around
+        them.
+        """
+        random.seed(46)
+        mask = random_mask((70, 15))
+        mask.draw(random_mask((70, 15)), (0, 0))
+        mask.draw(random_mask((70, 15)), (0, 0))
+        mask_rect = mask.get_rect()
+
+        for radius in (0, 1, 2, 4):
+            circle = self._circle_mask(radius)
+            bit_count = circle.count()
+            expected_mask = pygame.mask.Mask(mask.get_size())
+
+            for y in range(mask.get_size()[1]):
+                for x in range(mask.get_size()[0]):
+                    circle_rect = circle.get_rect(topleft=(x - radius, y - radius))
+
+                    if mask_rect.contains(circle_rect) and (
+                        mask.overlap_area(circle, circle_rect.topleft) == bit_count
+                    ):
+                        expected_mask.set_at((x, y))
+
+            eroded = mask.erode(radius)
+
+            assertMaskEqual(self, eroded, expected_mask, radius)
+
+    def test_open_and_close(self):
+        """Ensures open and close combine erode and dilate."""
+        random.seed(46)
+        mask = random_mask((90, 25))
+        radius = 3
+        padded = pygame.mask.Mask((96, 31))
+        padded.draw(mask, (radius, radius))
+        expected_close = pygame.mask.Mask(mask.get_size())
+        expected_close.draw(padded.dilate(radius).erode(radius), (-radius, -radius))
+
+        opened = mask.open(radius)
+        closed = mask.close(radius)
+
+        assertMaskEqual(self, opened, mask.erode(radius).dilate(radius))
+        assertMaskEqual(self, closed, expected_close)
+        self.assertEqual(mask.overlap_area(opened, (0, 0)), opened.count())
+        self.assertEqual(mask.overlap_area(closed, (0, 0)), mask.count())
+
+    def test_morphology__zero_size(self):
+        """Ensures the morphological operations work on zero sized masks."""
+        for size in zero_size_pairs(20, 20):
+            mask = pygame.mask.Mask(size)
+
+            for method in (mask.dilate, mask.erode, mask.open, mask.close):
+                self.assertEqual(method(2).get_size(), size)
+
+    def test_morphology__invalid_radius(self):
+        """Ensures the morphological operations detect invalid radii."""
+        mask = pygame.mask.Mask((10, 10))
+
+        for method in (mask.dilate, mask.erode, mask.open, mask.close):
+            with self.assertRaises(ValueError):
+                method(-1)
+
+            with self.assertRaises(TypeError):
+                method("1")
+
+    def test_distance_transform(self):
+        """Ensures distance_transform returns the distance to the nearest
+        unset bit.
+        """
+        random.seed(46)
+        width, height = 75, 9
+        mask = pygame.mask.Mask((width, height), fill=True)
+        mask.erase(random_mask((width, height)), (0, 0))
+        mask.erase(random_mask((width, height)), (0, 0))
+        unset_bits = [
+            (x, y)
+            for x in range(width)
+            for y in range(height)
+            if not mask.get_at((x, y))
+        ]
+
+        distances = mask.distance_transform()
+
+        self.assertEqual(distances.shape, (width, height))
+        self.assertEqual(distances.format, "f")
+        for x in range(width):
+            for y in range(height):
+                expected_distance = min(
+                    math.hypot(x - ux, y - uy) for ux, uy in unset_bits
+                )
+                self.assertAlmostEqual(distances[x, y], expected_distance, 5)
+
+    def test_distance_transform__no_unset_bits(self):
+        """Ensures distance_transform handles masks without unset bits."""
+        distances = pygame.mask.Mask((3, 2), fill=True).distance_transform()
+
+        self.assertEqual(distances.tolist(), [[float("inf")] * 2] * 3)
+        self.assertEqual(len(pygame.mask.Mask((0, 4)).distance_transform()), 0)
+
     def _draw_component_pattern_box(self, mask, size, pos, inverse=False):
         # Helper method to create/draw a 'box' pattern for testing.
         #
@@ -2449,6 +2783,96 @@ class MaskTypeTest(AssertRaisesRegexMixin, unittest.TestCase):
         self.assertEqual(mask.count(), mask_count)
         self.assertEqual(mask.get_size(), mask_size)
 
+    def test_connected_component__largest_of_random_bits(self):
+        """Ensures connected_component() returns the largest component of
+        masks with random bits.
+        """
+        random.seed(47)
+
+        for size in ((1, 30), (40, 20), (100, 7)):
+            mask = random_mask(size)
+
+            largest = mask.connected_component()
+
+            self.assertEqual(
+                largest.count(),
+                max(comp.count() for comp in mask.connected_components()),
+            )
+            self.assertEqual(largest.overlap_area(mask, (0, 0)), largest.count())
+
+    def test_connected_component__one_bit_wide(self):
+        """Ensures connected_component() works on masks one bit wide."""
+        mask = pygame.mask.Mask((1, 8))
+        for y in (0, 2, 3, 4, 7):
+            mask.set_at((0, y))
+        expected_mask = pygame.mask.Mask((1, 8))
+        for y in (2, 3, 4):
+            expected_mask.set_at((0, y))
+
+        assertMaskEqual(self, mask.connected_component(), expected_mask)
+        self.assertEqual(len(mask.connected_components()), 3)
+
+    def test_label_connected_components(self):
+        """Ensures label_connected_components() matches the masks returned by
+        connected_components().
+        """
+        random.seed(47)
+        width, height = 90, 15
+        mask = random_mask((width, height))
+        mask.erase(random_mask((width, height)), (0, 0))
+        comps = mask.connected_components()
+
+        labels, stats = mask.label_connected_components()
+
+        self.assertEqual(labels.shape, (width, height))
+        self.assertEqual(labels.format, "I")
+        self.assertEqual(len(stats), len(comps))
+
+        for label, (comp, stat) in enumerate(zip(comps, stats), 1):
+            area, rect, centroid = stat
+
+            self.assertEqual(area, comp.count())
+            self.assertEqual(rect, comp.get_bounding_rects()[0])
+            self.assertEqual(centroid, comp.centroid())
+
+        for x in range(width):
+            for y in range(height):
+                label = labels[x, y]
+
+                if mask.get_at((x, y)):
+                    self.assertTrue(comps[label - 1].get_at((x, y)))
+                else:
+                    self.assertEqual(label, 0)
+
+    def test_label_connected_components__minimum(self):
+        """Ensures label_connected_components() leaves the components smaller
+        than minimum unlabelled.
+        """
+        mask = pygame.mask.Mask((10, 5))
+        mask.set_at((0, 0))
+        mask.draw(pygame.mask.Mask((3, 3), fill=True), (4, 1))
+        mask.set_at((9, 4))
+
+        labels, stats = mask.label_connected_components(minimum=2)
+
+        self.assertEqual(stats, [(9, pygame.Rect(4, 1, 3, 3), (5, 2))])
+        self.assertEqual(labels[0, 0], 0)
+        self.assertEqual(labels[5, 2], 1)
+        self.assertEqual(labels[9, 4], 0)
+
+    def test_label_connected_components__empty_masks(self):
+        """Ensures label_connected_components() handles masks without set
+        bits.
+        """
+        for size in ((0, 0), (0, 5), (7, 3)):
+            mask = pygame.mask.Mask(size)
+
+            labels, stats = mask.label_connected_components()
+
+            self.assertEqual(stats, [])
+            self.assertEqual(len(labels.tobytes()), 0 if 0 in size else 84)
+            self.assertEqual(labels.tobytes().count(0), len(labels.tobytes()))
+
     @unittest.skipIf(IS_PYPY, "Segfaults on pypy")
     def test_get_bounding_rects(self):
         """Ensures get_bounding_rects works correctly."""
@@ -5320,6 +5744,62 @@ class MaskTypeTest(AssertRaisesRegexMixin, unittest.TestCase):
         self.assertEqual(to_surface.get_size(), mask_size)
         assertSurfaceFilled(self, to_surface, expected_color)
 
+    def test_to_surface__random_bits(self):
+        """Ensures random bits are drawn correctly when setsurface and
+        unsetsurface only cover part of the mask.
+
+        Uses a width that is not a multiple of 4 or 32 and a negative x dest,
+        so the bits are not read from the start of a word.
+        """
+        random.seed(50)
+        mask = random_mask((70, 6))
+        dest = (-3, 1)
+        original_color = pygame.Color("red")
+        setsurface_color = pygame.Color("green")
+        unsetsurface_color = pygame.Color("blue")
+        setcolor = pygame.Color("yellow")
+        unsetcolor = pygame.Color("cyan")
+        surface = pygame.Surface((80, 8), SRCALPHA, 32)
+        setsurface = pygame.Surface((41, 8), SRCALPHA, 32)
+        unsetsurface = pygame.Surface((75, 4), SRCALPHA, 32)
+        surface.fill(original_color)
+        setsurface.fill(setsurface_color)
+        unsetsurface.fill(unsetsurface_color)
+
+        for draw_unset in (True, False):
+            to_surface = mask.to_surface(
+                surface.copy(),
+                setsurface,
+                unsetsurface,
+                setcolor,
+                unsetcolor if draw_unset else None,
+                dest,
+            )
+
+            for x in range(surface.get_width()):
+                for y in range(surface.get_height()):
+                    mx, my = x - dest[0], y - dest[1]
+
+                    if not (0 <= mx < 70 and 0 <= my < 6):
+                        expected_color = original_color
+                    elif mask.get_at((mx, my)):
+                        if mx < 41:
+                            expected_color = setsurface_color
+                        else:
+                            expected_color = setcolor
+                    elif mx < 75 and my < 4:
+                        expected_color = unsetsurface_color
+                    elif draw_unset:
+                        expected_color = unsetcolor
+                    else:
+                        expected_color = original_color
+
+                    self.assertEqual(
+                        to_surface.get_at((x, y)),
+                        expected_color,
+                        "pos={}, draw_unset={}".format((x, y), draw_unset),
+                    )
+
     def test_zero_mask(self):
         """Ensures masks can be created with zero sizes."""
         for size in ((100, 0), (0, 100), (0, 0)):
@@ -6061,6 +6541,423 @@ class MaskSubclassTest(unittest.TestCase):
         assertSurfaceFilled(self, to_surface, expected_color)
 
 
+class CollisionWorldTest(unittest.TestCase):
+    def _overlapping_pairs(self, sprites):
+        """Returns the set of pairs of overlapping sprites found with
+        Mask.overlap().
+        """
+        keys = sorted(sprites)
+        pairs = set()
+
+        for i, key1 in enumerate(keys):
+            mask1, (x1, y1) = sprites[key1]
+
+            for key2 in keys[i + 1 :]:
+                mask2, (x2, y2) = sprites[key2]
+
+                if mask1.overlap(mask2, (x2 - x1, y2 - y1)) is not None:
+                    pairs.add((key1, key2))
+
+        return pairs
+
+    def test_add(self):
+        """Ensures masks can be added to a world."""
+        world = pygame.mask.CollisionWorld()
+        mask = pygame.Mask((5, 5), fill=True)
+
+        world.add("a", mask, (0, 0))
+        world.add("b", mask, Vector2(3, 3))
+
+        self.assertEqual(len(world), 2)
+        self.assertIn("a", world)
+        self.assertIn("b", world)
+        self.assertNotIn("c", world)
+
+    def test_add__existing_key(self):
+        """Ensures adding an existing key replaces its mask and offset."""
+        world = pygame.mask.CollisionWorld()
+        world.add("a", pygame.Mask((5, 5), fill=True), (0, 0))
+        world.add("b", pygame.Mask((5, 5), fill=True), (3, 3))
+
+        world.add("b", pygame.Mask((2, 2), fill=True), (5, 5))
+
+        self.assertEqual(len(world), 2)
+        self.assertEqual(world.query_pairs(), [])
+
+    def test_add__invalid_args(self):
+        """Ensures add() detects invalid arguments."""
+        world = pygame.mask.CollisionWorld()
+        mask = pygame.Mask((5, 5))
+
+        with self.assertRaises(TypeError):
+            world.add("a", mask, (0, "0"))
+
+        with self.assertRaises(TypeError):
+            world.add("a", "mask", (0, 0))
+
+        with self.assertRaises(TypeError):
+            world.add([], mask, (0, 0))
+
+        self.assertEqual(len(world), 0)
+
+    def test_move(self):
+        """Ensures masks can be moved in and out of collisions."""
+        world = pygame.mask.CollisionWorld()
+        mask = pygame.Mask((5, 5), fill=True)
+        world.add("a", mask, (0, 0))
+        world.add("b", mask, (10, 0))
+
+        self.assertEqual(world.query_pairs(), [])
+
+        world.move("b", (4, 4))
+
+        self.assertEqual(sorted(world.query_pairs()[0]), ["a", "b"])
+
+        world.move("a", (-1, -1))
+
+        self.assertEqual(world.query_pairs(), [])
+
+    def test_move__missing_key(self):
+        """Ensures move() raises a KeyError for keys not in the world."""
+        world = pygame.mask.CollisionWorld()
+
+        with self.assertRaises(KeyError):
+            world.move("a", (0, 0))
+
+    def test_remove(self):
+        """Ensures removed masks are no longer found."""
+        world = pygame.mask.CollisionWorld()
+        mask = pygame.Mask((5, 5), fill=True)
+        world.add("a", mask, (0, 0))
+        world.add("b", mask, (1, 1))
+        world.query_pairs()
+
+        world.remove("a")
+
+        self.assertEqual(len(world), 1)
+        self.assertNotIn("a", world)
+        self.assertEqual(world.query_pairs(), [])
+        self.assertEqual(world.query(mask, (0, 0)), ["b"])
+
+        with self.assertRaises(KeyError):
+            world.remove("a")
+
+    def test_clear(self):
+        """Ensures clear() removes all masks."""
+        world = pygame.mask.CollisionWorld()
+        mask = pygame.Mask((5, 5), fill=True)
+        world.add("a", mask, (0, 0))
+        world.add("b", mask, (1, 1))
+
+        world.clear()
+
+        self.assertEqual(len(world), 0)
+        self.assertEqual(world.query_pairs(), [])
+
+        world.add("c", mask, (0, 0))
+
+        self.assertEqual(world.query(mask, (4, 4)), ["c"])
+
+    def test_query(self):
+        """Ensures query() returns the keys of the overlapping masks."""
+        world = pygame.mask.CollisionWorld()
+        mask = pygame.Mask((10, 10), fill=True)
+        world.add(1, mask, (0, 0))
+        world.add(2, mask, (20, 0))
+        world.add(3, pygame.Mask((10, 10)), (5, 5))
+
+        row = pygame.Mask((30, 1), fill=True)
+
+        self.assertEqual(world.query(mask, (5, 5)), [1])
+        self.assertEqual(sorted(world.query(row, (0, 9))), [1, 2])
+        self.assertEqual(world.query(mask, (10, 10)), [])
+
+    def test_query_pairs__point_and_area(self):
+        """Ensures query_pairs() returns the point and area of the overlaps."""
+        world = pygame.mask.CollisionWorld()
+        mask1 = pygame.Mask((10, 10), fill=True)
+        mask2 = pygame.Mask((4, 4), fill=True)
+        world.add("a", mask1, (100, 50))
+        world.add("b", mask2, (108, 57))
+        expected_area = mask1.overlap_area(mask2, (8, 7))
+
+        pairs = world.query_pairs(point=True, area=True)
+
+        self.assertEqual(len(pairs), 1)
+        key1, key2, point, area = pairs[0]
+        self.assertEqual(sorted((key1, key2)), ["a", "b"])
+        self.assertEqual(point, (108, 57))
+        self.assertEqual(area, expected_area)
+        self.assertEqual(world.query_pairs(area=True)[0][2], expected_area)
+        self.assertEqual(world.query_pairs(point=True)[0][2], point)
+
+    def test_query_pairs__random_sprites(self):
+        """Ensures query_pairs() finds the same pairs as Mask.overlap() while
+        masks are added, moved and removed.
+        """
+        random.seed(44)
+        world = pygame.mask.CollisionWorld()
+        masks = [
+            random_mask((random.randint(1, 30), random.randint(1, 30)))
+            for _ in range(8)
+        ]
+        sprites = {}
+
+        for _ in range(10):
+            for _ in range(30):
+                key = random.randrange(60)
+
+                if key in sprites and random.random() < 0.2:
+                    world.remove(key)
+                    del sprites[key]
+                elif key in sprites and random.random() < 0.5:
+                    x, y = sprites[key][1]
+                    offset = (
+                        x + random.randint(-3, 3),
+                        y + random.randint(-3, 3),
+                    )
+                    world.move(key, offset)
+                    sprites[key] = (sprites[key][0], offset)
+                else:
+                    mask = random.choice(masks)
+                    offset = (
+                        random.randint(-20, 150),
+                        random.randint(-20, 150),
+                    )
+                    world.add(key, mask, offset)
+                    sprites[key] = (mask, offset)
+
+            pairs = world.query_pairs()
+            found = set(tuple(sorted(pair)) for pair in pairs)
+
+            self.assertEqual(len(pairs), len(found))
+            self.assertEqual(found, self._overlapping_pairs(sprites))
+            self.assertEqual(len(world), len(sprites))
+
+    def test_keys_changing_world(self):
+        """Ensures keys whose __hash__ adds or removes entries while they
+        are added or removed leave the world consistent.
+        """
+        world = pygame.mask.CollisionWorld()
+        mask = pygame.Mask((4, 4), fill=True)
+
+        class Key(object):
+            def __init__(self, *actions):
+                self.actions = list(actions)
+
+            def __hash__(self):
+                if self.actions:
+                    self.actions.pop(0)()
+                return 7
+
+        def nothing():
+            pass
+
+        def add_many():
+            for i in range(100):
+                world.add(("added", i), mask, (i, 0))
+
+        def remove_many():
+            for i in range(100):
+                world.remove(("added", i))
+
+        # The key is hashed once to look it up, then again to store it.
+        world.add(Key(nothing, add_many), mask, (0, 0))
+        found = world.query(pygame.Mask((200, 4), fill=True), (0, 0))
+
+        self.assertEqual(len(world), 101)
+        self.assertEqual(len(found), 101)
+
+        key = Key()
+        world.add(key, mask, (2, 0))
+        key.actions = [nothing, remove_many]
+        world.remove(key)
+
+        self.assertEqual(len(world), 1)
+        self.assertEqual(world.query_pairs(), [])
+
+    @unittest.skipIf(IS_PYPY, "relies on CPython garbage collection")
+    def test_query_pairs__finalizer_changing_world(self):
+        """Ensures a finalizer that changes the world while query_pairs()
+        builds its results does not affect them.
+        """
+        world = pygame.mask.CollisionWorld()
+        mask = pygame.Mask((8, 8), fill=True)
+        for i in range(200):
+            world.add(i, mask, (i % 20, i // 20))
+        expected = world.query_pairs()
+
+        class Cycle(object):
+            def __del__(self):
+                world.clear()
+
+        threshold = gc.get_threshold()
+        gc.set_threshold(1)
+        try:
+            cycle = Cycle()
+            cycle.cycle = cycle
+            del cycle
+            pairs = world.query_pairs()
+        finally:
+            gc.set_threshold(*threshold)
+
+        self.assertEqual(pairs, expected)
+
+
+class SparseMaskTest(unittest.TestCase):
+    TILE_SIZE = 256
+
+    def test_sparse_mask(self):
+        """Ensures a sparse mask can be created."""
+        for size, fill, expected_count in (
+            ((0, 0), False, 0),
+            ((300, 10), False, 0),
+            ((300, 10), True, 3000),
+            ((600, 700), True, 420000),
+        ):
+            sparse = pygame.mask.SparseMask(size, fill=fill)
+
+            self.assertIsInstance(sparse, pygame.mask.SparseMask)
+            self.assertEqual(sparse.get_size(), size)
+            self.assertEqual(sparse.count(), expected_count)
+            self.assertEqual(sparse.get_tile_count(), 0)
+
+    def test_sparse_mask__huge_size(self):
+        """Ensures huge sparse masks only allocate the tiles in use."""
+        sparse = pygame.mask.SparseMask((100000, 100000))
+        mask = pygame.Mask((10, 10), fill=True)
+
+        sparse.draw(mask, (50000, 50000))
+        sparse.draw(mask, (99995, 99995))
+
+        self.assertEqual(sparse.count(), 125)
+        self.assertEqual(sparse.get_tile_count(), 2)
+        self.assertEqual(sparse.get_at((99999, 99999)), 1)
+        self.assertEqual(sparse.overlap(mask, (50005, 50005)), (50005, 50005))
+        self.assertIsNone(sparse.overlap(mask, (0, 0)))
+
+    def test_sparse_mask__invalid_args(self):
+        """Ensures invalid sizes and positions are rejected."""
+        with self.assertRaises(ValueError):
+            pygame.mask.SparseMask((-1, 5))
+
+        with self.assertRaises(TypeError):
+            pygame.mask.SparseMask("ab")
+
+        sparse = pygame.mask.SparseMask((10, 10))
+
+        for pos in ((-1, 0), (0, 10), (10, 0)):
+            with self.assertRaises(IndexError):
+                sparse.get_at(pos)
+
+            with self.assertRaises(IndexError):
+                sparse.set_at(pos)
+
+        with self.assertRaises(TypeError):
+            sparse.draw(pygame.mask.SparseMask((2, 2)), (0, 0))
+
+    def test_set_at(self):
+        """Ensures bits can be set and cleared one at a time."""
+        sparse = pygame.mask.SparseMask((300, 300))
+
+        sparse.set_at((299, 0))
+        sparse.set_at((5, 260), 1)
+        sparse.set_at((5, 260), 0)
+
+        self.assertEqual(sparse.get_at((299, 0)), 1)
+        self.assertEqual(sparse.get_at((5, 260)), 0)
+        self.assertEqual(sparse.count(), 1)
+        self.assertEqual(sparse.get_tile_count(), 1)
+
+    def test_full_and_empty_tiles(self):
+        """Ensures full tiles are shared and empty tiles are freed."""
+        size = (self.TILE_SIZE * 2 + 10, self.TILE_SIZE + 5)
+        sparse = pygame.mask.SparseMask(size)
+        mask = pygame.Mask(size, fill=True)
+
+        sparse.draw(mask, (0, 0))
+
+        self.assertEqual(sparse.count(), size[0] * size[1])
+        self.assertEqual(sparse.get_tile_count(), 0)
+
+        sparse.set_at((1, 1), 0)
+
+        self.assertEqual(sparse.count(), size[0] * size[1] - 1)
+        self.assertEqual(sparse.get_tile_count(), 1)
+
+        sparse.erase(mask, (0, 0))
+
+        self.assertEqual(sparse.count(), 0)
+        self.assertEqual(sparse.get_tile_count(), 0)
+
+        sparse.fill()
+        sparse.erase(pygame.Mask((3, 3), fill=True), (self.TILE_SIZE - 1, 0))
+
+        self.assertEqual(sparse.count(), size[0] * size[1] - 9)
+        self.assertEqual(sparse.get_tile_count(), 2)
+
+        sparse.clear()
+
+        self.assertEqual(sparse.count(), 0)
+        self.assertEqual(sparse.get_tile_count(), 0)
+
+    def test_draw_and_erase__random(self):
+        """Ensures a sparse mask matches a Mask drawn and erased the same
+        way, across tile boundaries.
+        """
+        random.seed(48)
+        width, height = self.TILE_SIZE * 2 + 30, self.TILE_SIZE + 40
+        sparse = pygame.mask.SparseMask((width, height))
+        expected = pygame.Mask((width, height))
+        masks = []
+
+        for _ in range(8):
+            mask_w, mask_h = random.randint(1, 300), random.randint(1, 300)
+            mask = pygame.Mask((mask_w, mask_h))
+
+            for _ in range(random.randrange(2000)):
+                mask.set_at((random.randrange(mask_w), random.randrange(mask_h)))
+
+            masks.append(mask)
+
+        masks.append(pygame.Mask((300, 300), fill=True))
+
+        for _ in range(60):
+            mask = random.choice(masks)
+            offset = (random.randint(-200, width), random.randint(-200, height))
+
+            if random.random() < 0.6:
+                sparse.draw(mask, offset)
+                expected.draw(mask, offset)
+            else:
+                sparse.erase(mask, offset)
+                expected.erase(mask, offset)
+
+            probe = random.choice(masks)
+            offset = (random.randint(-200, width), random.randint(-200, height))
+            point = sparse.overlap(probe, offset)
+
+            self.assertEqual(sparse.count(), expected.count())
+            self.assertEqual(
+                sparse.overlap_area(probe, offset),
+                expected.overlap_area(probe, offset),
+            )
+            self.assertEqual(
+                point is None, expected.overlap(probe, offset) is None
+            )
+
+            if point is not None:
+                self.assertEqual(expected.get_at(point), 1)
+                self.assertEqual(
+                    probe.get_at((point[0] - offset[0], point[1] - offset[1])),
+                    1,
+                )
+
+        for x in range(0, width, 7):
+            for y in range(0, height, 5):
+                self.assertEqual(sparse.get_at((x, y)), expected.get_at((x, y)))
+
+
 @unittest.skipIf(IS_PYPY, "pypy has lots of mask failures")  # TODO
 class MaskModuleTest(unittest.TestCase):
     def test_from_surface(self):
@@ -6237,6 +7134,40 @@ class MaskModuleTest(unittest.TestCase):
                     mask.overlap_area(expected_mask, offset), expected_count, msg
                 )
 
+    def test_from_surface__random_pixels(self):
+        """Ensures from_surface sets the bits of random pixels correctly
+        for widths that do not fill whole mask words.
+
+        32 bit surfaces are checked several pixels at a time, with any
+        pixels left over at the end of each row checked one at a time.
+        """
+        random.seed(42)
+        formats = ((SRCALPHA, 32), (0, 32), (SRCALPHA, 16), (0, 24))
+
+        for width in (1, 15, 16, 17, 63, 64, 65, 100, 129):
+            for flags, depth in formats:
+                surface = pygame.Surface((width, 3), flags, depth)
+                for y in range(3):
+                    for x in range(width):
+                        surface.set_at((x, y), [random.randint(0, 255)] * 4)
+                msg = "width={}, depth={}, flags={}".format(width, depth, flags)
+
+                for threshold in (0, 127, 254, 255):
+                    assertMaskEqual(
+                        self,
+                        pygame.mask.from_surface(surface, threshold),
+                        maskFromSurface(surface, threshold),
+                        msg,
+                    )
+
+                surface.set_colorkey(surface.get_at((0, 0)))
+                assertMaskEqual(
+                    self,
+                    pygame.mask.from_surface(surface),
+                    maskFromSurface(surface),
+                    msg,
+                )
+
     def test_from_surface__with_colorkey_mask_cleared(self):
         """Ensures from_surface creates a mask with the correct bits set
         when the surface uses a colorkey.
@@ -6364,6 +7295,80 @@ class MaskModuleTest(unittest.TestCase):
             self.assertEqual(mask.count(), 100)
             self.assertEqual(mask.get_bounding_rects(), [pygame.Rect((40, 40, 10, 10))])
 
+    def test_from_threshold__random_pixels(self):
+        """Ensures from_threshold sets the bits of random pixels correctly
+        for widths that do not fill whole mask words.
+
+        Only surfaces with 8 bit channels are checked, so the channels
+        get_at returns are the ones compared.
+        """
+        random.seed(42)
+        threshold = (40, 60, 80, 255)
+
+        def within(color1, color2):
+            return all(abs(color1[i] - color2[i]) < threshold[i] for i in range(3))
+
+        for width in (1, 15, 16, 17, 63, 64, 65, 100, 129):
+            for depth in (24, 32):
+                surface = pygame.Surface((width, 3), 0, depth)
+                othersurface = pygame.Surface((width, 3), 0, depth)
+                for y in range(3):
+                    for x in range(width):
+                        color = [random.randint(0, 255) for i in range(3)]
+                        surface.set_at((x, y), color)
+                        color[random.randint(0, 2)] ^= random.choice((15, 31, 63))
+                        othersurface.set_at((x, y), color)
+                color = surface.get_at((width // 2, 1))
+                msg = "width={}, depth={}".format(width, depth)
+
+                mask = pygame.mask.from_threshold(surface, color, threshold)
+                mask2 = pygame.mask.from_threshold(
+                    surface, (0, 0, 0), threshold, othersurface
+                )
+
+                for y in range(3):
+                    for x in range(width):
+                        pixel = surface.get_at((x, y))
+                        self.assertEqual(
+                            mask.get_at((x, y)), within(pixel, color), msg
+                        )
+                        self.assertEqual(
+                            mask2.get_at((x, y)),
+                            within(pixel, othersurface.get_at((x, y))),
+                            msg,
+                        )
+
+    def test_rotation_cache(self):
+        """Ensures rotation_cache returns the mask rotated by evenly spaced
+        angles.
+        """
+        random.seed(49)
+        mask = random_mask((21, 12))
+
+        for steps, scale in ((1, 1.0), (8, 1.0), (36, 1.0), (12, 1.5)):
+            masks = pygame.mask.rotation_cache(mask, steps, scale=scale)
+
+            self.assertEqual(len(masks), steps)
+
+            for i, rotated in enumerate(masks):
+                assertMaskEqual(
+                    self, rotated, mask.transform(360.0 * i / steps, scale)
+                )
+
+    def test_rotation_cache__invalid_args(self):
+        """Ensures rotation_cache rejects invalid steps and scales."""
+        mask = pygame.Mask((5, 5))
+
+        for steps in (0, -1):
+            with self.assertRaises(ValueError):
+                pygame.mask.rotation_cache(mask, steps)
+
+        with self.assertRaises(ValueError):
+            pygame.mask.rotation_cache(mask, 4, -2.0)
+
+        with self.assertRaises(TypeError):
+            pygame.mask.rotation_cache(pygame.Surface((5, 5)), 4)
+
     def test_zero_size_from_surface(self):
         """Ensures from_surface can create masks from zero sized surfaces."""
         for size in ((100, 0), (0, 100), (0, 0)):
@@ -490,6 +490,24 @@ class SurfaceTypeTest(AssertRaisesRegexMixin, unittest.TestCase):
 
         self.assertEqual(s1.get_flags(), pygame.SRCALPHA)
 
+    def test_get_flags__premultiplied(self):
+        """Ensure the PREMULTIPLIED flag is kept and reported."""
+        s1 = pygame.Surface((32, 32), pygame.SRCALPHA | pygame.PREMULTIPLIED, 32)
+
+        self.assertEqual(s1.get_flags(), pygame.SRCALPHA | pygame.PREMULTIPLIED)
+        self.assertTrue(s1.copy().get_flags() & pygame.PREMULTIPLIED)
+        self.assertTrue(s1.convert_alpha(s1).get_flags() & pygame.PREMULTIPLIED)
+        self.assertTrue(
+            s1.subsurface((0, 0, 8, 8)).get_flags() & pygame.PREMULTIPLIED
+        )
+        self.assertFalse(
+            pygame.Surface((32, 32), pygame.SRCALPHA).get_flags()
+            & pygame.PREMULTIPLIED
+        )
+
+        with self.assertRaises(ValueError):
+            pygame.Surface((32, 32), pygame.PREMULTIPLIED, 24)
+
     @unittest.skipIf(
         os.environ.get("SDL_VIDEODRIVER") == "dummy",
         'requires a non-"dummy" SDL_VIDEODRIVER',
@@ -1648,6 +1666,86 @@ class GeneralSurfaceTests(AssertRaisesRegexMixin, unittest.TestCase):
         finally:
             pygame.display.quit()
 
+    def test_convert__pixel_values(self):
+        """Ensure convert keeps the colors between common formats."""
+        size = (67, 5)
+        sources = [
+            pygame.Surface(size, 0, 8),
+            pygame.Surface(size, 0, 16),
+            pygame.Surface(size, 0, 24),
+            pygame.Surface(size, 0, 32),
+            pygame.Surface(size, SRCALPHA, 16),
+            pygame.Surface(size, SRCALPHA, 32),
+            pygame.Surface(size, SRCALPHA, 32, (0xFF, 0xFF00, 0xFF0000, 0xFF000000)),
+        ]
+        targets = [
+            (0xFF0000, 0xFF00, 0xFF, 0xFF000000),
+            (0xFF, 0xFF00, 0xFF0000, 0xFF000000),
+            (0xFF00, 0xFF0000, 0xFF000000, 0xFF),
+            (0xFF0000, 0xFF00, 0xFF, 0),
+        ]
+
+        pygame.display.init()
+        try:
+            for source in sources:
+                for x in range(size[0]):
+                    for y in range(size[1]):
+                        source.set_at(
+                            (x, y), (x * 3, y * 50, 255 - x * 3, 128 + x + y)
+                        )
+                for masks in targets:
+                    surface = source.convert(masks)
+                    self.assertEqual(surface.get_masks(), masks)
+                    for x in range(size[0]):
+                        for y in range(size[1]):
+                            color = source.get_at((x, y))
+                            if not masks[3]:
+                                color.a = 255
+                            self.assertEqual(surface.get_at((x, y)), color)
+        finally:
+            pygame.display.quit()
+
+    def test_premul_alpha(self):
+        """Ensure surf.premul_alpha multiplies colors by alpha"""
+        colors = [
+            (0, 0, 0, 0),
+            (255, 255, 255, 0),
+            (255, 255, 255, 255),
+            (200, 100, 50, 128),
+            (49, 67, 73, 199),
+            (1, 254, 128, 1),
+        ]
+        for masks in (
+            (0xFF0000, 0xFF00, 0xFF, 0xFF000000),
+            (0xFF, 0xFF00, 0xFF0000, 0xFF000000),
+            (0xFF000000, 0xFF0000, 0xFF00, 0xFF),
+        ):
+            source = pygame.Surface((len(colors), 3), 0, 32, masks)
+            for x, color in enumerate(colors):
+                for y in range(3):
+                    source.set_at((x, y), color)
+
+            result = source.premul_alpha()
+
+            self.assertEqual(result.get_size(), source.get_size())
+            self.assertEqual(result.get_masks(), source.get_masks())
+            self.assertTrue(result.get_flags() & pygame.PREMULTIPLIED)
+            self.assertFalse(source.get_flags() & pygame.PREMULTIPLIED)
+            for x, color in enumerate(colors):
+                for y in range(3):
+                    self.assertEqual(
+                        result.get_at((x, y)), pygame.Color(color).premul_alpha()
+                    )
+                    self.assertEqual(source.get_at((x, y)), color)
+
+            # already premultiplied surfaces are copied unchanged
+            again = result.premul_alpha()
+            for x in range(len(colors)):
+                self.assertEqual(again.get_at((x, 0)), result.get_at((x, 0)))
+
+        with self.assertRaises(ValueError):
+            pygame.Surface((4, 4), 0, 24).premul_alpha()
+
     def test_convert_alpha(self):
         """Ensure the surface returned by surf.convert_alpha
         has alpha values added"""
@@ -2572,6 +2670,33 @@ class GeneralSurfaceTests(AssertRaisesRegexMixin, unittest.TestCase):
         surf.scroll(dx=-3, dy=-3)
         self.assertEqual(surf.get_at((0, 0)), spot_color)
 
+    def test_flip_ip(self):
+        # Odd widths cover the unpaired middle column and the SIMD tail.
+        for bitsize in (8, 16, 24, 32):
+            for w, h in ((1, 1), (9, 5), (17, 4)):
+                surf = pygame.Surface((w, h), 0, bitsize)
+                for x in range(w):
+                    for y in range(h):
+                        surf.set_at((x, y), ((x * 29) % 256, (y * 53) % 256, 7))
+                for flip_x, flip_y in ((1, 0), (0, 1), (1, 1), (0, 0)):
+                    with self.subTest(bitsize=bitsize, size=(w, h), x=flip_x, y=flip_y):
+                        comp = pygame.transform.flip(surf, flip_x, flip_y)
+                        flipped = surf.copy()
+                        flipped.flip_ip(flip_x, flip_y)
+                        for x in range(w):
+                            for y in range(h):
+                                self.assertEqual(
+                                    flipped.get_at((x, y)), comp.get_at((x, y))
+                                )
+
+        # Keyword arguments, and flipping twice restores the image.
+        surf = pygame.Surface((6, 3), pygame.SRCALPHA, 32)
+        surf.set_at((0, 0), (1, 2, 3, 4))
+        self.assertIsNone(surf.flip_ip(flip_x=True, flip_y=True))
+        self.assertEqual(surf.get_at((5, 2)), (1, 2, 3, 4))
+        surf.flip_ip(True, True)
+        self.assertEqual(surf.get_at((0, 0)), (1, 2, 3, 4))
+
 
 class SurfaceSubtypeTest(unittest.TestCase):
     """Issue #280: Methods that return a new Surface preserve subclasses"""
@@ -3771,6 +3896,22 @@ class SurfaceBlendTest(unittest.TestCase):
                 dst.fill(fill_color, special_flags=getattr(pygame, blend_name))
                 self._assert_surface(dst, p, ", %s" % blend_name)
 
+    def test_fill_blend_premultiplied(self):
+        def blend(s, d, a):
+            return s + d - (((d + 1) * a) >> 8)
+
+        dst = pygame.Surface((4, 4), pygame.SRCALPHA, 32)
+        for dst_color in [(0, 0, 0, 0), (255, 255, 255, 255), (10, 100, 50, 200)]:
+            for color in [(0, 0, 0, 0), (100, 50, 25, 128), (255, 0, 90, 255)]:
+                dst.fill(dst_color)
+                dst.fill(color, special_flags=pygame.BLEND_PREMULTIPLIED)
+                expected = tuple(
+                    blend(color[i], dst_color[i], color[3]) for i in range(4)
+                )
+                self.assertEqual(
+                    dst.get_at((1, 1)), expected, (dst_color, color)
+                )
+
 
 class SurfaceSelfBlitTest(unittest.TestCase):
     """Blit to self tests.
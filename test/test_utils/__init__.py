@@ -1,3 +1,4 @@
+import array
 import os
 import pygame
 import sys
@@ -185,6 +186,14 @@ def rect_outer_bounds(rect):
     ]
 
 
+def number_array(typecode, rows):
+    """Returns rows of numbers as a 2 dimensional buffer of typecode items,
+    as taken by the batched draw, gfxdraw and mask functions."""
+    cols = len(rows[0]) if rows else 0
+    flat = array.array(typecode, [value for row in rows for value in row])
+    return memoryview(flat).cast("B").cast(typecode, (len(rows), cols))
+
+
 def import_submodule(module):
     m = __import__(module)
     for n in module.split(".")[1:]:
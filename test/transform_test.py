@@ -1,6 +1,7 @@
 import unittest
 import os
 import platform
+import math
 
 from pygame.tests import test_utils
 from pygame.tests.test_utils import example_path
@@ -812,6 +813,199 @@ class TransformModuleTest(unittest.TestCase):
         finally:
             pygame.display.quit()
 
+    def test_laplacian__in_place(self):
+        """Ensure laplacian can write into its own source surface."""
+        s1 = pygame.Surface((16, 16))
+        s1.fill((10, 10, 70))
+        pygame.draw.line(s1, (255, 0, 0), (3, 10), (12, 10))
+        expected = pygame.transform.laplacian(s1)
+
+        self.assertIs(pygame.transform.laplacian(s1, s1), s1)
+
+        for pos in ((0, 0), (3, 10), (8, 9), (8, 11)):
+            self.assertEqual(s1.get_at(pos), expected.get_at(pos))
+
+    def test_convolve(self):
+        """Ensure convolve applies a kernel to every channel."""
+        surf = pygame.Surface((10, 10), SRCALPHA, 32)
+        surf.fill((40, 80, 120, 200))
+        surf.set_at((5, 5), (140, 80, 20, 255))
+
+        identity = ((0, 0, 0), (0, 1, 0), (0, 0, 0))
+        result = pygame.transform.convolve(surf, identity)
+        self.assertEqual(result.get_size(), surf.get_size())
+        self.assertEqual(result.get_at((5, 5)), (140, 80, 20, 255))
+        self.assertEqual(result.get_at((0, 9)), (40, 80, 120, 200))
+
+        blur = [[1 / 9.0] * 3] * 3
+        result = pygame.transform.convolve(surf, blur)
+        self.assertEqual(result.get_at((5, 5)), (51, 80, 109, 206))
+        self.assertEqual(result.get_at((4, 6)), (51, 80, 109, 206))
+        self.assertEqual(result.get_at((0, 0)), (40, 80, 120, 200))
+
+        # results are clamped to 0-255
+        sharpen = ((0, -1, 0), (-1, 5, -1), (0, -1, 0))
+        result = pygame.transform.convolve(surf, sharpen)
+        self.assertEqual(result.get_at((5, 5)), (255, 80, 0, 255))
+        self.assertEqual(result.get_at((5, 4)), (0, 80, 220, 145))
+
+    def test_convolve__borders(self):
+        """Ensure the border modes pick the right pixels past the edges."""
+        surf = pygame.Surface((5, 1), 0, 32)
+        for x, value in enumerate((10, 20, 30, 40, 50)):
+            surf.set_at((x, 0), (value, value, value))
+        left = ((1, 0, 0),)
+
+        result = pygame.transform.convolve(surf, left, border="clamp")
+        self.assertEqual(result.get_at((0, 0)), (10, 10, 10, 255))
+        result = pygame.transform.convolve(surf, left, border="wrap")
+        self.assertEqual(result.get_at((0, 0)), (50, 50, 50, 255))
+        result = pygame.transform.convolve(
+            surf, left, border="constant", border_color=(1, 2, 3)
+        )
+        self.assertEqual(result.get_at((0, 0)), (1, 2, 3, 255))
+        self.assertEqual(result.get_at((4, 0)), (40, 40, 40, 255))
+
+        self.assertRaises(
+            ValueError, pygame.transform.convolve, surf, left, border="mirror"
+        )
+
+    def test_convolve__formats(self):
+        """Ensure convolve gives the same result for all bit depths."""
+        kernel = (
+            (0, 0, 1, 0, 0),
+            (0, 0, 0, 0, 0),
+            (1, 0, -2, 0, 1),
+            (0, 0, 0, 0, 0),
+            (0, 0, 1, 0, 0),
+        )
+        expected = None
+        for depth in (32, 24, 16):
+            surf = pygame.Surface((64, 48), 0, depth)
+            surf.fill((0, 0, 0))
+            pygame.draw.rect(surf, (248, 252, 248), (20, 10, 12, 14))
+
+            result = pygame.transform.convolve(surf, kernel)
+            colors = [result.get_at(pos) for pos in ((20, 10), (18, 12), (0, 0))]
+            if expected is None:
+                expected = colors
+            self.assertEqual(colors, expected, "depth %d" % depth)
+
+        dest = pygame.Surface((64, 48), 0, 8)
+        self.assertIs(pygame.transform.convolve(surf, kernel, dest), dest)
+
+    def test_convolve__invalid_kernels(self):
+        """Ensure badly sized kernels are rejected."""
+        surf = pygame.Surface((8, 8))
+        convolve = pygame.transform.convolve
+
+        self.assertRaises(ValueError, convolve, surf, ())
+        self.assertRaises(ValueError, convolve, surf, ((1, 1),))
+        self.assertRaises(ValueError, convolve, surf, ((1,), (1,)))
+        self.assertRaises(ValueError, convolve, surf, [[0] * 9] * 9)
+        self.assertRaises(ValueError, convolve, surf, ((1, 1, 1), (1,), (1,)))
+        self.assertRaises(TypeError, convolve, surf, 1)
+        self.assertRaises(TypeError, convolve, surf, ((1, "a", 1),))
+        self.assertRaises(ValueError, convolve, surf, ((1,),), pygame.Surface((4, 4)))
+
+    def test_apply_lut(self):
+        invert = bytes(255 - i for i in range(256))
+        halve = [i // 2 for i in range(256)]
+
+        for depth, flags in ((32, pygame.SRCALPHA), (32, 0), (24, 0)):
+            s = pygame.Surface((9, 3), flags, depth)
+            s.fill((200, 100, 0, 255))
+            s.set_at((4, 1), (0, 255, 64, 255))
+
+            result = pygame.transform.apply_lut(s, invert, None, halve)
+
+            self.assertEqual(result.get_size(), s.get_size())
+            self.assertEqual(result.get_at((0, 0)), (55, 100, 0, 255))
+            self.assertEqual(result.get_at((4, 1)), (255, 255, 32, 255))
+
+        # Other formats are remapped through their colors.
+        s = pygame.Surface((4, 4), 0, 16)
+        s.fill((0, 0, 0))
+        result = pygame.transform.apply_lut(s, invert, invert, invert)
+        self.assertEqual(result.get_at((0, 0)), (255, 255, 255, 255))
+
+        # Alpha has its own table.
+        s = pygame.Surface((3, 3), pygame.SRCALPHA, 32)
+        s.fill((10, 20, 30, 40))
+        result = pygame.transform.apply_lut(s, lut_a=invert)
+        self.assertEqual(result.get_at((1, 1)), (10, 20, 30, 215))
+
+    def test_apply_lut__in_place(self):
+        s = pygame.Surface((5, 5), 0, 32)
+        s.fill((1, 2, 3))
+        lut = [min(i * 10, 255) for i in range(256)]
+
+        result = pygame.transform.apply_lut(s, lut, lut, lut, dest_surface=s)
+
+        self.assertIs(result, s)
+        self.assertEqual(s.get_at((2, 2)), (10, 20, 30, 255))
+
+        dest = pygame.Surface((5, 5), 0, 24)
+        pygame.transform.apply_lut(s, lut_r=lut, dest_surface=dest)
+        self.assertEqual(dest.get_at((2, 2)), (100, 20, 30, 255))
+
+    def test_apply_lut__invalid(self):
+        s = pygame.Surface((5, 5), 0, 32)
+
+        with self.assertRaises(ValueError):
+            pygame.transform.apply_lut(s, list(range(255)))
+        with self.assertRaises(ValueError):
+            pygame.transform.apply_lut(s, [256] * 256)
+        with self.assertRaises(TypeError):
+            pygame.transform.apply_lut(s, "x" * 256)
+        with self.assertRaises(ValueError):
+            pygame.transform.apply_lut(s, dest_surface=pygame.Surface((4, 5)))
+
+    def test_color_matrix(self):
+        gray = (
+            (0.25, 0.5, 0.25, 0, 0),
+            (0.25, 0.5, 0.25, 0, 0),
+            (0.25, 0.5, 0.25, 0, 0),
+            (0, 0, 0, 1, 0),
+        )
+        for depth, flags in ((32, pygame.SRCALPHA), (32, 0), (24, 0)):
+            s = pygame.Surface((7, 3), flags, depth)
+            s.fill((200, 100, 40, 255))
+
+            result = pygame.transform.color_matrix(s, gray)
+
+            self.assertEqual(result.get_at((3, 1)), (110, 110, 110, 255))
+
+        # Channel swap, offsets and clamping.
+        s = pygame.Surface((6, 2), pygame.SRCALPHA, 32)
+        s.fill((10, 20, 30, 128))
+        matrix = (
+            (0, 0, 1, 0, 0),
+            (0, 0, 0, 0, 255),
+            (2, 0, 0, 0, -30),
+            (0, 0, 0, 2, 0),
+        )
+        result = pygame.transform.color_matrix(surface=s, matrix=matrix)
+        self.assertEqual(result.get_at((5, 1)), (30, 255, 0, 255))
+
+        # Alpha reads as opaque without per pixel alpha.
+        s = pygame.Surface((4, 4), 0, 32)
+        s.fill((0, 0, 0))
+        matrix = ((0, 0, 0, 0.5, 0),) * 3 + ((0, 0, 0, 1, 0),)
+        result = pygame.transform.color_matrix(s, matrix, dest_surface=s)
+        self.assertIs(result, s)
+        self.assertEqual(s.get_at((0, 0)), (128, 128, 128, 255))
+
+    def test_color_matrix__invalid(self):
+        s = pygame.Surface((5, 5), 0, 32)
+
+        with self.assertRaises(TypeError):
+            pygame.transform.color_matrix(s, ((1, 0, 0, 0),) * 4)
+        with self.assertRaises(TypeError):
+            pygame.transform.color_matrix(s, ((1, 0, 0, 0, 0),) * 3)
+        with self.assertRaises(TypeError):
+            pygame.transform.color_matrix(s, ((1, 0, 0, 0, "0"),) * 4)
+
     def test_average_surfaces(self):
         """ """
 
@@ -940,6 +1134,64 @@ class TransformModuleTest(unittest.TestCase):
         self.assertEqual(dest_surface.get_size(), expected_size)
         self.assertEqual(dest_surface.get_flags(), expected_flags)
 
+    def test_average_surfaces__32_odd_width(self):
+        """Ensure the 32 bit fast path handles rows not a multiple of 4."""
+        size = (7, 3)
+        s1 = pygame.Surface(size, SRCALPHA, 32)
+        s2 = pygame.Surface(size, SRCALPHA, 32)
+        s1.fill((10, 20, 30, 0))
+        s2.fill((21, 40, 61, 100))
+        s2.set_at((6, 2), (1, 2, 3, 4))
+
+        sr = pygame.transform.average_surfaces([s1, s2])
+
+        for pos in ((0, 0), (3, 1), (6, 1)):
+            self.assertEqual(sr.get_at(pos), (16, 30, 46, 255))
+        self.assertEqual(sr.get_at((6, 2)), (6, 11, 17, 255))
+
+    def test_surface_accumulator(self):
+        """Ensure SurfaceAccumulator averages surfaces one at a time."""
+        size = (9, 4)
+        acc = pygame.transform.SurfaceAccumulator(size)
+        self.assertEqual(acc.get_size(), size)
+        self.assertEqual(acc.get_count(), 0)
+        self.assertRaises(ValueError, acc.get_average)
+
+        for color in ((10, 20, 30, 40), (20, 30, 40, 50), (30, 40, 50, 60)):
+            s = pygame.Surface(size, SRCALPHA, 32)
+            s.fill(color)
+            acc.add(s)
+        self.assertEqual(acc.get_count(), 3)
+
+        average = acc.get_average()
+        self.assertEqual(average.get_size(), size)
+        self.assertEqual(average.get_at((0, 0)), (20, 30, 40, 50))
+        self.assertEqual(average.get_at((8, 3)), (20, 30, 40, 50))
+
+        acc.clear()
+        self.assertEqual(acc.get_count(), 0)
+        self.assertRaises(ValueError, acc.get_average)
+
+    def test_surface_accumulator__mixed_formats(self):
+        """Ensure surfaces of other formats are accumulated too."""
+        size = (5, 5)
+        acc = pygame.transform.SurfaceAccumulator(size)
+        for depth, color in ((32, (100, 0, 50)), (24, (0, 100, 50)), (16, (0, 0, 0))):
+            s = pygame.Surface(size, 0, depth)
+            s.fill(color)
+            acc.add(s)
+
+        self.assertEqual(acc.get_average().get_at((2, 2)), (33, 33, 33, 255))
+
+        dest = pygame.Surface(size, 0, 24)
+        self.assertIs(acc.get_average(dest_surface=dest), dest)
+        self.assertEqual(dest.get_at((4, 4)), (33, 33, 33, 255))
+
+        self.assertRaises(ValueError, acc.add, pygame.Surface((4, 5)))
+        self.assertRaises(
+            ValueError, acc.get_average, dest_surface=pygame.Surface((4, 5))
+        )
+
     def test_average_color(self):
         """ """
 
@@ -1006,6 +1258,120 @@ class TransformModuleTest(unittest.TestCase):
         for pt, color in gradient:
             self.assertTrue(s.get_at(pt) == color)
 
+    def test_affine__identity(self):
+        s = pygame.Surface((7, 5), pygame.SRCALPHA)
+        for pt, color in test_utils.gradient(7, 5):
+            s.set_at(pt, color)
+
+        result = pygame.transform.affine(s, ((1, 0), (0, 1)))
+
+        self.assertEqual(result.get_size(), (7, 5))
+        for pt, color in test_utils.gradient(7, 5):
+            self.assertEqual(result.get_at(pt), color)
+
+    def test_affine__matches_rotate_and_scale(self):
+        w, h = 6, 4
+        s = pygame.Surface((w, h), pygame.SRCALPHA)
+        for pt, color in test_utils.gradient(w, h):
+            s.set_at(pt, color)
+
+        rotated = pygame.transform.affine(s, ((0, 1), (-1, 0)))
+        expected = pygame.transform.rotate(s, 90)
+        self.assertEqual(rotated.get_size(), expected.get_size())
+        for x in range(h):
+            for y in range(w):
+                self.assertEqual(rotated.get_at((x, y)), expected.get_at((x, y)))
+
+        scaled = pygame.transform.affine(surface=s, matrix=((2, 0), (0, 3)))
+        expected = pygame.transform.scale(s, (w * 2, h * 3))
+        self.assertEqual(scaled.get_size(), (w * 2, h * 3))
+        for x in range(w * 2):
+            for y in range(h * 3):
+                self.assertEqual(scaled.get_at((x, y)), expected.get_at((x, y)))
+
+        # Mirroring keeps the size and needs no translation.
+        mirrored = pygame.transform.affine(s, ((-1, 0), (0, 1)))
+        self.assertEqual(mirrored.get_at((0, 0)), s.get_at((w - 1, 0)))
+
+    def test_affine__size_and_translation(self):
+        s = pygame.Surface((4, 4))
+        s.fill((10, 20, 30))
+        s.set_colorkey((1, 2, 3))
+
+        result = pygame.transform.affine(s, ((1, 0, 5), (0, 1, 6)), size=(12, 12))
+
+        self.assertEqual(result.get_size(), (12, 12))
+        self.assertEqual(result.get_at((5, 6)), (10, 20, 30, 255))
+        self.assertEqual(result.get_at((8, 9)), (10, 20, 30, 255))
+        # Uncovered areas take the colorkey.
+        self.assertEqual(result.get_at((4, 6))[:3], (1, 2, 3))
+        self.assertEqual(result.get_at((9, 9))[:3], (1, 2, 3))
+
+    def test_affine__dest_surface(self):
+        s = pygame.Surface((4, 4), pygame.SRCALPHA)
+        s.fill((255, 0, 0))
+        dest = pygame.Surface((10, 10), pygame.SRCALPHA)
+
+        result = pygame.transform.affine(
+            s, ((1, 0, 3), (0, 1, 3)), dest_surface=dest
+        )
+
+        self.assertIs(result, dest)
+        self.assertEqual(dest.get_at((3, 3)), (255, 0, 0, 255))
+        self.assertEqual(dest.get_at((0, 0)).a, 0)
+
+        with self.assertRaises(ValueError):
+            pygame.transform.affine(s, ((1, 0), (0, 1)), dest_surface=s)
+        with self.assertRaises(ValueError):
+            pygame.transform.affine(
+                s, ((1, 0), (0, 1)), size=(4, 4), dest_surface=dest
+            )
+        with self.assertRaises(ValueError):
+            pygame.transform.affine(
+                s, ((1, 0), (0, 1)), dest_surface=pygame.Surface((4, 4), 0, 24)
+            )
+
+    def test_affine__smooth(self):
+        for depth in (24, 32):
+            s = pygame.Surface((8, 8), 0, depth)
+            s.fill((40, 80, 120))
+
+            result = pygame.transform.affine(s, ((3, 1), (-1, 3)), smooth=True)
+
+            w, h = result.get_size()
+            self.assertEqual((w, h), (32, 32))
+            # The middle is covered by the source on all sides.
+            self.assertEqual(result.get_at((w // 2, h // 2)), (40, 80, 120, 255))
+
+        s = pygame.Surface((8, 8), pygame.SRCALPHA)
+        s.fill((255, 255, 255, 255))
+        result = pygame.transform.affine(s, ((4, 0), (0, 4)), smooth=True)
+        # Edges fade into the transparent background.
+        self.assertEqual(result.get_at((16, 16)), (255, 255, 255, 255))
+        self.assertLess(result.get_at((0, 16)).a, 255)
+
+        with self.assertRaises(ValueError):
+            pygame.transform.affine(
+                pygame.Surface((4, 4), 0, 8), ((2, 0), (0, 2)), smooth=True
+            )
+
+    def test_affine__invalid_matrix(self):
+        s = pygame.Surface((4, 4))
+
+        with self.assertRaises(ValueError):
+            pygame.transform.affine(s, ((1, 2), (2, 4)))
+        with self.assertRaises(TypeError):
+            pygame.transform.affine(s, (1, 0, 0, 1))
+        with self.assertRaises(TypeError):
+            pygame.transform.affine(s, ((1, 0), (0, 1), (0, 0)))
+        with self.assertRaises(TypeError):
+            pygame.transform.affine(s, ((1, 0), (0, "1")))
+
+    def test_affine__empty_surface(self):
+        result = pygame.transform.affine(pygame.Surface((0, 5)), ((2, 0), (0, 2)))
+
+        self.assertEqual(result.get_size(), (0, 10))
+
     def test_scale2x(self):
 
         # __doc__ (as of 2008-06-25) for pygame.transform.scale2x:
@@ -1166,6 +1532,71 @@ class TransformModuleTest(unittest.TestCase):
         self.assertEqual(s1.get_rect(), pygame.Rect(0, 0, 0, 0))
         self.assertEqual(s2.get_rect(), pygame.Rect(0, 0, 0, 0))
 
+    def test_rotozoom__large_surface(self):
+        """Large outputs are split in row bands; check every band.
+
+        The source is made of 10x10 cells, each with its own red and green,
+        so a band reading the wrong rows or a bad interpolation gives colors
+        outside the cells around the point the pixel maps back to.
+        """
+        cell, margin = 10, 1.0
+        s = pygame.Surface((300, 300), pygame.SRCALPHA, 32)
+        for x in range(0, 300, cell):
+            for y in range(0, 300, cell):
+                s.fill((x // cell * 8, y // cell * 8, 128), (x, y, cell, cell))
+
+        for angle, scale in ((0, 1.5), (45, 1.5), (90, 2)):
+            result = pygame.transform.rotozoom(s, angle, scale)
+            w, h = result.get_size()
+            cos_a = math.cos(math.radians(angle)) / scale
+            sin_a = math.sin(math.radians(angle)) / scale
+            for y in range(0, h, 3):
+                for x in range(0, w, 3):
+                    # The point of the source this pixel comes from.
+                    dx, dy = x - w / 2.0, y - h / 2.0
+                    sx = dx * cos_a - dy * sin_a + 150
+                    sy = dx * sin_a + dy * cos_a + 150
+                    if not (margin <= sx < 300 - margin) or not (
+                        margin <= sy < 300 - margin
+                    ):
+                        continue
+                    r, g, b, a = result.get_at((x, y))
+                    pos = (angle, x, y)
+                    self.assertEqual((b, a), (128, 255), pos)
+                    self.assertTrue(int((sx - margin) / cell) * 8 <= r, pos)
+                    self.assertTrue(r <= int((sx + margin) / cell) * 8, pos)
+                    self.assertTrue(int((sy - margin) / cell) * 8 <= g, pos)
+                    self.assertTrue(g <= int((sy + margin) / cell) * 8, pos)
+
+    def test_premultiplied__kept(self):
+        """Ensures scale, smoothscale and rotozoom keep premultiplication.
+
+        The results are flagged PREMULTIPLIED and no color channel exceeds
+        the alpha, while plain surfaces stay unflagged.
+        """
+        s = pygame.Surface((16, 16), pygame.SRCALPHA, 32)
+        s.fill((200, 100, 50, 128))
+        s.fill((0, 0, 0, 0), (0, 0, 8, 16))
+        s = s.premul_alpha()
+
+        results = [
+            pygame.transform.scale(s, (32, 32)),
+            pygame.transform.smoothscale(s, (24, 24)),
+            pygame.transform.smoothscale(s, (8, 8)),
+            pygame.transform.rotozoom(s, 30, 1.5),
+        ]
+        for result in results:
+            self.assertTrue(result.get_flags() & pygame.PREMULTIPLIED)
+            w, h = result.get_size()
+            for x in range(w):
+                for y in range(h):
+                    r, g, b, a = result.get_at((x, y))
+                    self.assertTrue(max(r, g, b) <= a, (x, y, (r, g, b, a)))
+
+        plain = pygame.Surface((16, 16), pygame.SRCALPHA, 32)
+        result = pygame.transform.smoothscale(plain, (8, 8))
+        self.assertFalse(result.get_flags() & pygame.PREMULTIPLIED)
+
     def test_smoothscale(self):
         """Tests the stated boundaries, sizing, and color blending of smoothscale function"""
         # __doc__ (as of 2008-08-02) for pygame.transform.smoothscale:
@@ -1310,6 +1741,53 @@ class TransformDisplayModuleTest(unittest.TestCase):
         self.assertEqual(surf.get_at((0, 0)), surf2.get_at((0, 0)))
         self.assertEqual(surf2.get_at((0, 0)), (255, 0, 0, 255))
 
+    def test_flip__dest_surface(self):
+        s = pygame.Surface((5, 3), 0, 32)
+        s.fill((0, 0, 0))
+        s.set_at((0, 0), (255, 0, 0))
+        dest = pygame.Surface((5, 3), 0, 32)
+
+        result = pygame.transform.flip(s, True, True, dest_surface=dest)
+
+        self.assertIs(result, dest)
+        self.assertEqual(dest.get_at((4, 2)), (255, 0, 0, 255))
+        self.assertEqual(s.get_at((0, 0)), (255, 0, 0, 255))
+
+        # Passing the source flips it in place.
+        result = pygame.transform.flip(s, True, False, s)
+        self.assertIs(result, s)
+        self.assertEqual(s.get_at((4, 0)), (255, 0, 0, 255))
+
+        with self.assertRaises(ValueError):
+            pygame.transform.flip(s, True, False, pygame.Surface((3, 5), 0, 32))
+        with self.assertRaises(ValueError):
+            pygame.transform.flip(s, True, False, pygame.Surface((5, 3), 0, 8))
+
+    def test_rotate__dest_surface(self):
+        s = pygame.Surface((4, 2), 0, 32)
+        s.fill((0, 0, 0))
+        s.set_at((3, 0), (0, 0, 255))
+
+        for angle in (90, 180, -90, 360, 30):
+            expected = pygame.transform.rotate(s, angle)
+            dest = pygame.Surface(expected.get_size(), 0, 32)
+            result = pygame.transform.rotate(s, angle, dest_surface=dest)
+            self.assertIs(result, dest)
+            for x in range(dest.get_width()):
+                for y in range(dest.get_height()):
+                    self.assertEqual(dest.get_at((x, y)), expected.get_at((x, y)))
+
+        # Half turns can be done in place.
+        result = pygame.transform.rotate(s, 180, s)
+        self.assertIs(result, s)
+        self.assertEqual(s.get_at((0, 1)), (0, 0, 255, 255))
+
+        with self.assertRaises(ValueError):
+            pygame.transform.rotate(s, 90, pygame.Surface((4, 2), 0, 32))
+        with self.assertRaises(ValueError):
+            square = pygame.Surface((4, 4), 0, 32)
+            pygame.transform.rotate(square, 90, square)
+
 
 if __name__ == "__main__":
     unittest.main()